@@ -9,11 +9,18 @@
 #ifndef OPENMVG_CAMERAS_CAMERA_UNDISTORT_IMAGE_HPP
 #define OPENMVG_CAMERAS_CAMERA_UNDISTORT_IMAGE_HPP
 
-#include <limits>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
 
 #include "openMVG/cameras/Camera_Intrinsics.hpp"
 #include "openMVG/image/image_container.hpp"
+#include "openMVG/image/pixel_types.hpp"
 #include "openMVG/image/sample.hpp"
 
 namespace openMVG
@@ -61,6 +68,209 @@ void UndistortImage(
   }
 }
 
+/**
+* @brief Precomputed undistortion map of a camera: for each pixel of the
+*  undistorted image, the position of the distorted (input) image pixel used for
+*  the bilinear sampling, in a compact fixed point format (8 bytes per pixel).
+*  It computes the distortion once per intrinsic instead of once per image.
+*/
+class UndistortionMap
+{
+public:
+  /// Remap entry: top left source pixel and the bilinear weights of its right
+  ///  and bottom neighbors (fixed point, kWeightOne means 1)
+  struct Entry
+  {
+    uint32_t offset; // kInvalidOffset if the source pixel is outside the image
+    uint16_t wx, wy;
+  };
+  static const uint32_t kInvalidOffset = std::numeric_limits<uint32_t>::max();
+  static const uint16_t kWeightOne = 1 << 15;
+
+  /**
+  * @brief Compute the map of a camera for images of the given size
+  *  (the undistorted image has the same size than the input image)
+  * @param cam Intrinsic parameter used to undistort the images
+  * @param width Image width
+  * @param height Image height
+  */
+  UndistortionMap(
+    const IntrinsicBase * cam,
+    const int width,
+    const int height )
+    : width_( width ), height_( height ),
+      entries_( static_cast<size_t>( width ) * height )
+  {
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for
+#endif
+    for ( int j = 0; j < height_; ++j )
+      for ( int i = 0; i < width_; ++i )
+      {
+        // compute coordinates with distortion
+        const Vec2 disto_pix = cam->get_d_pixel( Vec2( i, j ) );
+        Entry & entry = entries_[ static_cast<size_t>( j ) * width_ + i ];
+        entry.offset = kInvalidOffset;
+        entry.wx = entry.wy = 0;
+        // keep the pixel if it is in the image domain
+        if ( !( disto_pix( 0 ) >= 0.0 && disto_pix( 0 ) < width_ &&
+                disto_pix( 1 ) >= 0.0 && disto_pix( 1 ) < height_ ) )
+          continue;
+        // top left neighbor (the right/bottom neighbor must be in the image)
+        const int x0 = std::max( 0, std::min( static_cast<int>( disto_pix( 0 ) ), width_ - 2 ) );
+        const int y0 = std::max( 0, std::min( static_cast<int>( disto_pix( 1 ) ), height_ - 2 ) );
+        const double fx = std::min( 1.0, std::max( 0.0, disto_pix( 0 ) - x0 ) );
+        const double fy = std::min( 1.0, std::max( 0.0, disto_pix( 1 ) - y0 ) );
+        entry.offset = static_cast<uint32_t>( static_cast<size_t>( y0 ) * width_ + x0 );
+        entry.wx = static_cast<uint16_t>( fx * kWeightOne + 0.5 );
+        entry.wy = static_cast<uint16_t>( fy * kWeightOne + 0.5 );
+      }
+  }
+
+  int Width() const { return width_; }
+  int Height() const { return height_; }
+  const std::vector<Entry> & Entries() const { return entries_; }
+
+private:
+  int width_, height_;
+  std::vector<Entry> entries_;
+};
+
+/**
+* @brief Thread safe cache of the undistortion maps, shared by the images
+*  having the same intrinsic (hash value) and the same size.
+*/
+class UndistortionMapCache
+{
+public:
+  /**
+  * @brief Return the undistortion map of a camera (computed on the first request)
+  * @param cam Intrinsic parameter used to undistort the images
+  * @param width Image width
+  * @param height Image height
+  */
+  std::shared_ptr<const UndistortionMap> Get(
+    const IntrinsicBase * cam,
+    const int width,
+    const int height )
+  {
+    // The map is computed with the lock held: the cache is meant for a
+    //  few intrinsics shared by many images.
+    std::lock_guard<std::mutex> lock( mutex_ );
+    std::shared_ptr<const UndistortionMap> & map =
+      maps_[ std::make_tuple( cam->hashValue(), width, height ) ];
+    if ( !map )
+      map = std::make_shared<UndistortionMap>( cam, width, height );
+    return map;
+  }
+
+private:
+  std::mutex mutex_;
+  std::map<std::tuple<std::size_t, int, int>, std::shared_ptr<const UndistortionMap>> maps_;
+};
+
+namespace internal
+{
+
+/// Channel description of the pixel types supported by the remap kernel
+template <typename T>
+struct RemapPixel
+{
+  using channel_type = T;
+  static const int channels = 1;
+};
+
+template <typename T>
+struct RemapPixel<image::Rgb<T>>
+{
+  using channel_type = T;
+  static const int channels = 3;
+};
+
+template <typename T>
+struct RemapPixel<image::Rgba<T>>
+{
+  using channel_type = T;
+  static const int channels = 4;
+};
+
+/// Convert an interpolated value to a channel value
+template <typename T>
+inline T RemapChannel( const float value )
+{
+  return static_cast<T>( value );
+}
+
+template <>
+inline unsigned char RemapChannel<unsigned char>( const float value )
+{
+  // the bilinear interpolation keeps the value in the channel range
+  return static_cast<unsigned char>( value + 0.5f );
+}
+
+} // namespace internal
+
+/**
+* @brief  Undistort an image with a precomputed undistortion map (bilinear sampling)
+* @param imageIn Input image
+* @param map Undistortion map computed for the input image size
+* @param[out] image_ud Output undistorted image
+* @param fillcolor color used to fill pixels where no input pixel is found
+* @param b_parallel undistort the rows in parallel (false if the caller
+*  already runs several images at once)
+* @return false if the map does not fit the input image size
+*/
+template <typename Image>
+bool UndistortImage(
+  const Image& imageIn,
+  const UndistortionMap & map,
+  Image & image_ud,
+  typename Image::Tpixel fillcolor = typename Image::Tpixel( 0 ),
+  const bool b_parallel = true )
+{
+  using Pixel = internal::RemapPixel<typename Image::Tpixel>;
+  using channel_type = typename Pixel::channel_type;
+  static_assert( sizeof( typename Image::Tpixel ) == Pixel::channels * sizeof( channel_type ),
+    "The remap kernel requires packed pixel channels" );
+
+  if ( imageIn.Width() != map.Width() || imageIn.Height() != map.Height() ||
+       imageIn.Width() < 2 || imageIn.Height() < 2 )
+    return false;
+
+  image_ud.resize( imageIn.Width(), imageIn.Height(), true, fillcolor );
+  const channel_type * source = reinterpret_cast<const channel_type *>( imageIn.data() );
+  channel_type * target = reinterpret_cast<channel_type *>( image_ud.data() );
+  const size_t row_stride = static_cast<size_t>( imageIn.Width() ) * Pixel::channels;
+  const UndistortionMap::Entry * entries = map.Entries().data();
+  const float weight_scale = 1.0f / UndistortionMap::kWeightOne;
+
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for if ( b_parallel )
+#endif
+  for ( int j = 0; j < imageIn.Height(); ++j )
+  {
+    const size_t row_begin = static_cast<size_t>( j ) * imageIn.Width();
+    for ( int i = 0; i < imageIn.Width(); ++i )
+    {
+      const UndistortionMap::Entry & entry = entries[ row_begin + i ];
+      if ( entry.offset == UndistortionMap::kInvalidOffset )
+        continue;
+      const float fx = entry.wx * weight_scale;
+      const float fy = entry.wy * weight_scale;
+      const channel_type * top = source + static_cast<size_t>( entry.offset ) * Pixel::channels;
+      const channel_type * bottom = top + row_stride;
+      channel_type * out = target + ( row_begin + i ) * Pixel::channels;
+      for ( int c = 0; c < Pixel::channels; ++c )
+      {
+        const float top_value = top[ c ] + fx * ( static_cast<float>( top[ c + Pixel::channels ] ) - top[ c ] );
+        const float bottom_value = bottom[ c ] + fx * ( static_cast<float>( bottom[ c + Pixel::channels ] ) - bottom[ c ] );
+        out[ c ] = internal::RemapChannel<channel_type>( top_value + fy * ( bottom_value - top_value ) );
+      }
+    }
+  }
+  return true;
+}
+
 /**
 * @brief  Undistort an image according a given camera & its distortion model
 * @param imageIn Input image
@@ -0,0 +1,83 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/cameras/Camera_Pinhole_Radial.hpp"
+#include "openMVG/cameras/Camera_undistort_image.hpp"
+
+#include "testing/testing.h"
+
+using namespace openMVG;
+using namespace openMVG::cameras;
+using namespace openMVG::image;
+
+// Smooth synthetic image (the bilinear sampling error is small)
+template <typename Image, typename Functor>
+Image SyntheticImage(const int width, const int height, Functor pixel)
+{
+  Image image(width, height);
+  for (int j = 0; j < height; ++j)
+    for (int i = 0; i < width; ++i)
+      image(j, i) = pixel(0.5 + 0.5 * std::sin(i / 7.0) * std::cos(j / 11.0));
+  return image;
+}
+
+TEST(UndistortionMap, Same_As_Direct_Undistortion) {
+
+  const int width = 320, height = 240;
+  const Pinhole_Intrinsic_Radial_K3 cam(width, height, 300.0, width / 2.0, height / 2.0, -0.25, 0.05, 0.0);
+
+  UndistortionMapCache cache;
+  const std::shared_ptr<const UndistortionMap> map = cache.Get(&cam, width, height);
+  EXPECT_EQ(width, map->Width());
+  EXPECT_EQ(height, map->Height());
+  // The map is shared by the images having the same intrinsic and size
+  EXPECT_EQ(map.get(), cache.Get(&cam, width, height).get());
+  EXPECT_TRUE(map.get() != cache.Get(&cam, width / 2, height / 2).get());
+
+  {
+    const Image<unsigned char> image = SyntheticImage<Image<unsigned char>>(width, height,
+      [](double v) { return static_cast<unsigned char>(255 * v); });
+    Image<unsigned char> image_ud, image_ud_map;
+    UndistortImage(image, &cam, image_ud);
+    EXPECT_TRUE(UndistortImage(image, *map, image_ud_map));
+    EXPECT_EQ(image_ud.Width(), image_ud_map.Width());
+    EXPECT_EQ(image_ud.Height(), image_ud_map.Height());
+    EXPECT_TRUE((image_ud.cast<int>() - image_ud_map.cast<int>()).cwiseAbs().maxCoeff() <= 1);
+  }
+  {
+    const Image<float> image = SyntheticImage<Image<float>>(width, height,
+      [](double v) { return static_cast<float>(v); });
+    Image<float> image_ud, image_ud_map;
+    UndistortImage(image, &cam, image_ud);
+    EXPECT_TRUE(UndistortImage(image, *map, image_ud_map));
+    EXPECT_TRUE((image_ud - image_ud_map).cwiseAbs().maxCoeff() < 1e-3);
+    // The serial kernel gives the same image
+    Image<float> image_ud_serial;
+    EXPECT_TRUE(UndistortImage(image, *map, image_ud_serial, 0.f, false));
+    EXPECT_TRUE(image_ud_serial == image_ud_map);
+  }
+  {
+    const Image<RGBColor> image = SyntheticImage<Image<RGBColor>>(width, height,
+      [](double v) { return RGBColor(255 * v, 255 * (1.0 - v), 128); });
+    Image<RGBColor> image_ud, image_ud_map;
+    UndistortImage(image, &cam, image_ud, BLACK);
+    EXPECT_TRUE(UndistortImage(image, *map, image_ud_map, BLACK));
+    int max_difference = 0;
+    for (int j = 0; j < height; ++j)
+      for (int i = 0; i < width; ++i)
+        max_difference = std::max(max_difference,
+          (image_ud(j, i).cast<int>() - image_ud_map(j, i).cast<int>()).cwiseAbs().maxCoeff());
+    EXPECT_TRUE(max_difference <= 1);
+  }
+
+  // The map must fit the image size
+  Image<unsigned char> small_image(width / 2, height / 2), small_image_ud;
+  EXPECT_FALSE(UndistortImage(small_image, *map, small_image_ud));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -0,0 +1,151 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/geometry/aabb_tree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace openMVG
+{
+namespace geometry
+{
+
+namespace
+{
+// Maximal number of boxes in a leaf
+const IndexT kLeafSize = 4;
+
+/// Representative point of a box used to split the boxes: its center, or its
+///  finite bound along the axes where it is unbounded
+Vec3 Anchor( const AABB & box )
+{
+  Vec3 anchor;
+  for ( int axis = 0; axis < 3; ++axis )
+  {
+    const double lo = box.min()[axis], hi = box.max()[axis];
+    if ( std::isfinite( lo ) && std::isfinite( hi ) )
+      anchor[axis] = ( lo + hi ) / 2.;
+    else if ( std::isfinite( lo ) )
+      anchor[axis] = lo;
+    else if ( std::isfinite( hi ) )
+      anchor[axis] = hi;
+    else
+      anchor[axis] = 0.;
+  }
+  return anchor;
+}
+} // namespace
+
+AABB_Tree::AABB_Tree( const std::vector<AABB> & boxes )
+  : boxes_( boxes ),
+    indexes_( boxes.size() )
+{
+  std::iota( indexes_.begin(), indexes_.end(), 0 );
+  if ( !boxes_.empty() )
+  {
+    nodes_.reserve( 2 * ( boxes_.size() / kLeafSize + 1 ) );
+    Build( 0, static_cast<IndexT>( boxes_.size() ) );
+  }
+}
+
+IndexT AABB_Tree::Build( const IndexT begin, const IndexT end )
+{
+  const IndexT node_index = static_cast<IndexT>( nodes_.size() );
+  nodes_.push_back( { AABB(), begin, end, UndefinedIndexT, UndefinedIndexT } );
+
+  AABB node_box, anchor_box;
+  for ( IndexT i = begin; i < end; ++i )
+  {
+    node_box.extend( boxes_[indexes_[i]] );
+    anchor_box.extend( Anchor( boxes_[indexes_[i]] ) );
+  }
+  nodes_[node_index].box = node_box;
+
+  if ( end - begin > kLeafSize )
+  {
+    // Split at the median of the anchors along the largest axis
+    int axis;
+    anchor_box.sizes().maxCoeff( &axis );
+    const IndexT middle = begin + ( end - begin ) / 2;
+    std::nth_element( indexes_.begin() + begin, indexes_.begin() + middle,
+      indexes_.begin() + end,
+      [&]( const IndexT a, const IndexT b )
+      {
+        return Anchor( boxes_[a] )[axis] < Anchor( boxes_[b] )[axis];
+      } );
+    const IndexT left = Build( begin, middle );
+    const IndexT right = Build( middle, end );
+    nodes_[node_index].left = left;
+    nodes_[node_index].right = right;
+  }
+  return node_index;
+}
+
+void AABB_Tree::Query( const AABB & box, std::vector<IndexT> & indexes ) const
+{
+  indexes.clear();
+  if ( nodes_.empty() )
+    return;
+
+  std::vector<IndexT> stack( 1, 0 );
+  while ( !stack.empty() )
+  {
+    const Node & node = nodes_[stack.back()];
+    stack.pop_back();
+    if ( !node.box.intersects( box ) )
+      continue;
+    if ( node.isLeaf() )
+    {
+      for ( IndexT i = node.begin; i < node.end; ++i )
+      {
+        if ( boxes_[indexes_[i]].intersects( box ) )
+          indexes.push_back( indexes_[i] );
+      }
+    }
+    else
+    {
+      stack.push_back( node.left );
+      stack.push_back( node.right );
+    }
+  }
+}
+
+std::vector<std::pair<IndexT, IndexT>> AABB_Tree::OverlappingPairs() const
+{
+  std::vector<std::pair<IndexT, IndexT>> pairs;
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    std::vector<std::pair<IndexT, IndexT>> thread_pairs;
+    std::vector<IndexT> indexes;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic, 64)
+#endif
+    for ( int i = 0; i < static_cast<int>( boxes_.size() ); ++i )
+    {
+      Query( boxes_[i], indexes );
+      for ( const IndexT j : indexes )
+      {
+        if ( static_cast<IndexT>( i ) < j )
+          thread_pairs.emplace_back( i, j );
+      }
+    }
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp critical
+#endif
+    {
+      pairs.insert( pairs.end(), thread_pairs.cbegin(), thread_pairs.cend() );
+    }
+  }
+  std::sort( pairs.begin(), pairs.end() );
+  return pairs;
+}
+
+} // namespace geometry
+} // namespace openMVG
@@ -0,0 +1,75 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_GEOMETRY_AABB_TREE_HPP
+#define OPENMVG_GEOMETRY_AABB_TREE_HPP
+
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+#include "openMVG/types.hpp"
+
+#include <Eigen/Geometry>
+
+#include <utility>
+#include <vector>
+
+namespace openMVG
+{
+namespace geometry
+{
+
+/// Axis aligned bounding box (bounds can be infinite)
+using AABB = Eigen::AlignedBox<double, 3>;
+
+/**
+* @brief Bounding volume hierarchy of axis aligned bounding boxes.
+*  The static binary tree is built by splitting the boxes at the median of
+*  their centers along the largest axis. It is used as a broad phase to find
+*  the overlapping boxes without testing all the pairs.
+*  The boxes can be unbounded along some axes (i.e. infinite frustums).
+*/
+class AABB_Tree
+{
+public:
+  explicit AABB_Tree( const std::vector<AABB> & boxes );
+
+  /**
+  * @brief List the boxes that overlap a given box
+  * @param box The query box
+  * @param[out] indexes Indexes (in the input vector) of the overlapping boxes
+  */
+  void Query( const AABB & box, std::vector<IndexT> & indexes ) const;
+
+  /**
+  * @brief List all the pairs of overlapping boxes (computed in parallel)
+  * @return The pairs of indexes (i, j) with i < j, sorted
+  */
+  std::vector<std::pair<IndexT, IndexT>> OverlappingPairs() const;
+
+  /// Number of boxes in the tree
+  size_t size() const { return boxes_.size(); }
+
+private:
+  struct Node
+  {
+    AABB box;
+    // Leaf: range [begin, end) in indexes_, inner node: children indexes
+    IndexT begin, end;
+    IndexT left, right;
+    bool isLeaf() const { return left == UndefinedIndexT; }
+  };
+
+  /// Build the subtree of the boxes indexes_[begin, end), return its node index
+  IndexT Build( const IndexT begin, const IndexT end );
+
+  std::vector<AABB> boxes_;
+  std::vector<IndexT> indexes_;
+  std::vector<Node> nodes_;
+};
+
+} // namespace geometry
+} // namespace openMVG
+
+#endif // OPENMVG_GEOMETRY_AABB_TREE_HPP
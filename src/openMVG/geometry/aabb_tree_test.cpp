@@ -0,0 +1,117 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/geometry/aabb_tree.hpp"
+#include "openMVG/geometry/frustum.hpp"
+#include "openMVG/multiview/test_data_sets.hpp"
+
+#include "CppUnitLite/TestHarness.h"
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::geometry;
+
+// Overlapping pairs by exhaustive comparison
+std::vector<std::pair<IndexT, IndexT>> BruteForcePairs(const std::vector<AABB> & boxes)
+{
+  std::vector<std::pair<IndexT, IndexT>> pairs;
+  for (IndexT i = 0; i < boxes.size(); ++i)
+    for (IndexT j = i + 1; j < boxes.size(); ++j)
+      if (boxes[i].intersects(boxes[j]))
+        pairs.emplace_back(i, j);
+  return pairs;
+}
+
+TEST(AABB_Tree, Random_Boxes)
+{
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> position(-10.0, 10.0), size(0.1, 2.0);
+  std::vector<AABB> boxes;
+  for (int i = 0; i < 500; ++i)
+  {
+    const Vec3 min(position(random_generator), position(random_generator), position(random_generator));
+    boxes.emplace_back(min, min + Vec3(size(random_generator), size(random_generator), size(random_generator)));
+  }
+  // Some unbounded boxes
+  const double inf = std::numeric_limits<double>::infinity();
+  boxes.emplace_back(Vec3(0, 0, 0), Vec3(inf, 1, 1));
+  boxes.emplace_back(Vec3(-inf, -inf, -5), Vec3(-8, inf, -4));
+
+  const AABB_Tree tree(boxes);
+  EXPECT_EQ(boxes.size(), tree.size());
+  const std::vector<std::pair<IndexT, IndexT>> pairs = tree.OverlappingPairs();
+  const std::vector<std::pair<IndexT, IndexT>> expected_pairs = BruteForcePairs(boxes);
+  EXPECT_FALSE(expected_pairs.empty());
+  EXPECT_TRUE(pairs == expected_pairs);
+
+  // Query
+  std::vector<IndexT> indexes;
+  const AABB query(Vec3(-1, -1, -1), Vec3(1, 1, 1));
+  tree.Query(query, indexes);
+  std::sort(indexes.begin(), indexes.end());
+  std::vector<IndexT> expected_indexes;
+  for (IndexT i = 0; i < boxes.size(); ++i)
+    if (boxes[i].intersects(query))
+      expected_indexes.push_back(i);
+  EXPECT_TRUE(indexes == expected_indexes);
+}
+
+TEST(AABB_Tree, Empty)
+{
+  const AABB_Tree tree({});
+  EXPECT_TRUE(tree.OverlappingPairs().empty());
+  std::vector<IndexT> indexes;
+  tree.Query(AABB(Vec3(-1, -1, -1), Vec3(1, 1, 1)), indexes);
+  EXPECT_TRUE(indexes.empty());
+}
+
+// The bounding box overlaps are a superset of the frustum intersections
+TEST(AABB_Tree, Frustum_Broad_Phase)
+{
+  const int focal = 1000;
+  const int principal_Point = 500;
+  const int iNviews = 32;
+  const NViewDataSet d =
+    NRealisticCamerasRing(
+    iNviews, 6,
+    nViewDatasetConfigurator(focal, focal, principal_Point, principal_Point, 5, 0));
+
+  for (const bool b_truncated : {true, false})
+  {
+    std::vector<Frustum> frustums;
+    std::vector<AABB> boxes;
+    for (int i = 0; i < iNviews; ++i)
+    {
+      frustums.push_back(b_truncated ?
+        Frustum(principal_Point*2, principal_Point*2, d._K[i], d._R[i], d._C[i], 0.1, 1.5) :
+        Frustum(principal_Point*2, principal_Point*2, d._K[i], d._R[i], d._C[i]));
+      boxes.push_back(frustums.back().bounding_box());
+      // The supporting points are in the box
+      for (const Vec3 & point : frustums.back().frustum_points())
+        EXPECT_TRUE(boxes.back().contains(point));
+    }
+
+    const std::vector<std::pair<IndexT, IndexT>> candidates =
+      AABB_Tree(boxes).OverlappingPairs();
+    // The truncated frustums are pruned by the broad phase
+    if (b_truncated)
+      EXPECT_TRUE(candidates.size() < static_cast<size_t>(iNviews * (iNviews - 1) / 2));
+    for (int i = 0; i < iNviews; ++i)
+      for (int j = i + 1; j < iNviews; ++j)
+        if (frustums[i].intersect(frustums[j]))
+          EXPECT_TRUE(std::binary_search(candidates.cbegin(), candidates.cend(),
+            std::pair<IndexT, IndexT>(i, j)));
+  }
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -10,6 +10,7 @@
 
 #include <fstream>
 #include <iomanip>
+#include <limits>
 
 namespace openMVG{
 namespace geometry{
@@ -139,6 +140,31 @@ const std::vector<Vec3> & Frustum::frustum_points() const
   return points;
 }
 
+AABB Frustum::bounding_box() const
+{
+  AABB box;
+  if ( isTruncated() )
+  {
+    for ( const Vec3 & point : points )
+      box.extend( point );
+    return box;
+  }
+  // Infinite frustum: the box is unbounded along the viewing rays directions
+  box.extend( cones[0] );
+  for ( int i = 1; i < 5; ++i )
+  {
+    const Vec3 ray = cones[i] - cones[0];
+    for ( int axis = 0; axis < 3; ++axis )
+    {
+      if ( ray[axis] > 0. )
+        box.max()[axis] = std::numeric_limits<double>::infinity();
+      else if ( ray[axis] < 0. )
+        box.min()[axis] = - std::numeric_limits<double>::infinity();
+    }
+  }
+  return box;
+}
+
 bool Frustum::export_Ply
 (
   const Frustum & frustum,
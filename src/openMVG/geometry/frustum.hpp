@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 
+#include "openMVG/geometry/aabb_tree.hpp"
 #include "openMVG/geometry/half_space_intersection.hpp"
 
 namespace openMVG
@@ -129,6 +130,16 @@ struct Frustum : public HalfPlaneObject
   */
   const std::vector<Vec3> & frustum_points() const;
 
+  /**
+  * @brief Return the axis aligned bounding box of the frustum
+  * @return Bounding box of the supporting points (truncated frustum)
+  * @note The box of an infinite frustum is unbounded along the directions of its viewing rays:
+  *  two such boxes overlap as soon as the cameras look to the same half-spaces, so a broad
+  *  phase built on them can only discard the pairs of cameras looking away from each other.
+  *  Use truncated frustums (near and far planes, i.e. from the landmarks depths) to bound them.
+  */
+  AABB bounding_box() const;
+
   /**
   * @brief Export the Frustum as a PLY file (infinite frustum as exported as a normalized cone)
   * @return true if the file can be saved on disk
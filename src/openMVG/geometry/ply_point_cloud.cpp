@@ -0,0 +1,512 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/geometry/ply_point_cloud.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace openMVG {
+namespace geometry {
+
+namespace {
+
+// Size of the record buffer before it is written
+const std::size_t kBufferSize = 1 << 22;
+// Number of points of a block formatted by a thread
+const std::size_t kBlockSize = 1 << 15;
+// Number of blocks formatted (in parallel) before being written
+const std::size_t kBatchBlockCount = 16;
+// Size of a binary (double x, y, z, uchar red, green, blue) record
+const std::size_t kBinaryRecordSize = 3 * sizeof(double) + 3;
+// Maximal size of an ASCII record ("%.16f" of the largest doubles)
+const std::size_t kAsciiRecordMaxSize = 1024;
+
+bool IsLittleEndianHost()
+{
+  const uint16_t value = 1;
+  unsigned char first_byte;
+  std::memcpy(&first_byte, &value, 1);
+  return first_byte == 1;
+}
+
+void AppendRecord
+(
+  std::vector<char> & buffer,
+  const bool b_ascii,
+  const Vec3 & X,
+  const Ply_Color & color
+)
+{
+  if (b_ascii)
+  {
+    char record[kAsciiRecordMaxSize];
+    const int size = std::snprintf(record, sizeof(record),
+      "%.16f %.16f %.16f %d %d %d\n", X(0), X(1), X(2),
+      static_cast<int>(color(0)), static_cast<int>(color(1)), static_cast<int>(color(2)));
+    buffer.insert(buffer.end(), record, record + std::min<std::size_t>(size, sizeof(record) - 1));
+  }
+  else
+  {
+    const std::size_t offset = buffer.size();
+    buffer.resize(offset + kBinaryRecordSize);
+    char * record = &buffer[offset];
+    std::memcpy(record, X.data(), 3 * sizeof(double));
+    if (!IsLittleEndianHost())
+    {
+      for (int i = 0; i < 3; ++i)
+        std::reverse(record + i * sizeof(double), record + (i + 1) * sizeof(double));
+    }
+    std::memcpy(record + 3 * sizeof(double), color.data(), 3);
+  }
+}
+
+// Color from RGB components in [0,255]
+Ply_Color ToColor(const Vec3 & rgb)
+{
+  const Vec3 clamped = rgb.cwiseMax(0.0).cwiseMin(255.0);
+  return Ply_Color(
+    static_cast<unsigned char>(clamped(0)),
+    static_cast<unsigned char>(clamped(1)),
+    static_cast<unsigned char>(clamped(2)));
+}
+
+template <typename T>
+double DecodeValue(const char * data, const bool b_swap)
+{
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, data, sizeof(T));
+  if (b_swap)
+    std::reverse(bytes, bytes + sizeof(T));
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  return static_cast<double>(value);
+}
+
+} // namespace
+
+//-----------------
+//-- Ply_Point_Writer
+//-----------------
+
+Ply_Point_Writer::~Ply_Point_Writer()
+{
+  if (stream_.is_open())
+    Close();
+}
+
+bool Ply_Point_Writer::Open
+(
+  const std::string & filename,
+  const std::size_t vertex_count,
+  const bool b_ascii
+)
+{
+  if (stream_.is_open())
+    Close();
+
+  stream_.clear();
+  stream_.open(filename.c_str(), std::ios::out | std::ios::binary);
+  if (!stream_.is_open())
+    return false;
+
+  b_ascii_ = b_ascii;
+  vertex_count_ = vertex_count;
+  written_count_ = 0;
+
+  std::ostringstream header;
+  header << "ply"
+    << '\n' << "format "
+            << (b_ascii ? "ascii 1.0" : "binary_little_endian 1.0")
+    << '\n' << "comment generated by OpenMVG"
+    << '\n' << "element vertex " << vertex_count
+    << '\n' << "property double x"
+    << '\n' << "property double y"
+    << '\n' << "property double z"
+    << '\n' << "property uchar red"
+    << '\n' << "property uchar green"
+    << '\n' << "property uchar blue"
+    << '\n' << "end_header" << '\n';
+  const std::string header_string = header.str();
+  buffer_.reserve(kBufferSize + kAsciiRecordMaxSize);
+  buffer_.assign(header_string.cbegin(), header_string.cend());
+  return true;
+}
+
+bool Ply_Point_Writer::Write
+(
+  const Vec3 & X,
+  const Ply_Color & color
+)
+{
+  return WriteRecords(&X, 1, nullptr, color);
+}
+
+bool Ply_Point_Writer::Write
+(
+  const std::vector<Vec3> & points,
+  const Ply_Color & color
+)
+{
+  return WriteRecords(points.data(), points.size(), nullptr, color);
+}
+
+bool Ply_Point_Writer::Write
+(
+  const std::vector<Vec3> & points,
+  const std::vector<Vec3> & colors
+)
+{
+  if (colors.size() != points.size())
+    return false;
+  return WriteRecords(points.data(), points.size(), colors.data(), Ply_Color::Zero());
+}
+
+bool Ply_Point_Writer::WriteRecords
+(
+  const Vec3 * points,
+  const std::size_t count,
+  const Vec3 * colors,
+  const Ply_Color & color
+)
+{
+  if (!stream_.is_open())
+    return false;
+
+  // Small arrays are formatted in the record buffer
+  if (count < kBlockSize)
+  {
+    for (std::size_t i = 0; i < count; ++i)
+      AppendRecord(buffer_, b_ascii_, points[i], colors ? ToColor(colors[i]) : color);
+    written_count_ += count;
+    if (buffer_.size() >= kBufferSize)
+      return FlushBuffer();
+    return stream_.good();
+  }
+
+  // Large arrays are formatted by blocks in parallel, and written in order
+  if (!FlushBuffer())
+    return false;
+  std::vector<std::vector<char>> blocks(kBatchBlockCount);
+  for (std::size_t batch_begin = 0; batch_begin < count; batch_begin += kBlockSize * kBatchBlockCount)
+  {
+    const int block_count = static_cast<int>(std::min(kBatchBlockCount,
+      (count - batch_begin + kBlockSize - 1) / kBlockSize));
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int b = 0; b < block_count; ++b)
+    {
+      const std::size_t begin = batch_begin + b * kBlockSize;
+      const std::size_t end = std::min(count, begin + kBlockSize);
+      std::vector<char> & block = blocks[b];
+      block.clear();
+      block.reserve((end - begin) * (b_ascii_ ? 64 : kBinaryRecordSize));
+      for (std::size_t i = begin; i < end; ++i)
+        AppendRecord(block, b_ascii_, points[i], colors ? ToColor(colors[i]) : color);
+    }
+    for (int b = 0; b < block_count; ++b)
+      stream_.write(blocks[b].data(), blocks[b].size());
+    if (!stream_.good())
+      return false;
+  }
+  written_count_ += count;
+  return true;
+}
+
+bool Ply_Point_Writer::FlushBuffer()
+{
+  if (!buffer_.empty())
+  {
+    stream_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+  return stream_.good();
+}
+
+bool Ply_Point_Writer::Close()
+{
+  if (!stream_.is_open())
+    return false;
+  bool bOk = FlushBuffer();
+  stream_.close();
+  bOk &= !stream_.fail();
+  return bOk && written_count_ == vertex_count_;
+}
+
+//-----------------
+//-- Ply_Point_Reader
+//-----------------
+
+bool Ply_Point_Reader::Open(const std::string & filename)
+{
+  if (stream_.is_open())
+    stream_.close();
+  stream_.clear();
+  properties_.clear();
+  record_size_ = vertex_count_ = read_count_ = 0;
+  b_valid_ = false;
+
+  stream_.open(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!stream_.is_open())
+    return false;
+  b_valid_ = ParseHeader();
+  return b_valid_;
+}
+
+bool Ply_Point_Reader::HasColors() const
+{
+  int color_count = 0;
+  for (const Property & property : properties_)
+    color_count += property.usage >= 3;
+  return color_count == 3;
+}
+
+bool Ply_Point_Reader::ParseHeader()
+{
+  static const char * const property_names[] = {"x", "y", "z", "red", "green", "blue"};
+  struct Scalar_Type { const char * name; Scalar type; std::size_t size; };
+  static const Scalar_Type scalar_types[] = {
+    {"char", Scalar::INT8, 1}, {"int8", Scalar::INT8, 1},
+    {"uchar", Scalar::UINT8, 1}, {"uint8", Scalar::UINT8, 1},
+    {"short", Scalar::INT16, 2}, {"int16", Scalar::INT16, 2},
+    {"ushort", Scalar::UINT16, 2}, {"uint16", Scalar::UINT16, 2},
+    {"int", Scalar::INT32, 4}, {"int32", Scalar::INT32, 4},
+    {"uint", Scalar::UINT32, 4}, {"uint32", Scalar::UINT32, 4},
+    {"float", Scalar::FLOAT32, 4}, {"float32", Scalar::FLOAT32, 4},
+    {"double", Scalar::FLOAT64, 8}, {"float64", Scalar::FLOAT64, 8}};
+
+  // Elements stored before the vertices: (count, record size, has list properties)
+  struct Element { std::size_t count; std::size_t size; bool b_list; };
+  std::vector<Element> skipped_elements;
+  enum { NONE, BEFORE_VERTEX, VERTEX, AFTER_VERTEX } element_state = NONE;
+  bool b_vertex_found = false, b_format_found = false;
+
+  std::string line;
+  if (!std::getline(stream_, line) || line.compare(0, 3, "ply") != 0)
+    return false;
+  while (std::getline(stream_, line))
+  {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    std::istringstream tokens(line);
+    std::string keyword;
+    tokens >> keyword;
+    if (keyword == "end_header")
+      break;
+    if (keyword == "format")
+    {
+      std::string format;
+      tokens >> format;
+      if (format == "ascii")
+        format_ = Format::ASCII;
+      else if (format == "binary_little_endian")
+        format_ = Format::BINARY_LITTLE_ENDIAN;
+      else if (format == "binary_big_endian")
+        format_ = Format::BINARY_BIG_ENDIAN;
+      else
+        return false;
+      b_format_found = true;
+    }
+    else if (keyword == "element")
+    {
+      std::string name;
+      std::size_t count = 0;
+      if (!(tokens >> name >> count))
+        return false;
+      if (name == "vertex")
+      {
+        element_state = VERTEX;
+        vertex_count_ = count;
+        b_vertex_found = true;
+      }
+      else if (!b_vertex_found)
+      {
+        element_state = BEFORE_VERTEX;
+        skipped_elements.push_back({count, 0, false});
+      }
+      else
+      {
+        element_state = AFTER_VERTEX;
+      }
+    }
+    else if (keyword == "property")
+    {
+      std::string type_name, name;
+      tokens >> type_name;
+      if (type_name == "list")
+      {
+        // Variable size records: only supported in ASCII before the vertices
+        if (element_state == VERTEX)
+          return false;
+        if (element_state == BEFORE_VERTEX)
+          skipped_elements.back().b_list = true;
+        continue;
+      }
+      tokens >> name;
+      const auto scalar_type = std::find_if(std::begin(scalar_types), std::end(scalar_types),
+        [&type_name](const Scalar_Type & type) { return type_name == type.name; });
+      if (scalar_type == std::end(scalar_types) || name.empty())
+        return false;
+
+      if (element_state == BEFORE_VERTEX)
+      {
+        skipped_elements.back().size += scalar_type->size;
+      }
+      else if (element_state == VERTEX)
+      {
+        int usage = -1;
+        for (int i = 0; i < 6; ++i)
+        {
+          if (name == property_names[i] || (i >= 3 && name == std::string("diffuse_") + property_names[i]))
+            usage = i;
+        }
+        properties_.push_back({scalar_type->type, record_size_, usage});
+        record_size_ += scalar_type->size;
+      }
+    }
+    // comment, obj_info and unknown lines are ignored
+  }
+  if (!stream_ || !b_format_found || !b_vertex_found)
+    return false;
+
+  // x, y and z are required
+  for (int i = 0; i < 3; ++i)
+  {
+    if (std::none_of(properties_.cbegin(), properties_.cend(),
+          [i](const Property & property) { return property.usage == i; }))
+      return false;
+  }
+
+  // Skip the elements stored before the vertices
+  for (const Element & element : skipped_elements)
+  {
+    if (format_ == Format::ASCII)
+    {
+      for (std::size_t i = 0; i < element.count; ++i)
+        std::getline(stream_, line);
+    }
+    else
+    {
+      if (element.b_list)
+        return false;
+      stream_.seekg(element.count * element.size, std::ios::cur);
+    }
+  }
+  return stream_.good() || vertex_count_ == 0;
+}
+
+std::size_t Ply_Point_Reader::Read
+(
+  const std::size_t max_count,
+  std::vector<Vec3> & points,
+  std::vector<Ply_Color> * colors
+)
+{
+  points.clear();
+  if (colors)
+    colors->clear();
+  if (!b_valid_)
+    return 0;
+
+  const std::size_t count = std::min(max_count, vertex_count_ - read_count_);
+  if (count == 0)
+    return 0;
+  points.resize(count);
+  if (colors)
+    colors->assign(count, Ply_Color(255, 255, 255));
+
+  // Color components: integers are clamped to [0,255], reals in [0,1] are scaled
+  const auto to_color_component = [](const Scalar type, const double value)
+  {
+    const double scaled =
+      (type == Scalar::FLOAT32 || type == Scalar::FLOAT64) ? value * 255.0 : value;
+    return static_cast<unsigned char>(std::min(255.0, std::max(0.0, scaled)));
+  };
+
+  if (format_ == Format::ASCII)
+  {
+    std::string line;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      if (!std::getline(stream_, line))
+      {
+        b_valid_ = false;
+        points.resize(i);
+        if (colors)
+          colors->resize(i);
+        read_count_ += i;
+        return i;
+      }
+      const char * cursor = line.c_str();
+      for (const Property & property : properties_)
+      {
+        char * end = nullptr;
+        const double value = std::strtod(cursor, &end);
+        cursor = end;
+        if (property.usage < 0)
+          continue;
+        if (property.usage < 3)
+          points[i](property.usage) = value;
+        else if (colors)
+          (*colors)[i](property.usage - 3) = to_color_component(property.type, value);
+      }
+    }
+    read_count_ += count;
+    return count;
+  }
+
+  // Binary records are decoded in parallel
+  buffer_.resize(count * record_size_);
+  stream_.read(buffer_.data(), buffer_.size());
+  if (static_cast<std::size_t>(stream_.gcount()) != buffer_.size())
+  {
+    b_valid_ = false;
+    points.clear();
+    if (colors)
+      colors->clear();
+    return 0;
+  }
+  const bool b_swap = (format_ == Format::BINARY_LITTLE_ENDIAN) != IsLittleEndianHost();
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 4096)
+#endif
+  for (int64_t i = 0; i < static_cast<int64_t>(count); ++i)
+  {
+    const char * record = &buffer_[i * record_size_];
+    for (const Property & property : properties_)
+    {
+      if (property.usage < 0 || (property.usage >= 3 && !colors))
+        continue;
+      const char * data = record + property.offset;
+      double value = 0.0;
+      switch (property.type)
+      {
+        case Scalar::INT8: value = DecodeValue<int8_t>(data, b_swap); break;
+        case Scalar::UINT8: value = DecodeValue<uint8_t>(data, b_swap); break;
+        case Scalar::INT16: value = DecodeValue<int16_t>(data, b_swap); break;
+        case Scalar::UINT16: value = DecodeValue<uint16_t>(data, b_swap); break;
+        case Scalar::INT32: value = DecodeValue<int32_t>(data, b_swap); break;
+        case Scalar::UINT32: value = DecodeValue<uint32_t>(data, b_swap); break;
+        case Scalar::FLOAT32: value = DecodeValue<float>(data, b_swap); break;
+        case Scalar::FLOAT64: value = DecodeValue<double>(data, b_swap); break;
+      }
+      if (property.usage < 3)
+        points[i](property.usage) = value;
+      else
+        (*colors)[i](property.usage - 3) = to_color_component(property.type, value);
+    }
+  }
+  read_count_ += count;
+  return count;
+}
+
+} // namespace geometry
+} // namespace openMVG
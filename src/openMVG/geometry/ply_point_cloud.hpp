@@ -0,0 +1,180 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_GEOMETRY_PLY_POINT_CLOUD_HPP
+#define OPENMVG_GEOMETRY_PLY_POINT_CLOUD_HPP
+
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace openMVG {
+namespace geometry {
+
+/// RGB color of a PLY vertex
+using Ply_Color = Eigen::Matrix<unsigned char, 3, 1>;
+
+/**
+* @brief Streaming writer of colored 3D points in a PLY file.
+*
+* The vertices are stored as (double x, y, z, uchar red, green, blue)
+*  records, in binary little endian (default) or in ASCII.
+* The records are formatted in a large buffer that is written with few big
+*  write calls. The point arrays are split in blocks that are formatted in
+*  parallel (OpenMP) and written in order.
+*
+* Usage:
+* @code
+* Ply_Point_Writer writer;
+* if (writer.Open("cloud.ply", points.size() + 1))
+* {
+*   writer.Write(points); // white points
+*   writer.Write(camera_center, Ply_Color(0, 255, 0));
+*   bOk = writer.Close();
+* }
+* @endcode
+*/
+class Ply_Point_Writer
+{
+public:
+  ~Ply_Point_Writer();
+
+  /**
+  * @brief Create the file and write the PLY header.
+  * @param vertex_count number of points that will be written
+  * @param b_ascii ASCII or binary little endian records
+  */
+  bool Open
+  (
+    const std::string & filename,
+    const std::size_t vertex_count,
+    const bool b_ascii = false
+  );
+
+  /// Write a point
+  bool Write
+  (
+    const Vec3 & X,
+    const Ply_Color & color = Ply_Color(255, 255, 255)
+  );
+
+  /// Write points of the same color
+  bool Write
+  (
+    const std::vector<Vec3> & points,
+    const Ply_Color & color = Ply_Color(255, 255, 255)
+  );
+
+  /// Write points with their colors (RGB components in [0,255])
+  bool Write
+  (
+    const std::vector<Vec3> & points,
+    const std::vector<Vec3> & colors
+  );
+
+  /**
+  * @brief Flush the buffered records and close the file.
+  * @return false if an error occured or if the number of written points
+  *  differs from the one given to Open
+  */
+  bool Close();
+
+private:
+  bool WriteRecords
+  (
+    const Vec3 * points,
+    const std::size_t count,
+    const Vec3 * colors,
+    const Ply_Color & color
+  );
+  bool FlushBuffer();
+
+  std::ofstream stream_;
+  bool b_ascii_ = false;
+  std::size_t vertex_count_ = 0;
+  std::size_t written_count_ = 0;
+  std::vector<char> buffer_;
+};
+
+/**
+* @brief Streaming reader of the vertices of a PLY file.
+*
+* ASCII, binary little endian and binary big endian files are supported.
+* The x, y, z and (optional) red, green, blue vertex properties are read,
+*  whatever their scalar type; the other vertex properties are skipped.
+* The vertices are read by batches, so point clouds larger than the memory
+*  can be ingested.
+*
+* Usage:
+* @code
+* Ply_Point_Reader reader;
+* std::vector<Vec3> points;
+* if (reader.Open("cloud.ply"))
+*   while (reader.Read(1 << 20, points) > 0)
+*     // use points
+* @endcode
+*/
+class Ply_Point_Reader
+{
+public:
+  /// Open the file and parse its header
+  bool Open(const std::string & filename);
+
+  /// Number of vertices declared in the header
+  std::size_t vertex_count() const { return vertex_count_; }
+
+  /// Tell if the vertices have red, green and blue properties
+  bool HasColors() const;
+
+  /**
+  * @brief Read the next vertices.
+  * @param max_count maximum number of vertices to read
+  * @param[out] points the read points (previous content is discarded)
+  * @param[out] colors if set, the read colors (white if the file has none)
+  * @return the number of read vertices (0 at the end of the vertices or on error)
+  */
+  std::size_t Read
+  (
+    const std::size_t max_count,
+    std::vector<Vec3> & points,
+    std::vector<Ply_Color> * colors = nullptr
+  );
+
+  /// Tell if all the vertices have been read successfully
+  bool IsComplete() const { return b_valid_ && read_count_ == vertex_count_; }
+
+private:
+  enum class Scalar { INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT32, FLOAT64 };
+
+  // Vertex property (used properties: x, y, z, red, green, blue)
+  struct Property
+  {
+    Scalar type;
+    std::size_t offset; // In the binary record
+    int usage;          // 0..5 for x, y, z, red, green, blue, -1 if unused
+  };
+
+  enum class Format { ASCII, BINARY_LITTLE_ENDIAN, BINARY_BIG_ENDIAN };
+
+  bool ParseHeader();
+
+  std::ifstream stream_;
+  Format format_ = Format::ASCII;
+  std::vector<Property> properties_;
+  std::size_t record_size_ = 0;
+  std::size_t vertex_count_ = 0;
+  std::size_t read_count_ = 0;
+  bool b_valid_ = false;
+  std::vector<char> buffer_;
+};
+
+} // namespace geometry
+} // namespace openMVG
+
+#endif // OPENMVG_GEOMETRY_PLY_POINT_CLOUD_HPP
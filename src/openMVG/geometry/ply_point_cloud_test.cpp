@@ -0,0 +1,144 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/geometry/ply_point_cloud.hpp"
+
+#include "CppUnitLite/TestHarness.h"
+#include "testing/testing.h"
+
+#include <cstdio>
+#include <fstream>
+
+using namespace openMVG;
+using namespace openMVG::geometry;
+
+namespace {
+
+// Points and colors of the test cloud (large enough to use the parallel blocks)
+void create_test_cloud
+(
+  const std::size_t point_count,
+  std::vector<Vec3> & points,
+  std::vector<Vec3> & colors
+)
+{
+  points.resize(point_count);
+  colors.resize(point_count);
+  for (std::size_t i = 0; i < point_count; ++i)
+  {
+    points[i] = Vec3(i, -0.5 * i, 1.0 / (i + 1));
+    colors[i] = Vec3(i % 256, (i / 256) % 256, 7);
+  }
+}
+
+} // namespace
+
+// Write the test cloud and a green point, then read it back by batches
+TEST(Ply_Point_Cloud, Round_trip)
+{
+  for (const bool b_ascii : {false, true})
+  {
+    const std::string filename = b_ascii ? "ply_ascii.ply" : "ply_binary.ply";
+    std::vector<Vec3> points, colors;
+    create_test_cloud(100000, points, colors);
+
+    Ply_Point_Writer writer;
+    EXPECT_TRUE(writer.Open(filename, points.size() + 1, b_ascii));
+    EXPECT_TRUE(writer.Write(Vec3(1, 2, 3), Ply_Color(0, 255, 0)));
+    EXPECT_TRUE(writer.Write(points, colors));
+    EXPECT_TRUE(writer.Close());
+
+    Ply_Point_Reader reader;
+    EXPECT_TRUE(reader.Open(filename));
+    EXPECT_EQ(points.size() + 1, reader.vertex_count());
+    EXPECT_TRUE(reader.HasColors());
+
+    std::vector<Vec3> read_points;
+    std::vector<Ply_Color> read_colors;
+    EXPECT_EQ(1, reader.Read(1, read_points, &read_colors));
+    EXPECT_MATRIX_EQ(Vec3(1, 2, 3), read_points[0]);
+    EXPECT_TRUE(read_colors[0] == Ply_Color(0, 255, 0));
+
+    std::size_t index = 0;
+    while (reader.Read(30000, read_points, &read_colors) > 0)
+    {
+      for (std::size_t i = 0; i < read_points.size(); ++i, ++index)
+      {
+        EXPECT_MATRIX_NEAR(points[index], read_points[i], 1e-12);
+        EXPECT_TRUE(read_colors[i] == colors[index].cast<unsigned char>());
+      }
+    }
+    EXPECT_EQ(points.size(), index);
+    EXPECT_TRUE(reader.IsComplete());
+    std::remove(filename.c_str());
+  }
+}
+
+TEST(Ply_Point_Cloud, Vertex_count_mismatch)
+{
+  const std::string filename = "ply_mismatch.ply";
+  Ply_Point_Writer writer;
+  EXPECT_TRUE(writer.Open(filename, 2));
+  EXPECT_TRUE(writer.Write(Vec3(1, 2, 3)));
+  EXPECT_FALSE(writer.Close());
+  std::remove(filename.c_str());
+}
+
+TEST(Ply_Point_Cloud, Read_foreign_layout)
+{
+  // Big endian float coordinates, an extra property and a leading element
+  const std::string filename = "ply_foreign.ply";
+  {
+    std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
+    stream << "ply\n"
+      << "format binary_big_endian 1.0\n"
+      << "element camera 1\n"
+      << "property float focal\n"
+      << "element vertex 2\n"
+      << "property float z\n"
+      << "property float x\n"
+      << "property int confidence\n"
+      << "property float y\n"
+      << "element face 0\n"
+      << "property list uchar int vertex_indices\n"
+      << "end_header\n";
+    const auto write_big_endian = [&stream](const char * value, const std::size_t size)
+    {
+      for (std::size_t i = 0; i < size; ++i)
+        stream.put(value[size - 1 - i]);
+    };
+    // Assume the test host is little endian (as the PLY files written by OpenMVG)
+    const float focal = 1000.f;
+    write_big_endian(reinterpret_cast<const char*>(&focal), sizeof(float));
+    for (int i = 0; i < 2; ++i)
+    {
+      const float z = 3.f + i, x = 1.f + i, y = 2.f + i;
+      const int confidence = 42;
+      write_big_endian(reinterpret_cast<const char*>(&z), sizeof(float));
+      write_big_endian(reinterpret_cast<const char*>(&x), sizeof(float));
+      write_big_endian(reinterpret_cast<const char*>(&confidence), sizeof(int));
+      write_big_endian(reinterpret_cast<const char*>(&y), sizeof(float));
+    }
+  }
+
+  Ply_Point_Reader reader;
+  EXPECT_TRUE(reader.Open(filename));
+  EXPECT_EQ(2, reader.vertex_count());
+  EXPECT_FALSE(reader.HasColors());
+  std::vector<Vec3> points;
+  std::vector<Ply_Color> colors;
+  EXPECT_EQ(2, reader.Read(10, points, &colors));
+  EXPECT_MATRIX_EQ(Vec3(1, 2, 3), points[0]);
+  EXPECT_MATRIX_EQ(Vec3(2, 3, 4), points[1]);
+  EXPECT_TRUE(colors[1] == Ply_Color(255, 255, 255));
+  EXPECT_EQ(0, reader.Read(10, points));
+  EXPECT_TRUE(reader.IsComplete());
+  std::remove(filename.c_str());
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -11,9 +11,10 @@
 
 #include <algorithm>
 #include <array>
+#include <iterator>
+#include <numeric>
 #include <ostream>
-#include <set>
-#include <unordered_map>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -96,8 +97,162 @@ inline std::ostream & operator<<( std::ostream & os, const Triplet & t )
   return os;
 }
 
+/**
+* @brief Compact (CSR) view of a graph used to list its triplets (triangles).
+* The nodes are ranked by ascending degree and each edge is oriented from its
+*  lowest to its highest ranked node. A triplet is then found exactly once, from
+*  its lowest ranked node, by intersecting two sorted out-neighbor lists whose
+*  length is bounded by O(sqrt(#edges)).
+* The edges keep their index in the input pair sequence, so the caller can
+*  access the data of the three triplet edges without any lookup.
+* Self loops are ignored and duplicated edges are kept only once (first occurrence).
+*/
+class DegreeOrderedGraph
+{
+public:
+  /// Indexes of the triplet edges in the input pair sequence: (i,j), (j,k), (i,k)
+  using TripletEdges = std::array<IndexT, 3>;
+
+  template <typename IterablePairs>
+  explicit DegreeOrderedGraph
+  (
+    const IterablePairs & pairs
+  )
+  {
+    // Contiguous node indexes (node_ids_ is sorted)
+    for (const auto & edge : pairs)
+    {
+      node_ids_.push_back(static_cast<IndexT>(edge.first));
+      node_ids_.push_back(static_cast<IndexT>(edge.second));
+    }
+    std::sort(node_ids_.begin(), node_ids_.end());
+    node_ids_.erase(std::unique(node_ids_.begin(), node_ids_.end()), node_ids_.end());
+    const auto dense_index = [&](IndexT id) -> IndexT
+    {
+      return static_cast<IndexT>(std::distance(node_ids_.cbegin(),
+        std::lower_bound(node_ids_.cbegin(), node_ids_.cend(), id)));
+    };
+
+    // Undirected edges (lowest index first) with their input index
+    std::vector<std::array<IndexT, 3>> edges;
+    IndexT edge_index = 0;
+    for (const auto & edge : pairs)
+    {
+      const IndexT a = dense_index(static_cast<IndexT>(edge.first));
+      const IndexT b = dense_index(static_cast<IndexT>(edge.second));
+      if (a != b)
+        edges.push_back({{std::min(a, b), std::max(a, b), edge_index}});
+      ++edge_index;
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end(),
+      [](const std::array<IndexT, 3> & lhs, const std::array<IndexT, 3> & rhs)
+      { return lhs[0] == rhs[0] && lhs[1] == rhs[1]; }), edges.end());
+
+    // Rank the nodes by ascending degree (ties are broken by node id)
+    const IndexT nb_nodes = static_cast<IndexT>(node_ids_.size());
+    std::vector<IndexT> degree(nb_nodes, 0);
+    for (const auto & edge : edges)
+    {
+      ++degree[edge[0]];
+      ++degree[edge[1]];
+    }
+    std::vector<IndexT> rank_to_node(nb_nodes);
+    std::iota(rank_to_node.begin(), rank_to_node.end(), 0);
+    std::stable_sort(rank_to_node.begin(), rank_to_node.end(),
+      [&degree](IndexT lhs, IndexT rhs) { return degree[lhs] < degree[rhs]; });
+    std::vector<IndexT> node_to_rank(nb_nodes);
+    for (IndexT rank = 0; rank < nb_nodes; ++rank)
+      node_to_rank[rank_to_node[rank]] = rank;
+    for (IndexT & node : rank_to_node)
+      node = node_ids_[node];
+    node_ids_ = std::move(rank_to_node);
+
+    // Oriented adjacency (lowest rank -> highest rank) in CSR format
+    offsets_.assign(nb_nodes + 1, 0);
+    for (auto & edge : edges)
+    {
+      edge[0] = node_to_rank[edge[0]];
+      edge[1] = node_to_rank[edge[1]];
+      if (edge[0] > edge[1])
+        std::swap(edge[0], edge[1]);
+      ++offsets_[edge[0] + 1];
+    }
+    std::partial_sum(offsets_.cbegin(), offsets_.cend(), offsets_.begin());
+    out_neighbors_.resize(edges.size());
+    std::vector<IndexT> cursor(offsets_.cbegin(), offsets_.cend() - 1);
+    for (const auto & edge : edges)
+      out_neighbors_[cursor[edge[0]]++] = {edge[1], edge[2]};
+    for (IndexT rank = 0; rank < nb_nodes; ++rank)
+      std::sort(out_neighbors_.begin() + offsets_[rank],
+                out_neighbors_.begin() + offsets_[rank + 1]);
+  }
+
+  /// Number of nodes of the graph (node ranks are in [0, NumNodes()))
+  IndexT NumNodes() const
+  {
+    return static_cast<IndexT>(node_ids_.size());
+  }
+
+  /**
+  * @brief Call functor(triplet, triplet_edges) for each triplet whose lowest
+  *  ranked node is node_rank. The triplet node ids are sorted (i<j<k).
+  *  Distinct node_rank values can be visited concurrently.
+  * @param[in] node_rank Rank of the node in [0, NumNodes())
+  * @param[in] functor Callable as functor(const Triplet &, const TripletEdges &)
+  */
+  template <typename Functor>
+  void VisitTriplets
+  (
+    const IndexT node_rank,
+    Functor && functor
+  ) const
+  {
+    const auto u_begin = out_neighbors_.cbegin() + offsets_[node_rank];
+    const auto u_end = out_neighbors_.cbegin() + offsets_[node_rank + 1];
+    for (auto uv = u_begin; uv != u_end; ++uv)
+    {
+      // The third node w is a common out-neighbor of u and v (rank(w) > rank(v))
+      auto uw = std::next(uv);
+      auto vw = out_neighbors_.cbegin() + offsets_[uv->first];
+      const auto v_end = out_neighbors_.cbegin() + offsets_[uv->first + 1];
+      while (uw != u_end && vw != v_end)
+      {
+        if (uw->first < vw->first)
+          ++uw;
+        else if (vw->first < uw->first)
+          ++vw;
+        else
+        {
+          // Sort the node ids (i<j<k) along with the index of their opposite edge
+          std::array<std::pair<IndexT, IndexT>, 3> nodes {{
+            {node_ids_[node_rank], vw->second},
+            {node_ids_[uv->first], uw->second},
+            {node_ids_[uw->first], uv->second}}};
+          if (nodes[1].first < nodes[0].first) std::swap(nodes[0], nodes[1]);
+          if (nodes[2].first < nodes[1].first) std::swap(nodes[1], nodes[2]);
+          if (nodes[1].first < nodes[0].first) std::swap(nodes[0], nodes[1]);
+          functor(Triplet(nodes[0].first, nodes[1].first, nodes[2].first),
+                  TripletEdges {{nodes[2].second, nodes[0].second, nodes[1].second}});
+          ++uw;
+          ++vw;
+        }
+      }
+    }
+  }
+
+private:
+  // Node id of each rank
+  std::vector<IndexT> node_ids_;
+  // Sorted out-neighbors (node rank, input edge index) of each node rank
+  std::vector<IndexT> offsets_;
+  std::vector<std::pair<IndexT, IndexT>> out_neighbors_;
+};
+
 /**
 * @brief Return triplets contained in the graph build from IterablePairs
+* @note The triplets are listed in parallel (OpenMP) with a degree ordered
+*  triangle listing (see DegreeOrderedGraph) and sorted in lexicographic order.
 * @param[in] pairs A list of pairs
 * @param[out] triplets List of triplet found in graph
 * @return boolean return true if some triplet are found
@@ -111,52 +266,39 @@ bool ListTriplets
 {
   triplets.clear();
 
-  // Build an adjacency list corresponding to the edge list
-  std::unordered_map<IndexT, std::set<IndexT>> adjacency_list;
-  for (const auto & edge : pairs)
-  {
-    adjacency_list[edge.first].insert(edge.second);
-    adjacency_list[edge.second].insert(edge.first);
-  }
+  const DegreeOrderedGraph graph(pairs);
 
-  std::vector<IndexT> node_candidate_for_triplet;
-
-  // List the pair and find all triplets thanks to the adjacency list
-  for (const auto & edge_it : pairs)
+  std::vector<Triplet> found_triplets;
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel
+#endif
   {
-    // Find any targeting edge that contains the first and the second node index
-    const auto & node1_edges = adjacency_list.find(edge_it.first)->second;
-    const auto & node2_edges = adjacency_list.find(edge_it.second)->second;
-
-    // Compute the intersection between the two adjacency lists to find
-    //  triplets (it will list the nodes that are connected to the first and
-    //  second)
-    node_candidate_for_triplet.clear();
-    std::set_intersection(node1_edges.cbegin(),
-                          node1_edges.cend(),
-                          node2_edges.cbegin(),
-                          node2_edges.cend(),
-                          std::back_inserter(node_candidate_for_triplet));
-    // Add a triplet
-    for (const auto & node_index_it : node_candidate_for_triplet)
+    std::vector<Triplet> thread_triplets;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic, 64) nowait
+#endif
+    for (int node_rank = 0; node_rank < static_cast<int>(graph.NumNodes()); ++node_rank)
     {
-      std::array<IndexT, 3> triplet_indexes {{
-        static_cast<IndexT>(edge_it.first),
-        static_cast<IndexT>(edge_it.second),
-        node_index_it}};
-      // sort the triplet indexes as i<j<k (monotonic ascending sorting)
-      std::sort(triplet_indexes.begin(), triplet_indexes.end());
-      triplets.emplace_back(triplet_indexes[0],
-                            triplet_indexes[1],
-                            triplet_indexes[2]);
+      graph.VisitTriplets(node_rank,
+        [&thread_triplets](const Triplet & triplet, const DegreeOrderedGraph::TripletEdges &)
+        {
+          thread_triplets.push_back(triplet);
+        });
     }
-
-    // Since we have already listed all the triplets than contain this edge.
-    // We can now remove the edge from the adjacency graph to reduce the
-    // node array size for the next iterations.
-    adjacency_list[edge_it.first].erase(edge_it.second);
-    adjacency_list[edge_it.second].erase(edge_it.first);
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp critical
+#endif
+    found_triplets.insert(found_triplets.end(), thread_triplets.cbegin(), thread_triplets.cend());
   }
+
+  // Sort the triplets to get the same listing whatever the number of threads
+  std::sort(found_triplets.begin(), found_triplets.end(),
+    [](const Triplet & lhs, const Triplet & rhs)
+    {
+      return std::tie(lhs.i, lhs.j, lhs.k) < std::tie(rhs.i, rhs.j, rhs.k);
+    });
+  for (const Triplet & triplet : found_triplets)
+    triplets.emplace_back(triplet.i, triplet.j, triplet.k);
   return ( !triplets.empty() );
 }
 
@@ -187,6 +187,66 @@ TEST(TripletFinder, test_for_triplet) {
   }
 }
 
+// Complete graph with sparse node ids: every node subset of size 3 is a triplet
+TEST(TripletFinder, test_complete_graph) {
+
+  const int nb_nodes = 12;
+  Pairs pairs;
+  for (int i = 0; i < nb_nodes; ++i)
+    for (int j = i + 1; j < nb_nodes; ++j)
+      pairs.emplace_back(10 * j, 10 * i); // non ascending node ids
+
+  std::vector<Triplet> vec_triplets;
+  EXPECT_TRUE(ListTriplets(pairs, vec_triplets));
+  EXPECT_EQ(nb_nodes * (nb_nodes - 1) * (nb_nodes - 2) / 6, vec_triplets.size());
+  for (size_t i = 0; i < vec_triplets.size(); ++i)
+  {
+    const Triplet & t = vec_triplets[i];
+    EXPECT_TRUE(t.i < t.j && t.j < t.k);
+    if (i > 0)
+      EXPECT_TRUE(vec_triplets[i - 1] != t);
+  }
+}
+
+TEST(TripletFinder, test_triplet_edges) {
+
+  //
+  // a_b_d
+  // |/ /
+  // c_/
+  // with a duplicated (c,b) edge
+  const int a = 0, b = 1, c = 2, d = 3;
+  const Pairs pairs = { {b,a}, {c,a}, {c,b}, {b,c}, {b,d}, {d,c} };
+
+  const DegreeOrderedGraph graph(pairs);
+  std::vector<std::pair<Triplet, DegreeOrderedGraph::TripletEdges>> triplets;
+  for (openMVG::IndexT node = 0; node < graph.NumNodes(); ++node)
+  {
+    graph.VisitTriplets(node,
+      [&](const Triplet & triplet, const DegreeOrderedGraph::TripletEdges & edges)
+      {
+        triplets.emplace_back(triplet, edges);
+      });
+  }
+  EXPECT_EQ(2, triplets.size());
+  for (const auto & triplet_it : triplets)
+  {
+    const Triplet & t = triplet_it.first;
+    const DegreeOrderedGraph::TripletEdges & edges = triplet_it.second;
+    EXPECT_TRUE(t.i < t.j && t.j < t.k);
+    // Edges are given in the (i,j), (j,k), (i,k) order
+    EXPECT_TRUE(Triplet(t.i, t.j, t.k).contain(pairs[edges[0]]));
+    EXPECT_TRUE(std::min(pairs[edges[0]].first, pairs[edges[0]].second) == static_cast<int>(t.i));
+    EXPECT_TRUE(std::max(pairs[edges[0]].first, pairs[edges[0]].second) == static_cast<int>(t.j));
+    EXPECT_TRUE(std::min(pairs[edges[1]].first, pairs[edges[1]].second) == static_cast<int>(t.j));
+    EXPECT_TRUE(std::max(pairs[edges[1]].first, pairs[edges[1]].second) == static_cast<int>(t.k));
+    EXPECT_TRUE(std::min(pairs[edges[2]].first, pairs[edges[2]].second) == static_cast<int>(t.i));
+    EXPECT_TRUE(std::max(pairs[edges[2]].first, pairs[edges[2]].second) == static_cast<int>(t.k));
+    // The first occurrence of the duplicated edge is used
+    EXPECT_TRUE(edges[0] != 3 && edges[1] != 3 && edges[2] != 3);
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -23,6 +23,9 @@ namespace linearProgramming  {
 /// http://en.wikipedia.org/wiki/Bisection_method
 /// The bisection algorithm continue as long as
 ///  precision or max iteration number is not reach.
+/// If bWarmStart is true, the solver problem is set up once and then updated
+///  for each new gamma value (see LP_Solver::update): the constraint builder
+///  must keep the same problem structure for all the gamma values.
 ///
 template <typename ConstraintBuilder, typename ConstraintType>
 bool BisectionLP(
@@ -34,7 +37,8 @@ bool BisectionLP(
   double eps      = 1e-8, // precision that stop dichotomy
   const int maxIteration = 20, // max number of iteration
   double * bestFeasibleGamma = nullptr , // value of best bisection found value
-  bool bVerbose = false)
+  bool bVerbose = false,
+  bool bWarmStart = false) // update the previous problem instead of a new setup
 {
   int k = 0;
   bool bModelFound = false;
@@ -47,7 +51,10 @@ bool BisectionLP(
 
     //-- Setup constraint and solver
     cstraintBuilder.Build(gamma, constraint);
-    solver.setup(constraint);
+    if (bWarmStart && k > 1)
+      solver.update(constraint);
+    else
+      solver.setup(constraint);
     //--
     // Solving
     const bool bFeasible = solver.solve();
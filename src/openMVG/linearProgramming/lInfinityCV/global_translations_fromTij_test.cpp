@@ -10,9 +10,12 @@
 #include "openMVG/linearProgramming/linearProgrammingOSI_X.hpp"
 #include "openMVG/linearProgramming/lInfinityCV/global_translations_fromTij.hpp"
 
+#include "openMVG/multiview/translation_averaging_solver.hpp"
 #include "openMVG/multiview/translation_averaging_test.hpp"
 #include "testing/testing.h"
 
+#include <random>
+
 using namespace openMVG;
 using namespace openMVG::linearProgramming;
 using namespace lInfinityCV;
@@ -102,6 +105,176 @@ TEST(translation_averaging, globalTi_from_tijs) {
   }
 }
 
+// Residual norms of the relative motions for some global translations, the scale
+//  of each relative motion (>= 1) minimizing its L1 residual norm is used:
+//  - L1: sum of the absolute values of the residual coordinates,
+//  - LInf: largest absolute value of the residual coordinates.
+void Relative_Motion_Residuals
+(
+  const std::vector<openMVG::RelativeInfo_Vec > & vec_relative_estimates,
+  const std::vector<Vec3> & translations,
+  double * l1_norm,
+  double * linf_norm
+)
+{
+  *l1_norm = *linf_norm = 0.0;
+  for (const openMVG::RelativeInfo_Vec & group : vec_relative_estimates)
+  {
+    // 2-view estimates: one relative motion (and scale) per group
+    const relativeInfo & rel = group[0];
+    const Vec3 a = translations[rel.first.second]
+      - rel.second.first * translations[rel.first.first];
+    const Vec3 & b = rel.second.second;
+    // The L1 norm is piecewise linear in the scale: test its breakpoints
+    std::vector<double> scales = {1.0};
+    for (int k = 0; k < 3; ++k)
+      if (b(k) != 0.0 && a(k) / b(k) > 1.0)
+        scales.push_back(a(k) / b(k));
+    double best_l1 = std::numeric_limits<double>::max(), best_scale = 1.0;
+    for (const double scale : scales)
+    {
+      const double l1 = (a - scale * b).lpNorm<1>();
+      if (l1 < best_l1)
+      {
+        best_l1 = l1;
+        best_scale = scale;
+      }
+    }
+    *l1_norm += best_l1;
+    *linf_norm = std::max(*linf_norm, (a - best_scale * b).lpNorm<Eigen::Infinity>());
+  }
+}
+
+// Minimal sum of the L1 norms of the relative motion residuals (2-view estimates),
+//  solved as a linear program: each residual coordinate is bounded by a slack variable
+//  (-e <= t_j - R_ij t_i - s_ij t_ij <= e) and the sum of the slack variables is minimized.
+double L1_Translation_Averaging_LP
+(
+  const std::vector<openMVG::RelativeInfo_Vec > & vec_relative_estimates,
+  const int nb_poses
+)
+{
+  const int nb_motions = vec_relative_estimates.size();
+  const int nb_var = 3 * nb_poses + nb_motions + 3 * nb_motions; // T, scales, slacks
+  const auto SCALEVAR = [&](int e) { return 3 * nb_poses + e; };
+  const auto SLACKVAR = [&](int e, int k) { return 3 * nb_poses + nb_motions + 3 * e + k; };
+
+  LP_Constraints_Sparse constraint;
+  constraint.nbParams_ = nb_var;
+  constraint.bminimize_ = true;
+  constraint.vec_bounds_.assign(nb_var,
+    {std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max()});
+  for (int k = 0; k < 3; ++k)
+    constraint.vec_bounds_[k] = {0.0, 0.0};
+  constraint.vec_cost_.assign(nb_var, 0.0);
+  for (int e = 0; e < nb_motions; ++e)
+  {
+    constraint.vec_bounds_[SCALEVAR(e)].first = 1.0;
+    for (int k = 0; k < 3; ++k)
+    {
+      constraint.vec_bounds_[SLACKVAR(e, k)].first = 0.0;
+      constraint.vec_cost_[SLACKVAR(e, k)] = 1.0;
+    }
+  }
+
+  std::vector<Eigen::Triplet<double>> coefficients;
+  for (int e = 0; e < nb_motions; ++e)
+  {
+    const relativeInfo & rel = vec_relative_estimates[e][0];
+    const int i = rel.first.first, j = rel.first.second;
+    for (int k = 0; k < 3; ++k)
+    {
+      for (const int sign : {1, -1})
+      {
+        const int row = 6 * e + 2 * k + (sign == 1 ? 0 : 1);
+        coefficients.emplace_back(row, 3 * j + k, sign);
+        for (int l = 0; l < 3; ++l)
+          coefficients.emplace_back(row, 3 * i + l, -sign * rel.second.first(k, l));
+        coefficients.emplace_back(row, SCALEVAR(e), -sign * rel.second.second(k));
+        coefficients.emplace_back(row, SLACKVAR(e, k), -1.0);
+      }
+    }
+  }
+  constraint.constraint_mat_ = sRMat(6 * nb_motions, nb_var);
+  constraint.constraint_mat_.setFromTriplets(coefficients.begin(), coefficients.end());
+  constraint.constraint_objective_ = Vec::Zero(6 * nb_motions);
+  constraint.vec_sign_.assign(6 * nb_motions, LP_Constraints::LP_LESS_OR_EQUAL);
+
+  OSI_CLP_SolverWrapper solverLP(nb_var);
+  solverLP.setup(constraint);
+  if (!solverLP.solve())
+    return std::numeric_limits<double>::max();
+  std::vector<double> vec_solution(nb_var);
+  solverLP.getSolution(vec_solution);
+  double l1_norm = 0.0;
+  for (int e = 0; e < nb_motions; ++e)
+    for (int k = 0; k < 3; ++k)
+      l1_norm += vec_solution[SLACKVAR(e, k)];
+  return l1_norm;
+}
+
+// The linear program of [GlobalACSfM] (TRANSLATION_AVERAGING_L1) and the ADMM
+//  solver (TRANSLATION_AVERAGING_L1_ADMM) share the feasible set (t_0 = 0, scales >= 1)
+//  but not the objective: the LP minimizes the largest residual coordinate (LInf),
+//  the ADMM solver the sum of the residual coordinates (L1).
+TEST(translation_averaging, globalTi_from_tijs_LP_vs_L1_ADMM) {
+
+  const int iNviews = 12;
+  std::vector<openMVG::RelativeInfo_Vec > vec_relative_estimates;
+  const NViewDataSet d =
+    Setup_RelativeTranslations_AndNviewDataset(vec_relative_estimates, 1000, 500, iNviews, 6, true, false);
+
+  // Noisy relative translations, and one outlier
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::normal_distribution<double> noise(0.0, 0.01);
+  for (openMVG::RelativeInfo_Vec & group : vec_relative_estimates)
+  {
+    Vec3 & tij = group[0].second.second;
+    tij += tij.norm() * Vec3(noise(random_generator), noise(random_generator), noise(random_generator));
+  }
+  vec_relative_estimates[4][0].second.second = Vec3(1.0, -2.0, 0.5);
+
+  //-- LP (LInf) solution
+  std::vector<double> vec_solution(iNviews*3 + vec_relative_estimates.size() + 1);
+  OSI_CLP_SolverWrapper solverLP(vec_solution.size());
+  Tifromtij_ConstraintBuilder cstBuilder(vec_relative_estimates);
+  LP_Constraints_Sparse constraint;
+  cstBuilder.Build(constraint);
+  solverLP.setup(constraint);
+  EXPECT_TRUE(solverLP.solve());
+  solverLP.getSolution(vec_solution);
+  const double gamma = vec_solution[vec_solution.size()-1];
+  std::vector<Vec3> translations_LP(iNviews);
+  for (int i = 0; i < iNviews; ++i)
+    translations_LP[i] << vec_solution[i*3], vec_solution[i*3+1], vec_solution[i*3+2];
+
+  //-- ADMM (L1) solution
+  std::vector<Vec3> translations_ADMM;
+  EXPECT_TRUE(solve_translations_problem_l1_admm(vec_relative_estimates, translations_ADMM));
+  CHECK_EQUAL(iNviews, translations_ADMM.size());
+
+  double l1_LP, linf_LP, l1_ADMM, linf_ADMM;
+  Relative_Motion_Residuals(vec_relative_estimates, translations_LP, &l1_LP, &linf_LP);
+  Relative_Motion_Residuals(vec_relative_estimates, translations_ADMM, &l1_ADMM, &linf_ADMM);
+  std::cout
+    << "LP:   gamma = " << gamma << ", L1 = " << l1_LP << ", LInf = " << linf_LP << "\n"
+    << "ADMM: L1 = " << l1_ADMM << ", LInf = " << linf_ADMM << std::endl;
+
+  // Each solver is the best for its own objective
+  EXPECT_TRUE(gamma <= linf_ADMM + 1e-6);
+  const double l1_optimum = L1_Translation_Averaging_LP(vec_relative_estimates, iNviews);
+  std::cout << "L1 optimum (LP): " << l1_optimum << std::endl;
+  EXPECT_NEAR(l1_optimum, l1_ADMM, 1e-2 * l1_optimum);
+  // The outlier spreads over the LInf solution, not over the L1 one
+  EXPECT_TRUE(l1_ADMM < l1_LP);
+  for (int i = 1; i < iNviews; ++i)
+  {
+    const Vec3 C_computed = - d._R[i].transpose() * translations_ADMM[i];
+    const Vec3 C_GT = d._C[i] - d._C[0];
+    EXPECT_NEAR(0.0, DistanceLInfinity(C_computed.normalized(), C_GT.normalized()), 0.05);
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -10,6 +10,7 @@
 #include "openMVG/linearProgramming/linearProgrammingInterface.hpp"
 #include "openMVG/linearProgramming/linearProgrammingOSI_X.hpp"
 #include "openMVG/linearProgramming/lInfinityCV/tijsAndXis_From_xi_Ri.hpp"
+#include "openMVG/linearProgramming/lInfinityCV/triplet_tijsAndXis_kernel.hpp"
 #include "openMVG/multiview/projection.hpp"
 #include "openMVG/multiview/test_data_sets.hpp"
 #include "openMVG/numeric/numeric.h"
@@ -198,6 +199,89 @@ TEST(Translation_Structure_L_Infinity, OSICLP_SOLVER_K) {
   d2.ExportToPLY("test_After_Infinity.ply");
 }
 
+// Check that a warm started bisection (problem update) finds a valid solution
+TEST(Translation_Structure_L_Infinity, OSICLP_SOLVER_WARM_START) {
+
+  const size_t nViews = 3;
+  const size_t nbPoints = 6;
+  const NViewDataSet d = NRealisticCamerasRing(nViews, nbPoints,
+    nViewDatasetConfigurator(1,1,0,0,5,0)); // Suppose a camera with Unit matrix as K
+
+  //Create the mega matrix
+  Mat megaMat(4, d._n*d._x[0].cols());
+  {
+    size_t cpt = 0;
+    for (size_t i=0; i<d._n;++i)
+    {
+      for (Mat2X::Index j=0; j < d._x[0].cols(); ++j)
+      {
+        megaMat.col(cpt++) << d._x[i].col(j), j, i;
+      }
+    }
+  }
+
+  std::vector<double> vec_solution((nViews + nbPoints)*3);
+  OSI_CLP_SolverWrapper wrapperOSICLPSolver(vec_solution.size());
+  Translation_Structure_L1_ConstraintBuilder cstBuilder( d._R, megaMat);
+  double gamma = 1.0;
+  EXPECT_TRUE(
+    (BisectionLP<Translation_Structure_L1_ConstraintBuilder, LP_Constraints_Sparse>(
+    wrapperOSICLPSolver,
+    cstBuilder,
+    &vec_solution,
+    1.0,
+    0.0,
+    1e-8, 20, &gamma, false, true))
+  );
+  EXPECT_TRUE(gamma < 1e-6);
+
+  // The cold started bisection reaches the same gamma (same feasibility tests)
+  {
+    std::vector<double> vec_solution_cold(vec_solution.size());
+    OSI_CLP_SolverWrapper wrapperOSICLPSolver_cold(vec_solution.size());
+    double gamma_cold = 1.0;
+    EXPECT_TRUE(
+      (BisectionLP<Translation_Structure_L1_ConstraintBuilder, LP_Constraints_Sparse>(
+      wrapperOSICLPSolver_cold,
+      cstBuilder,
+      &vec_solution_cold,
+      1.0,
+      0.0,
+      1e-8, 20, &gamma_cold, false, false))
+    );
+    EXPECT_EQ(gamma_cold, gamma);
+  }
+
+  // Check the L_infinity reprojection residuals of the found solution
+  for (size_t i = 0; i < nViews; ++i)
+  {
+    const Vec3 t(vec_solution[3*i], vec_solution[3*i+1], vec_solution[3*i+2]);
+    for (size_t j = 0; j < nbPoints; ++j)
+    {
+      const size_t index = 3 * (nViews + j);
+      const Vec3 X(vec_solution[index], vec_solution[index+1], vec_solution[index+2]);
+      const Vec2 residual = (d._R[i] * X + t).hnormalized() - d._x[i].col(j);
+      EXPECT_TRUE(residual.lpNorm<Eigen::Infinity>() <= gamma + 1e-6);
+    }
+  }
+}
+
+// Check the triplet solver (algebraic fast path) on noise free data
+TEST(Translation_Structure_L_Infinity, TRIPLET_SOLVER) {
+
+  const NViewDataSet d = NRealisticCamerasRing(3, translations_Triplet_Solver::MINIMUM_SAMPLES,
+    nViewDatasetConfigurator(1,1,0,0,5,0)); // Suppose a camera with Unit matrix as K
+
+  std::vector<trifocal::kernel::TrifocalTensorModel> models;
+  translations_Triplet_Solver::Solve(d._x[0], d._x[1], d._x[2], d._R, &models, 1e-2);
+  CHECK_EQUAL(1, models.size());
+  for (Mat2X::Index j = 0; j < d._x[0].cols(); ++j)
+  {
+    EXPECT_NEAR(0.0, translations_Triplet_Solver::Error(models[0],
+      d._x[0].col(j), d._x[1].col(j), d._x[2].col(j)), 1e-8);
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
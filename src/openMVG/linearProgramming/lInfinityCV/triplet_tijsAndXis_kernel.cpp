@@ -8,6 +8,8 @@
 
 #include "openMVG/linearProgramming/lInfinityCV/triplet_tijsAndXis_kernel.hpp"
 
+#include <algorithm>
+
 #include "openMVG/multiview/projection.hpp"
 #include "openMVG/multiview/triangulation_nview.hpp"
 #include "openMVG/numeric/numeric.h"
@@ -62,6 +64,78 @@ namespace openMVG{
 
 using openMVG::trifocal::kernel::TrifocalTensorModel;
 
+/// Algebraic (non LP) solution of the translations and structure of a triplet
+///  with known rotations: linear least squares solution of the
+///  x_ij ^ (R_i X_j + t_i) = 0 constraints, with t_0 = 0.
+/// The solution is scaled so that the minimal depth is 1 (as the LP
+///  cheirality constraints).
+/// Return false if a point is not in front of all the cameras, else the
+///  translations and the maximal coordinate wise reprojection residual
+///  (the residual bounded by the LP gamma value).
+static bool TranslationsTripletAlgebraic
+(
+  const Mat * pts[3],
+  const std::vector<Mat3> & vec_KR,
+  std::vector<Vec3> * vec_tis,
+  double * max_residual
+)
+{
+  const int n_obs = pts[0]->cols();
+  const int n_params = 6 + 3 * n_obs; // t_1, t_2, X_j
+  Mat A = Mat::Zero(6 * n_obs, n_params);
+  int row = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    const Mat3 & R = vec_KR[i];
+    for (int j = 0; j < n_obs; ++j)
+    {
+      for (int c = 0; c < 2; ++c)
+      {
+        // (R X + t)_c - x_c (R X + t)_2 = 0
+        const double x = (*pts[i])(c, j);
+        A.block<1,3>(row, 6 + 3 * j) = R.row(c) - x * R.row(2);
+        if (i > 0)
+        {
+          A(row, 3 * (i - 1) + c) = 1.0;
+          A(row, 3 * (i - 1) + 2) = -x;
+        }
+        ++row;
+      }
+    }
+  }
+
+  // Solution: eigen vector of AtA associated to the smallest eigen value
+  const Eigen::SelfAdjointEigenSolver<Mat> eigen_solver(A.transpose() * A);
+  const Vec solution = eigen_solver.eigenvectors().col(0);
+
+  vec_tis->assign({Vec3::Zero(),
+                   solution.segment<3>(0),
+                   solution.segment<3>(3)});
+
+  // Depths (R X + t)_2 must have the same sign
+  Mat depths(3, n_obs);
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < n_obs; ++j)
+      depths(i, j) = vec_KR[i].row(2).dot(solution.segment<3>(6 + 3 * j))
+        + (*vec_tis)[i](2);
+  const double min_depth = depths.minCoeff(), max_depth = depths.maxCoeff();
+  if (min_depth <= 0.0 && max_depth >= 0.0)
+    return false;
+  const double scale = (min_depth > 0.0) ? 1.0 / min_depth : 1.0 / max_depth;
+  for (Vec3 & t : *vec_tis)
+    t *= scale;
+
+  *max_residual = 0.0;
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < n_obs; ++j)
+    {
+      const Vec3 X = vec_KR[i] * solution.segment<3>(6 + 3 * j) * scale + (*vec_tis)[i];
+      *max_residual = std::max(*max_residual,
+        (X.hnormalized() - pts[i]->col(j)).lpNorm<Eigen::Infinity>());
+    }
+  return true;
+}
+
 /// Solve the computation of the "tensor".
 void translations_Triplet_Solver::Solve
 (
@@ -77,6 +151,24 @@ void translations_Triplet_Solver::Solve
   if (n_obs < MINIMUM_SAMPLES)
     return;
 
+  // Fast path: use the algebraic solution if it is as good as the best
+  //  solution the bisection below could find (gamma = ThresholdUpperBound / 4)
+  {
+    const Mat * pts[3] = {&pt0, &pt1, &pt2};
+    std::vector<Vec3> vec_tis;
+    double max_residual;
+    if (TranslationsTripletAlgebraic(pts, vec_KR, &vec_tis, &max_residual)
+        && max_residual <= ThresholdUpperBound / 4.0)
+    {
+      TrifocalTensorModel PTemp;
+      PTemp.P1 = HStack(vec_KR[0], vec_tis[0]);
+      PTemp.P2 = HStack(vec_KR[1], vec_tis[1]);
+      PTemp.P3 = HStack(vec_KR[2], vec_tis[2]);
+      P->push_back(PTemp);
+      return;
+    }
+  }
+
   // Build the megaMatMatrix (compact form of point coordinates & their view index)
   Mat4X megaMat(4, n_obs*3);
   {
@@ -102,7 +194,7 @@ void translations_Triplet_Solver::Solve
     cstBuilder,
     &vec_solution,
     ThresholdUpperBound,
-    0.0, 1e-8, 2, &gamma, false))
+    0.0, 1e-8, 2, &gamma, false, true))
   {
     const std::vector<Vec3> vec_tis {
       {vec_solution[0], vec_solution[1], vec_solution[2]},
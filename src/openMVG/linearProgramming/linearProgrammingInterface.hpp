@@ -91,6 +91,15 @@ public:
   virtual bool setup(const LP_Constraints & constraints) = 0;
   virtual bool setup(const LP_Constraints_Sparse & constraints) = 0;
 
+  /// Update the coefficients, objective values, bounds and cost of the
+  ///  problem defined by the last setup() call.
+  /// The problem structure must be unchanged (same size, constraint signs
+  ///  and sparsity pattern). Solvers that support it warm start the next
+  ///  solve() from the last solution basis.
+  /// Default: perform a new setup.
+  virtual bool update(const LP_Constraints & constraints) { return setup(constraints); }
+  virtual bool update(const LP_Constraints_Sparse & constraints) { return setup(constraints); }
+
   /// Setup the feasibility and found the solution that best fit the constraint.
   virtual bool solve() = 0;
 
@@ -7,6 +7,7 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include "openMVG/linearProgramming/linearProgrammingOSI_X.hpp"
+#include <algorithm>
 #include <assert.h>
 #include <cstddef>
 #include "CoinPackedVector.hpp"
@@ -16,7 +17,9 @@
 namespace openMVG   {
 namespace linearProgramming  {
 
-OSI_X_SolverWrapper::OSI_X_SolverWrapper(int nbParams) : LP_Solver(nbParams)
+OSI_X_SolverWrapper::OSI_X_SolverWrapper(int nbParams) :
+  LP_Solver(nbParams),
+  bWarmStart_(false)
 {
   si.reset(new OsiClpSolverInterface);
   si->setLogLevel(0);
@@ -104,6 +107,7 @@ bool OSI_X_SolverWrapper::setup(const LP_Constraints & cstraints) //cstraints <-
   }
 
   si->loadProblem(*matrix, &col_lb[0], &col_ub[0], cstraints.vec_cost_.empty() ? nullptr : &cstraints.vec_cost_[0], &row_lb[0], &row_ub[0] );
+  bWarmStart_ = false;
 
   return true;
 }
@@ -201,10 +205,77 @@ bool OSI_X_SolverWrapper::setup(const LP_Constraints_Sparse & cstraints) //cstra
     cstraints.vec_cost_.empty() ? nullptr : &cstraints.vec_cost_[0],
     &row_lb[0],
     &row_ub[0]);
+  bWarmStart_ = false;
 
   return true;
 }
 
+bool OSI_X_SolverWrapper::update(const LP_Constraints_Sparse & cstraints) //cstraints <-> constraints
+{
+  if (!si)
+  {
+    return false;
+  }
+
+  const sRMat & A = cstraints.constraint_mat_;
+  const int nbLine = A.rows() +
+    std::count(cstraints.vec_sign_.begin(), cstraints.vec_sign_.end(), LP_Constraints::LP_EQUAL);
+
+  // No compatible problem is loaded: perform a full setup
+  if (si->getNumCols() != A.cols() || si->getNumRows() != nbLine)
+  {
+    return setup(cstraints);
+  }
+
+  si->setObjSense( ((cstraints.bminimize_) ? 1 : -1) );
+
+  //-- Update the row-wise constraint (same row layout as in setup)
+  int rowindex = 0;
+  for (int i=0; i < A.rows(); ++i)
+  {
+    if ( cstraints.vec_sign_[i] == LP_Constraints::LP_EQUAL ||
+         cstraints.vec_sign_[i] == LP_Constraints::LP_LESS_OR_EQUAL )
+    {
+      const int coef = 1;
+      for (sRMat::InnerIterator it(A,i); it; ++it)
+      {
+        si->modifyCoefficient(rowindex, it.col(), coef * it.value(), true);
+      }
+      si->setRowUpper(rowindex, coef * cstraints.constraint_objective_(i));
+      ++rowindex;
+    }
+
+    if ( cstraints.vec_sign_[i] == LP_Constraints::LP_EQUAL ||
+         cstraints.vec_sign_[i] == LP_Constraints::LP_GREATER_OR_EQUAL )
+    {
+      const int coef = -1;
+      for (sRMat::InnerIterator it(A,i); it; ++it)
+      {
+        si->modifyCoefficient(rowindex, it.col(), coef * it.value(), true);
+      }
+      si->setRowUpper(rowindex, coef * cstraints.constraint_objective_(i));
+      ++rowindex;
+    }
+  }
+
+  //-- Update the bounds of the parameters
+  for (int i=0; i < this->nbParams_; ++i)
+  {
+    const std::pair<double, double> & bounds =
+      (cstraints.vec_bounds_.size() == 1) ? cstraints.vec_bounds_[0] : cstraints.vec_bounds_[i];
+    si->setColBounds(i, bounds.first, bounds.second);
+  }
+
+  //-- Update the objective function
+  for (int i=0; i < static_cast<int>(cstraints.vec_cost_.size()); ++i)
+  {
+    si->setObjCoeff(i, cstraints.vec_cost_[i]);
+  }
+
+  bWarmStart_ = true;
+  return true;
+}
+
 
 bool OSI_X_SolverWrapper::solve()
 {
@@ -212,7 +283,15 @@ bool OSI_X_SolverWrapper::solve()
   if ( si )
   {
     si->getModelPtr()->setPerturbation(50);
-    si->initialSolve();
+    if (bWarmStart_)
+    {
+      // Start from the basis of the last solve (dual simplex)
+      si->resolve();
+    }
+    else
+    {
+      si->initialSolve();
+    }
     return si->isProvenOptimal();
   }
   return false;
@@ -32,12 +32,17 @@ public:
   bool setup(const LP_Constraints & constraints) override;
   bool setup(const LP_Constraints_Sparse & constraints) override;
 
+  /// Modify the loaded problem in place and warm start the next solve()
+  using LP_Solver::update;
+  bool update(const LP_Constraints_Sparse & constraints) override;
+
   bool solve() override;
 
   bool getSolution(std::vector<double> & estimatedParams) override;
 
 private:
   std::shared_ptr<OsiClpSolverInterface> si;
+  bool bWarmStart_; // Tell if the next solve can start from the last basis
 };
 
 using OSI_CLP_SolverWrapper = OSI_X_SolverWrapper;
@@ -0,0 +1,419 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/matching/indMatch_store.hpp"
+
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+#if defined _WIN32
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif
+
+namespace openMVG {
+namespace matching {
+
+namespace
+{
+
+const char kShardMagic[8] = {'O', 'M', 'V', 'G', 'B', 'M', 'A', 'T'};
+const char kIndexMagic[8] = {'O', 'M', 'V', 'G', 'B', 'I', 'D', 'X'};
+const uint32_t kVersion = 1;
+const uint32_t kByteOrderMark = 0x01020304;
+const char kShardExtension[] = "shard";
+const char kIndexExtension[] = "idx";
+
+struct Shard_Header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+};
+
+// Header of a pair record (followed by the IndMatch array)
+struct Record_Header
+{
+  IndexT I, J;
+  uint64_t count;
+};
+
+struct Index_Header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t shard_size; // Size of the shard data covered by the index
+  uint64_t pair_count;
+};
+
+// The match arrays are read in place: 8 bytes aligned, without padding
+static_assert(sizeof(IndMatch) == 2 * sizeof(IndexT), "IndMatch must be a packed (i, j) pair");
+static_assert(std::is_standard_layout<IndMatch>::value, "IndMatch must have a standard layout");
+static_assert(sizeof(Shard_Header) % 8 == 0 && sizeof(Record_Header) % 8 == 0,
+  "The match arrays must be 8 bytes aligned");
+
+template <typename Header_T>
+bool ValidHeader(const Header_T & header, const char (&magic)[8])
+{
+  return std::memcmp(header.magic, magic, 8) == 0
+    && header.version == kVersion
+    && header.byte_order == kByteOrderMark;
+}
+
+template <typename Header_T>
+Header_T MakeHeader(const char (&magic)[8])
+{
+  Header_T header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, magic, 8);
+  header.version = kVersion;
+  header.byte_order = kByteOrderMark;
+  return header;
+}
+
+std::string IndexFilename(const std::string & shard_filename)
+{
+  return stlplus::create_filespec(
+    stlplus::folder_part(shard_filename),
+    stlplus::basename_part(shard_filename),
+    kIndexExtension);
+}
+
+/// Tell if an index entry designates a complete record of the shard data
+template <typename Entry_T>
+bool ValidIndexEntry
+(
+  const system::MappedFile & shard,
+  const uint64_t shard_size,
+  const Entry_T & entry
+)
+{
+  // The match array follows its record header, 8 bytes aligned, within the indexed data
+  if (entry.offset < sizeof(Shard_Header) + sizeof(Record_Header) ||
+      entry.offset > shard_size || entry.offset % 8 != 0 ||
+      entry.count > (shard_size - entry.offset) / sizeof(IndMatch))
+    return false;
+  Record_Header record;
+  std::memcpy(&record, shard.data() + entry.offset - sizeof(Record_Header), sizeof(Record_Header));
+  return record.I == entry.I && record.J == entry.J && record.count == entry.count;
+}
+
+/**
+* @brief Read the pair index of a mapped shard:
+*  the entries of its .idx file, then the records appended after them.
+*  If an entry of the .idx file is not valid, the whole shard is scanned.
+* @return the size of the valid shard data (an incomplete last record is excluded)
+*/
+template <typename Entry_T>
+uint64_t ReadShardIndex
+(
+  const system::MappedFile & shard,
+  const std::string & shard_filename,
+  std::vector<Entry_T> & entries
+)
+{
+  entries.clear();
+  Shard_Header shard_header;
+  if (shard.size() < sizeof(Shard_Header))
+    return 0;
+  std::memcpy(&shard_header, shard.data(), sizeof(Shard_Header));
+  if (!ValidHeader(shard_header, kShardMagic))
+    return 0;
+
+  uint64_t offset = sizeof(Shard_Header);
+
+  // Offset table of the .idx file (if it matches the shard)
+  std::ifstream stream(IndexFilename(shard_filename).c_str(), std::ios::in | std::ios::binary);
+  Index_Header index_header;
+  if (stream.read(reinterpret_cast<char *>(&index_header), sizeof(Index_Header))
+      && ValidHeader(index_header, kIndexMagic)
+      && index_header.shard_size <= shard.size()
+      && index_header.shard_size >= offset
+      && index_header.pair_count <= (index_header.shard_size - offset) / sizeof(Record_Header))
+  {
+    entries.resize(index_header.pair_count);
+    if (stream.read(reinterpret_cast<char *>(entries.data()), entries.size() * sizeof(Entry_T)) &&
+        std::all_of(entries.cbegin(), entries.cend(), [&](const Entry_T & entry)
+          { return ValidIndexEntry(shard, index_header.shard_size, entry); }))
+    {
+      offset = index_header.shard_size;
+    }
+    else
+    {
+      std::cerr << "Invalid match shard index, the shard is scanned: " << shard_filename << std::endl;
+      entries.clear();
+    }
+  }
+
+  // Scan the records that are not in the index
+  while (offset + sizeof(Record_Header) <= shard.size())
+  {
+    Record_Header record;
+    std::memcpy(&record, shard.data() + offset, sizeof(Record_Header));
+    const uint64_t data_offset = offset + sizeof(Record_Header);
+    if (record.count > (shard.size() - data_offset) / sizeof(IndMatch))
+      break; // Incomplete record
+    entries.push_back({record.I, record.J, data_offset, record.count});
+    offset = data_offset + record.count * sizeof(IndMatch);
+  }
+  return offset;
+}
+
+bool TruncateFile(std::FILE * file, const uint64_t size)
+{
+  std::fflush(file);
+#if defined _WIN32
+  return _chsize_s(_fileno(file), static_cast<__int64>(size)) == 0;
+#else
+  return ::ftruncate(fileno(file), static_cast<off_t>(size)) == 0;
+#endif
+}
+
+} // namespace
+
+//-----------------
+//-- Matches_Shard_Writer
+//-----------------
+
+Matches_Shard_Writer::~Matches_Shard_Writer()
+{
+  if (file_)
+    Close();
+}
+
+bool Matches_Shard_Writer::Open(const std::string & store_dir, const std::string & shard_name)
+{
+  if (file_)
+    Close();
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  b_failed_ = false;
+  size_ = 0;
+
+  if (!stlplus::folder_exists(store_dir) && !stlplus::folder_create(store_dir))
+  {
+    std::cerr << "Cannot create the match store directory: " << store_dir << std::endl;
+    return false;
+  }
+  shard_filename_ = stlplus::create_filespec(store_dir, shard_name, kShardExtension);
+
+  // Keep the complete records of an existing shard
+  if (stlplus::file_exists(shard_filename_))
+  {
+    system::MappedFile shard;
+    if (shard.Open(shard_filename_))
+      size_ = ReadShardIndex(shard, shard_filename_, entries_);
+  }
+  // The index is written again when the shard is closed
+  const std::string index_filename = IndexFilename(shard_filename_);
+  if (stlplus::file_exists(index_filename))
+    stlplus::file_delete(index_filename);
+
+  // Large buffered writes (the buffer is set before any operation on the file)
+  const auto open_file = [this](const char * mode)
+  {
+    file_ = std::fopen(shard_filename_.c_str(), mode);
+    if (file_)
+      std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+  };
+  bool bOk = false;
+  if (size_ > 0)
+  {
+    open_file("r+b");
+    bOk = file_ && TruncateFile(file_, size_) && std::fseek(file_, 0, SEEK_END) == 0;
+  }
+  else
+  {
+    entries_.clear();
+    open_file("wb");
+    const Shard_Header header = MakeHeader<Shard_Header>(kShardMagic);
+    // The header is written at once: an interrupted writer leaves a valid empty shard
+    bOk = file_ && std::fwrite(&header, sizeof(header), 1, file_) == 1 && std::fflush(file_) == 0;
+    size_ = sizeof(header);
+  }
+  if (!bOk)
+  {
+    if (file_)
+      std::fclose(file_);
+    file_ = nullptr;
+    std::cerr << "Cannot open the match shard: " << shard_filename_ << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool Matches_Shard_Writer::Append(const Pair & pair, const IndMatches & matches)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file_)
+    return false;
+  const Record_Header record = {pair.first, pair.second, matches.size()};
+  if (std::fwrite(&record, sizeof(record), 1, file_) != 1
+      || (!matches.empty()
+          && std::fwrite(matches.data(), sizeof(IndMatch), matches.size(), file_) != matches.size()))
+  {
+    b_failed_ = true;
+    return false;
+  }
+  entries_.push_back({pair.first, pair.second, size_ + sizeof(record), matches.size()});
+  size_ += sizeof(record) + matches.size() * sizeof(IndMatch);
+  return true;
+}
+
+void Matches_Shard_Writer::insert(std::pair<Pair, IndMatches> && pairWiseMatches)
+{
+  Append(pairWiseMatches.first, pairWiseMatches.second);
+}
+
+bool Matches_Shard_Writer::Flush()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return file_ && std::fflush(file_) == 0;
+}
+
+bool Matches_Shard_Writer::Close()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file_)
+    return false;
+  bool bOk = std::fflush(file_) == 0;
+  bOk &= std::fclose(file_) == 0;
+  file_ = nullptr;
+
+  // Write the offset table of the shard
+  if (bOk)
+  {
+    Index_Header header = MakeHeader<Index_Header>(kIndexMagic);
+    header.shard_size = size_;
+    header.pair_count = entries_.size();
+    std::ofstream stream(IndexFilename(shard_filename_).c_str(), std::ios::out | std::ios::binary);
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char *>(entries_.data()), entries_.size() * sizeof(Index_Entry));
+    bOk = stream.good();
+  }
+  return bOk && !b_failed_;
+}
+
+std::size_t Matches_Shard_Writer::pair_count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+//-----------------
+//-- Matches_Store
+//-----------------
+
+bool Matches_Store::Open(const std::string & store_dir)
+{
+  shards_.clear();
+  index_.clear();
+  if (!stlplus::folder_exists(store_dir))
+    return false;
+
+  std::vector<std::string> shard_names =
+    stlplus::folder_wildcard(store_dir, std::string("*.") + kShardExtension, false, true);
+  std::sort(shard_names.begin(), shard_names.end());
+
+  std::vector<Matches_Shard_Writer::Index_Entry> entries;
+  for (const std::string & shard_name : shard_names)
+  {
+    const std::string shard_filename = stlplus::create_filespec(store_dir, shard_name);
+    // A writer interrupted before its header was written leaves an empty shard
+    if (stlplus::file_size(shard_filename) < sizeof(Shard_Header))
+    {
+      std::cerr << "Empty match shard, it is skipped: " << shard_filename << std::endl;
+      continue;
+    }
+    std::unique_ptr<system::MappedFile> shard(new system::MappedFile);
+    if (!shard->Open(shard_filename) || ReadShardIndex(*shard, shard_filename, entries) == 0)
+    {
+      std::cerr << "Invalid match shard: " << shard_filename << std::endl;
+      shards_.clear();
+      index_.clear();
+      return false;
+    }
+    for (const auto & entry : entries)
+      index_[{entry.I, entry.J}] = {shards_.size(), entry.offset, entry.count};
+    shards_.push_back(std::move(shard));
+  }
+  return true;
+}
+
+Pair_Set Matches_Store::GetPairs() const
+{
+  Pair_Set pairs;
+  for (const auto & index_it : index_)
+    pairs.insert(pairs.end(), index_it.first);
+  return pairs;
+}
+
+bool Matches_Store::Get(const Pair & pair, const IndMatch * & matches, std::size_t & count) const
+{
+  const auto it = index_.find(pair);
+  if (it == index_.end())
+    return false;
+  matches = reinterpret_cast<const IndMatch *>(shards_[it->second.shard]->data() + it->second.offset);
+  count = it->second.count;
+  return true;
+}
+
+bool Matches_Store::Get(const Pair & pair, IndMatches & matches) const
+{
+  const IndMatch * pair_matches = nullptr;
+  std::size_t count = 0;
+  if (!Get(pair, pair_matches, count))
+    return false;
+  matches.assign(pair_matches, pair_matches + count);
+  return true;
+}
+
+void Matches_Store::Load(PairWiseMatches & matches) const
+{
+  matches.clear();
+  for (const auto & index_it : index_)
+    Get(index_it.first, matches[index_it.first]);
+}
+
+bool Save_Store(const PairWiseMatches & matches, const std::string & store_dir)
+{
+  // Replace the previous content of the store
+  if (stlplus::folder_exists(store_dir))
+  {
+    for (const char * extension : {kShardExtension, kIndexExtension})
+    {
+      for (const std::string & name :
+             stlplus::folder_wildcard(store_dir, std::string("*.") + extension, false, true))
+        stlplus::file_delete(stlplus::create_filespec(store_dir, name));
+    }
+  }
+
+  Matches_Shard_Writer writer;
+  if (!writer.Open(store_dir, "0"))
+    return false;
+  for (const auto & pair_matches : matches)
+    writer.Append(pair_matches.first, pair_matches.second);
+  return writer.Close();
+}
+
+bool Load_Store(PairWiseMatches & matches, const std::string & store_dir)
+{
+  Matches_Store store;
+  if (!store.Open(store_dir))
+    return false;
+  store.Load(matches);
+  return true;
+}
+
+}  // namespace matching
+}  // namespace openMVG
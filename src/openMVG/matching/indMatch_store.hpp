@@ -0,0 +1,154 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_MATCHING_IND_MATCH_STORE_HPP
+#define OPENMVG_MATCHING_IND_MATCH_STORE_HPP
+
+#include "openMVG/matching/indMatch.hpp"
+#include "openMVG/system/mapped_file.hpp"
+#include "openMVG/types.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace openMVG {
+namespace matching {
+
+/**
+* Sharded binary match store
+*
+* A store is a directory (".bmat" extension by convention) of shard files.
+* Each shard is written by a single writer (a process or a matching worker),
+* so many workers can append pairs to the same store without coordination.
+*
+* Shard file (<name>.shard):
+*  - a header (magic, version, byte order mark),
+*  - the appended pair records: (I, J, match count) then the raw IndMatch array.
+* Shard index (<name>.idx), written when a shard is closed:
+*  - the offset table of the pairs of the shard (pair, array offset, match count).
+*
+* The shards are memory mapped: the pair index is read from the .idx files
+* (the records appended after an index was written, e.g. by a worker that
+* did not finish, are found by scanning the record headers) and the match
+* arrays are accessed in place, pair by pair.
+* A truncated last record (interrupted writer) is ignored, as well as a
+* shard whose header is incomplete (writer interrupted at once).
+* If a pair is stored several times, the last record (in shard name order)
+* is used.
+* The data is stored in the host byte order (the reader checks it).
+*/
+
+/// Writer of a shard of a match store (pairs can be appended from many threads)
+class Matches_Shard_Writer : public PairWiseMatchesContainer
+{
+public:
+  Matches_Shard_Writer() = default;
+  ~Matches_Shard_Writer() override;
+
+  Matches_Shard_Writer(const Matches_Shard_Writer &) = delete;
+  Matches_Shard_Writer & operator=(const Matches_Shard_Writer &) = delete;
+
+  /**
+  * @brief Open a shard of a store for appending.
+  *  The store directory is created if needed. The pairs of an existing shard
+  *  are kept (an incomplete last record is discarded).
+  * @param store_dir store directory
+  * @param shard_name shard name (unique per concurrent writer)
+  */
+  bool Open(const std::string & store_dir, const std::string & shard_name);
+
+  /// Append the matches of a pair (thread safe)
+  bool Append(const Pair & pair, const IndMatches & matches);
+
+  /// PairWiseMatchesContainer interface: the matchers can write in the shard
+  void insert(std::pair<Pair, IndMatches> && pairWiseMatches) override;
+
+  /// Write the buffered records to the file (thread safe)
+  bool Flush();
+
+  /**
+  * @brief Write the shard index and close the shard.
+  * @return false if an append failed or if the shard cannot be written
+  */
+  bool Close();
+
+  /// Number of pair records of the shard
+  std::size_t pair_count() const;
+
+private:
+  struct Index_Entry
+  {
+    IndexT I, J;
+    uint64_t offset; // Byte offset of the IndMatch array
+    uint64_t count;
+  };
+
+  mutable std::mutex mutex_;
+  std::FILE * file_ = nullptr;
+  std::string shard_filename_;
+  uint64_t size_ = 0;
+  std::vector<Index_Entry> entries_;
+  bool b_failed_ = false;
+
+  friend class Matches_Store;
+};
+
+/// Memory mapped reader of a match store
+class Matches_Store
+{
+public:
+  /// Map the shards of a store directory and build the pair index
+  bool Open(const std::string & store_dir);
+
+  /// Number of stored pairs
+  std::size_t size() const { return index_.size(); }
+
+  /// Stored pairs
+  Pair_Set GetPairs() const;
+
+  /// Tell if a pair is stored
+  bool Has(const Pair & pair) const { return index_.count(pair) != 0; }
+
+  /**
+  * @brief Access in place to the matches of a pair (in the mapped shard).
+  * @param[out] matches beginning of the matches array (valid while the store is open)
+  * @param[out] count number of matches
+  */
+  bool Get(const Pair & pair, const IndMatch * & matches, std::size_t & count) const;
+
+  /// Copy the matches of a pair
+  bool Get(const Pair & pair, IndMatches & matches) const;
+
+  /// Copy all the stored pairs
+  void Load(PairWiseMatches & matches) const;
+
+private:
+  struct Pair_Location
+  {
+    std::size_t shard;
+    uint64_t offset;
+    uint64_t count;
+  };
+
+  std::vector<std::unique_ptr<system::MappedFile>> shards_;
+  std::map<Pair, Pair_Location> index_;
+};
+
+/// Save matches in a store directory (as a single shard, the previous shards are removed)
+bool Save_Store(const PairWiseMatches & matches, const std::string & store_dir);
+
+/// Load all the matches of a store directory
+bool Load_Store(PairWiseMatches & matches, const std::string & store_dir);
+
+}  // namespace matching
+}  // namespace openMVG
+
+#endif // OPENMVG_MATCHING_IND_MATCH_STORE_HPP
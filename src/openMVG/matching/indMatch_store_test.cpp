@@ -0,0 +1,272 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/matching/indMatch_store.hpp"
+
+#include "testing/testing.h"
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <fstream>
+#include <thread>
+
+using namespace openMVG;
+using namespace matching;
+
+namespace {
+
+// Pair (I, J) has I + J matches (k, 2k)
+IndMatches create_test_matches(const Pair & pair)
+{
+  IndMatches matches;
+  for (IndexT k = 0; k < pair.first + pair.second; ++k)
+    matches.emplace_back(k, 2 * k);
+  return matches;
+}
+
+} // namespace
+
+TEST(Matches_Store, Save_Load)
+{
+  const std::string store_dir = "matches_save_load.bmat";
+  PairWiseMatches matches;
+  EXPECT_TRUE(Save_Store(matches, store_dir));
+  EXPECT_TRUE(Load_Store(matches, store_dir));
+  EXPECT_EQ(0, matches.size());
+
+  matches[{0,1}] = create_test_matches({0,1});
+  matches[{1,2}] = create_test_matches({1,2});
+  matches[{2,5}] = {};
+  EXPECT_TRUE(Save_Store(matches, store_dir));
+
+  PairWiseMatches matches_load;
+  EXPECT_TRUE(Load_Store(matches_load, store_dir));
+  EXPECT_EQ(3, matches_load.size());
+  for (const auto & pair_matches : matches)
+    EXPECT_TRUE(pair_matches.second == matches_load.at(pair_matches.first));
+
+  // Saving again replaces the content of the store
+  matches.erase({0,1});
+  EXPECT_TRUE(Save_Store(matches, store_dir));
+  EXPECT_TRUE(Load_Store(matches_load, store_dir));
+  EXPECT_EQ(2, matches_load.size());
+  EXPECT_EQ(0, matches_load.count({0,1}));
+}
+
+TEST(Matches_Store, Lazy_access)
+{
+  const std::string store_dir = "matches_lazy.bmat";
+  PairWiseMatches matches;
+  matches[{3,4}] = create_test_matches({3,4});
+  matches[{4,9}] = create_test_matches({4,9});
+  EXPECT_TRUE(Save_Store(matches, store_dir));
+
+  Matches_Store store;
+  EXPECT_TRUE(store.Open(store_dir));
+  EXPECT_EQ(2, store.size());
+  EXPECT_TRUE(store.GetPairs() == getPairs(matches));
+  EXPECT_TRUE(store.Has({4,9}));
+  EXPECT_FALSE(store.Has({9,4}));
+
+  const IndMatch * pair_matches = nullptr;
+  std::size_t count = 0;
+  EXPECT_TRUE(store.Get({4,9}, pair_matches, count));
+  EXPECT_EQ(13, count);
+  EXPECT_EQ(IndMatch(12, 24), pair_matches[12]);
+  EXPECT_FALSE(store.Get({0,1}, pair_matches, count));
+}
+
+TEST(Matches_Store, Concurrent_shards)
+{
+  const std::string store_dir = "matches_concurrent.bmat";
+  EXPECT_TRUE(Save_Store(PairWiseMatches(), store_dir));
+
+  // Two workers (shards), each one appending pairs from many threads
+  const IndexT view_count = 40;
+  for (const IndexT worker : {0, 1})
+  {
+    Matches_Shard_Writer writer;
+    EXPECT_TRUE(writer.Open(store_dir, "worker_" + std::to_string(worker)));
+    std::vector<std::thread> threads;
+    for (IndexT thread_id = 0; thread_id < 4; ++thread_id)
+    {
+      threads.emplace_back([&writer, worker, thread_id, view_count]
+      {
+        for (IndexT I = thread_id; I < view_count; I += 4)
+        {
+          for (IndexT J = I + 1; J < view_count; ++J)
+          {
+            if ((I + J) % 2 == worker)
+              writer.insert({{I, J}, create_test_matches({I, J})});
+          }
+        }
+      });
+    }
+    for (std::thread & thread : threads)
+      thread.join();
+    EXPECT_TRUE(writer.Close());
+  }
+
+  Matches_Store store;
+  EXPECT_TRUE(store.Open(store_dir));
+  EXPECT_EQ(view_count * (view_count - 1) / 2, store.size());
+  IndMatches pair_matches;
+  for (IndexT I = 0; I < view_count; ++I)
+  {
+    for (IndexT J = I + 1; J < view_count; ++J)
+    {
+      EXPECT_TRUE(store.Get({I, J}, pair_matches));
+      EXPECT_TRUE(pair_matches == create_test_matches({I, J}));
+    }
+  }
+}
+
+TEST(Matches_Store, Interrupted_writer)
+{
+  const std::string store_dir = "matches_interrupted.bmat";
+  EXPECT_TRUE(Save_Store(PairWiseMatches(), store_dir));
+  const std::string shard_filename = stlplus::create_filespec(store_dir, "worker", "shard");
+  {
+    Matches_Shard_Writer writer;
+    EXPECT_TRUE(writer.Open(store_dir, "worker"));
+    EXPECT_TRUE(writer.Append({0,1}, create_test_matches({0,1})));
+    EXPECT_TRUE(writer.Close());
+  }
+  // Append an incomplete record (as an interrupted writer would do)
+  {
+    std::ofstream stream(shard_filename.c_str(), std::ios::out | std::ios::binary | std::ios::app);
+    const IndexT I = 1, J = 2;
+    const uint64_t count = 100;
+    stream.write(reinterpret_cast<const char *>(&I), sizeof(IndexT));
+    stream.write(reinterpret_cast<const char *>(&J), sizeof(IndexT));
+    stream.write(reinterpret_cast<const char *>(&count), sizeof(uint64_t));
+    stream.write(reinterpret_cast<const char *>(&count), sizeof(uint64_t));
+  }
+  Matches_Store store;
+  EXPECT_TRUE(store.Open(store_dir));
+  EXPECT_EQ(1, store.size());
+  EXPECT_FALSE(store.Has({1,2}));
+
+  // The writer resumes after the last complete record
+  {
+    Matches_Shard_Writer writer;
+    EXPECT_TRUE(writer.Open(store_dir, "worker"));
+    EXPECT_EQ(1, writer.pair_count());
+    EXPECT_TRUE(writer.Append({1,2}, create_test_matches({1,2})));
+    // A pair stored again replaces the previous record
+    EXPECT_TRUE(writer.Append({0,1}, {{7,7}}));
+    EXPECT_TRUE(writer.Flush());
+    // Not closed: the reader scans the records that are not indexed
+    Matches_Store store_before_close;
+    EXPECT_TRUE(store_before_close.Open(store_dir));
+    EXPECT_EQ(2, store_before_close.size());
+    EXPECT_TRUE(writer.Close());
+  }
+  PairWiseMatches matches;
+  EXPECT_TRUE(Load_Store(matches, store_dir));
+  EXPECT_EQ(2, matches.size());
+  EXPECT_TRUE(matches.at({1,2}) == create_test_matches({1,2}));
+  EXPECT_EQ(1, matches.at({0,1}).size());
+  EXPECT_EQ(IndMatch(7,7), matches.at({0,1})[0]);
+}
+
+TEST(Matches_Store, Invalid_index)
+{
+  const std::string store_dir = "matches_invalid_index.bmat";
+  PairWiseMatches matches;
+  matches[{0,1}] = create_test_matches({0,1});
+  matches[{1,2}] = create_test_matches({1,2});
+  matches[{3,4}] = create_test_matches({3,4});
+  EXPECT_TRUE(Save_Store(matches, store_dir));
+
+  std::vector<std::string> index_names =
+    stlplus::folder_wildcard(store_dir, "*.idx", false, true);
+  EXPECT_EQ(1, index_names.size());
+  const std::string index_filename = stlplus::create_filespec(store_dir, index_names[0]);
+
+  // Corrupt the match count of the second entry (after the 32 bytes header):
+  //  its array would overrun the shard
+  {
+    std::fstream stream(index_filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    const uint64_t count = 1 << 20;
+    stream.seekp(32 + 24 + 16);
+    stream.write(reinterpret_cast<const char *>(&count), sizeof(count));
+  }
+  // The shard is scanned instead: the matches are intact
+  PairWiseMatches matches_load;
+  EXPECT_TRUE(Load_Store(matches_load, store_dir));
+  EXPECT_EQ(3, matches_load.size());
+  for (const auto & pair_matches : matches)
+    EXPECT_TRUE(pair_matches.second == matches_load.at(pair_matches.first));
+
+  // Same with an offset that does not point to the record of the entry
+  {
+    std::fstream stream(index_filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    const uint64_t count = 1, offset = 16 + 16;
+    stream.seekp(32 + 24 + 8);
+    stream.write(reinterpret_cast<const char *>(&offset), sizeof(offset));
+    stream.write(reinterpret_cast<const char *>(&count), sizeof(count));
+  }
+  EXPECT_TRUE(Load_Store(matches_load, store_dir));
+  EXPECT_EQ(3, matches_load.size());
+  for (const auto & pair_matches : matches)
+    EXPECT_TRUE(pair_matches.second == matches_load.at(pair_matches.first));
+}
+
+TEST(Matches_Store, Empty_shard)
+{
+  const std::string store_dir = "matches_empty_shard.bmat";
+  PairWiseMatches matches;
+  matches[{0,1}] = create_test_matches({0,1});
+  EXPECT_TRUE(Save_Store(matches, store_dir));
+
+  // A worker interrupted before its header was written: 0-byte shard
+  const std::string shard_filename = stlplus::create_filespec(store_dir, "worker", "shard");
+  std::ofstream(shard_filename.c_str(), std::ios::out | std::ios::binary).close();
+  EXPECT_EQ(0, stlplus::file_size(shard_filename));
+
+  // The empty shard is skipped, the other shards are read
+  PairWiseMatches matches_load;
+  EXPECT_TRUE(Load_Store(matches_load, store_dir));
+  EXPECT_EQ(1, matches_load.size());
+  EXPECT_TRUE(matches_load.at({0,1}) == matches.at({0,1}));
+
+  // Same with a header-short shard
+  {
+    std::ofstream stream(shard_filename.c_str(), std::ios::out | std::ios::binary);
+    stream.write("OMVG", 4);
+  }
+  EXPECT_TRUE(Load_Store(matches_load, store_dir));
+  EXPECT_EQ(1, matches_load.size());
+
+  // The writer starts the shard again
+  {
+    Matches_Shard_Writer writer;
+    EXPECT_TRUE(writer.Open(store_dir, "worker"));
+    EXPECT_EQ(0, writer.pair_count());
+    EXPECT_TRUE(writer.Append({1,2}, create_test_matches({1,2})));
+    EXPECT_TRUE(writer.Close());
+  }
+  EXPECT_TRUE(Load_Store(matches_load, store_dir));
+  EXPECT_EQ(2, matches_load.size());
+}
+
+TEST(Matches_Store, Header_flushed)
+{
+  const std::string store_dir = "matches_header_flushed.bmat";
+  Matches_Shard_Writer writer;
+  EXPECT_TRUE(writer.Open(store_dir, "worker"));
+  EXPECT_TRUE(writer.Append({0,1}, create_test_matches({0,1})));
+  // Not flushed: the header is already on disk
+  const std::string shard_filename = stlplus::create_filespec(store_dir, "worker", "shard");
+  EXPECT_TRUE(stlplus::file_size(shard_filename) > 0);
+  Matches_Store store;
+  EXPECT_TRUE(store.Open(store_dir));
+  EXPECT_TRUE(writer.Close());
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -51,6 +51,13 @@ TEST(IndMatch, IO)
   EXPECT_EQ(1, matches.count({1,2}));
   EXPECT_EQ(2, matches.at({0,1}).size());
   EXPECT_EQ(3, matches.at({1,2}).size());
+
+  // Sharded binary match store
+  EXPECT_TRUE(Save(matches, "matches.bmat"));
+  EXPECT_TRUE(Load(matches, "matches.bmat"));
+  EXPECT_EQ(2, matches.size());
+  EXPECT_EQ(2, matches.at({0,1}).size());
+  EXPECT_EQ(3, matches.at({1,2}).size());
 }
 
 TEST(IndMatch, DuplicateRemoval_NoRemoval)
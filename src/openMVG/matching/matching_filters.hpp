@@ -13,6 +13,7 @@
 #include <cassert>
 #include <iterator>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "openMVG/matching/indMatch.hpp"
@@ -59,6 +60,46 @@ inline void NNdistanceRatio
   }
 }
 
+/**
+  * Sort the indexes kept by NNdistanceRatio by increasing distance ratio
+  * (the most distinctive correspondences first).
+  * The order of the resulting matches is then a quality ranking,
+  * as used by progressive sampling (see robust::ProsacSampler).
+  *
+  * \param[in]  first    Iterator on the sequence of distance.
+  * \param[in]  NN       Number of neighbor in iterator
+  *   sequence (minimum required 2).
+  * \param[in,out] vec_ratioOkIndex  Indexes that respect NN dist Ratio
+  *
+  * \return void.
+  */
+template <typename DataInputIterator>
+inline void SortByNNdistanceRatio
+(
+  DataInputIterator first, // distance start
+  int NN, // Number of neighbor in iterator sequence (minimum required 2)
+  std::vector<int> & vec_ratioOkIndex // indexes that respect NN dist Ratio
+)
+{
+  assert( NN >= 2);
+
+  std::vector<std::pair<double, int>> vec_ratio_index;
+  vec_ratio_index.reserve(vec_ratioOkIndex.size());
+  for (const int index : vec_ratioOkIndex)
+  {
+    DataInputIterator iter = first;
+    std::advance(iter, index * NN);
+    DataInputIterator iter2 = iter;
+    std::advance(iter2, 1);
+    // The second neighbor distance is not null (the ratio test passed)
+    vec_ratio_index.emplace_back(
+      static_cast<double>(*iter) / static_cast<double>(*iter2), index);
+  }
+  std::sort(vec_ratio_index.begin(), vec_ratio_index.end());
+  for (size_t i = 0; i < vec_ratio_index.size(); ++i)
+    vec_ratioOkIndex[i] = vec_ratio_index[i].second;
+}
+
 /**
   * Symmetric matches filtering :
   * Suppose matches from dataset A to B stored in vec_matches
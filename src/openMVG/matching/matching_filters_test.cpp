@@ -39,6 +39,28 @@ TEST( matching, setIntersection)
   EXPECT_EQ(7, vec_intersect[5]);
 }
 
+/// Distance ratio filtering, then ranking by increasing distance ratio
+TEST( matching, SortByNNdistanceRatio)
+{
+  // Two nearest neighbor distances per query
+  const float distances[] = {
+    1.f, 10.f,  // ratio 0.1
+    5.f, 6.f,   // ratio 0.83 (rejected)
+    3.f, 10.f,  // ratio 0.3
+    1.f, 4.f,   // ratio 0.25
+    2.f, 10.f}; // ratio 0.2
+
+  vector<int> vec_ratio_ok;
+  NNdistanceRatio(distances, distances + 10, 2, vec_ratio_ok, 0.6f);
+  EXPECT_EQ(4, vec_ratio_ok.size());
+
+  SortByNNdistanceRatio(distances, 2, vec_ratio_ok);
+  EXPECT_EQ(4, vec_ratio_ok.size());
+  EXPECT_EQ(0, vec_ratio_ok[0]);
+  EXPECT_EQ(4, vec_ratio_ok[1]);
+  EXPECT_EQ(3, vec_ratio_ok[2]);
+  EXPECT_EQ(2, vec_ratio_ok[3]);
+}
 
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
@@ -74,6 +74,7 @@ class RegionsMatcher
    * @brief Match some regions to the database
    * Look for each query to the 2 nearest neighbor and keep the match if it pass
    * the distance ratio test: (first_distance < second_distance * f_dist_ratio).
+   * The matches are ordered by increasing distance ratio (most distinctive first).
    */
   virtual bool MatchDistanceRatio
   (
@@ -194,6 +195,11 @@ public:
       number_neighbor,       // Number of neighbor in iterator sequence (minimum required 2)
       nn_ratio_indexes,      // output (indices that respect the distance Ratio)
       b_squared_metric_ ? Square(distance_ratio) : distance_ratio);
+    // Most distinctive matches first (quality ranking for progressive sampling)
+    matching::SortByNNdistanceRatio(
+      nn_distances.cbegin(),
+      number_neighbor,
+      nn_ratio_indexes);
 
     matches.clear();
     matches.reserve(nn_ratio_indexes.size());
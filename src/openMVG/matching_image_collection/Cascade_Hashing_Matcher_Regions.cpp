@@ -188,6 +188,8 @@ void Match
         2, // Number of neighbor in iterator sequence (minimum required 2)
         vec_nn_ratio_idx, // output (indices that respect the distance Ratio)
         Square(fDistRatio));
+      // Most distinctive matches first (quality ranking for progressive sampling)
+      matching::SortByNNdistanceRatio(pvec_distances.cbegin(), 2, vec_nn_ratio_idx);
 
       matching::IndMatches vec_putative_matches;
       vec_putative_matches.reserve(vec_nn_ratio_idx.size());
@@ -196,6 +198,10 @@ void Match
         const size_t index = vec_nn_ratio_idx[k];
         vec_putative_matches.emplace_back(pvec_indices[index*2].j_, pvec_indices[index*2].i_);
       }
+      // Rank of the matches (the deduplication sorts them by index)
+      std::map<IndMatch, uint32_t> match_rank;
+      for (uint32_t k = 0; k < vec_putative_matches.size(); ++k)
+        match_rank.emplace(vec_putative_matches[k], k);
 
       // Remove duplicates
       matching::IndMatch::getDeduplicated(vec_putative_matches);
@@ -206,6 +212,13 @@ void Match
         pointFeaturesI, pointFeaturesJ);
       matchDeduplicator.getDeduplicated(vec_putative_matches);
 
+      // Restore the distance ratio ordering
+      std::sort(vec_putative_matches.begin(), vec_putative_matches.end(),
+        [&match_rank](const IndMatch & a, const IndMatch & b)
+        {
+          return match_rank.at(a) < match_rank.at(b);
+        });
+
 #ifdef OPENMVG_USE_OPENMP
 #pragma omp critical
 #endif
@@ -40,10 +40,12 @@ struct GeometricFilter_EMatrix_AC
   GeometricFilter_EMatrix_AC
   (
     double dPrecision = std::numeric_limits<double>::infinity(),
-    uint32_t iteration = 1024
+    uint32_t iteration = 1024,
+    bool bProgressiveSampling = false
   ):
     m_dPrecision(dPrecision),
     m_stIteration(iteration),
+    m_bProgressiveSampling(bProgressiveSampling),
     m_E(Mat3::Identity()),
     m_dPrecision_robust(std::numeric_limits<double>::infinity())
   {
@@ -121,7 +123,8 @@ struct GeometricFilter_EMatrix_AC
     const double upper_bound_precision = Square(m_dPrecision);
     std::vector<uint32_t> vec_inliers;
     const auto ACRansacOut =
-      openMVG::robust::ACRANSAC(kernel, vec_inliers, m_stIteration, &m_E, upper_bound_precision);
+      openMVG::robust::ACRANSAC(kernel, vec_inliers, m_stIteration, &m_E, upper_bound_precision,
+        false, true, m_bProgressiveSampling);
 
     if (vec_inliers.size() > KernelType::MINIMUM_SAMPLES *2.5)
     {
@@ -198,6 +201,7 @@ struct GeometricFilter_EMatrix_AC
 
   double m_dPrecision;    // upper_bound precision used for robust estimation
   uint32_t m_stIteration; // maximal number of iteration for robust estimation
+  bool m_bProgressiveSampling; // PROSAC sampling (putative matches sorted by quality)
   //
   //-- Stored data
   Mat3 m_E;
@@ -36,9 +36,11 @@ struct GeometricFilter_ESphericalMatrix_AC_Angular
 {
   GeometricFilter_ESphericalMatrix_AC_Angular(
     const double precision_upper_bound,
-    const size_t iteration)
+    const size_t iteration,
+    const bool bProgressiveSampling = false)
     : m_precision_upper_bound(precision_upper_bound),
       m_stIteration(iteration),
+      m_bProgressiveSampling(bProgressiveSampling),
       m_E(Mat3::Identity()),
       m_precision_upper_bound_robust(std::numeric_limits<double>::infinity())
   {
@@ -115,7 +117,8 @@ struct GeometricFilter_ESphericalMatrix_AC_Angular
         D2R(m_precision_upper_bound) : std::numeric_limits<double>::infinity();
     std::vector<uint32_t> vec_inliers;
     const auto ac_ransac_output =
-      ACRANSAC(kernel, vec_inliers, m_stIteration, &m_E, upper_bound_precision);
+      ACRANSAC(kernel, vec_inliers, m_stIteration, &m_E, upper_bound_precision,
+        false, true, m_bProgressiveSampling);
 
     const double & threshold = ac_ransac_output.first;
 
@@ -171,6 +174,8 @@ struct GeometricFilter_ESphericalMatrix_AC_Angular
   double m_precision_upper_bound = std::numeric_limits<double>::infinity();
   // maximal number of iteration for robust estimation
   size_t m_stIteration = 1024;
+  // PROSAC sampling (putative matches sorted by quality)
+  bool m_bProgressiveSampling = false;
 
   //
   //-- Stored data
@@ -10,11 +10,14 @@
 #define OPENMVG_MATCHING_IMAGE_COLLECTION_GEOMETRIC_FILTER_HPP
 
 #include <algorithm>
+#include <iostream>
 #include <map>
+#include <utility>
 #include <vector>
 
 #include "openMVG/features/feature.hpp"
 #include "openMVG/matching/indMatch.hpp"
+#include "openMVG/system/timer.hpp"
 
 #include "third_party/progress/progress_display.hpp"
 
@@ -42,6 +45,11 @@ struct ImageCollectionGeometricFilter
   /// Perform robust model estimation (with optional guided_matching) for all
   /// the pairs and regions correspondences contained in the putative_matches
   /// set.
+  /// Small pairs are processed by batches, and the stage timings are reported
+  /// if a progress display is provided.
+  /// If a (thread safe) output container is provided, each pair is inserted in it as soon as
+  /// it is filtered (with no matches if no valid model is found) instead of
+  /// being stored in _map_GeometricMatches (i.e. to journal the completed pairs).
   template<typename GeometryFunctor>
   void Robust_model_estimation
   (
@@ -49,7 +57,8 @@ struct ImageCollectionGeometricFilter
     const PairWiseMatches & putative_matches,
     const bool b_guided_matching = false,
     const double d_distance_ratio = 0.6,
-    C_Progress *progress_bar = nullptr
+    C_Progress *progress_bar = nullptr,
+    PairWiseMatchesContainer * output = nullptr
   );
 
   const PairWiseMatches & Get_geometric_matches() const
@@ -57,6 +66,10 @@ struct ImageCollectionGeometricFilter
     return _map_GeometricMatches;
   }
 
+  /// Putative matches count from which a batch of consecutive pairs is
+  /// processed as a single parallel task
+  static const size_t kBatchPutativeMatches = 4096;
+
   // Data
   const sfm::SfM_Data * sfm_data_;
   const std::shared_ptr<sfm::Regions_Provider> & regions_provider_;
@@ -70,61 +83,127 @@ void ImageCollectionGeometricFilter::Robust_model_estimation
   const PairWiseMatches & putative_matches,
   const bool b_guided_matching,
   const double d_distance_ratio,
-  C_Progress * my_progress_bar
+  C_Progress * my_progress_bar,
+  PairWiseMatchesContainer * output
 )
 {
+  const bool b_report_timing = (my_progress_bar != nullptr);
   if (!my_progress_bar)
     my_progress_bar = &C_Progress::dummy();
   my_progress_bar->restart( putative_matches.size(), "\n- Geometric filtering -\n" );
 
+  system::Timer timer;
+
+  // Random access to the pairs
+  std::vector<PairWiseMatches::const_iterator> pairs;
+  pairs.reserve(putative_matches.size());
+  for (auto iter = putative_matches.cbegin(); iter != putative_matches.cend(); ++iter)
+    pairs.push_back(iter);
+
+  // Group the consecutive small pairs in batches ([begin, end) pair ranges)
+  //  so that a task amortizes its scheduling over enough work
+  std::vector<std::pair<uint32_t, uint32_t>> batches;
+  {
+    size_t batch_matches = 0;
+    uint32_t begin = 0;
+    for (uint32_t i = 0; i < pairs.size(); ++i)
+    {
+      batch_matches += pairs[i]->second.size();
+      if (batch_matches >= kBatchPutativeMatches || i + 1 == pairs.size())
+      {
+        batches.emplace_back(begin, i + 1);
+        begin = i + 1;
+        batch_matches = 0;
+      }
+    }
+  }
+
+  // Per pair results (written by a single task, collected in pair order)
+  std::vector<IndMatches> geometric_matches(pairs.size());
+  std::vector<uint8_t> b_valid_pairs(pairs.size(), 0);
+
+  // Cumulated time (over the threads) of the filtering stages
+  double robust_estimation_time = 0.0, guided_matching_time = 0.0;
+
+  // The RANSAC scratch buffers are reused across the pairs of a thread
+  //  (see robust::acransac_nfa_internal::ThreadWorkspace)
 #ifdef OPENMVG_USE_OPENMP
-#pragma omp parallel for schedule(dynamic)
+#pragma omp parallel for schedule(dynamic) reduction(+:robust_estimation_time, guided_matching_time)
 #endif
-  for (int i = 0; i < (int)putative_matches.size(); ++i)
+  for (int batch = 0; batch < static_cast<int>(batches.size()); ++batch)
   {
-    if (my_progress_bar->hasBeenCanceled())
-      continue;
-    auto iter = putative_matches.begin();
-    advance(iter,i);
+    for (uint32_t i = batches[batch].first; i < batches[batch].second; ++i)
+    {
+      if (my_progress_bar->hasBeenCanceled())
+        break;
 
-    Pair current_pair = iter->first;
-    const std::vector<IndMatch> & vec_PutativeMatches = iter->second;
+      const Pair current_pair = pairs[i]->first;
+      const std::vector<IndMatch> & vec_PutativeMatches = pairs[i]->second;
 
-    //-- Apply the geometric filter (robust model estimation)
-    {
+      //-- Apply the geometric filter (robust model estimation)
       IndMatches putative_inliers;
       GeometryFunctor geometricFilter = functor; // use a copy since we are in a multi-thread context
-      if (geometricFilter.Robust_estimation(
+      system::Timer stage_timer;
+      const bool b_valid = geometricFilter.Robust_estimation(
         sfm_data_,
         regions_provider_,
-        iter->first,
+        current_pair,
         vec_PutativeMatches,
-        putative_inliers))
+        putative_inliers);
+      robust_estimation_time += stage_timer.elapsed();
+      if (b_valid)
       {
         if (b_guided_matching)
         {
+          stage_timer.reset();
           IndMatches guided_geometric_inliers;
           geometricFilter.Geometry_guided_matching(
             sfm_data_,
             regions_provider_,
-            iter->first,
+            current_pair,
             d_distance_ratio,
             guided_geometric_inliers);
           //std::cout
           // << "#before/#after: " << putative_inliers.size()
           // << "/" << guided_geometric_inliers.size() << std::endl;
           std::swap(putative_inliers, guided_geometric_inliers);
+          guided_matching_time += stage_timer.elapsed();
         }
-
-#ifdef OPENMVG_USE_OPENMP
-#pragma omp critical
-#endif
+        if (output)
         {
-          _map_GeometricMatches.insert( {current_pair, std::move(putative_inliers)});
+          output->insert({current_pair, std::move(putative_inliers)});
         }
+        else
+        {
+          geometric_matches[i] = std::move(putative_inliers);
+          b_valid_pairs[i] = 1;
+        }
+      }
+      else if (output)
+      {
+        output->insert({current_pair, IndMatches()});
       }
+      ++(*my_progress_bar);
     }
-    ++(*my_progress_bar);
+  }
+
+  for (uint32_t i = 0; i < pairs.size(); ++i)
+  {
+    if (b_valid_pairs[i])
+      _map_GeometricMatches.insert({pairs[i]->first, std::move(geometric_matches[i])});
+  }
+
+  if (b_report_timing)
+  {
+    std::cout
+      << "\n- Geometric filtering timing -\n"
+      << " #pairs: " << pairs.size() << " in " << batches.size() << " batches\n"
+      << " robust estimation: " << robust_estimation_time << " s\n";
+    if (b_guided_matching)
+      std::cout << " guided matching: " << guided_matching_time << " s\n";
+    std::cout
+      << " (time cumulated over the threads)\n"
+      << " total: " << timer.elapsed() << " s" << std::endl;
   }
 }
 
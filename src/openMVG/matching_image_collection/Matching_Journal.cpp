@@ -0,0 +1,108 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/matching_image_collection/Matching_Journal.hpp"
+
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <iostream>
+
+namespace openMVG {
+namespace matching_image_collection {
+
+using namespace openMVG::matching;
+
+namespace
+{
+const char kJournalShardName[] = "journal";
+} // namespace
+
+bool Matching_Journal::Open(const std::string & journal_dir, const bool b_resume)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  journal_dir_ = journal_dir;
+  completed_pairs_.clear();
+  matches_.clear();
+
+  // An empty or header-short shard (run killed before its first write) is
+  //  skipped by the store: there is no completed pair
+  Matches_Store store;
+  const bool b_valid_journal =
+    b_resume && stlplus::folder_exists(journal_dir_) && store.Open(journal_dir_);
+  if (b_resume && stlplus::folder_exists(journal_dir_) && !b_valid_journal)
+    std::cerr << "Invalid matching journal, it is started again: " << journal_dir_ << std::endl;
+
+  if (b_valid_journal)
+  {
+    store.Load(matches_);
+    // The empty records are the completed pairs without matches
+    for (auto it = matches_.begin(); it != matches_.end();)
+    {
+      completed_pairs_.insert(completed_pairs_.end(), it->first);
+      if (it->second.empty())
+        it = matches_.erase(it);
+      else
+        ++it;
+    }
+  }
+  else if (stlplus::folder_exists(journal_dir_) && !stlplus::folder_delete(journal_dir_, true))
+  {
+    std::cerr << "Cannot reset the matching journal: " << journal_dir_ << std::endl;
+    return false;
+  }
+  return writer_.Open(journal_dir_, kJournalShardName);
+}
+
+void Matching_Journal::insert(std::pair<Pair, IndMatches> && pairWiseMatches)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  writer_.Append(pairWiseMatches.first, pairWiseMatches.second);
+  completed_pairs_.insert(pairWiseMatches.first);
+  if (!pairWiseMatches.second.empty())
+    matches_.insert(std::move(pairWiseMatches));
+}
+
+bool Matching_Journal::Checkpoint(const Pair_Set & pairs)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool bOk = true;
+  for (const Pair & pair : pairs)
+  {
+    if (!completed_pairs_.insert(pair).second)
+      continue;
+    if (matches_.count(pair) == 0)
+      bOk &= writer_.Append(pair, {});
+  }
+  return writer_.Flush() && bOk;
+}
+
+void Matching_Journal::Extract(const Pair_Set & pairs, PairWiseMatches & matches)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  matches.clear();
+  for (auto & pair_matches : matches_)
+  {
+    if (pairs.count(pair_matches.first) != 0)
+      matches.insert({pair_matches.first, std::move(pair_matches.second)});
+  }
+  matches_.clear();
+}
+
+bool Matching_Journal::Close()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return writer_.Close();
+}
+
+bool Matching_Journal::Remove()
+{
+  Close();
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !stlplus::folder_exists(journal_dir_) || stlplus::folder_delete(journal_dir_, true);
+}
+
+} // namespace matching_image_collection
+} // namespace openMVG
@@ -0,0 +1,109 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_MATCHING_IMAGE_COLLECTION_MATCHING_JOURNAL_HPP
+#define OPENMVG_MATCHING_IMAGE_COLLECTION_MATCHING_JOURNAL_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <string>
+
+#include "openMVG/matching/indMatch.hpp"
+#include "openMVG/matching/indMatch_store.hpp"
+#include "openMVG/types.hpp"
+
+namespace openMVG {
+namespace matching_image_collection {
+
+/**
+* Journal of the completed pairs of a matching stage (putative matching or
+* geometric filtering), used to resume an interrupted stage.
+*
+* The journal is a match store directory (see matching::Matches_Store):
+* - a pair is appended as soon as the stage outputs it (an empty record if
+*   it has no matches), the records are buffered and reach the disk by blocks,
+* - once the stage is done, its pairs that were not output are appended as
+*   empty records and the journal is flushed (checkpoint).
+* A process killed during the stage only loses its last buffered records and
+* the pairs that the stage does not output (i.e. the putative pairs without
+* matches): they are processed again by the resumed run.
+*/
+class Matching_Journal : public matching::PairWiseMatchesContainer
+{
+public:
+  /**
+  * @brief Open the journal of a stage.
+  * @param journal_dir journal directory
+  * @param b_resume keep the pairs completed by a previous run (else start
+  *  an empty journal). A journal that cannot be read (e.g. a run killed
+  *  before its first write) is started again.
+  */
+  bool Open(const std::string & journal_dir, const bool b_resume);
+
+  /// Pairs completed by the previous runs and the current one
+  const Pair_Set & Completed_pairs() const { return completed_pairs_; }
+
+  /// Journal a completed pair and its matches (thread safe)
+  void insert(std::pair<Pair, matching::IndMatches> && pairWiseMatches) override;
+
+  /// Mark some pairs as completed and flush the journal
+  bool Checkpoint(const Pair_Set & pairs);
+
+  /// Move the journaled matches of some pairs
+  void Extract(const Pair_Set & pairs, matching::PairWiseMatches & matches);
+
+  /// Close the journal
+  bool Close();
+
+  /// Close the journal and remove its directory (once the stage result is saved)
+  bool Remove();
+
+private:
+  std::mutex mutex_;
+  std::string journal_dir_;
+  matching::Matches_Shard_Writer writer_;
+  Pair_Set completed_pairs_;
+  matching::PairWiseMatches matches_;
+};
+
+/**
+* @brief Run a matching stage on the pairs that are not completed in a journal.
+*  The stage runs once on all the remaining pairs (its result does not depend on
+*  the journal) and outputs the pairs to the journal as they are computed.
+* @param pairs the pairs of the stage
+* @param journal the journal of the stage
+* @param stage functor (const Pair_Set & remaining_pairs, PairWiseMatchesContainer & output)
+* @param[out] matches the matches of the pairs (resumed and computed)
+* @return false if the journal cannot be written
+*/
+template <typename Stage_Functor>
+bool Run_with_journal
+(
+  const Pair_Set & pairs,
+  Matching_Journal & journal,
+  Stage_Functor && stage,
+  matching::PairWiseMatches & matches
+)
+{
+  Pair_Set remaining_pairs;
+  std::set_difference(pairs.cbegin(), pairs.cend(),
+    journal.Completed_pairs().cbegin(), journal.Completed_pairs().cend(),
+    std::inserter(remaining_pairs, remaining_pairs.end()));
+  if (!remaining_pairs.empty())
+  {
+    stage(remaining_pairs, journal);
+    if (!journal.Checkpoint(remaining_pairs))
+      return false;
+  }
+  journal.Extract(pairs, matches);
+  return true;
+}
+
+} // namespace matching_image_collection
+} // namespace openMVG
+
+#endif // OPENMVG_MATCHING_IMAGE_COLLECTION_MATCHING_JOURNAL_HPP
@@ -0,0 +1,183 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/matching_image_collection/Matching_Journal.hpp"
+#include "openMVG/matching_image_collection/Pair_Builder.hpp"
+
+#include "testing/testing.h"
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <fstream>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace openMVG;
+using namespace openMVG::matching;
+using namespace openMVG::matching_image_collection;
+
+namespace {
+
+// A stage that matches the pairs with an even I + J and lists the processed pairs
+struct Test_Stage
+{
+  Pair_Set & processed_pairs;
+  int * call_count = nullptr;
+
+  void operator()(const Pair_Set & pairs, PairWiseMatchesContainer & output) const
+  {
+    if (call_count)
+      ++(*call_count);
+    for (const Pair & pair : pairs)
+    {
+      processed_pairs.insert(pair);
+      if ((pair.first + pair.second) % 2 == 0)
+        output.insert({pair, {{pair.first, pair.second}}});
+    }
+  }
+};
+
+} // namespace
+
+TEST(Matching_Journal, Resume)
+{
+  const std::string journal_dir = "matching_journal_resume.bmat";
+  const Pair_Set pairs = exhaustivePairs(80);
+  Pair_Set first_pairs;
+  for (const Pair & pair : pairs)
+  {
+    if (pair.first < 20)
+      first_pairs.insert(pair);
+  }
+
+  // First run: only a part of the pairs is done
+  PairWiseMatches matches;
+  Pair_Set processed_pairs;
+  {
+    Matching_Journal journal;
+    EXPECT_TRUE(journal.Open(journal_dir, false));
+    EXPECT_TRUE(Run_with_journal(first_pairs, journal, Test_Stage{processed_pairs}, matches));
+    EXPECT_TRUE(journal.Close());
+  }
+  EXPECT_TRUE(processed_pairs == first_pairs);
+
+  // Resumed run: the completed pairs are not processed again,
+  //  the remaining ones are processed by a single stage run
+  processed_pairs.clear();
+  int call_count = 0;
+  {
+    Matching_Journal journal;
+    EXPECT_TRUE(journal.Open(journal_dir, true));
+    EXPECT_EQ(first_pairs.size(), journal.Completed_pairs().size());
+    EXPECT_TRUE(Run_with_journal(pairs, journal, Test_Stage{processed_pairs, &call_count}, matches));
+    EXPECT_TRUE(journal.Remove());
+  }
+  EXPECT_EQ(1, call_count);
+  EXPECT_EQ(pairs.size() - first_pairs.size(), processed_pairs.size());
+  EXPECT_EQ(0, processed_pairs.count(*first_pairs.begin()));
+
+  // Same result as a run without interruption
+  PairWiseMatches expected_matches;
+  processed_pairs.clear();
+  Test_Stage{processed_pairs}(pairs, expected_matches);
+  EXPECT_TRUE(matches == expected_matches);
+
+  // Not resumed: all the pairs are processed again
+  processed_pairs.clear();
+  {
+    Matching_Journal journal;
+    EXPECT_TRUE(journal.Open(journal_dir, true));
+    EXPECT_EQ(0, journal.Completed_pairs().size());
+    EXPECT_TRUE(Run_with_journal(pairs, journal, Test_Stage{processed_pairs}, matches));
+    EXPECT_TRUE(journal.Close());
+  }
+  EXPECT_TRUE(processed_pairs == pairs);
+  {
+    Matching_Journal journal;
+    EXPECT_TRUE(journal.Open(journal_dir, false));
+    EXPECT_EQ(0, journal.Completed_pairs().size());
+    EXPECT_TRUE(journal.Remove());
+  }
+}
+
+TEST(Matching_Journal, Interrupted_stage)
+{
+  const std::string journal_dir = "matching_journal_interrupted.bmat";
+  {
+    Matching_Journal journal;
+    EXPECT_TRUE(journal.Open(journal_dir, false));
+    // A stage interrupted before its checkpoint: the output pairs are journaled
+    journal.insert({{0,1}, {{1,1}}});
+    journal.insert({{0,2}, {}});
+    EXPECT_TRUE(journal.Close());
+  }
+  Matching_Journal journal;
+  EXPECT_TRUE(journal.Open(journal_dir, true));
+  EXPECT_EQ(2, journal.Completed_pairs().size());
+  EXPECT_EQ(1, journal.Completed_pairs().count({0,1}));
+  EXPECT_EQ(1, journal.Completed_pairs().count({0,2}));
+
+  // Only the pair that was not output is processed again
+  Pair_Set processed_pairs;
+  PairWiseMatches matches;
+  EXPECT_TRUE(Run_with_journal({{0,1}, {0,2}, {0,3}}, journal, Test_Stage{processed_pairs}, matches));
+  EXPECT_TRUE(processed_pairs == Pair_Set({{0,3}}));
+  EXPECT_EQ(1, matches.size());
+  EXPECT_EQ(IndMatch(1,1), matches.at({0,1})[0]);
+  EXPECT_TRUE(journal.Remove());
+}
+
+TEST(Matching_Journal, Killed_writer)
+{
+  const std::string journal_dir = "matching_journal_killed.bmat";
+#if !defined(_WIN32)
+  // A run killed before its first flush: the output pair is buffered only
+  const pid_t pid = fork();
+  if (pid == 0)
+  {
+    Matching_Journal journal;
+    journal.Open(journal_dir, false);
+    journal.insert({{0,1}, {{1,1}}});
+    _exit(0);
+  }
+  int status = 0;
+  EXPECT_EQ(pid, waitpid(pid, &status, 0));
+  EXPECT_TRUE(stlplus::folder_exists(journal_dir));
+#endif
+  // The journal is resumed without completed pairs
+  {
+    Matching_Journal journal;
+    EXPECT_TRUE(journal.Open(journal_dir, true));
+    EXPECT_EQ(0, journal.Completed_pairs().size());
+    Pair_Set processed_pairs;
+    PairWiseMatches matches;
+    EXPECT_TRUE(Run_with_journal({{0,1}, {0,2}}, journal, Test_Stage{processed_pairs}, matches));
+    EXPECT_TRUE(processed_pairs == Pair_Set({{0,1}, {0,2}}));
+    EXPECT_EQ(1, matches.size());
+    EXPECT_TRUE(journal.Remove());
+  }
+
+  // Same with a 0-byte journal shard
+  EXPECT_TRUE(stlplus::folder_create(journal_dir));
+  std::ofstream(stlplus::create_filespec(journal_dir, "journal", "shard").c_str()).close();
+  {
+    Matching_Journal journal;
+    EXPECT_TRUE(journal.Open(journal_dir, true));
+    EXPECT_EQ(0, journal.Completed_pairs().size());
+    journal.insert({{0,2}, {{2,2}}});
+    EXPECT_TRUE(journal.Close());
+  }
+  Matching_Journal journal;
+  EXPECT_TRUE(journal.Open(journal_dir, true));
+  EXPECT_EQ(1, journal.Completed_pairs().size());
+  EXPECT_TRUE(journal.Remove());
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -0,0 +1,144 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_MATCHING_IMAGE_COLLECTION_PAIR_SHARDING_HPP
+#define OPENMVG_MATCHING_IMAGE_COLLECTION_PAIR_SHARDING_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "openMVG/matching/indMatch.hpp"
+#include "openMVG/types.hpp"
+
+namespace openMVG {
+
+/// Weight of each view used to balance the matching shards (i.e. its feature count)
+using View_Weights = std::map<IndexT, std::size_t>;
+
+/// Estimated matching cost of a pair: product of the view weights
+/// (the views without a weight count as 1)
+inline double pairMatchingCost(const Pair & pair, const View_Weights & weights)
+{
+  const auto weight = [&weights](const IndexT view_id) -> double
+  {
+    const auto it = weights.find(view_id);
+    return (it == weights.end()) ? 1.0 : std::max<std::size_t>(it->second, 1);
+  };
+  return weight(pair.first) * weight(pair.second);
+}
+
+/// Split a pair set into shards of balanced matching cost.
+/// The shards are contiguous ranges of the ordered pairs:
+/// - the split only depends on the pairs and the weights (deterministic),
+/// - the pairs sharing a first view are mostly in the same shard (the
+///   matchers are built once per first view).
+/// Some shards are empty if there are less pairs than shards.
+inline std::vector<Pair_Set> shardPairs
+(
+  const Pair_Set & pairs,
+  const View_Weights & weights,
+  const std::size_t shard_count
+)
+{
+  std::vector<Pair_Set> shards(shard_count);
+  if (shard_count == 0)
+    return shards;
+
+  double total_cost = 0.0;
+  for (const Pair & pair : pairs)
+    total_cost += pairMatchingCost(pair, weights);
+
+  // A pair goes to the shard whose cost range contains its cost midpoint
+  double cumulative_cost = 0.0;
+  std::size_t shard = 0;
+  for (const Pair & pair : pairs)
+  {
+    const double cost = pairMatchingCost(pair, weights);
+    while (shard + 1 < shard_count
+           && cumulative_cost + cost / 2.0 > total_cost * (shard + 1) / shard_count)
+      ++shard;
+    shards[shard].insert(shards[shard].end(), pair);
+    cumulative_cost += cost;
+  }
+  return shards;
+}
+
+/// Directory of a shard of a matching plan (plan_dir/shard_XXXX)
+inline std::string shardDirectory(const std::string & plan_dir, const std::size_t shard)
+{
+  std::ostringstream os;
+  os << plan_dir << "/shard_" << std::setfill('0') << std::setw(4) << shard;
+  return os.str();
+}
+
+/// Add the matches computed for a shard to the merged matches.
+/// The result is independent of the merge order of the shards.
+/// @return false (and an explanation in error) if a pair is not planned in
+///  the shard or if it is already merged (shards that are not disjoint).
+inline bool mergeShardMatches
+(
+  const Pair_Set & shard_pairs,
+  matching::PairWiseMatches & shard_matches,
+  matching::PairWiseMatches & merged_matches,
+  std::string & error
+)
+{
+  for (auto & pair_matches : shard_matches)
+  {
+    const Pair & pair = pair_matches.first;
+    std::ostringstream os;
+    os << "(" << pair.first << ", " << pair.second << ")";
+    if (shard_pairs.count(pair) == 0)
+    {
+      error = "the pair " + os.str() + " is not planned in the shard";
+      return false;
+    }
+    if (merged_matches.count(pair) != 0)
+    {
+      error = "the pair " + os.str() + " is already merged from another shard";
+      return false;
+    }
+    merged_matches[pair] = std::move(pair_matches.second);
+  }
+  shard_matches.clear();
+  return true;
+}
+
+/// Digest (64 bits FNV-1a) of pairwise matches, used to compare match files
+/// (e.g. the results of two runs of a distributed matching)
+inline uint64_t matchesDigest(const matching::PairWiseMatches & matches)
+{
+  uint64_t digest = 14695981039346656037ULL;
+  const auto hash = [&digest](const uint64_t value)
+  {
+    for (int i = 0; i < 8; ++i)
+    {
+      digest ^= (value >> (8 * i)) & 0xFF;
+      digest *= 1099511628211ULL;
+    }
+  };
+  for (const auto & pair_matches : matches)
+  {
+    hash(pair_matches.first.first);
+    hash(pair_matches.first.second);
+    hash(pair_matches.second.size());
+    for (const matching::IndMatch & match : pair_matches.second)
+    {
+      hash(match.i_);
+      hash(match.j_);
+    }
+  }
+  return digest;
+}
+
+} // namespace openMVG
+
+#endif // OPENMVG_MATCHING_IMAGE_COLLECTION_PAIR_SHARDING_HPP
@@ -0,0 +1,127 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/matching_image_collection/Pair_Builder.hpp"
+#include "openMVG/matching_image_collection/Pair_Sharding.hpp"
+#include "testing/testing.h"
+
+using namespace openMVG;
+using namespace openMVG::matching;
+
+namespace {
+
+double shardCost(const Pair_Set & pairs, const View_Weights & weights)
+{
+  double cost = 0.0;
+  for (const Pair & pair : pairs)
+    cost += pairMatchingCost(pair, weights);
+  return cost;
+}
+
+// The shards are a partition of the pairs with balanced costs
+bool checkShards
+(
+  const Pair_Set & pairs,
+  const View_Weights & weights,
+  const std::vector<Pair_Set> & shards
+)
+{
+  Pair_Set union_pairs;
+  std::size_t pair_count = 0;
+  double max_pair_cost = 0.0;
+  for (const Pair & pair : pairs)
+    max_pair_cost = std::max(max_pair_cost, pairMatchingCost(pair, weights));
+  const double mean_cost = shardCost(pairs, weights) / shards.size();
+  for (const Pair_Set & shard : shards)
+  {
+    union_pairs.insert(shard.cbegin(), shard.cend());
+    pair_count += shard.size();
+    if (std::abs(shardCost(shard, weights) - mean_cost) > max_pair_cost)
+      return false;
+  }
+  return union_pairs == pairs && pair_count == pairs.size();
+}
+
+} // namespace
+
+TEST(Pair_Sharding, Uniform_weights)
+{
+  const Pair_Set pairs = exhaustivePairs(30);
+  const std::vector<Pair_Set> shards = shardPairs(pairs, View_Weights(), 4);
+  EXPECT_EQ(4, shards.size());
+  EXPECT_TRUE(checkShards(pairs, View_Weights(), shards));
+  // Deterministic
+  EXPECT_TRUE(shards == shardPairs(pairs, View_Weights(), 4));
+}
+
+TEST(Pair_Sharding, Feature_count_weights)
+{
+  const Pair_Set pairs = exhaustivePairs(40);
+  View_Weights weights;
+  for (IndexT view_id = 0; view_id < 40; ++view_id)
+    weights[view_id] = (view_id % 5 == 0) ? 20000 : 1000 + 10 * view_id;
+  const std::vector<Pair_Set> shards = shardPairs(pairs, weights, 7);
+  EXPECT_TRUE(checkShards(pairs, weights, shards));
+  // The shards do not have the same pair count
+  EXPECT_TRUE(shards.front().size() != shards.back().size());
+}
+
+TEST(Pair_Sharding, More_shards_than_pairs)
+{
+  const Pair_Set pairs = exhaustivePairs(3);
+  const std::vector<Pair_Set> shards = shardPairs(pairs, View_Weights(), 5);
+  EXPECT_EQ(5, shards.size());
+  std::size_t non_empty_count = 0;
+  for (const Pair_Set & shard : shards)
+    non_empty_count += !shard.empty();
+  EXPECT_EQ(3, non_empty_count);
+  EXPECT_TRUE(shardPairs(pairs, View_Weights(), 0).empty());
+}
+
+TEST(Pair_Sharding, Merge)
+{
+  const std::vector<Pair_Set> shards = shardPairs(exhaustivePairs(6), View_Weights(), 3);
+  // Matches of each shard (some pairs have no match)
+  const auto shard_matches = [&shards](const std::size_t shard)
+  {
+    PairWiseMatches matches;
+    for (const Pair & pair : shards[shard])
+      if ((pair.first + pair.second) % 3 != 0)
+        matches[pair] = {{pair.first, pair.second}, {pair.second, pair.first}};
+    return matches;
+  };
+
+  // The merged matches do not depend on the merge order
+  std::string error;
+  PairWiseMatches merged, merged_reverse;
+  for (std::size_t shard = 0; shard < shards.size(); ++shard)
+  {
+    PairWiseMatches matches = shard_matches(shard);
+    EXPECT_TRUE(mergeShardMatches(shards[shard], matches, merged, error));
+    EXPECT_TRUE(matches.empty());
+    matches = shard_matches(shards.size() - 1 - shard);
+    EXPECT_TRUE(mergeShardMatches(shards[shards.size() - 1 - shard], matches, merged_reverse, error));
+  }
+  EXPECT_EQ(10, merged.size());
+  EXPECT_TRUE(merged == merged_reverse);
+  EXPECT_EQ(matchesDigest(merged), matchesDigest(merged_reverse));
+
+  // A result merged twice or from the wrong shard is rejected
+  PairWiseMatches matches = shard_matches(0);
+  EXPECT_FALSE(mergeShardMatches(shards[0], matches, merged, error));
+  EXPECT_FALSE(error.empty());
+  matches = shard_matches(0);
+  PairWiseMatches merged_wrong;
+  EXPECT_FALSE(mergeShardMatches(shards[1], matches, merged_wrong, error));
+
+  // The digest depends on the matches
+  merged.begin()->second.pop_back();
+  EXPECT_TRUE(matchesDigest(merged) != matchesDigest(merged_reverse));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
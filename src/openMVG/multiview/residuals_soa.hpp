@@ -0,0 +1,309 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2026 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_MULTIVIEW_RESIDUALS_SOA_HPP
+#define OPENMVG_MULTIVIEW_RESIDUALS_SOA_HPP
+
+// Structure of arrays (SoA) evaluation of the robust estimation residuals.
+//
+// The kernels store the point correspondences column-wise (one point per
+//  column). Evaluating a model over all the correspondences one column at a
+//  time prevents the compiler from using SIMD registers across points.
+// Here the coordinates are stored one contiguous array per coordinate, and
+//  the residual formula is written as an Eigen array expression, so a whole
+//  range of correspondences is evaluated in a single vectorized loop.
+//  The vector width is the Eigen packet width (SSE, AVX, NEON, ...) selected
+//  by the compilation flags (see OPENMVG_USE_AVX/OPENMVG_USE_AVX2).
+//
+// Provided residual kernels (float or double precision):
+//  - fundamental::kernel::SampsonError
+//  - fundamental::kernel::SymmetricEpipolarDistanceError
+//  - fundamental::kernel::EpipolarDistanceError
+//  - homography::kernel::AsymmetricError
+//  - AngularError (essential matrix from bearing vectors)
+//  - resection::SquaredPixelReprojectionError
+//
+
+#include <cstdint>
+#include <utility>
+
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+#include "openMVG/multiview/solver_essential_eight_point.hpp"
+#include "openMVG/multiview/solver_fundamental_kernel.hpp"
+#include "openMVG/multiview/solver_homography_kernel.hpp"
+#include "openMVG/multiview/solver_resection_metrics.hpp"
+
+namespace openMVG {
+namespace soa {
+
+/// SoA storage of N points of dimension Dim (one contiguous column per coordinate)
+template <typename Scalar, int Dim>
+using Points = Eigen::Matrix<Scalar, Eigen::Dynamic, Dim>;
+
+/// Convert a column-wise (Dim x N) point matrix to the SoA layout
+template <typename Scalar, int Dim, typename Derived>
+Points<Scalar, Dim> ToSoA(const Eigen::MatrixBase<Derived> & x)
+{
+  assert(x.rows() == Dim);
+  return x.transpose().template cast<Scalar>();
+}
+
+/**
+* @brief SoA evaluation of the ErrorT residual functor.
+* The generic version is not available (the kernel must fall back to the
+*  column-wise ErrorT::Error evaluation).
+* Specializations store a SoA copy of the data and provide:
+*  - Errors(model, begin, end, errors): compute errors[begin, end) with the
+*    same value as ErrorT::Error(model, x1.col(i), x2.col(i)).
+*/
+template <typename ErrorT, typename Scalar = double>
+class Residuals
+{
+public:
+  static constexpr bool available = false;
+
+  Residuals() = default;
+
+  template <typename Data1, typename Data2>
+  Residuals(const Data1 &, const Data2 &) {}
+
+  template <typename ModelT>
+  void Errors(const ModelT &, uint32_t, uint32_t, Scalar *) const {}
+};
+
+/// Common storage of the two view residuals (x1 -> x2 correspondences)
+template <typename Scalar, int Dim1, int Dim2>
+class CorrespondencesSoA
+{
+public:
+  static constexpr bool available = true;
+
+  CorrespondencesSoA() = default;
+
+  template <typename Data1, typename Data2>
+  CorrespondencesSoA(const Data1 & x1, const Data2 & x2)
+    : x1_(ToSoA<Scalar, Dim1>(x1)), x2_(ToSoA<Scalar, Dim2>(x2))
+  {
+    assert(x1_.rows() == x2_.rows());
+  }
+
+protected:
+  using Array = Eigen::Array<Scalar, Eigen::Dynamic, 1>;
+
+  // Coordinate c of the samples in [begin, begin + n)
+  auto x1(int c, uint32_t begin, uint32_t n) const
+    -> decltype(std::declval<const Points<Scalar, Dim1>&>().col(c).segment(begin, n).array())
+  {
+    return x1_.col(c).segment(begin, n).array();
+  }
+  auto x2(int c, uint32_t begin, uint32_t n) const
+    -> decltype(std::declval<const Points<Scalar, Dim2>&>().col(c).segment(begin, n).array())
+  {
+    return x2_.col(c).segment(begin, n).array();
+  }
+
+  Points<Scalar, Dim1> x1_;
+  Points<Scalar, Dim2> x2_;
+};
+
+// Note: the array expressions below are lazy, the intermediate terms
+//  (i.e. epipolar lines) are not stored but fused in the final assignment.
+
+template <typename Scalar>
+class Residuals<fundamental::kernel::SampsonError, Scalar>
+  : public CorrespondencesSoA<Scalar, 2, 2>
+{
+  using Base = CorrespondencesSoA<Scalar, 2, 2>;
+public:
+  using Base::Base;
+
+  void Errors
+  (
+    const Mat3 & F,
+    const uint32_t begin,
+    const uint32_t end,
+    Scalar * errors
+  ) const
+  {
+    const uint32_t n = end - begin;
+    const Eigen::Matrix<Scalar, 3, 3> f = F.cast<Scalar>();
+    const auto x = this->x1(0, begin, n), y = this->x1(1, begin, n);
+    const auto u = this->x2(0, begin, n), v = this->x2(1, begin, n);
+    // Epipolar lines: F * x1 (in image 2) and F^t * x2 (in image 1)
+    const auto a2 = f(0,0) * x + f(0,1) * y + f(0,2);
+    const auto b2 = f(1,0) * x + f(1,1) * y + f(1,2);
+    const auto c2 = f(2,0) * x + f(2,1) * y + f(2,2);
+    const auto a1 = f(0,0) * u + f(1,0) * v + f(2,0);
+    const auto b1 = f(0,1) * u + f(1,1) * v + f(2,1);
+    // See page 287 equation (11.9) of HZ.
+    Eigen::Map<typename Base::Array>(errors + begin, n) =
+      (a2 * u + b2 * v + c2).square()
+      / (a2.square() + b2.square() + a1.square() + b1.square());
+  }
+};
+
+template <typename Scalar>
+class Residuals<fundamental::kernel::SymmetricEpipolarDistanceError, Scalar>
+  : public CorrespondencesSoA<Scalar, 2, 2>
+{
+  using Base = CorrespondencesSoA<Scalar, 2, 2>;
+public:
+  using Base::Base;
+
+  void Errors
+  (
+    const Mat3 & F,
+    const uint32_t begin,
+    const uint32_t end,
+    Scalar * errors
+  ) const
+  {
+    const uint32_t n = end - begin;
+    const Eigen::Matrix<Scalar, 3, 3> f = F.cast<Scalar>();
+    const auto x = this->x1(0, begin, n), y = this->x1(1, begin, n);
+    const auto u = this->x2(0, begin, n), v = this->x2(1, begin, n);
+    const auto a2 = f(0,0) * x + f(0,1) * y + f(0,2);
+    const auto b2 = f(1,0) * x + f(1,1) * y + f(1,2);
+    const auto c2 = f(2,0) * x + f(2,1) * y + f(2,2);
+    const auto a1 = f(0,0) * u + f(1,0) * v + f(2,0);
+    const auto b1 = f(0,1) * u + f(1,1) * v + f(2,1);
+    // See page 288 equation (11.10) of HZ.
+    Eigen::Map<typename Base::Array>(errors + begin, n) =
+      (a2 * u + b2 * v + c2).square()
+      * ((a2.square() + b2.square()).inverse() + (a1.square() + b1.square()).inverse())
+      / Scalar(4);
+  }
+};
+
+template <typename Scalar>
+class Residuals<fundamental::kernel::EpipolarDistanceError, Scalar>
+  : public CorrespondencesSoA<Scalar, 2, 2>
+{
+  using Base = CorrespondencesSoA<Scalar, 2, 2>;
+public:
+  using Base::Base;
+
+  void Errors
+  (
+    const Mat3 & F,
+    const uint32_t begin,
+    const uint32_t end,
+    Scalar * errors
+  ) const
+  {
+    const uint32_t n = end - begin;
+    const Eigen::Matrix<Scalar, 3, 3> f = F.cast<Scalar>();
+    const auto x = this->x1(0, begin, n), y = this->x1(1, begin, n);
+    const auto u = this->x2(0, begin, n), v = this->x2(1, begin, n);
+    const auto a2 = f(0,0) * x + f(0,1) * y + f(0,2);
+    const auto b2 = f(1,0) * x + f(1,1) * y + f(1,2);
+    const auto c2 = f(2,0) * x + f(2,1) * y + f(2,2);
+    // Transfer error in image 2
+    Eigen::Map<typename Base::Array>(errors + begin, n) =
+      (a2 * u + b2 * v + c2).square() / (a2.square() + b2.square());
+  }
+};
+
+template <typename Scalar>
+class Residuals<homography::kernel::AsymmetricError, Scalar>
+  : public CorrespondencesSoA<Scalar, 2, 2>
+{
+  using Base = CorrespondencesSoA<Scalar, 2, 2>;
+public:
+  using Base::Base;
+
+  template <typename ModelT>
+  void Errors
+  (
+    const ModelT & H,
+    const uint32_t begin,
+    const uint32_t end,
+    Scalar * errors
+  ) const
+  {
+    const uint32_t n = end - begin;
+    const Eigen::Matrix<Scalar, 3, 3> h = H.template cast<Scalar>();
+    const auto x = this->x1(0, begin, n), y = this->x1(1, begin, n);
+    const auto u = this->x2(0, begin, n), v = this->x2(1, begin, n);
+    // Transfer of x1 in image 2: H * x1
+    const auto px = h(0,0) * x + h(0,1) * y + h(0,2);
+    const auto py = h(1,0) * x + h(1,1) * y + h(1,2);
+    const auto pw = h(2,0) * x + h(2,1) * y + h(2,2);
+    Eigen::Map<typename Base::Array>(errors + begin, n) =
+      (u - px / pw).square() + (v - py / pw).square();
+  }
+};
+
+template <typename Scalar>
+class Residuals<AngularError, Scalar>
+  : public CorrespondencesSoA<Scalar, 3, 3>
+{
+  using Base = CorrespondencesSoA<Scalar, 3, 3>;
+public:
+  using Base::Base;
+
+  void Errors
+  (
+    const Mat3 & E,
+    const uint32_t begin,
+    const uint32_t end,
+    Scalar * errors
+  ) const
+  {
+    const uint32_t n = end - begin;
+    const Eigen::Matrix<Scalar, 3, 3> e = E.cast<Scalar>();
+    const auto x = this->x1(0, begin, n), y = this->x1(1, begin, n),
+      z = this->x1(2, begin, n);
+    const auto u = this->x2(0, begin, n), v = this->x2(1, begin, n),
+      w = this->x2(2, begin, n);
+    // Epipolar plane normal: E * x1
+    const auto a = e(0,0) * x + e(0,1) * y + e(0,2) * z;
+    const auto b = e(1,0) * x + e(1,1) * y + e(1,2) * z;
+    const auto c = e(2,0) * x + e(2,1) * y + e(2,2) * z;
+    const auto norm = (a.square() + b.square() + c.square()).sqrt();
+    // As the scalar version: a null normal gives a 0 error, and the sine is
+    //  clamped to [-1, 1] (rounding) so that no NaN is produced
+    Eigen::Map<typename Base::Array>(errors + begin, n) =
+      (norm > Scalar(0)).select((a * u + b * v + c * w) / norm, Scalar(0))
+      .max(Scalar(-1)).min(Scalar(1)).asin().abs();
+  }
+};
+
+template <typename Scalar>
+class Residuals<resection::SquaredPixelReprojectionError, Scalar>
+  : public CorrespondencesSoA<Scalar, 2, 3>
+{
+  using Base = CorrespondencesSoA<Scalar, 2, 3>;
+public:
+  using Base::Base;
+
+  void Errors
+  (
+    const Mat34 & P,
+    const uint32_t begin,
+    const uint32_t end,
+    Scalar * errors
+  ) const
+  {
+    const uint32_t n = end - begin;
+    const Eigen::Matrix<Scalar, 3, 4> p = P.cast<Scalar>();
+    const auto u = this->x1(0, begin, n), v = this->x1(1, begin, n);
+    const auto X = this->x2(0, begin, n), Y = this->x2(1, begin, n),
+      Z = this->x2(2, begin, n);
+    const auto px = p(0,0) * X + p(0,1) * Y + p(0,2) * Z + p(0,3);
+    const auto py = p(1,0) * X + p(1,1) * Y + p(1,2) * Z + p(1,3);
+    const auto pw = p(2,0) * X + p(2,1) * Y + p(2,2) * Z + p(2,3);
+    Eigen::Map<typename Base::Array>(errors + begin, n) =
+      (u - px / pw).square() + (v - py / pw).square();
+  }
+};
+
+} // namespace soa
+} // namespace openMVG
+
+#endif // OPENMVG_MULTIVIEW_RESIDUALS_SOA_HPP
@@ -0,0 +1,140 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2026 openMVG authors.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/multiview/residuals_soa.hpp"
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace openMVG;
+
+// Return the max relative deviation between the SoA residuals and the
+//  column-wise ErrorT evaluation, computed on a sub range of the samples.
+// Return infinity if a value outside of the range has been modified.
+template <typename ErrorT, typename Scalar, typename ModelT>
+double ResidualsDeviation
+(
+  const ModelT & model,
+  const Mat & x1,
+  const Mat & x2
+)
+{
+  const soa::Residuals<ErrorT, Scalar> residuals(x1, x2);
+  const uint32_t begin = 3, end = x1.cols() - 2;
+  std::vector<Scalar> errors(x1.cols(), Scalar(-1));
+  residuals.Errors(model, begin, end, errors.data());
+
+  double max_deviation = 0.0;
+  for (uint32_t i = 0; i < x1.cols(); ++i)
+  {
+    if (i < begin || i >= end)
+    {
+      if (errors[i] != Scalar(-1))
+        return std::numeric_limits<double>::infinity();
+      continue;
+    }
+    const double expected = ErrorT::Error(model, x1.col(i), x2.col(i));
+    max_deviation = std::max(max_deviation,
+      std::abs(expected - errors[i]) / (1.0 + expected));
+  }
+  return max_deviation;
+}
+
+static const int kNbPoints = 101; // Not a multiple of the SIMD width
+
+TEST(Residuals_SoA, Availability) {
+  EXPECT_TRUE((soa::Residuals<fundamental::kernel::SampsonError>::available));
+  EXPECT_TRUE((soa::Residuals<AngularError, float>::available));
+  EXPECT_FALSE((soa::Residuals<resection::AngularReprojectionError>::available));
+}
+
+TEST(Residuals_SoA, Fundamental) {
+  const Mat x1 = Mat2X::Random(2, kNbPoints);
+  const Mat x2 = Mat2X::Random(2, kNbPoints);
+  const Mat3 F = Mat3::Random();
+
+  EXPECT_TRUE((ResidualsDeviation<fundamental::kernel::SampsonError, double>(F, x1, x2)) < 1e-10);
+  EXPECT_TRUE((ResidualsDeviation<fundamental::kernel::SymmetricEpipolarDistanceError, double>(F, x1, x2)) < 1e-10);
+  EXPECT_TRUE((ResidualsDeviation<fundamental::kernel::EpipolarDistanceError, double>(F, x1, x2)) < 1e-10);
+
+  EXPECT_TRUE((ResidualsDeviation<fundamental::kernel::SampsonError, float>(F, x1, x2)) < 1e-3);
+  EXPECT_TRUE((ResidualsDeviation<fundamental::kernel::SymmetricEpipolarDistanceError, float>(F, x1, x2)) < 1e-3);
+  EXPECT_TRUE((ResidualsDeviation<fundamental::kernel::EpipolarDistanceError, float>(F, x1, x2)) < 1e-3);
+}
+
+TEST(Residuals_SoA, Homography) {
+  const Mat x1 = Mat2X::Random(2, kNbPoints);
+  const Mat x2 = Mat2X::Random(2, kNbPoints);
+  Mat3 H = Mat3::Identity() + 0.1 * Mat3::Random();
+  H(2,2) = 1.0;
+  const Mat H_dynamic = H;
+
+  EXPECT_TRUE((ResidualsDeviation<homography::kernel::AsymmetricError, double>(H_dynamic, x1, x2)) < 1e-10);
+  EXPECT_TRUE((ResidualsDeviation<homography::kernel::AsymmetricError, float>(H_dynamic, x1, x2)) < 1e-3);
+}
+
+TEST(Residuals_SoA, Angular) {
+  const Mat x1 = Mat3X::Random(3, kNbPoints).colwise().normalized();
+  const Mat x2 = Mat3X::Random(3, kNbPoints).colwise().normalized();
+  const Mat3 E = Mat3::Random();
+
+  EXPECT_TRUE((ResidualsDeviation<AngularError, double>(E, x1, x2)) < 1e-10);
+  EXPECT_TRUE((ResidualsDeviation<AngularError, float>(E, x1, x2)) < 1e-3);
+}
+
+TEST(Residuals_SoA, Angular_Degenerate) {
+  Mat x1 = Mat3X::Random(3, kNbPoints).colwise().normalized();
+  Mat x2 = Mat3X::Random(3, kNbPoints).colwise().normalized();
+  // Rank 2 model: the first points are in its null space (null normal),
+  //  the next ones are on their epipolar plane normal (sine of +-1)
+  //  (exact in float: integer values)
+  Mat3 E;
+  E << 1, 2, 3,
+      -2, 1, -1,
+       0, 3, 3;
+  for (int i = 0; i < 10; ++i)
+    x1.col(i) = Vec3(1, 1, -1);
+  for (int i = 10; i < 20; ++i)
+    x2.col(i) = ((i % 2) ? 1.0 : -1.0) * (E * x1.col(i)).normalized();
+
+  const soa::Residuals<AngularError, float> residuals_float(x1, x2);
+  const soa::Residuals<AngularError, double> residuals_double(x1, x2);
+  std::vector<float> errors_float(kNbPoints);
+  std::vector<double> errors_double(kNbPoints);
+  residuals_float.Errors(E, 0, kNbPoints, errors_float.data());
+  residuals_double.Errors(E, 0, kNbPoints, errors_double.data());
+  for (int i = 0; i < kNbPoints; ++i)
+  {
+    // No NaN: same values as the scalar version (0 for a null normal),
+    //  PI/2 for the points on the normal
+    const double expected = (i >= 10 && i < 20) ?
+      M_PI / 2.0 : AngularError::Error(E, x1.col(i), x2.col(i));
+    EXPECT_TRUE(std::isfinite(errors_float[i]) && std::isfinite(errors_double[i]));
+    EXPECT_NEAR(expected, errors_double[i], 1e-6);
+    EXPECT_NEAR(expected, errors_float[i], 1e-3);
+  }
+}
+
+TEST(Residuals_SoA, Resection) {
+  Mat X = Mat3X::Random(3, kNbPoints);
+  X.row(2).array() += 5.0; // points in front of the camera
+  const Mat x = Mat2X::Random(2, kNbPoints);
+  Mat34 P;
+  P << Mat3::Identity() + 0.1 * Mat3::Random(), Vec3::Random();
+
+  EXPECT_TRUE((ResidualsDeviation<resection::SquaredPixelReprojectionError, double>(P, x, X)) < 1e-10);
+  EXPECT_TRUE((ResidualsDeviation<resection::SquaredPixelReprojectionError, float>(P, x, X)) < 1e-3);
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
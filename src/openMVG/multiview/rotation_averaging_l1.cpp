@@ -35,6 +35,12 @@ using namespace lemon;
 #include <Eigen/Cholesky>
 #include <Eigen/SparseCholesky>
 
+#ifdef OPENMVG_USE_OPENMP
+#include <omp.h>
+#endif
+
+#include <array>
+#include <numeric>
 #include <queue>
 
 namespace openMVG   {
@@ -337,24 +343,28 @@ inline void FillMappingMatrix(
   const uint32_t nMainViewID,
   sMat& A)
 {
-  A.reserve(A.rows()*2); // estimate of the number of non-zeros (optional)
+  // Fill from a triplet list (random order insertion in a column major
+  //  matrix is quadratic in the number of non-zeros)
+  std::vector<Eigen::Triplet<double>> triplets;
+  triplets.reserve(RelRs.size()*6);
   sMat::Index i = 0, j = 0;
   for (size_t r=0; r<RelRs.size(); ++r) {
     const RelativeRotation& relR = RelRs[r];
     if (relR.i != nMainViewID) {
       j = 3*(relR.i<nMainViewID ? relR.i : relR.i-1);
-      A.insert(i+0,j+0) = -1.0;
-      A.insert(i+1,j+1) = -1.0;
-      A.insert(i+2,j+2) = -1.0;
+      triplets.emplace_back(i+0,j+0,-1.0);
+      triplets.emplace_back(i+1,j+1,-1.0);
+      triplets.emplace_back(i+2,j+2,-1.0);
     }
     if (relR.j != nMainViewID) {
       j = 3*(relR.j<nMainViewID ? relR.j : relR.j-1);
-      A.insert(i+0,j+0) = 1.0;
-      A.insert(i+1,j+1) = 1.0;
-      A.insert(i+2,j+2) = 1.0;
+      triplets.emplace_back(i+0,j+0,1.0);
+      triplets.emplace_back(i+1,j+1,1.0);
+      triplets.emplace_back(i+2,j+2,1.0);
     }
     i+=3;
   }
+  A.setFromTriplets(triplets.begin(), triplets.end());
   A.makeCompressed();
 }
 
@@ -364,7 +374,10 @@ inline void FillErrorMatrix(
   const Matrix3x3Arr& Rs,
   Vec & b)
 {
-  for (size_t r = 0; r < RelRs.size(); ++r) {
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int r = 0; r < static_cast<int>(RelRs.size()); ++r) {
     const RelativeRotation& relR = RelRs[r];
     const Matrix3x3& Ri = Rs[relR.i];
     const Matrix3x3& Rj = Rs[relR.j];
@@ -382,8 +395,11 @@ inline void CorrectMatrix(
   const uint32_t nMainViewID,
   Matrix3x3Arr& Rs)
 {
-  for (size_t r = 0; r < Rs.size(); ++r) {
-    if (r == nMainViewID)
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(static)
+#endif
+  for (int r = 0; r < static_cast<int>(Rs.size()); ++r) {
+    if (static_cast<uint32_t>(r) == nMainViewID)
       continue;
     Matrix3x3& Ri = Rs[r];
     const uint32_t i = (r<nMainViewID ? r : r-1);
@@ -411,6 +427,13 @@ bool SolveL1RA
   // init x with 0 that corresponds to trusting completely the initial Ri guess
   Vec x(Vec::Zero(n)), b(m);
 
+  // A is constant along the iterations: factorize A^t.A only once
+  L1Solver<sMat >::Options options;
+  // Each L1 step is re-linearized by the outer loop: a rough ADMM solution is
+  //  sufficient (the ADMM tail converges slowly and is then mostly wasted).
+  options.max_num_iterations = 100;
+  L1Solver<sMat > l1_solver(options, A);
+
   // Current error and the previous one
   double e = std::numeric_limits<double>::max(), ep;
   unsigned iter = 0;
@@ -420,8 +443,6 @@ bool SolveL1RA
     FillErrorMatrix(RelRs, Rs, b);
 
     // solve the linear system using l1 norm
-    L1Solver<sMat >::Options options;
-    L1Solver<sMat > l1_solver(options, A);
     l1_solver.Solve(b, &x);
 
     ep = e; e = x.norm();
@@ -436,12 +457,154 @@ bool SolveL1RA
   return true;
 }
 
+// Relative rotations graph stored as an edge list and its incidence in CSR
+//  form (incident edges of each pose are contiguous), used to assemble the
+//  weighted normal equations A^t.W.A and A^t.W.b of the IRLS in parallel
+//  (one pose per thread, without any synchronization) and in place, in the
+//  fixed sparsity pattern of A^t.A.
+struct RelativeRotationsGraph_CSR
+{
+  RelativeRotationsGraph_CSR
+  (
+    const RelativeRotations& RelRs,
+    const uint32_t nPoses,
+    const uint32_t nMainViewID
+  )
+  {
+    const uint32_t nVars = nPoses - 1; // one view is kept constant
+    const auto var_index = [nMainViewID](uint32_t pose) -> int
+      { return (pose == nMainViewID) ? -1 : (pose < nMainViewID ? pose : pose - 1); };
+
+    // Edge list and its incidence count
+    edge_vars.resize(RelRs.size());
+    offsets.assign(nVars + 1, 0);
+    for (size_t e = 0; e < RelRs.size(); ++e)
+    {
+      edge_vars[e] = {var_index(RelRs[e].i), var_index(RelRs[e].j)};
+      if (edge_vars[e].first >= 0) ++offsets[edge_vars[e].first + 1];
+      if (edge_vars[e].second >= 0) ++offsets[edge_vars[e].second + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    // Sparsity pattern of the normal equations (3x3 diagonal blocks)
+    std::vector<Eigen::Triplet<double>> triplets;
+    triplets.reserve(3 * nVars + 6 * RelRs.size());
+    for (uint32_t v = 0; v < nVars; ++v)
+      for (int a = 0; a < 3; ++a)
+        triplets.emplace_back(3 * v + a, 3 * v + a, 0.0);
+    for (const auto & vars : edge_vars)
+    {
+      if (vars.first < 0 || vars.second < 0)
+        continue;
+      for (int a = 0; a < 3; ++a)
+      {
+        triplets.emplace_back(3 * vars.first + a, 3 * vars.second + a, 0.0);
+        triplets.emplace_back(3 * vars.second + a, 3 * vars.first + a, 0.0);
+      }
+    }
+    normal_equations.resize(3 * nVars, 3 * nVars);
+    normal_equations.setFromTriplets(triplets.begin(), triplets.end());
+    normal_equations.makeCompressed();
+
+    // Position of the coefficients in the compressed (column major) storage
+    const auto value_index = [this](int row, int col) -> int
+    {
+      const auto begin = normal_equations.innerIndexPtr() + normal_equations.outerIndexPtr()[col];
+      const auto end = normal_equations.innerIndexPtr() + normal_equations.outerIndexPtr()[col + 1];
+      return static_cast<int>(std::lower_bound(begin, end, row) - normal_equations.innerIndexPtr());
+    };
+    diagonal.resize(nVars);
+    for (uint32_t v = 0; v < nVars; ++v)
+      for (int a = 0; a < 3; ++a)
+        diagonal[v][a] = value_index(3 * v + a, 3 * v + a);
+
+    incidences.resize(offsets.back());
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t e = 0; e < edge_vars.size(); ++e)
+    {
+      const int vi = edge_vars[e].first, vj = edge_vars[e].second;
+      // A row block: -I for the pose i, +I for the pose j
+      const std::array<std::pair<int, int>, 2> ends = {{ {vi, vj}, {vj, vi} }};
+      for (int k = 0; k < 2; ++k)
+      {
+        const int v = ends[k].first, other = ends[k].second;
+        if (v < 0)
+          continue;
+        Incidence & incidence = incidences[fill[v]++];
+        incidence.edge = e;
+        incidence.sign = (k == 0) ? -1.0 : 1.0;
+        for (int a = 0; a < 3; ++a)
+          incidence.off_diagonal[a] = (other < 0) ? -1 : value_index(3 * other + a, 3 * v + a);
+      }
+    }
+  }
+
+  // Compute residuals = A.x - b
+  void Residuals(const Vec & x, const Vec & b, Eigen::ArrayXd & residuals) const
+  {
+    residuals.resize(b.size());
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (int e = 0; e < static_cast<int>(edge_vars.size()); ++e)
+    {
+      Vec3 r = - b.segment<3>(3 * e);
+      if (edge_vars[e].first >= 0) r -= x.segment<3>(3 * edge_vars[e].first);
+      if (edge_vars[e].second >= 0) r += x.segment<3>(3 * edge_vars[e].second);
+      residuals.segment<3>(3 * e) = r.array();
+    }
+  }
+
+  // Assemble in place the normal equations A^t.W.A and the right hand side A^t.W.b
+  void AssembleWeighted(const Eigen::ArrayXd & weights, const Vec & b, Vec & rhs)
+  {
+    double * values = normal_equations.valuePtr();
+    const auto outer = normal_equations.outerIndexPtr();
+    const int nVars = static_cast<int>(diagonal.size());
+    rhs.resize(3 * nVars);
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (int v = 0; v < nVars; ++v)
+    {
+      std::fill(values + outer[3 * v], values + outer[3 * v + 3], 0.0);
+      for (int a = 0; a < 3; ++a)
+      {
+        double diagonal_value = 0.0, rhs_value = 0.0;
+        for (int k = offsets[v]; k < offsets[v + 1]; ++k)
+        {
+          const Incidence & incidence = incidences[k];
+          const double w = weights[3 * incidence.edge + a];
+          diagonal_value += w;
+          rhs_value += incidence.sign * w * b[3 * incidence.edge + a];
+          if (incidence.off_diagonal[a] >= 0)
+            values[incidence.off_diagonal[a]] -= w;
+        }
+        values[diagonal[v][a]] = diagonal_value;
+        rhs[3 * v + a] = rhs_value;
+      }
+    }
+  }
+
+  struct Incidence
+  {
+    uint32_t edge;
+    double sign; // coefficient of the pose in the edge rows of A
+    std::array<int, 3> off_diagonal; // index of the coupling coefficients (-1 for the main view)
+  };
+
+  std::vector<std::pair<int, int>> edge_vars; // variable index of the poses (-1 for the main view)
+  std::vector<int> offsets; // CSR offsets of the incident edges of each variable
+  std::vector<Incidence> incidences;
+  std::vector<std::array<int, 3>> diagonal; // index of the diagonal coefficients
+  sMat normal_equations; // A^t.W.A
+};
+
 // Iteratively Reweighted Least Squares (IRLS) implementation
 bool SolveIRLS
 (
   const RelativeRotations& RelRs,
   Matrix3x3Arr& Rs,
-  const sMat & A,
   const unsigned int nMainViewID,
   const double sigma
 )
@@ -458,8 +621,10 @@ bool SolveIRLS
   //  compute it once to speed up the solution time.
   using Linear_Solver_T = Eigen::SimplicialLDLT<sMat >;
 
+  RelativeRotationsGraph_CSR graph(RelRs, static_cast<uint32_t>(Rs.size()), nMainViewID);
+
   Linear_Solver_T linear_solver;
-  linear_solver.analyzePattern(A.transpose() * A);
+  linear_solver.analyzePattern(graph.normal_equations);
   if (linear_solver.info() != Eigen::Success) {
     std::cerr << "Cholesky decomposition failed." << std::endl;
     return false;
@@ -468,7 +633,7 @@ bool SolveIRLS
   const double sigmaSq(Square(sigma));
 
   Eigen::ArrayXd errors, weights;
-  Vec xp(n);
+  Vec xp(n), rhs(n);
   // current error and the previous one
   double e = std::numeric_limits<double>::max(), ep;
   unsigned int iter = 0;
@@ -479,21 +644,21 @@ bool SolveIRLS
     FillErrorMatrix(RelRs, Rs, b);
 
     // Compute the weights for each error term
-    errors = (A * x - b).array();
+    graph.Residuals(x, b, errors);
 
     // compute robust errors using the Huber-like loss function
     weights = sigmaSq / (errors.square() + sigmaSq).square();
 
     // Update the factorization for the weighted values
-    const sMat at_weight = A.transpose() * weights.matrix().asDiagonal();
-    linear_solver.factorize(at_weight * A);
+    graph.AssembleWeighted(weights, b, rhs);
+    linear_solver.factorize(graph.normal_equations);
     if (linear_solver.info() != Eigen::Success) {
       std::cerr << "Failed to factorize the least squares system." << std::endl;
       return false;
     }
 
     // Solve the least squares problem
-    x = linear_solver.solve(at_weight * b);
+    x = linear_solver.solve(rhs);
     if (linear_solver.info() != Eigen::Success) {
       std::cerr << "Failed to solve the least squares system." << std::endl;
       return false;
@@ -543,7 +708,7 @@ bool RefineRotationsAvgL1IRLS(
     return false;
   }
 
-  if (!internal::SolveIRLS(RelRs, Rs, A, nMainViewID, sigma))
+  if (!internal::SolveIRLS(RelRs, Rs, nMainViewID, sigma))
   {
     std::cerr << "Could not solve the ILRS step." << std::endl;
     return false;
@@ -15,6 +15,12 @@
 #include <ceres/ceres.h>
 #include <ceres/rotation.h>
 
+#include <Eigen/SparseCholesky>
+
+#include <iostream>
+#include <limits>
+#include <random>
+
 #ifdef _MSC_VER
 #pragma warning( once : 4267 ) //warning C4267: 'argument' : conversion from 'size_t' to 'const int', possible loss of data
 #endif
@@ -59,6 +65,82 @@ bool compare_first_abs(std::pair<double, Vec> const &x, std::pair<double, Vec> c
  return std::abs(x.first) < std::abs(y.first);
 }
 
+namespace internal {
+
+// Compute the nb_eigen eigenvectors of the smallest eigenvalues of a sparse
+//  symmetric positive semi-definite matrix by block inverse subspace iteration:
+//  - a single sparse factorization of the (slightly shifted) matrix is computed,
+//  - a Rayleigh-Ritz projection is used at each iteration to rotate the subspace,
+//  - guard vectors are added to the subspace to speed up the convergence
+//    (the rate is the ratio of the nb_eigen-th to the block size + 1-th eigenvalue).
+// Memory is in O(#non zeros of the factorization) instead of O(n^2) for the
+//  dense eigen decomposition.
+bool SmallestEigenVectors_Sparse
+(
+  const sMat & spd_mat,
+  const int nb_eigen,
+  Mat & eigen_vectors,
+  const int max_iterations = 100,
+  const double tolerance = 1e-9
+)
+{
+  const sMat::Index n = spd_mat.rows();
+  if (n < nb_eigen)
+    return false;
+  const int block_size = std::min<int>(2 * nb_eigen, n);
+
+  // Shift the matrix to make it positive definite (its null space is of interest)
+  const double shift = 1e-8 * std::max(spd_mat.diagonal().mean(), 1.0);
+  sMat shifted_mat = spd_mat;
+  for (sMat::Index i = 0; i < n; ++i)
+    shifted_mat.coeffRef(i, i) += shift;
+
+  Eigen::SimplicialLDLT<sMat> linear_solver(shifted_mat);
+  if (linear_solver.info() != Eigen::Success)
+    return false;
+
+  // Deterministic pseudo random initial subspace
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+  Mat Y(n, block_size);
+  for (Mat::Index c = 0; c < Y.cols(); ++c)
+    for (Mat::Index r = 0; r < Y.rows(); ++r)
+      Y(r, c) = distribution(random_generator);
+
+  const double matrix_norm = std::max(spd_mat.diagonal().maxCoeff(), 1.0);
+  double residual = std::numeric_limits<double>::max();
+  for (int iter = 0; iter < max_iterations && residual >= tolerance * matrix_norm; ++iter)
+  {
+    // Inverse iteration and orthonormalization of the subspace
+    const Mat X = linear_solver.solve(Y);
+    if (linear_solver.info() != Eigen::Success)
+      return false;
+    const Mat Q = X.householderQr().householderQ() * Mat::Identity(n, block_size);
+
+    // Rayleigh-Ritz projection
+    const Mat AQ = spd_mat * Q;
+    const Mat H = Q.transpose() * AQ;
+    Eigen::SelfAdjointEigenSolver<Mat> es(H);
+    Y = Q * es.eigenvectors();
+
+    // Residual of the sought eigen pairs: ||A.Y - Y.Lambda||
+    residual =
+      (AQ * es.eigenvectors().leftCols(nb_eigen)
+       - Y.leftCols(nb_eigen) * es.eigenvalues().head(nb_eigen).asDiagonal()).norm();
+  }
+  eigen_vectors = Y.leftCols(nb_eigen);
+  // An unconverged subspace is not a null space estimate
+  if (residual >= tolerance * matrix_norm)
+  {
+    std::cerr << "Sparse eigen solver: no convergence after " << max_iterations
+      << " iterations (relative residual: " << residual / matrix_norm << ")" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+} // namespace internal
+
 //-- Solve the Global Rotation matrix registration for each camera given a list
 //    of relative orientation using matrix parametrization
 //    [1] formula 6.62 page 100. Dense formulation.
@@ -129,26 +211,36 @@ bool L2RotationAveraging
   }
 
   // nCamera * 3 because each columns have 3 elements.
-  Mat AtA(3*nCamera,3*nCamera);
+  sMat AtAsparse(3*nCamera,3*nCamera);
   {
     sMat A(nRotationEstimation*3, 3*nCamera);
     A.setFromTriplets(tripletList.begin(), tripletList.end());
     tripletList.clear();
     tripletList.shrink_to_fit();
 
-    const sMat AtAsparse = A.transpose() * A;
-    AtA = Mat(AtAsparse); // convert to dense
+    AtAsparse = A.transpose() * A;
   }
 
   // Solve Ax=0 => eigen vectors
-  Eigen::SelfAdjointEigenSolver<Mat> es(AtA, Eigen::ComputeEigenvectors);
-
-  if (es.info() != Eigen::Success)
+  Mat nullspace(3*nCamera, 3);
+  if (nCamera > kDenseRotationAveragingMaxCameras)
   {
-    return false;
+    // Large graph: sparse iterative eigen solver
+    if (!internal::SmallestEigenVectors_Sparse(AtAsparse, 3, nullspace))
+    {
+      return false;
+    }
   }
-  // else
+  else
   {
+    const Mat AtA(AtAsparse); // convert to dense
+    Eigen::SelfAdjointEigenSolver<Mat> es(AtA, Eigen::ComputeEigenvectors);
+
+    if (es.info() != Eigen::Success)
+    {
+      return false;
+    }
+
     // Sort abs(eigenvalues)
     std::vector<std::pair<double, Vec>> eigs(AtA.cols());
     for (Mat::Index i = 0; i < AtA.cols(); ++i)
@@ -156,10 +248,15 @@ bool L2RotationAveraging
       eigs[i] = {es.eigenvalues()[i], es.eigenvectors().col(i)};
     }
     std::stable_sort(eigs.begin(), eigs.end(), &compare_first_abs);
-
-    const Vec & NullspaceVector0 = eigs[0].second;
-    const Vec & NullspaceVector1 = eigs[1].second;
-    const Vec & NullspaceVector2 = eigs[2].second;
+    for (int i = 0; i < 3; ++i)
+    {
+      nullspace.col(i) = eigs[i].second;
+    }
+  }
+  {
+    const auto NullspaceVector0 = nullspace.col(0);
+    const auto NullspaceVector1 = nullspace.col(1);
+    const auto NullspaceVector2 = nullspace.col(2);
 
     //--
     // Search the closest matrix :
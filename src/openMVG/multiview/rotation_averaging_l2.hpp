@@ -35,6 +35,11 @@ namespace l2  {
 //  approximate rotation in the Frobenius norm using SVD
 Mat3 ClosestSVDRotationMatrix(const Mat3 & rotMat);
 
+/// Above this number of cameras, the null space of the L2 rotation averaging
+///  system is computed with a sparse iterative eigen solver instead of a
+///  dense eigen decomposition (O(n^2) memory, O(n^3) time).
+static const size_t kDenseRotationAveragingMaxCameras = 200;
+
 //-- Solve the Global Rotation matrix registration for each camera given a list
 //    of relative orientation using matrix parametrization
 //    [1] formula 6.62 page 100. Dense formulation.
@@ -160,6 +160,40 @@ TEST ( rotation_averaging, RefineRotationsL2_CompleteGraph)
   }
 }
 
+// Test over a large loop of cameras (sparse eigen solver)
+TEST ( rotation_averaging, RotationLeastSquare_LargeRing_Sparse)
+{
+  //-- Setup a circular camera rig
+  const int iNviews = kDenseRotationAveragingMaxCameras + 50;
+  const NViewDataSet d = NRealisticCamerasRing(iNviews, 5,
+    nViewDatasetConfigurator(1,1,0,0,5,0)); // Suppose a camera with Unit matrix as K
+
+  //Link each camera to the two next ones
+  RelativeRotations vec_relativeRotEstimate;
+  for (size_t i = 0; i < iNviews; ++i)
+  {
+    for (const size_t j : {(i+1)%iNviews, (i+2)%iNviews})
+    {
+      Mat3 Rrel;
+      Vec3 trel;
+      RelativeCameraMotion(d._R[i], d._t[i], d._R[j], d._t[j], &Rrel, &trel);
+      vec_relativeRotEstimate.push_back(RelativeRotation(i, j, Rrel, 1));
+    }
+  }
+
+  //- Solve the global rotation estimation problem :
+  std::vector<Mat3> vec_globalR;
+  EXPECT_TRUE(L2RotationAveraging(iNviews, vec_relativeRotEstimate, vec_globalR));
+  EXPECT_EQ(iNviews, vec_globalR.size());
+
+  // Check that each global rotations is near the true ones
+  //  (the first rotation is set to Identity)
+  for (size_t i = 0; i < iNviews; ++i)
+  {
+    EXPECT_NEAR(0.0, FrobeniusDistance(Mat3(d._R[i] * d._R[0].transpose()), vec_globalR[i]), 1e-6);
+  }
+}
+
 TEST ( rotation_averaging, RefineRotationsAvgL1IRLS_SimpleTriplet)
 {
   using namespace std;
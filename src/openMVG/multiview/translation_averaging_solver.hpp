@@ -66,6 +66,46 @@ solve_translations_problem_softl1
   const double d_l1_loss_threshold = 0.01
 );
 
+/// Options of the ADMM L1 translation averaging solver
+struct L1_ADMM_Translation_Averaging_Options
+{
+  int max_iterations = 5000;
+  // Initial augmented Lagrangian parameter (adapted along the iterations)
+  double rho = 1.0;
+  // Over-relaxation parameter (typically between 1.0 and 1.8)
+  double alpha = 1.6;
+  // Convergence tolerances of the primal and dual residuals
+  double absolute_tolerance = 1e-6;
+  double relative_tolerance = 1e-5;
+};
+
+/**
+* @brief Registration of relative translations to global translations. It minimizes the
+*  sum of the L1 norms of the residuals (t_j - R_ij t_i - s_ij t_ij), with scales s_ij >= 1,
+*  by using the Alternating Direction Method of Multipliers (ADMM).
+*  The feasible set is the one of the linear program of [2] (TRANSLATION_AVERAGING_L1),
+*  but not the objective: the linear program minimizes the largest residual coordinate
+*  (L_inf bound gamma), so the solutions differ on noisy data. The L1 objective spreads
+*  less the error of an outlier relative motion over the other ones.
+*  The problem matrix has only 3 rows per relative motion and the normal equations are
+*  factorized once. The sparse matrix vector products are multi-threaded (OpenMP) by Eigen.
+*  All relative motions must be 1 connected component.
+*
+* @param[in] vec_initial_estimates group of relative motion information
+*             Each group will have its own optimized scale
+* @param[out] translations found global camera translations
+* @param[in] options solver iterations and convergence tolerance
+* @return True if the registration can be solved
+*/
+bool
+solve_translations_problem_l1_admm
+(
+  const std::vector<openMVG::RelativeInfo_Vec > & vec_initial_estimates,
+  std::vector<Eigen::Vector3d> & translations,
+  const L1_ADMM_Translation_Averaging_Options & options =
+    L1_ADMM_Translation_Averaging_Options()
+);
+
 } // namespace openMVG
 
 #endif // OPENMVG_MULTIVIEW_TRANSLATION_AVERAGING_SOLVER_HPP
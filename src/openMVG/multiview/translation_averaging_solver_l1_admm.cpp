@@ -0,0 +1,226 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/multiview/translation_averaging_common.hpp"
+#include "openMVG/multiview/translation_averaging_solver.hpp"
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+#include "openMVG/types.hpp"
+
+#include <Eigen/SparseCore>
+#ifdef EIGEN_MPL2_ONLY
+#include <Eigen/SparseLU>
+#else
+#include <Eigen/SparseCholesky>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <set>
+#include <vector>
+
+//------------------
+//-- Bibliography --
+//------------------
+//- [1] "Distributed Optimization and Statistical Learning via the Alternating
+//-      Direction Method of Multipliers."
+//- Authors: Stephen Boyd, Neal Parikh, Eric Chu, Borja Peleato and Jonathan Eckstein.
+//- Date: 2011.
+//- Journal: Foundations and Trends in Machine Learning.
+
+namespace openMVG {
+
+bool solve_translations_problem_l1_admm
+(
+  const std::vector<openMVG::RelativeInfo_Vec > & vec_relative_group_estimates,
+  std::vector<Eigen::Vector3d> & translations,
+  const L1_ADMM_Translation_Averaging_Options & options
+)
+{
+  //-- Count:
+  //- #poses are used by the relative position estimates
+  //- #relative estimates we will use
+  std::set<IndexT> count_set;
+  IndexT relative_info_count = 0;
+  for (const openMVG::RelativeInfo_Vec & iter : vec_relative_group_estimates)
+  {
+    for (const relativeInfo & it_relative_motion : iter)
+    {
+      ++relative_info_count;
+      count_set.insert(it_relative_motion.first.first);
+      count_set.insert(it_relative_motion.first.second);
+    }
+  }
+  const IndexT nb_poses = count_set.size();
+  const IndexT nb_scales = vec_relative_group_estimates.size();
+  if (nb_poses < 2 || relative_info_count == 0)
+    return false;
+
+  // Unknowns: the translations of the poses [1, nb_poses) (the first
+  //  translation is set to 0 to fix the gauge freedom) and one scale per group.
+  const Eigen::Index nb_translation_var = 3 * (nb_poses - 1);
+  const Eigen::Index nb_var = nb_translation_var + nb_scales;
+  const auto TVAR = [](IndexT i, int l) -> Eigen::Index
+    { return 3 * (static_cast<Eigen::Index>(i) - 1) + l; };
+
+  //--
+  // Build the sparse system A.x with the residuals of the relative motions:
+  //  t_j - R_ij t_i - s_ij t_ij (3 rows per relative motion, at most 7 non zeros per row)
+  // Row major storage allows Eigen to run the matrix-vector products in parallel.
+  //--
+  using sRMat = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+  const Eigen::Index nb_rows = 3 * static_cast<Eigen::Index>(relative_info_count);
+  std::vector<Eigen::Triplet<double>> coefficients;
+  coefficients.reserve(nb_rows * 5);
+  {
+    Eigen::Index row = 0;
+    IndexT scale_idx = 0;
+    for (const openMVG::RelativeInfo_Vec & iter : vec_relative_group_estimates)
+    {
+      for (const relativeInfo & info : iter)
+      {
+        const IndexT I = info.first.first;
+        const IndexT J = info.first.second;
+        const Mat3 & R_ij = info.second.first;
+        const Vec3 & t_ij = info.second.second;
+        for (int l = 0; l < 3; ++l, ++row)
+        {
+          if (J != 0)
+            coefficients.emplace_back(row, TVAR(J, l), 1.0);
+          if (I != 0)
+          {
+            for (int k = 0; k < 3; ++k)
+              coefficients.emplace_back(row, TVAR(I, k), -R_ij(l, k));
+          }
+          coefficients.emplace_back(row, nb_translation_var + scale_idx, -t_ij(l));
+        }
+      }
+      ++scale_idx; // One scale per relative_motion group
+    }
+  }
+  sRMat A(nb_rows, nb_var);
+  A.setFromTriplets(coefficients.begin(), coefficients.end());
+  coefficients.clear();
+  coefficients.shrink_to_fit();
+  const sRMat At = A.transpose();
+
+  //--
+  // ADMM splitting [1] (6.1, 6.2):
+  //   minimize ||z||_1 + I(w >= 1)
+  //   s.t. z = A.x, w = S.x (S selects the scales)
+  // Since S^t.S is a diagonal selection of the scales, the x-update system
+  //  (A^t.A + S^t.S) does not depend on rho and is factorized only once.
+  //--
+  Eigen::SparseMatrix<double> normal_equations = At * A;
+  for (IndexT k = 0; k < nb_scales; ++k)
+    normal_equations.coeffRef(nb_translation_var + k, nb_translation_var + k) += 1.0;
+  normal_equations.makeCompressed();
+
+#ifdef EIGEN_MPL2_ONLY
+  Eigen::SparseLU<Eigen::SparseMatrix<double>> linear_solver;
+#else
+  // The system is SPD as soon as the relative motions graph is connected
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> linear_solver;
+#endif
+  linear_solver.compute(normal_equations);
+  if (linear_solver.info() != Eigen::Success)
+  {
+    std::cerr << "Cannot compute the matrix factorization" << std::endl;
+    return false;
+  }
+
+  // Residual (z) and scale (w) auxiliary variables and their scaled dual variables (u, v)
+  Eigen::VectorXd x(nb_var);
+  Eigen::VectorXd z = Eigen::VectorXd::Zero(nb_rows), u = Eigen::VectorXd::Zero(nb_rows);
+  Eigen::VectorXd w = Eigen::VectorXd::Ones(nb_scales), v = Eigen::VectorXd::Zero(nb_scales);
+  Eigen::VectorXd z_old(nb_rows), w_old(nb_scales), rhs(nb_var), a_times_x(nb_rows), ax_hat(nb_rows);
+
+  const double primal_abs_tolerance_eps =
+    std::sqrt(static_cast<double>(nb_rows + nb_scales)) * options.absolute_tolerance;
+  const double dual_abs_tolerance_eps =
+    std::sqrt(static_cast<double>(nb_var)) * options.absolute_tolerance;
+
+  double rho = options.rho;
+  bool converged = false;
+  int iteration = 0;
+  for (; iteration < options.max_iterations && !converged; ++iteration)
+  {
+    // Update x: (A^t.A + S^t.S) x = A^t (z - u) + S^t (w - v)
+    z_old = z - u; // used as a temporary buffer
+    rhs.noalias() = At * z_old;
+    rhs.tail(nb_scales) += w - v;
+    x = linear_solver.solve(rhs);
+    a_times_x.noalias() = A * x;
+
+    // Over-relaxation
+    ax_hat = options.alpha * a_times_x + (1.0 - options.alpha) * z;
+    const Eigen::VectorXd sx_hat =
+      options.alpha * x.tail(nb_scales) + (1.0 - options.alpha) * w;
+
+    // Update z (L1 proximal operator: soft thresholding) and w (projection on s >= 1)
+    std::swap(z, z_old);
+    const double kappa = 1.0 / rho;
+    z = (ax_hat + u).unaryExpr([kappa](double val)
+      { return (val > kappa) ? val - kappa : (val < -kappa) ? val + kappa : 0.0; });
+    w_old = w;
+    w = (sx_hat + v).cwiseMax(1.0);
+
+    // Update the dual variables
+    u += ax_hat - z;
+    v += sx_hat - w;
+
+    // Compute the convergence terms [1] (3.12)
+    const double r_norm = std::sqrt(
+      (a_times_x - z).squaredNorm() + (x.tail(nb_scales) - w).squaredNorm());
+    rhs.noalias() = At * (z - z_old);
+    rhs.tail(nb_scales) += w - w_old;
+    const double s_norm = rho * rhs.norm();
+    const double max_norm = std::max(
+      std::sqrt(a_times_x.squaredNorm() + x.tail(nb_scales).squaredNorm()),
+      std::sqrt(z.squaredNorm() + w.squaredNorm()));
+    rhs.noalias() = At * u;
+    rhs.tail(nb_scales) += v;
+    const double primal_eps =
+      primal_abs_tolerance_eps + options.relative_tolerance * max_norm;
+    const double dual_eps =
+      dual_abs_tolerance_eps + options.relative_tolerance * rho * rhs.norm();
+
+    converged = (r_norm < primal_eps && s_norm < dual_eps);
+
+    // Residual balancing [1] (3.13): keep the primal and dual residuals of the same magnitude.
+    // The x-update system does not depend on rho, only the scaled dual variables are updated.
+    if (r_norm > 10.0 * s_norm)
+    {
+      rho *= 2.0;
+      u /= 2.0;
+      v /= 2.0;
+    }
+    else if (s_norm > 10.0 * r_norm)
+    {
+      rho /= 2.0;
+      u *= 2.0;
+      v *= 2.0;
+    }
+  }
+
+  if (!converged)
+  {
+    std::cout
+      << "L1 ADMM translation averaging: maximum number of iterations reached ("
+      << options.max_iterations << ")." << std::endl;
+  }
+
+  // Fill the global translations array
+  translations.resize(nb_poses);
+  translations[0].setZero();
+  for (IndexT i = 1; i < nb_poses; ++i)
+  {
+    translations[i] = x.segment<3>(TVAR(i, 0));
+  }
+  return true;
+}
+
+} // namespace openMVG
@@ -118,6 +118,77 @@ TEST(translation_averaging, globalTi_from_tijs_softl1_Ceres) {
   }
 }
 
+TEST(translation_averaging, globalTi_from_tijs_Triplets_l1_ADMM) {
+
+  const int focal = 1000;
+  const int principal_Point = 500;
+  //-- Setup a circular camera rig or "cardioid".
+  const int iNviews = 12;
+  const int iNbPoints = 6;
+
+  const bool bCardiod = true;
+  const bool bRelative_Translation_PerTriplet = true;
+  std::vector<RelativeInfo_Vec > vec_relative_estimates;
+
+  const NViewDataSet d =
+    Setup_RelativeTranslations_AndNviewDataset
+    (
+      vec_relative_estimates,
+      focal, principal_Point, iNviews, iNbPoints,
+      bCardiod, bRelative_Translation_PerTriplet
+    );
+
+  // Solve the translation averaging problem:
+  std::vector<Vec3> vec_translations;
+  EXPECT_TRUE(solve_translations_problem_l1_admm(
+    vec_relative_estimates, vec_translations));
+
+  EXPECT_EQ(iNviews, vec_translations.size());
+
+  // Check accuracy of the found translations
+  for (unsigned i = 0; i < iNviews; ++i)
+  {
+    const Vec3 t = vec_translations[i];
+    const Mat3 & Ri = d._R[i];
+    const Vec3 C_computed = - Ri.transpose() * t;
+
+    const Vec3 C_GT = d._C[i] - d._C[0];
+
+    //-- Check that found camera position is equal to GT value
+    if (i==0)  {
+      EXPECT_MATRIX_NEAR(C_computed, C_GT, 1e-6);
+    }
+    else  {
+     EXPECT_NEAR(0.0, DistanceLInfinity(C_computed.normalized(), C_GT.normalized()), 1e-4);
+    }
+  }
+}
+
+TEST(translation_averaging, globalTi_from_tijs_l1_ADMM_outlier) {
+
+  //-- Setup a circular camera rig with 2-view relative translations
+  const int iNviews = 12;
+  std::vector<RelativeInfo_Vec > vec_relative_estimates;
+
+  const NViewDataSet d =
+    Setup_RelativeTranslations_AndNviewDataset(vec_relative_estimates, 1000, 500, iNviews, 6, true, false);
+
+  // Corrupt one relative translation: the L1 solution must ignore it
+  vec_relative_estimates[4][0].second.second = Vec3(1.0, -2.0, 0.5);
+
+  std::vector<Vec3> vec_translations;
+  EXPECT_TRUE(solve_translations_problem_l1_admm(
+    vec_relative_estimates, vec_translations));
+  EXPECT_EQ(iNviews, vec_translations.size());
+
+  for (unsigned i = 1; i < iNviews; ++i)
+  {
+    const Vec3 C_computed = - d._R[i].transpose() * vec_translations[i];
+    const Vec3 C_GT = d._C[i] - d._C[0];
+    EXPECT_NEAR(0.0, DistanceLInfinity(C_computed.normalized(), C_GT.normalized()), 1e-3);
+  }
+}
+
 TEST(translation_averaging, globalTi_from_tijs_l2_chordal) {
 
   const int focal = 1000;
@@ -10,6 +10,7 @@
 #define OPENMVG_ROBUST_ESTIMATION_RAND_SAMPLING_HPP
 
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <random>
 #include <type_traits>
@@ -99,6 +100,95 @@ bool UniformSample
   return true;
 }
 
+/**
+* PROSAC progressive sampling [1].
+* The data must be ordered by decreasing quality (i.e. the most confident
+* correspondences first, as the ratio test matchers provide them).
+* The samples are first drawn among the top ranked data, and the sampling set
+* grows progressively until it covers the whole data. After about
+* max_prosac_iterations draws the sampling is equivalent to uniform sampling.
+*
+*  [1] Matching with PROSAC - Progressive Sample Consensus.
+*      Ondrej Chum and Jiri Matas. CVPR 2005.
+*/
+class ProsacSampler
+{
+public:
+  /**
+  * \param[in] num_samples Size of a minimal sample.
+  * \param[in] total_samples The number of available (sorted) data
+  *   (must be greater or equal to num_samples).
+  * \param[in] max_prosac_iterations Number of draws (T_N) after which the
+  *   sampling set covers the whole data.
+  */
+  ProsacSampler
+  (
+    const uint32_t num_samples,
+    const uint32_t total_samples,
+    const uint32_t max_prosac_iterations = 200000
+  ):
+    num_samples_(num_samples),
+    total_samples_(total_samples),
+    t_(0),
+    n_(std::min(num_samples, total_samples)),
+    T_n_(max_prosac_iterations),
+    T_n_prime_(1)
+  {
+    // Average number of draws T_n containing only data from the top n ones
+    //  T_n = T_N * prod_{i=0}^{m-1} (n - i) / (N - i)
+    for (uint32_t i = 0; i < num_samples_ && i < n_; ++i)
+    {
+      T_n_ *= static_cast<double>(n_ - i) / (total_samples_ - i);
+    }
+  }
+
+  /**
+  * Draw a minimal sample (num_samples unique indexes in [0, total_samples)).
+  * Each draw contains the newest data of the current sampling set
+  *  [0, n) and num_samples-1 data randomly picked in [0, n-1).
+  */
+  template <class RandomGeneratorT>
+  void Sample
+  (
+    RandomGeneratorT & random_generator,
+    std::vector<uint32_t> * samples
+  )
+  {
+    ++t_;
+    // Grow the sampling set once its expected number of draws is reached
+    if (t_ >= T_n_prime_ && n_ < total_samples_)
+    {
+      const double T_n_plus_1 =
+        T_n_ * (n_ + 1.0) / (n_ + 1.0 - num_samples_);
+      T_n_prime_ += static_cast<uint32_t>(std::ceil(T_n_plus_1 - T_n_));
+      T_n_ = T_n_plus_1;
+      ++n_;
+    }
+
+    if (t_ > T_n_prime_)
+    {
+      // The sampling set has not grown for a while: uniform draw in [0, n)
+      UniformSample(num_samples_, n_, random_generator, samples);
+    }
+    else
+    {
+      // Draw num_samples-1 data in [0, n-1) and add the n-th one
+      UniformSample(num_samples_ - 1, n_ - 1, random_generator, samples);
+      samples->push_back(n_ - 1);
+    }
+  }
+
+  /// Current size of the sampling set (the top ranked data)
+  uint32_t SamplingSetSize() const { return n_; }
+
+private:
+  const uint32_t num_samples_;   // m: size of a minimal sample
+  const uint32_t total_samples_; // N: number of data
+  uint32_t t_;                   // Number of draws so far
+  uint32_t n_;                   // Size of the current sampling set
+  double T_n_;                   // Expected number of draws from the top n data
+  uint32_t T_n_prime_;           // Draw index at which the sampling set grows
+};
 
 } // namespace robust
 } // namespace openMVG
@@ -45,6 +45,30 @@ TEST(UniformSampleTestInAVectorOfUniqueElements, NoRepetions) {
   }
 }
 
+// Assert that the PROSAC samples are unique, in range, start among the top
+//  ranked data and end up covering the whole data.
+TEST(ProsacSampler, ProgressiveSampling) {
+
+  const uint32_t num_samples = 7, total = 500;
+  ProsacSampler sampler(num_samples, total, 20000);
+  std::vector<uint32_t> samples;
+  uint32_t previous_set_size = 0;
+  for (int i = 0; i < 2 * 20000; ++i) {
+    sampler.Sample(random_generator, &samples);
+    CHECK_EQUAL(num_samples, samples.size());
+    const std::set<uint32_t> myset(samples.begin(), samples.end());
+    CHECK_EQUAL(num_samples, myset.size());
+    // Samples are drawn in the current sampling set
+    EXPECT_TRUE(*myset.rbegin() < sampler.SamplingSetSize());
+    // The sampling set can only grow
+    EXPECT_TRUE(previous_set_size <= sampler.SamplingSetSize());
+    previous_set_size = sampler.SamplingSetSize();
+    if (i == 0)
+      EXPECT_TRUE(sampler.SamplingSetSize() < total / 10);
+  }
+  CHECK_EQUAL(total, sampler.SamplingSetSize());
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
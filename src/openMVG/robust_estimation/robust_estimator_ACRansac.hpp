@@ -43,6 +43,7 @@
 #include <limits>
 #include <numeric>
 #include <random>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -114,6 +115,96 @@ static void makelogcombi
   makelogcombi_k(k, n, vec_logc_k, vec_log10);
 }
 
+/// Reusable scratch buffers of the ACRANSAC routine.
+/// When many small problems are solved in a row (i.e. the geometric filtering
+///  of thousands of video frame pairs) the buffer allocations and the log
+///  combinatorial table computations dominate; a workspace keeps them
+///  between the calls.
+struct ACRANSAC_Workspace
+{
+  /// Sampling indices
+  std::vector<uint32_t> index, sample;
+  /// Residual array and [residual,index] array
+  std::vector<double> residuals;
+  std::vector<std::pair<double,uint32_t>> sorted_residuals;
+  /// Combinatorial log tables of the last problem size (logcombi_k among logcombi_n)
+  std::vector<float> log10_table, logc_n, logc_k;
+  uint32_t logcombi_k = 0, logcombi_n = 0;
+  /// Tell if the workspace is used by a running ACRANSAC (see ScopedWorkspace)
+  bool in_use = false;
+
+  /// Compute the combinatorial log tables (reused if the problem size is unchanged)
+  void MakeLogCombi(const uint32_t k, const uint32_t n)
+  {
+    if (!logc_n.empty() && k == logcombi_k && n == logcombi_n)
+      return;
+    // The log10 lookup table values do not depend on n, only extend it
+    for (uint32_t i = log10_table.size(); i <= n; ++i)
+      log10_table.push_back(log10(static_cast<float>(i)));
+    makelogcombi_n(n, logc_n, log10_table);
+    makelogcombi_k(k, n, logc_k, log10_table);
+    logcombi_k = k;
+    logcombi_n = n;
+  }
+};
+
+/// Workspace of the calling thread (its buffers live until the thread exits)
+inline ACRANSAC_Workspace & ThreadWorkspace()
+{
+  static thread_local ACRANSAC_Workspace workspace;
+  return workspace;
+}
+
+/// Borrow the calling thread workspace for the scope lifetime.
+/// If it is already in use (nested ACRANSAC call) a private workspace is used.
+class ScopedWorkspace
+{
+public:
+  ScopedWorkspace():
+    m_thread_workspace(ThreadWorkspace()),
+    m_borrowed(!m_thread_workspace.in_use)
+  {
+    m_thread_workspace.in_use = true;
+  }
+
+  ~ScopedWorkspace()
+  {
+    if (m_borrowed)
+      m_thread_workspace.in_use = false;
+  }
+
+  ScopedWorkspace(const ScopedWorkspace &) = delete;
+  ScopedWorkspace & operator=(const ScopedWorkspace &) = delete;
+
+  ACRANSAC_Workspace & get()
+  {
+    return m_borrowed ? m_thread_workspace : m_private_workspace;
+  }
+
+private:
+  ACRANSAC_Workspace & m_thread_workspace;
+  const bool m_borrowed;
+  ACRANSAC_Workspace m_private_workspace;
+};
+
+/// Detect if a kernel can compute the residual errors of a range of samples:
+///  void Errors(const Model &, uint32_t begin, uint32_t end, std::vector<double> &) const
+template <typename Kernel>
+class HasRangeErrors
+{
+  template <typename K>
+  static auto test(int) -> decltype(
+    std::declval<const K &>().Errors(
+      std::declval<const typename K::Model &>(),
+      uint32_t(0), uint32_t(0),
+      std::declval<std::vector<double> &>()),
+    std::true_type());
+  template <typename>
+  static std::false_type test(...);
+public:
+  static constexpr bool value = decltype(test<Kernel>(0))::value;
+};
+
 template <typename Kernel>
 class NFA_Interface
 {
@@ -124,26 +215,67 @@ public:
    * @param[in] dmaxThreshold Upper bound of the residual error (default infinity)
    * @param[in] bquantified_nfa_evaluation Tell if NFA evaluation is using the quantified or exhaustive evaluation method.
    *  An upper bound different from infinity must be provided to be set to true.
+   * @param[in] bearly_bailout Allow the partial evaluation of the models
+   *  (only used in the quantified evaluation mode, see ComputeResiduals).
+   * @param[in] workspace Scratch buffers to use (nullptr: use private buffers).
+   *  It must not be shared with another living NFA_Interface.
    */
   NFA_Interface
   (
     const Kernel & kernel,
     const double dmaxThreshold = std::numeric_limits<double>::infinity(),
-    const bool bquantified_nfa_evaluation = false
+    const bool bquantified_nfa_evaluation = false,
+    const bool bearly_bailout = false,
+    ACRANSAC_Workspace * workspace = nullptr
   ):
-    m_residuals(kernel.NumSamples()),
+    m_workspace(workspace ? *workspace : m_private_workspace),
+    m_residuals(m_workspace.residuals),
+    m_sorted_residuals(m_workspace.sorted_residuals),
+    m_logc_n(m_workspace.logc_n),
+    m_logc_k(m_workspace.logc_k),
     m_kernel(kernel),
     m_bquantified_nfa_evaluation(bquantified_nfa_evaluation),
     m_max_threshold(dmaxThreshold)
   {
+    m_residuals.resize(kernel.NumSamples());
     // Precompute log combi
     m_loge0 = log10((double)Kernel::MAX_MODELS * (kernel.NumSamples() - Kernel::MINIMUM_SAMPLES));
-    makelogcombi(Kernel::MINIMUM_SAMPLES, kernel.NumSamples(), m_logc_k, m_logc_n);
+    m_workspace.MakeLogCombi(Kernel::MINIMUM_SAMPLES, kernel.NumSamples());
+    if (m_bquantified_nfa_evaluation)
+      m_bins_value = Histogram<double>(0.0f, m_max_threshold, kNbBins).GetXbinsValue();
+    if (bearly_bailout && m_bquantified_nfa_evaluation && HasRangeErrors<Kernel>::value)
+      ComputeBinsLogAlpha();
   };
 
   std::vector<double> & residuals()
   { return m_residuals;}
 
+  /**
+   * @brief Compute the residual errors of a model.
+   * In the quantified NFA evaluation mode, if the early bailout is enabled,
+   *  once a meaningful model has been found (nfa_to_beat < 0), the residuals
+   *  are computed by chunks and the evaluation stops as soon as the histogram
+   *  of the residuals seen so far proves that the model NFA cannot be lower
+   *  than nfa_to_beat (whatever the values of the remaining residuals are).
+   * The test is exact: a rejected model would not have been selected by
+   *  ComputeNFA_and_inliers. Until a meaningful model is found, all the
+   *  residuals are computed, so the best model is tracked as without bailout.
+   *
+   * @param[in] model The model to evaluate
+   * @param[in] nfa_to_beat The best NFA found so far
+   *
+   * @return false if the model has been rejected before all its residuals are computed.
+   */
+  bool ComputeResiduals
+  (
+    const typename Kernel::Model & model,
+    const double nfa_to_beat
+  )
+  {
+    return ComputeResiduals(model, nfa_to_beat,
+      std::integral_constant<bool, HasRangeErrors<Kernel>::value>());
+  }
+
   /**
    * @brief Evaluation of the NFA (Number of False Alarm)
    *  for the given residual distribution.
@@ -168,13 +300,123 @@ public:
 
 private:
 
+  /// Number of bins used by the quantified NFA evaluation
+  static const int kNbBins = 20;
+  /// Number of residuals evaluated between two early bailout tests
+  static const uint32_t kBailoutChunkSize = 128;
+  /// Safety margin of the early bailout test (log10 NFA scale)
+  static constexpr double kNFA_BoundMargin = 1.0;
+
+  /// Precompute the log(alpha) value of the quantified NFA bins
+  void ComputeBinsLogAlpha()
+  {
+    const std::vector<double> & residual_val = m_bins_value;
+    m_bins_logalpha.assign(kNbBins, std::numeric_limits<double>::quiet_NaN());
+    for (int bin = 0; bin < kNbBins; ++bin)
+    {
+      // Same parametrization as in ComputeNFA_and_inliers (NaN: unused bin)
+      if (residual_val[bin] > std::numeric_limits<float>::epsilon())
+        m_bins_logalpha[bin] = m_kernel.logalpha0()
+          + m_kernel.multError() * log10(residual_val[bin]
+          + std::numeric_limits<float>::epsilon());
+    }
+  }
+
+  /// Quantified NFA of a bin for a given cumulative count
+  double BinNFA(const double logalpha, const uint32_t cumulative_count) const
+  {
+    return m_loge0
+      + logalpha * (double)(cumulative_count - Kernel::MINIMUM_SAMPLES)
+      + m_logc_n[cumulative_count]
+      + m_logc_k[cumulative_count];
+  }
+
+  /**
+   * @brief Lower bound of the quantified NFA of a partially evaluated model.
+   * For each bin, the final cumulative count lies in [seen, seen + unseen].
+   * The bin NFA is concave in the cumulative count (linear term plus
+   *  logcombi(k,n) + logcombi(m,k)), so its minimum over this interval is
+   *  reached at one of its ends.
+   */
+  double NFA_LowerBound
+  (
+    const Histogram<double> & histo,
+    const uint32_t unseen
+  ) const
+  {
+    double lower_bound = std::numeric_limits<double>::infinity();
+    uint32_t cumulative_count = 0;
+    const std::vector<size_t> & frequencies = histo.GetHist();
+    for (int bin = 0; bin < kNbBins; ++bin)
+    {
+      cumulative_count += frequencies[bin];
+      const double logalpha = m_bins_logalpha[bin];
+      const uint32_t hi = cumulative_count + unseen;
+      if (std::isnan(logalpha) || hi <= Kernel::MINIMUM_SAMPLES)
+        continue;
+      const uint32_t lo = std::max(cumulative_count, uint32_t(Kernel::MINIMUM_SAMPLES + 1));
+      lower_bound = std::min(lower_bound,
+        std::min(BinNFA(logalpha, lo), BinNFA(logalpha, hi)));
+    }
+    return lower_bound;
+  }
+
+  /// Full evaluation (the kernel does not support partial evaluation)
+  bool ComputeResiduals
+  (
+    const typename Kernel::Model & model,
+    const double,
+    std::false_type
+  )
+  {
+    m_kernel.Errors(model, m_residuals);
+    return true;
+  }
+
+  /// Evaluation by chunks with early bailout
+  bool ComputeResiduals
+  (
+    const typename Kernel::Model & model,
+    const double nfa_to_beat,
+    std::true_type
+  )
+  {
+    // No bailout before a meaningful model is found
+    if (m_bins_logalpha.empty() || !(nfa_to_beat < 0.0))
+    {
+      m_kernel.Errors(model, m_residuals);
+      return true;
+    }
+    // A model is only kept if its NFA is better than the current one.
+    // The margin absorbs the rounding errors of the float logcombi tables.
+    const double nfa_bound = nfa_to_beat + kNFA_BoundMargin;
+    const uint32_t n = static_cast<uint32_t>(m_kernel.NumSamples());
+    Histogram<double> histo(0.0f, m_max_threshold, kNbBins);
+    for (uint32_t begin = 0; begin < n; begin += kBailoutChunkSize)
+    {
+      const uint32_t end = std::min(n, begin + kBailoutChunkSize);
+      m_kernel.Errors(model, begin, end, m_residuals);
+      histo.Add(m_residuals.cbegin() + begin, m_residuals.cbegin() + end);
+      if (end < n && NFA_LowerBound(histo, n - end) >= nfa_bound)
+        return false;
+    }
+    return true;
+  }
+
+  /// Scratch buffers (private or provided by the caller)
+  ACRANSAC_Workspace m_private_workspace;
+  ACRANSAC_Workspace & m_workspace;
   /// residual array
-  std::vector<double> m_residuals;
+  std::vector<double> & m_residuals;
   /// [residual,index] array -> used in the exhaustive nfa computation mode
-  std::vector<std::pair<double,uint32_t>> m_sorted_residuals;
+  std::vector<std::pair<double,uint32_t>> & m_sorted_residuals;
 
   /// Combinatorial log
-  std::vector<float> m_logc_n, m_logc_k;
+  std::vector<float> & m_logc_n, & m_logc_k;
+  /// Residual value of the quantified NFA bins
+  std::vector<double> m_bins_value;
+  /// log(alpha) of the quantified NFA bins (empty if early bailout is disabled)
+  std::vector<double> m_bins_logalpha;
   /// A-Contrario Epsilon 0 value
   double m_loge0;
 
@@ -208,7 +450,7 @@ NFA_Interface<Kernel>::ComputeNFA_and_inliers
     // This version avoid:
     //   - to sort explicitly the residual error array,
     //   - to compute the NFA for every sample of the datum.
-    const int nBins = 20;
+    const int nBins = kNbBins;
     Histogram<double> histo(0.0f, m_max_threshold, nBins);
     histo.Add(m_residuals.cbegin(), m_residuals.cend());
 
@@ -218,7 +460,7 @@ NFA_Interface<Kernel>::ComputeNFA_and_inliers
     nfa_thresholdT current_best_nfa(std::numeric_limits<double>::infinity(), 0.0);
     unsigned int cumulative_count = 0;
     const std::vector<size_t> & frequencies = histo.GetHist();
-    const std::vector<double> residual_val = histo.GetXbinsValue();
+    const std::vector<double> & residual_val = m_bins_value;
     for (int bin = 0; bin < nBins; ++bin)
     {
       cumulative_count += frequencies[bin];
@@ -318,6 +560,14 @@ NFA_Interface<Kernel>::ComputeNFA_and_inliers
  * @param[out] model returned model if found
  * @param[in] precision upper bound of the precision (squared error)
  * @param[in] bVerbose display console log
+ * @param[in] bEarlyBailout once a meaningful model is found, stop the scoring
+ *  of a model as soon as it cannot beat the best NFA found so far (same result,
+ *  requires an upper bound of the precision and a kernel providing
+ *  Errors(model, begin, end, errors))
+ * @param[in] bProgressiveSampling use PROSAC sampling (ProsacSampler). The
+ *  kernel data must be sorted by decreasing quality (i.e. putative matches
+ *  ordered by increasing distance ratio). The local optimization keeps
+ *  sampling uniformly among the inliers.
  *
  * @return (errorMax, minNFA)
  */
@@ -329,7 +579,9 @@ std::pair<double, double> ACRANSAC
   const unsigned int num_max_iteration = 1024,
   typename Kernel::Model * model = nullptr,
   double precision = std::numeric_limits<double>::infinity(),
-  bool bVerbose = false
+  bool bVerbose = false,
+  bool bEarlyBailout = true,
+  bool bProgressiveSampling = false
 )
 {
   vec_inliers.clear();
@@ -339,13 +591,22 @@ std::pair<double, double> ACRANSAC
   if (nData <= sizeSample)
     return {0.0, 0.0};
 
+  //--
+  // Scratch buffers: reuse the ones of the calling thread
+  acransac_nfa_internal::ScopedWorkspace workspace;
+
   //--
   // Sampling:
   // Possible sampling indices [0,..,nData] (will change in the optimization phase)
-  std::vector<uint32_t> vec_index(nData);
+  std::vector<uint32_t> & vec_index = workspace.get().index;
+  vec_index.resize(nData);
   std::iota(vec_index.begin(), vec_index.end(), 0);
   // Sample indices (used for model evaluation)
-  std::vector<uint32_t> vec_sample(sizeSample);
+  std::vector<uint32_t> & vec_sample = workspace.get().sample;
+  vec_sample.resize(sizeSample);
+  // Progressive sampling of the ordered data (until the local optimization)
+  ProsacSampler prosac_sampler(sizeSample, nData);
+  bool bSampleAmongInliers = false;
 
   const double maxThreshold = (precision == std::numeric_limits<double>::infinity()) ?
     std::numeric_limits<double>::infinity() :
@@ -354,7 +615,8 @@ std::pair<double, double> ACRANSAC
   // Initialize the NFA computation interface
   // (quantified NFA computation is used if a valid upper bound is provided)
   acransac_nfa_internal::NFA_Interface<Kernel> nfa_interface
-    (kernel, maxThreshold, (precision != std::numeric_limits<double>::infinity()));
+    (kernel, maxThreshold, (precision != std::numeric_limits<double>::infinity()),
+     bEarlyBailout, &workspace.get());
 
   // Output parameters
   double minNFA = std::numeric_limits<double>::infinity();
@@ -377,29 +639,34 @@ std::pair<double, double> ACRANSAC
   // Random number generation
   std::mt19937 random_generator(std::mt19937::default_seed);
 
+  // Estimated model(s)
+  std::vector<typename Kernel::Model> vec_models;
+
   //--
   // Main estimation loop.
   for (unsigned int iter = 0; iter < nIter && iter < num_max_iteration; ++iter)
   {
     // Get random samples
-    if (bACRansacMode)
+    if (bProgressiveSampling && !bSampleAmongInliers)
+      prosac_sampler.Sample(random_generator, &vec_sample);
+    else if (bACRansacMode)
       UniformSample(sizeSample, random_generator, &vec_index, &vec_sample);
     else
       UniformSample(sizeSample, nData, random_generator, &vec_sample);
 
     // Fit model(s). Can find up to Kernel::MAX_MODELS solution(s)
-    std::vector<typename Kernel::Model> vec_models;
+    vec_models.clear();
     kernel.Fit(vec_sample, &vec_models);
 
     // Evaluate model(s)
     bool better = false;
     for (const auto& model_it : vec_models)
     {
-      // Compute residual values
-      kernel.Errors(model_it, nfa_interface.residuals());
-
       if (!bACRansacMode)
       {
+        // Compute residual values
+        kernel.Errors(model_it, nfa_interface.residuals());
+
         // MAX-CONSENSUS checking (does a model with some support is existing)
         unsigned int nInlier = 0;
         for (size_t i = 0; i < nData; ++i)
@@ -411,6 +678,13 @@ std::pair<double, double> ACRANSAC
           bACRansacMode = true;
       }
 
+      else
+      {
+        // Compute residual values (stop early if the model cannot beat minNFA)
+        if (!nfa_interface.ComputeResiduals(model_it, minNFA))
+          continue;
+      }
+
       if (bACRansacMode)
       {
         // NFA evaluation; If better than the previous: update scoring & inliers indices
@@ -462,6 +736,7 @@ std::pair<double, double> ACRANSAC
       {
         // ACRANSAC optimization: draw samples among best set of inliers so far
         vec_index = vec_inliers;
+        bSampleAmongInliers = true;
         if (nIterReserve) {
             // reduce the number of iteration
             // next iterations will be dedicated to local optimization
@@ -24,12 +24,17 @@
 //
 // Mainly it add correct data normalization and define the required functions
 //  by the ACRANSAC algorithm.
+// They also provide a ranged Errors(model, begin, end, errors) evaluation
+//  that allows ACRANSAC to stop the scoring of hopeless models early.
+//  When the error metric has a SoA (structure of arrays) implementation
+//  (see multiview/residuals_soa.hpp) the ranged evaluation is vectorized.
 //
 
 #include <vector>
 
 #include "openMVG/multiview/conditioning.hpp"
 #include "openMVG/multiview/essential.hpp"
+#include "openMVG/multiview/residuals_soa.hpp"
 #include "openMVG/numeric/extract_columns.hpp"
 
 namespace openMVG {
@@ -127,6 +132,7 @@ public:
 
     NormalizePoints(x1, &x1_, &N1_, w1, h1);
     NormalizePoints(x2, &x2_, &N2_, w2, h2);
+    soa_residuals_ = soa::Residuals<ErrorT>(x1_, x2_);
 
     // LogAlpha0 is used to make error data scale invariant
     logalpha0_ =
@@ -165,8 +171,24 @@ public:
   ) const
   {
     vec_errors.resize(x1_.cols());
-    for (uint32_t sample = 0; sample < x1_.cols(); ++sample)
-      vec_errors[sample] = ErrorT::Error(model, x1_.col(sample), x2_.col(sample));
+    Errors(model, 0, x1_.cols(), vec_errors);
+  }
+
+  /// Compute the residual errors of the samples in [begin, end)
+  /// (partial model evaluation, vec_errors must be sized to NumSamples())
+  void Errors
+  (
+    const Model & model,
+    const uint32_t begin,
+    const uint32_t end,
+    std::vector<double> & vec_errors
+  ) const
+  {
+    if (soa::Residuals<ErrorT>::available)
+      soa_residuals_.Errors(model, begin, end, vec_errors.data());
+    else
+      for (uint32_t sample = begin; sample < end; ++sample)
+        vec_errors[sample] = ErrorT::Error(model, x1_.col(sample), x2_.col(sample));
   }
 
   size_t NumSamples() const
@@ -198,6 +220,7 @@ private:
   Mat3 N1_, N2_;      // Matrix used to normalize data
   double logalpha0_;  // Alpha0 is used to make the error adaptive to the image size
   bool bPointToLine_; // Store if error model is pointToLine or point to point
+  soa::Residuals<ErrorT> soa_residuals_; // SoA copy of the normalized data (if supported)
 };
 
 struct UnnormalizerResection {
@@ -235,6 +258,7 @@ public:
     assert(x2d_.cols() == x3D_.cols());
 
     NormalizePoints(x2d, &x2d_, &N1_, w, h);
+    soa_residuals_ = soa::Residuals<ErrorT>(x2d_, x3D_);
   }
 
   enum { MINIMUM_SAMPLES = Solver::MINIMUM_SAMPLES };
@@ -263,8 +287,24 @@ public:
   ) const
   {
     vec_errors.resize(x2d_.cols());
-    for (uint32_t sample = 0; sample < x2d_.cols(); ++sample)
-      vec_errors[sample] = ErrorT::Error(model, x2d_.col(sample), x3D_.col(sample));
+    Errors(model, 0, x2d_.cols(), vec_errors);
+  }
+
+  /// Compute the residual errors of the samples in [begin, end)
+  /// (partial model evaluation, vec_errors must be sized to NumSamples())
+  void Errors
+  (
+    const Model & model,
+    const uint32_t begin,
+    const uint32_t end,
+    std::vector<double> & vec_errors
+  ) const
+  {
+    if (soa::Residuals<ErrorT>::available)
+      soa_residuals_.Errors(model, begin, end, vec_errors.data());
+    else
+      for (uint32_t sample = begin; sample < end; ++sample)
+        vec_errors[sample] = ErrorT::Error(model, x2d_.col(sample), x3D_.col(sample));
   }
 
   size_t NumSamples() const { return x2d_.cols(); }
@@ -285,6 +325,7 @@ private:
   const Mat & x3D_;
   Mat3 N1_;          // Matrix used to normalize data
   double logalpha0_; // Alpha0 is used to make the error adaptive to the image size
+  soa::Residuals<ErrorT> soa_residuals_; // SoA copy of the data (if supported)
 };
 
 /// Essential matrix Kernel adaptor for the A contrario model estimator
@@ -320,6 +361,7 @@ public:
     assert(bearing1_.cols() == bearing2_.cols());
 
     logalpha0_ = ACParametrizationHelper<AContrarioParametrizationType::POINT_TO_LINE>::LogAlpha0(w2, h2, 0.5);
+    soa_residuals_ = soa::Residuals<ErrorT>(x1_, x2_);
   }
 
   enum { MINIMUM_SAMPLES = Solver::MINIMUM_SAMPLES };
@@ -352,12 +394,28 @@ public:
     const Model & model,
     std::vector<double> & vec_errors
   ) const
+  {
+    vec_errors.resize(x1_.cols());
+    Errors(model, 0, x1_.cols(), vec_errors);
+  }
+
+  /// Compute the residual errors of the samples in [begin, end)
+  /// (partial model evaluation, vec_errors must be sized to NumSamples())
+  void Errors
+  (
+    const Model & model,
+    const uint32_t begin,
+    const uint32_t end,
+    std::vector<double> & vec_errors
+  ) const
   {
     Mat3 F;
     FundamentalFromEssential(model, K1_, K2_, &F);
-    vec_errors.resize(x1_.cols());
-    for (uint32_t sample = 0; sample < x1_.cols(); ++sample)
-      vec_errors[sample] = ErrorT::Error(F, this->x1_.col(sample), this->x2_.col(sample));
+    if (soa::Residuals<ErrorT>::available)
+      soa_residuals_.Errors(F, begin, end, vec_errors.data());
+    else
+      for (uint32_t sample = begin; sample < end; ++sample)
+        vec_errors[sample] = ErrorT::Error(F, this->x1_.col(sample), this->x2_.col(sample));
   }
 
   size_t NumSamples() const { return x1_.cols(); }
@@ -374,6 +432,7 @@ private:
   Mat3 N1_, N2_;              // Matrix used to normalize data
   double logalpha0_;          // Alpha0 is used to make the error adaptive to the image size
   Mat3 K1_, K2_;              // Intrinsic camera parameter
+  soa::Residuals<ErrorT> soa_residuals_; // SoA copy of the image points (if supported)
 };
 
 /// Essential Ortho matrix Kernel adaptor for the A contrario model estimator
@@ -437,7 +496,20 @@ public:
   ) const
   {
     vec_errors.resize(bearing1_.cols());
-    for (uint32_t sample = 0; sample < bearing1_.cols(); ++sample)
+    Errors(model, 0, bearing1_.cols(), vec_errors);
+  }
+
+  /// Compute the residual errors of the samples in [begin, end)
+  /// (partial model evaluation, vec_errors must be sized to NumSamples())
+  void Errors
+  (
+    const Model & model,
+    const uint32_t begin,
+    const uint32_t end,
+    std::vector<double> & vec_errors
+  ) const
+  {
+    for (uint32_t sample = begin; sample < end; ++sample)
       vec_errors[sample] = ErrorT::Error(model, bearing1_.col(sample), bearing2_.col(sample));
   }
 
@@ -480,6 +552,7 @@ public:
     assert(3 == x1_.rows());
     assert(x1_.rows() == x2_.rows());
     assert(x1_.cols() == x2_.cols());
+    soa_residuals_ = soa::Residuals<ErrorT>(x1_, x2_);
   }
 
   enum { MINIMUM_SAMPLES = Solver::MINIMUM_SAMPLES };
@@ -512,8 +585,28 @@ public:
   ) const
   {
     vec_errors.resize(x1_.cols());
-    for (uint32_t sample = 0; sample < x1_.cols(); ++sample)
-      vec_errors[sample] = Square(ErrorT::Error(model, x1_.col(sample), x2_.col(sample)));
+    Errors(model, 0, x1_.cols(), vec_errors);
+  }
+
+  /// Compute the residual errors of the samples in [begin, end)
+  /// (partial model evaluation, vec_errors must be sized to NumSamples())
+  void Errors
+  (
+    const Model & model,
+    const uint32_t begin,
+    const uint32_t end,
+    std::vector<double> & vec_errors
+  ) const
+  {
+    if (soa::Residuals<ErrorT>::available)
+    {
+      soa_residuals_.Errors(model, begin, end, vec_errors.data());
+      for (uint32_t sample = begin; sample < end; ++sample)
+        vec_errors[sample] = Square(vec_errors[sample]);
+    }
+    else
+      for (uint32_t sample = begin; sample < end; ++sample)
+        vec_errors[sample] = Square(ErrorT::Error(model, x1_.col(sample), x2_.col(sample)));
   }
 
   size_t NumSamples() const
@@ -536,6 +629,7 @@ public:
 private:
   Mat x1_, x2_;       // Normalized input data
   double logalpha0_;  // Alpha0 is used to make the error scale invariant
+  soa::Residuals<ErrorT> soa_residuals_; // SoA copy of the bearing vectors (if supported)
 };
 
 } // namespace robust
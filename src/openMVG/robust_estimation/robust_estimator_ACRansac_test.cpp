@@ -15,6 +15,7 @@
 #include "third_party/vectorGraphics/svgDrawer.hpp"
 
 #include <iterator>
+#include <limits>
 #include <random>
 
 
@@ -62,6 +63,11 @@ public:
       vec_errors[sample] = ErrorArg::Error(model, x1_.col(sample));
   }
 
+  void Errors(const Model &model, uint32_t begin, uint32_t end, std::vector<double> & vec_errors) const {
+    for (uint32_t sample = begin; sample < end; ++sample)
+      vec_errors[sample] = ErrorArg::Error(model, x1_.col(sample));
+  }
+
   size_t NumSamples() const {
     return x1_.cols();
   }
@@ -364,6 +370,120 @@ TEST(RansacLineFitter, ACRANSACSimu) {
   }
 }
 
+// Check that the early bailout of the model scoring does not change the result
+TEST(RansacLineFitter, EarlyBailout) {
+
+  const int W = 800, H = 600;
+  Mat points;
+  generateLine(points, 2000, W, H, 1.0f, 0.6f);
+
+  ACRANSACOneViewKernel<LineSolver, pointToLineError, Vec2> lineKernel(points, W, H);
+  const double precision = Square(4.0);
+
+  std::vector<uint32_t> vec_inliers_full, vec_inliers_bailout;
+  Vec2 line_full, line_bailout;
+  const std::pair<double,double> ret_full =
+    ACRANSAC(lineKernel, vec_inliers_full, 1024, &line_full, precision, false, false);
+  const std::pair<double,double> ret_bailout =
+    ACRANSAC(lineKernel, vec_inliers_bailout, 1024, &line_bailout, precision, false, true);
+
+  EXPECT_FALSE(vec_inliers_full.empty());
+  CHECK_EQUAL(vec_inliers_full.size(), vec_inliers_bailout.size());
+  EXPECT_TRUE(vec_inliers_full == vec_inliers_bailout);
+  EXPECT_EQ(line_full, line_bailout);
+  EXPECT_EQ(ret_full.first, ret_bailout.first);
+  EXPECT_EQ(ret_full.second, ret_bailout.second);
+}
+
+// Check that the early bailout does not change the result when no model is
+//  meaningful (uniformly distributed points: no line can be found)
+TEST(RansacLineFitter, EarlyBailout_NoMeaningfulModel) {
+
+  const int W = 800, H = 600;
+  Mat points(2, 1000);
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::uniform_real_distribution<double> dW(0, W), dH(0, H);
+  for (Mat::Index i = 0; i < points.cols(); ++i)
+    points.col(i) << dW(random_generator), dH(random_generator);
+
+  ACRANSACOneViewKernel<LineSolver, pointToLineError, Vec2> lineKernel(points, W, H);
+  const double precision = Square(4.0);
+
+  std::vector<uint32_t> vec_inliers_full, vec_inliers_bailout;
+  Vec2 line_full(0, 0), line_bailout(0, 0);
+  const std::pair<double,double> ret_full =
+    ACRANSAC(lineKernel, vec_inliers_full, 300, &line_full, precision, false, false);
+  const std::pair<double,double> ret_bailout =
+    ACRANSAC(lineKernel, vec_inliers_bailout, 300, &line_bailout, precision, false, true);
+
+  // No meaningful model
+  EXPECT_TRUE(vec_inliers_full.empty());
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), ret_full.second);
+  EXPECT_TRUE(vec_inliers_full == vec_inliers_bailout);
+  EXPECT_EQ(line_full, line_bailout);
+  EXPECT_EQ(ret_full.first, ret_bailout.first);
+  EXPECT_EQ(ret_full.second, ret_bailout.second);
+}
+
+// Check ACRANSAC with a progressive sampling of quality ordered data
+TEST(RansacLineFitter, ProgressiveSampling) {
+
+  const int W = 800, H = 600;
+  Mat points;
+  generateLine(points, 1000, W, H, 1.0f, 0.7f);
+
+  // Order the data by quality: points close to the line first
+  const Vec2 lineEq(50, 0.3);
+  std::vector<std::pair<double, int>> ranking;
+  for (int i = 0; i < points.cols(); ++i)
+    ranking.emplace_back(pointToLineError::Error(lineEq, points.col(i)), i);
+  std::sort(ranking.begin(), ranking.end());
+  Mat sorted_points(2, points.cols());
+  for (int i = 0; i < points.cols(); ++i)
+    sorted_points.col(i) = points.col(ranking[i].second);
+
+  ACRANSACOneViewKernel<LineSolver, pointToLineError, Vec2> lineKernel(sorted_points, W, H);
+
+  std::vector<uint32_t> vec_inliers;
+  Vec2 line;
+  ACRANSAC(lineKernel, vec_inliers, 256, &line, Square(4.0), false, true, true);
+
+  EXPECT_TRUE(vec_inliers.size() >= 250);
+  EXPECT_NEAR(lineEq[0], line[0], 2.0);
+  EXPECT_NEAR(lineEq[1], line[1], 0.01);
+}
+
+// Check that the reuse of the thread workspace between problems of different
+//  sizes (and the private workspace of nested calls) gives the same results
+TEST(RansacLineFitter, WorkspaceReuse) {
+
+  const int W = 800, H = 600;
+  Mat points_a, points_b;
+  generateLine(points_a, 1000, W, H, 1.0f, 0.5f);
+  generateLine(points_b, 200, W, H, 1.0f, 0.3f);
+
+  using KernelT = ACRANSACOneViewKernel<LineSolver, pointToLineError, Vec2>;
+  const KernelT kernel_a(points_a, W, H), kernel_b(points_b, W, H);
+
+  std::vector<uint32_t> inliers_a, inliers_b, inliers_a_reuse, inliers_b_nested;
+  Vec2 line_a, line_b, line_a_reuse, line_b_nested;
+  ACRANSAC(kernel_a, inliers_a, 300, &line_a, Square(4.0));
+  ACRANSAC(kernel_b, inliers_b, 300, &line_b);
+  ACRANSAC(kernel_a, inliers_a_reuse, 300, &line_a_reuse, Square(4.0));
+  {
+    // The thread workspace is busy, ACRANSAC must use a private one
+    acransac_nfa_internal::ScopedWorkspace busy_workspace;
+    ACRANSAC(kernel_b, inliers_b_nested, 300, &line_b_nested);
+  }
+
+  EXPECT_FALSE(inliers_a.empty());
+  EXPECT_FALSE(inliers_b.empty());
+  EXPECT_TRUE(inliers_a == inliers_a_reuse);
+  EXPECT_EQ(line_a, line_a_reuse);
+  EXPECT_TRUE(inliers_b == inliers_b_nested);
+  EXPECT_EQ(line_b, line_b_nested);
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -0,0 +1,522 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/pipelines/global/GlobalSfM_anchored_averaging.hpp"
+#include "openMVG/numeric/numeric.h"
+
+#include <Eigen/SparseCore>
+#ifdef EIGEN_MPL2_ONLY
+#include <Eigen/SparseLU>
+#else
+#include <Eigen/SparseCholesky>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <queue>
+#include <set>
+#include <vector>
+
+namespace openMVG {
+namespace sfm {
+
+using namespace openMVG::rotation_averaging;
+
+namespace {
+
+#ifdef EIGEN_MPL2_ONLY
+using SparseSolver = Eigen::SparseLU<Eigen::SparseMatrix<double>>;
+#else
+using SparseSolver = Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>>;
+#endif
+
+// Number of iteratively reweighted least squares iterations
+const int kIRLS_Iterations = 10;
+
+/**
+* @brief Select the non anchor poses connected to the anchors by the valid
+*  edges and constrained by at least min_degree valid edges.
+*  The valid edges that do not link two selected (or anchor) poses, and the
+*  edges between two anchors, are invalidated.
+* @return the selected poses and their contiguous index
+*/
+Hash_Map<IndexT, IndexT> SelectFreePoses
+(
+  const std::vector<Pair> & edges,
+  const Hash_Map<IndexT, bool> & is_anchor,
+  const int min_degree,
+  std::vector<bool> & valid_edges
+)
+{
+  const auto anchor = [&is_anchor](IndexT id) { return is_anchor.count(id) == 1; };
+
+  std::set<IndexT> selected;
+  for (size_t e = 0; e < edges.size(); ++e)
+  {
+    if (!valid_edges[e])
+      continue;
+    if (!anchor(edges[e].first)) selected.insert(edges[e].first);
+    if (!anchor(edges[e].second)) selected.insert(edges[e].second);
+  }
+  const auto usable = [&](size_t e)
+  {
+    const Pair & edge = edges[e];
+    return valid_edges[e]
+      && (anchor(edge.first) || selected.count(edge.first))
+      && (anchor(edge.second) || selected.count(edge.second))
+      && !(anchor(edge.first) && anchor(edge.second));
+  };
+
+  // Iteratively remove the poses that are not constrained enough
+  bool b_removed = true;
+  while (b_removed)
+  {
+    std::map<IndexT, int> degree;
+    for (size_t e = 0; e < edges.size(); ++e)
+    {
+      if (!usable(e))
+        continue;
+      ++degree[edges[e].first];
+      ++degree[edges[e].second];
+    }
+    b_removed = false;
+    for (auto it = selected.begin(); it != selected.end();)
+    {
+      if (degree[*it] < min_degree)
+      {
+        it = selected.erase(it);
+        b_removed = true;
+      }
+      else
+        ++it;
+    }
+  }
+
+  // Keep the poses connected to the anchors
+  std::map<IndexT, std::vector<IndexT>> adjacency;
+  for (size_t e = 0; e < edges.size(); ++e)
+  {
+    if (!usable(e))
+      continue;
+    adjacency[edges[e].first].push_back(edges[e].second);
+    adjacency[edges[e].second].push_back(edges[e].first);
+  }
+  std::set<IndexT> visited;
+  std::queue<IndexT> to_visit;
+  for (const auto & node : adjacency)
+  {
+    if (anchor(node.first))
+    {
+      visited.insert(node.first);
+      to_visit.push(node.first);
+    }
+  }
+  while (!to_visit.empty())
+  {
+    const IndexT node = to_visit.front();
+    to_visit.pop();
+    for (const IndexT neighbor : adjacency[node])
+    {
+      if (visited.insert(neighbor).second)
+        to_visit.push(neighbor);
+    }
+  }
+  for (auto it = selected.begin(); it != selected.end();)
+  {
+    if (visited.count(*it) == 0)
+      it = selected.erase(it);
+    else
+      ++it;
+  }
+
+  for (size_t e = 0; e < edges.size(); ++e)
+    valid_edges[e] = usable(e);
+
+  Hash_Map<IndexT, IndexT> free_index;
+  for (const IndexT id : selected)
+  {
+    const IndexT index = free_index.size();
+    free_index[id] = index;
+  }
+  return free_index;
+}
+
+/// Closest rotation matrix (Frobenius norm)
+Mat3 ProjectToSO3(const Mat3 & M)
+{
+  const Eigen::JacobiSVD<Mat3> svd(M, Eigen::ComputeFullU | Eigen::ComputeFullV);
+  Mat3 D = Mat3::Identity();
+  D(2, 2) = (svd.matrixU() * svd.matrixV().transpose()).determinant() > 0 ? 1.0 : -1.0;
+  return svd.matrixU() * D * svd.matrixV().transpose();
+}
+
+/// Solve the weighted anchored chordal rotation problem (column-wise linear system)
+bool SolveAnchoredRotations
+(
+  const RelativeRotations & relative_rotations,
+  const std::vector<double> & weights,
+  const Hash_Map<IndexT, Mat3> & anchor_rotations,
+  const Hash_Map<IndexT, IndexT> & free_index,
+  std::vector<Mat3> & rotations
+)
+{
+  // Normal equations of the residuals (R_j - R_ij R_i): M.X = B where X stacks
+  //  the free rotations (3 rows per pose). The three columns of the rotations
+  //  are independent problems sharing the same matrix.
+  const Eigen::Index nb_unknowns = 3 * free_index.size();
+  std::vector<Eigen::Triplet<double>> coefficients;
+  Eigen::Matrix<double, Eigen::Dynamic, 3> B =
+    Eigen::Matrix<double, Eigen::Dynamic, 3>::Zero(nb_unknowns, 3);
+  const auto add_block = [&coefficients](Eigen::Index row, Eigen::Index col, const Mat3 & block)
+  {
+    for (int r = 0; r < 3; ++r)
+      for (int c = 0; c < 3; ++c)
+        coefficients.emplace_back(row + r, col + c, block(r, c));
+  };
+  for (size_t e = 0; e < relative_rotations.size(); ++e)
+  {
+    if (weights[e] <= 0.0)
+      continue;
+    const RelativeRotation & relative = relative_rotations[e];
+    const double w = weights[e];
+    const auto free_i = free_index.find(relative.i), free_j = free_index.find(relative.j);
+    const bool b_free_i = free_i != free_index.cend(), b_free_j = free_j != free_index.cend();
+    const Eigen::Index row_i = b_free_i ? 3 * free_i->second : 0;
+    const Eigen::Index row_j = b_free_j ? 3 * free_j->second : 0;
+    if (b_free_i)
+      add_block(row_i, row_i, w * Mat3::Identity());
+    if (b_free_j)
+      add_block(row_j, row_j, w * Mat3::Identity());
+    if (b_free_i && b_free_j)
+    {
+      add_block(row_i, row_j, -w * relative.Rij.transpose());
+      add_block(row_j, row_i, -w * relative.Rij);
+    }
+    else if (b_free_j)
+      B.middleRows<3>(row_j) += w * relative.Rij * anchor_rotations.at(relative.i);
+    else if (b_free_i)
+      B.middleRows<3>(row_i) += w * relative.Rij.transpose() * anchor_rotations.at(relative.j);
+  }
+  Eigen::SparseMatrix<double> M(nb_unknowns, nb_unknowns);
+  M.setFromTriplets(coefficients.begin(), coefficients.end());
+  M.makeCompressed();
+
+  SparseSolver solver;
+  solver.compute(M);
+  if (solver.info() != Eigen::Success)
+    return false;
+  const Eigen::Matrix<double, Eigen::Dynamic, 3> X = solver.solve(B);
+  if (solver.info() != Eigen::Success || !X.allFinite())
+    return false;
+
+  rotations.resize(free_index.size());
+  for (size_t k = 0; k < free_index.size(); ++k)
+    rotations[k] = ProjectToSO3(X.middleRows<3>(3 * k));
+  return true;
+}
+
+/**
+* @brief Solve the weighted anchored translation problem
+*  sum_ij w_ij ||c_j - c_i - s_ij d_ij||^2 with s_ij >= min_baseline.
+*  For the edges that are not clamped, s_ij is eliminated (s_ij = d_ij^t (c_j - c_i))
+*  and the residual is (I - d_ij d_ij^t)(c_j - c_i). The clamped edges use
+*  s_ij = min_baseline.
+*/
+bool SolveAnchoredCenters
+(
+  const std::vector<Pair> & edges,
+  const std::vector<Vec3> & directions,
+  const std::vector<double> & weights,
+  const std::vector<bool> & clamped,
+  const double min_baseline,
+  const Hash_Map<IndexT, Vec3> & anchor_centers,
+  const Hash_Map<IndexT, IndexT> & free_index,
+  std::vector<Vec3> & centers
+)
+{
+  // Normal equations of the residuals A_ij (c_j - c_i - o_ij), A_ij being
+  //  either the projector (I - d_ij d_ij^t) or the identity (A_ij^t A_ij = A_ij)
+  const Eigen::Index nb_unknowns = 3 * free_index.size();
+  std::vector<Eigen::Triplet<double>> coefficients;
+  Vec b = Vec::Zero(nb_unknowns);
+  const auto add_block = [&coefficients](Eigen::Index row, Eigen::Index col, const Mat3 & block)
+  {
+    for (int r = 0; r < 3; ++r)
+      for (int c = 0; c < 3; ++c)
+        coefficients.emplace_back(row + r, col + c, block(r, c));
+  };
+  for (size_t e = 0; e < edges.size(); ++e)
+  {
+    if (weights[e] <= 0.0)
+      continue;
+    const Mat3 Q = clamped[e] ?
+      Mat3(weights[e] * Mat3::Identity()) :
+      Mat3(weights[e] * (Mat3::Identity() - directions[e] * directions[e].transpose()));
+    const Vec3 Qo = clamped[e] ? Vec3(Q * directions[e] * min_baseline) : Vec3::Zero();
+    const auto free_i = free_index.find(edges[e].first), free_j = free_index.find(edges[e].second);
+    const bool b_free_i = free_i != free_index.cend(), b_free_j = free_j != free_index.cend();
+    const Eigen::Index row_i = b_free_i ? 3 * free_i->second : 0;
+    const Eigen::Index row_j = b_free_j ? 3 * free_j->second : 0;
+    if (b_free_i)
+    {
+      add_block(row_i, row_i, Q);
+      b.segment<3>(row_i) -= Qo;
+    }
+    if (b_free_j)
+    {
+      add_block(row_j, row_j, Q);
+      b.segment<3>(row_j) += Qo;
+    }
+    if (b_free_i && b_free_j)
+    {
+      add_block(row_i, row_j, -Q);
+      add_block(row_j, row_i, -Q);
+    }
+    else if (b_free_j)
+      b.segment<3>(row_j) += Q * anchor_centers.at(edges[e].first);
+    else if (b_free_i)
+      b.segment<3>(row_i) += Q * anchor_centers.at(edges[e].second);
+  }
+  Eigen::SparseMatrix<double> M(nb_unknowns, nb_unknowns);
+  M.setFromTriplets(coefficients.begin(), coefficients.end());
+  M.makeCompressed();
+
+  SparseSolver solver;
+  solver.compute(M);
+  if (solver.info() != Eigen::Success)
+    return false;
+  const Vec x = solver.solve(b);
+  if (solver.info() != Eigen::Success || !x.allFinite())
+    return false;
+
+  centers.resize(free_index.size());
+  for (size_t k = 0; k < free_index.size(); ++k)
+    centers[k] = x.segment<3>(3 * k);
+  return true;
+}
+
+} // namespace
+
+bool AnchoredRotationAveraging
+(
+  const RelativeRotations & relative_rotations,
+  const Hash_Map<IndexT, Mat3> & anchor_rotations,
+  Hash_Map<IndexT, Mat3> & rotations,
+  const double max_angular_error
+)
+{
+  rotations.clear();
+
+  std::vector<Pair> edges;
+  edges.reserve(relative_rotations.size());
+  for (const RelativeRotation & relative : relative_rotations)
+    edges.emplace_back(relative.i, relative.j);
+  Hash_Map<IndexT, bool> is_anchor;
+  for (const auto & anchor : anchor_rotations)
+    is_anchor[anchor.first] = true;
+
+  std::vector<bool> valid_edges(edges.size(), true);
+  Hash_Map<IndexT, IndexT> free_index = SelectFreePoses(edges, is_anchor, 1, valid_edges);
+  if (free_index.empty())
+    return false;
+
+  const auto rotation = [&](IndexT id, const std::vector<Mat3> & free_rotations) -> const Mat3 &
+  {
+    const auto it = free_index.find(id);
+    return (it != free_index.cend()) ? free_rotations[it->second] : anchor_rotations.at(id);
+  };
+  // Angular residual (degree) of the valid edges
+  const auto residuals = [&](const std::vector<Mat3> & free_rotations)
+  {
+    std::vector<double> errors(edges.size(), 0.0);
+    for (size_t e = 0; e < edges.size(); ++e)
+    {
+      if (!valid_edges[e])
+        continue;
+      const RelativeRotation & relative = relative_rotations[e];
+      const Mat3 & Ri = rotation(relative.i, free_rotations);
+      const Mat3 & Rj = rotation(relative.j, free_rotations);
+      errors[e] = R2D(getRotationMagnitude(Rj.transpose() * relative.Rij * Ri));
+    }
+    return errors;
+  };
+
+  // Iteratively reweighted least squares
+  std::vector<double> weights(edges.size());
+  for (size_t e = 0; e < edges.size(); ++e)
+    weights[e] = valid_edges[e] ? relative_rotations[e].weight : 0.0;
+  std::vector<Mat3> free_rotations;
+  for (int iteration = 0; iteration < kIRLS_Iterations; ++iteration)
+  {
+    if (!SolveAnchoredRotations(relative_rotations, weights, anchor_rotations, free_index, free_rotations))
+      return false;
+    const std::vector<double> errors = residuals(free_rotations);
+    for (size_t e = 0; e < edges.size(); ++e)
+    {
+      if (valid_edges[e])
+        weights[e] = relative_rotations[e].weight / std::max(errors[e], 0.1);
+    }
+  }
+
+  // Discard the outlier edges and solve again with the remaining ones
+  {
+    const std::vector<double> errors = residuals(free_rotations);
+    for (size_t e = 0; e < edges.size(); ++e)
+      valid_edges[e] = valid_edges[e] && errors[e] < max_angular_error;
+    free_index = SelectFreePoses(edges, is_anchor, 1, valid_edges);
+    if (free_index.empty())
+      return false;
+    for (size_t e = 0; e < edges.size(); ++e)
+      weights[e] = valid_edges[e] ? relative_rotations[e].weight : 0.0;
+    if (!SolveAnchoredRotations(relative_rotations, weights, anchor_rotations, free_index, free_rotations))
+      return false;
+  }
+
+  for (const auto & free_it : free_index)
+    rotations[free_it.first] = free_rotations[free_it.second];
+  return true;
+}
+
+bool AnchoredTranslationAveraging
+(
+  const RelativeInfo_Vec & relative_motions,
+  const Hash_Map<IndexT, Mat3> & global_rotations,
+  const Hash_Map<IndexT, Vec3> & anchor_centers,
+  Hash_Map<IndexT, Vec3> & centers,
+  const double max_angular_error
+)
+{
+  centers.clear();
+
+  // World direction of the baselines: c_j - c_i ~ R_i^t (-R_ij^t t_ij)
+  std::vector<Pair> edges;
+  std::vector<Vec3> directions;
+  for (const relativeInfo & relative : relative_motions)
+  {
+    const auto Ri = global_rotations.find(relative.first.first);
+    if (Ri == global_rotations.cend() || global_rotations.count(relative.first.second) == 0)
+      continue;
+    const Vec3 direction = - Ri->second.transpose()
+      * relative.second.first.transpose() * relative.second.second;
+    if (direction.norm() <= std::numeric_limits<double>::epsilon())
+      continue;
+    edges.push_back(relative.first);
+    directions.push_back(direction.normalized());
+  }
+  Hash_Map<IndexT, bool> is_anchor;
+  for (const auto & anchor : anchor_centers)
+    is_anchor[anchor.first] = true;
+
+  std::vector<bool> valid_edges(edges.size(), true);
+  Hash_Map<IndexT, IndexT> free_index = SelectFreePoses(edges, is_anchor, 2, valid_edges);
+  if (free_index.empty())
+    return false;
+
+  // Lower bound of the baseline lengths (it prevents the new poses from
+  //  collapsing): a fraction of the median distance between an anchor linked
+  //  to the new poses and its closest anchor.
+  std::vector<Vec3> linked_anchors;
+  {
+    std::set<IndexT> linked_ids;
+    for (size_t e = 0; e < edges.size(); ++e)
+    {
+      if (!valid_edges[e])
+        continue;
+      if (is_anchor.count(edges[e].first)) linked_ids.insert(edges[e].first);
+      if (is_anchor.count(edges[e].second)) linked_ids.insert(edges[e].second);
+    }
+    for (const IndexT id : linked_ids)
+      linked_anchors.push_back(anchor_centers.at(id));
+  }
+  std::vector<double> closest_distances;
+  for (const Vec3 & linked_anchor : linked_anchors)
+  {
+    double closest_distance = std::numeric_limits<double>::max();
+    for (const auto & anchor : anchor_centers)
+    {
+      const double distance = (anchor.second - linked_anchor).norm();
+      if (distance > 0.0)
+        closest_distance = std::min(closest_distance, distance);
+    }
+    if (closest_distance < std::numeric_limits<double>::max())
+      closest_distances.push_back(closest_distance);
+  }
+  if (closest_distances.empty())
+    return false; // The scale is undefined
+  std::nth_element(closest_distances.begin(),
+    closest_distances.begin() + closest_distances.size() / 2, closest_distances.end());
+  const double min_baseline = 0.1 * closest_distances[closest_distances.size() / 2];
+
+  const auto center = [&](IndexT id, const std::vector<Vec3> & free_centers) -> const Vec3 &
+  {
+    const auto it = free_index.find(id);
+    return (it != free_index.cend()) ? free_centers[it->second] : anchor_centers.at(id);
+  };
+
+  // Solve the problem on the valid edges: the clamped edges (active baseline
+  //  constraints) and, if b_robust, the weights of the iteratively reweighted
+  //  least squares (L1 cost on the distance residuals) are updated between the solves.
+  std::vector<Vec3> free_centers;
+  const auto solve = [&](const bool b_robust) -> bool
+  {
+    std::vector<double> weights(edges.size());
+    for (size_t e = 0; e < edges.size(); ++e)
+      weights[e] = valid_edges[e] ? 1.0 : 0.0;
+    std::vector<bool> clamped(edges.size(), false);
+    for (int iteration = 0; iteration < kIRLS_Iterations; ++iteration)
+    {
+      if (!SolveAnchoredCenters(edges, directions, weights, clamped, min_baseline,
+            anchor_centers, free_index, free_centers))
+        return false;
+      bool b_clamped_changed = false;
+      for (size_t e = 0; e < edges.size(); ++e)
+      {
+        if (!valid_edges[e])
+          continue;
+        const Vec3 baseline = center(edges[e].second, free_centers) - center(edges[e].first, free_centers);
+        const double length = directions[e].dot(baseline);
+        b_clamped_changed |= (clamped[e] != (length < min_baseline));
+        clamped[e] = length < min_baseline;
+        if (b_robust)
+        {
+          const double residual = (baseline - std::max(length, min_baseline) * directions[e]).norm();
+          weights[e] = 1.0 / std::max(residual, 1e-3 * min_baseline);
+        }
+      }
+      if (!b_robust && !b_clamped_changed)
+        break;
+    }
+    return true;
+  };
+
+  if (!solve(true))
+    return false;
+
+  // Discard the outlier edges (angular residual, including the wrong baseline
+  //  orientations) and solve again with the remaining ones
+  for (size_t e = 0; e < edges.size(); ++e)
+  {
+    if (!valid_edges[e])
+      continue;
+    const Vec3 baseline = center(edges[e].second, free_centers) - center(edges[e].first, free_centers);
+    const double length = baseline.norm();
+    const double error = (length > 0.0) ?
+      R2D(std::acos(clamp(baseline.dot(directions[e]) / length, -1.0, 1.0))) : 180.0;
+    valid_edges[e] = error < max_angular_error;
+  }
+  free_index = SelectFreePoses(edges, is_anchor, 2, valid_edges);
+  if (free_index.empty() || !solve(false))
+    return false;
+
+  for (const auto & free_it : free_index)
+    centers[free_it.first] = free_centers[free_it.second];
+  return true;
+}
+
+} // namespace sfm
+} // namespace openMVG
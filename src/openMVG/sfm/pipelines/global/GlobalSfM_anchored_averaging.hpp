@@ -0,0 +1,77 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_GLOBAL_ENGINE_PIPELINES_GLOBAL_ANCHORED_AVERAGING_HPP
+#define OPENMVG_SFM_GLOBAL_ENGINE_PIPELINES_GLOBAL_ANCHORED_AVERAGING_HPP
+
+#include "openMVG/multiview/rotation_averaging_common.hpp"
+#include "openMVG/multiview/translation_averaging_common.hpp"
+#include "openMVG/types.hpp"
+
+// Motion averaging with anchors: the poses of an existing reconstruction are
+//  held fixed and only the new poses (connected to them by relative motions)
+//  are estimated. It is used to add new views to a global SfM reconstruction
+//  without solving again the whole averaging problems.
+
+namespace openMVG {
+namespace sfm {
+
+/**
+* @brief Compute the global rotations of the poses connected to the anchor poses.
+*  It solves the linear chordal problem sum_ij w_ij ||R_j - R_ij R_i||_F^2 over
+*  the non anchor rotations (the anchor rotations are fixed), with iteratively
+*  reweighted least squares (L1 like robust cost). The edges with a residual
+*  larger than max_angular_error are then discarded and the problem is solved
+*  again on the remaining edges. The solutions are projected on SO(3).
+*
+* @param[in] relative_rotations relative rotations (R_j = R_ij R_i)
+* @param[in] anchor_rotations fixed global rotations
+* @param[out] rotations global rotations of the non anchor poses connected to the anchors
+* @param[in] max_angular_error residual threshold of the valid edges (degree)
+* @return true if some rotations are computed
+*/
+bool AnchoredRotationAveraging
+(
+  const rotation_averaging::RelativeRotations & relative_rotations,
+  const Hash_Map<IndexT, Mat3> & anchor_rotations,
+  Hash_Map<IndexT, Mat3> & rotations,
+  const double max_angular_error = 5.0
+);
+
+/**
+* @brief Compute the camera centers of the poses connected to the anchor poses
+*  from relative translation directions and known global rotations.
+*  It solves the problem sum_ij w_ij ||c_j - c_i - s_ij d_ij||^2 with
+*  s_ij >= min_baseline over the non anchor centers (the anchor centers are
+*  fixed), where d_ij is the world direction of the baseline and min_baseline
+*  is a fraction of the typical anchor spacing. It uses iteratively reweighted
+*  least squares (L1 like robust cost on the distance residuals). The edges with
+*  an angular residual larger than max_angular_error are then discarded and the
+*  problem is solved again on the remaining edges.
+*  A pose must be constrained by at least two relative translations.
+*  The scale of the solution is given by the anchor centers.
+*
+* @param[in] relative_motions relative motions (R_ij, t_ij): X_j = R_ij X_i + t_ij
+*   (the norm of t_ij is not used)
+* @param[in] global_rotations global rotations of the anchor and the new poses
+* @param[in] anchor_centers fixed camera centers
+* @param[out] centers camera centers of the non anchor poses that are constrained
+* @param[in] max_angular_error residual threshold of the valid edges (degree)
+* @return true if some centers are computed
+*/
+bool AnchoredTranslationAveraging
+(
+  const RelativeInfo_Vec & relative_motions,
+  const Hash_Map<IndexT, Mat3> & global_rotations,
+  const Hash_Map<IndexT, Vec3> & anchor_centers,
+  Hash_Map<IndexT, Vec3> & centers,
+  const double max_angular_error = 5.0
+);
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_GLOBAL_ENGINE_PIPELINES_GLOBAL_ANCHORED_AVERAGING_HPP
@@ -0,0 +1,152 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/pipelines/global/GlobalSfM_anchored_averaging.hpp"
+#include "openMVG/multiview/test_data_sets.hpp"
+#include "openMVG/numeric/numeric.h"
+
+#include "testing/testing.h"
+
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::rotation_averaging;
+using namespace openMVG::sfm;
+
+// Camera ring: one pose out of four is a new pose, the others are the anchors
+//  (existing reconstruction). The new poses are linked to the poses that are
+//  at most 4 steps away on the ring.
+struct AnchoredScene
+{
+  NViewDataSet d;
+  Hash_Map<IndexT, Mat3> anchor_rotations;
+  Hash_Map<IndexT, Vec3> anchor_centers;
+  std::vector<Pair> edges;
+
+  explicit AnchoredScene(const int nb_views)
+    : d(NRealisticCamerasRing(nb_views, 10))
+  {
+    Pair_Set pairs;
+    for (int i = 0; i < nb_views; ++i)
+    {
+      if (IsNew(i))
+      {
+        for (int step = 1; step <= 4; ++step)
+        {
+          const int j = (i + step) % nb_views, k = (i + nb_views - step) % nb_views;
+          pairs.insert(Pair(std::min(i, j), std::max(i, j)));
+          pairs.insert(Pair(std::min(i, k), std::max(i, k)));
+        }
+      }
+      else
+      {
+        anchor_rotations[i] = d._R[i];
+        anchor_centers[i] = d._C[i];
+      }
+    }
+    edges.assign(pairs.cbegin(), pairs.cend());
+  }
+
+  static bool IsNew(const IndexT id) { return id % 4 == 3; }
+
+  Mat3 Rij(const Pair & edge) const
+  {
+    return d._R[edge.second] * d._R[edge.first].transpose();
+  }
+
+  Vec3 tij(const Pair & edge) const
+  {
+    return d._t[edge.second] - Rij(edge) * d._t[edge.first];
+  }
+};
+
+TEST(AnchoredAveraging, Rotations_Noise_And_Outliers) {
+
+  const AnchoredScene scene(20);
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::normal_distribution<double> noise(0.0, D2R(0.1));
+
+  RelativeRotations relative_rotations;
+  for (size_t e = 0; e < scene.edges.size(); ++e)
+  {
+    const Pair & edge = scene.edges[e];
+    const Vec3 axis(noise(random_generator), noise(random_generator), noise(random_generator));
+    Mat3 Rij = Mat3(Eigen::AngleAxisd(axis.norm(), axis.normalized())) * scene.Rij(edge);
+    // Some gross outliers
+    if (e % 7 == 4)
+      Rij = Mat3(Eigen::AngleAxisd(D2R(30.0), Vec3::UnitZ())) * Rij;
+    relative_rotations.emplace_back(edge.first, edge.second, Rij);
+  }
+  // A disconnected pose is not estimated
+  relative_rotations.emplace_back(100, 101, Mat3::Identity());
+
+  Hash_Map<IndexT, Mat3> rotations;
+  EXPECT_TRUE(AnchoredRotationAveraging(relative_rotations, scene.anchor_rotations, rotations));
+  EXPECT_EQ(5, rotations.size());
+  for (const auto & rotation : rotations)
+  {
+    // Anchors are not returned
+    EXPECT_TRUE(AnchoredScene::IsNew(rotation.first));
+    const double error = R2D(getRotationMagnitude(
+      rotation.second * scene.d._R[rotation.first].transpose()));
+    EXPECT_TRUE(error < 0.2);
+  }
+}
+
+TEST(AnchoredAveraging, Translations_Noise_And_Outliers) {
+
+  const AnchoredScene scene(20);
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  std::normal_distribution<double> noise(0.0, 0.002);
+
+  Hash_Map<IndexT, Mat3> global_rotations;
+  for (size_t i = 0; i < scene.d._R.size(); ++i)
+    global_rotations[i] = scene.d._R[i];
+
+  RelativeInfo_Vec relative_motions;
+  for (size_t e = 0; e < scene.edges.size(); ++e)
+  {
+    const Pair & edge = scene.edges[e];
+    Vec3 tij = scene.tij(edge).normalized()
+      + Vec3(noise(random_generator), noise(random_generator), noise(random_generator));
+    // Some gross outliers (including a baseline sign flip)
+    if (e % 7 == 4)
+      tij = Mat3(Eigen::AngleAxisd(D2R(30.0), Vec3::UnitY())) * tij;
+    if (e == 12)
+      tij = - tij;
+    relative_motions.emplace_back(edge, std::make_pair(scene.Rij(edge), tij));
+  }
+  // A pose constrained by a single relative translation is not estimated
+  global_rotations[30] = Mat3::Identity();
+  relative_motions.emplace_back(Pair(0, 30), std::make_pair(Mat3::Identity(), Vec3(1, 0, 0)));
+
+  Hash_Map<IndexT, Vec3> centers;
+  EXPECT_TRUE(AnchoredTranslationAveraging(
+    relative_motions, global_rotations, scene.anchor_centers, centers));
+  EXPECT_EQ(5, centers.size());
+  EXPECT_EQ(0, centers.count(30));
+  // The scale is given by the anchors
+  const double baseline = (scene.d._C[1] - scene.d._C[0]).norm();
+  for (const auto & center : centers)
+  {
+    EXPECT_TRUE(AnchoredScene::IsNew(center.first));
+    EXPECT_TRUE((center.second - scene.d._C[center.first]).norm() < 0.02 * baseline);
+  }
+}
+
+TEST(AnchoredAveraging, No_Anchor_Connection) {
+
+  RelativeRotations relative_rotations;
+  relative_rotations.emplace_back(1, 2, Mat3::Identity());
+  Hash_Map<IndexT, Mat3> anchor_rotations = {{0, Mat3::Identity()}};
+  Hash_Map<IndexT, Mat3> rotations;
+  EXPECT_FALSE(AnchoredRotationAveraging(relative_rotations, anchor_rotations, rotations));
+  EXPECT_TRUE(rotations.empty());
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
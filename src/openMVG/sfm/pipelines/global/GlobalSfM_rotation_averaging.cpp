@@ -45,13 +45,11 @@ bool GlobalSfM_Rotation_AveragingSolver::Run(
       //-------------------
       // Triplet inference (test over the composition error)
       //-------------------
-      Pair_Set pairs = getPairs(relativeRotations);
-      std::vector<graph::Triplet> vec_triplets = graph::TripletListing(pairs);
-
       //-- Rejection triplet that are 'not' identity rotation (error to identity > 5°)
-      TripletRotationRejection(5.0f, vec_triplets, relativeRotations);
+      std::vector<graph::Triplet> vec_validated_triplets;
+      TripletRotationRejection(5.0f, vec_validated_triplets, relativeRotations);
 
-      pairs = getPairs(relativeRotations);
+      const Pair_Set pairs = getPairs(relativeRotations);
       const std::set<IndexT> set_remainingIds = graph::CleanGraph_KeepLargestBiEdge_Nodes<Pair_Set, IndexT>(pairs);
       if (set_remainingIds.empty())
         return false;
@@ -156,67 +154,82 @@ bool GlobalSfM_Rotation_AveragingSolver::Run(
 ///  angular error once rotation composition have been computed.
 void GlobalSfM_Rotation_AveragingSolver::TripletRotationRejection(
   const double max_angular_error,
-  std::vector<graph::Triplet> & vec_triplets,
+  std::vector<graph::Triplet> & vec_validated_triplets,
   RelativeRotations & relativeRotations) const
 {
   const size_t edges_start_count = relativeRotations.size();
 
-  RelativeRotations_map map_relatives = getMap(relativeRotations);
-  RelativeRotations_map map_relatives_validated;
+  // The view graph edges are indexed as the relative rotations
+  std::vector<Pair> edges;
+  edges.reserve(relativeRotations.size());
+  for (const RelativeRotation & rel : relativeRotations)
+    edges.emplace_back(rel.i, rel.j);
+  const graph::DegreeOrderedGraph view_graph(edges);
 
   //--
   // ROTATION OUTLIERS DETECTION
   //--
 
-  std::vector<graph::Triplet> vec_triplets_validated;
-  vec_triplets_validated.reserve(vec_triplets.size());
-
+  // The triplets are listed in parallel and their composition error is
+  //  computed on the fly (thread local buffers, no relative rotation lookup)
+  using TripletWithEdges = std::pair<graph::Triplet, graph::DegreeOrderedGraph::TripletEdges>;
+  std::vector<TripletWithEdges> vec_triplets_validated;
   std::vector<float> vec_errToIdentityPerTriplet;
-  vec_errToIdentityPerTriplet.reserve(vec_triplets.size());
-  // Compute the composition error for each length 3 cycles
-  for (size_t i = 0; i < vec_triplets.size(); ++i)
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel
+#endif
   {
-    const graph::Triplet & triplet = vec_triplets[i];
-    const IndexT I = triplet.i, J = triplet.j , K = triplet.k;
-
-    //-- Find the three relative rotations
-    const Pair ij(I,J), ji(J,I);
-    const Mat3 RIJ = (map_relatives.count(ij)) ?
-      map_relatives.at(ij).Rij : Mat3(map_relatives.at(ji).Rij.transpose());
-
-    const Pair jk(J,K), kj(K,J);
-    const Mat3 RJK = (map_relatives.count(jk)) ?
-      map_relatives.at(jk).Rij : Mat3(map_relatives.at(kj).Rij.transpose());
-
-    const Pair ki(K,I), ik(I,K);
-    const Mat3 RKI = (map_relatives.count(ki)) ?
-      map_relatives.at(ki).Rij : Mat3(map_relatives.at(ik).Rij.transpose());
-
-    const Mat3 Rot_To_Identity = RIJ * RJK * RKI; // motion composition
-    const float angularErrorDegree = static_cast<float>(R2D(getRotationMagnitude(Rot_To_Identity)));
-    vec_errToIdentityPerTriplet.push_back(angularErrorDegree);
-
-    if (angularErrorDegree < max_angular_error)
+    std::vector<TripletWithEdges> thread_triplets_validated;
+    std::vector<float> thread_errToIdentityPerTriplet;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic, 64) nowait
+#endif
+    for (int node_rank = 0; node_rank < static_cast<int>(view_graph.NumNodes()); ++node_rank)
+    {
+      view_graph.VisitTriplets(node_rank,
+        [&](const graph::Triplet & triplet, const graph::DegreeOrderedGraph::TripletEdges & triplet_edges)
+        {
+          //-- The three relative rotations: (I,J), (J,K), (I,K)
+          const RelativeRotation & rel_ij = relativeRotations[triplet_edges[0]];
+          const RelativeRotation & rel_jk = relativeRotations[triplet_edges[1]];
+          const RelativeRotation & rel_ik = relativeRotations[triplet_edges[2]];
+          const Mat3 RIJ = (rel_ij.i == triplet.i) ? rel_ij.Rij : Mat3(rel_ij.Rij.transpose());
+          const Mat3 RJK = (rel_jk.i == triplet.j) ? rel_jk.Rij : Mat3(rel_jk.Rij.transpose());
+          const Mat3 RKI = (rel_ik.i == triplet.k) ? rel_ik.Rij : Mat3(rel_ik.Rij.transpose());
+
+          const Mat3 Rot_To_Identity = RIJ * RJK * RKI; // motion composition
+          const float angularErrorDegree = static_cast<float>(R2D(getRotationMagnitude(Rot_To_Identity)));
+          thread_errToIdentityPerTriplet.push_back(angularErrorDegree);
+
+          if (angularErrorDegree < max_angular_error)
+            thread_triplets_validated.emplace_back(triplet, triplet_edges);
+        });
+    }
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp critical
+#endif
     {
-      vec_triplets_validated.push_back(triplet);
-
-      if (map_relatives.count(ij))
-        map_relatives_validated[ij] = map_relatives.at(ij);
-      else
-        map_relatives_validated[ji] = map_relatives.at(ji);
-
-      if (map_relatives.count(jk))
-        map_relatives_validated[jk] = map_relatives.at(jk);
-      else
-        map_relatives_validated[kj] = map_relatives.at(kj);
-
-      if (map_relatives.count(ki))
-        map_relatives_validated[ki] = map_relatives.at(ki);
-      else
-        map_relatives_validated[ik] = map_relatives.at(ik);
+      vec_triplets_validated.insert(vec_triplets_validated.end(),
+        thread_triplets_validated.cbegin(), thread_triplets_validated.cend());
+      vec_errToIdentityPerTriplet.insert(vec_errToIdentityPerTriplet.end(),
+        thread_errToIdentityPerTriplet.cbegin(), thread_errToIdentityPerTriplet.cend());
     }
   }
-  map_relatives = std::move(map_relatives_validated);
+  const size_t triplets_count = vec_errToIdentityPerTriplet.size();
+
+  // Keep the edges used by a validated triplet
+  std::vector<bool> vec_edge_validated(relativeRotations.size(), false);
+  for (const TripletWithEdges & triplet_it : vec_triplets_validated)
+  {
+    for (const IndexT edge_index : triplet_it.second)
+      vec_edge_validated[edge_index] = true;
+  }
+  RelativeRotations_map map_relatives;
+  for (size_t i = 0; i < relativeRotations.size(); ++i)
+  {
+    if (vec_edge_validated[i])
+      map_relatives[{relativeRotations[i].i, relativeRotations[i].j}] = relativeRotations[i];
+  }
 
   // update to keep only useful triplets
   relativeRotations.clear();
@@ -225,11 +238,12 @@ void GlobalSfM_Rotation_AveragingSolver::TripletRotationRejection(
   std::transform(map_relatives.cbegin(), map_relatives.cend(), std::inserter(used_pairs, used_pairs.begin()), stl::RetrieveKey());
 
   // Display statistics about rotation triplets error:
+  // (sorted first, since the threads append the errors in any order)
+  std::sort(vec_errToIdentityPerTriplet.begin(), vec_errToIdentityPerTriplet.end());
+
   std::cout << "\nStatistics about rotation triplets:" << std::endl;
   minMaxMeanMedian<float>(vec_errToIdentityPerTriplet.cbegin(), vec_errToIdentityPerTriplet.cend());
 
-  std::sort(vec_errToIdentityPerTriplet.begin(), vec_errToIdentityPerTriplet.end());
-
   if (!vec_errToIdentityPerTriplet.empty())
   {
     Histogram<float> histo(0.0f, *max_element(vec_errToIdentityPerTriplet.cbegin(), vec_errToIdentityPerTriplet.cend()), 20);
@@ -239,11 +253,21 @@ void GlobalSfM_Rotation_AveragingSolver::TripletRotationRejection(
 
   {
     std::cout << "\nTriplets filtering based on composition error on unit cycles\n";
-    std::cout << "#Triplets before: " << vec_triplets.size() << "\n"
+    std::cout << "#Triplets before: " << triplets_count << "\n"
     << "#Triplets after: " << vec_triplets_validated.size() << std::endl;
   }
 
-  vec_triplets = std::move(vec_triplets_validated);
+  // Return the validated triplets (in lexicographic order)
+  std::sort(vec_triplets_validated.begin(), vec_triplets_validated.end(),
+    [](const TripletWithEdges & lhs, const TripletWithEdges & rhs)
+    {
+      return std::tie(lhs.first.i, lhs.first.j, lhs.first.k)
+        < std::tie(rhs.first.i, rhs.first.j, rhs.first.k);
+    });
+  vec_validated_triplets.clear();
+  vec_validated_triplets.reserve(vec_triplets_validated.size());
+  for (const TripletWithEdges & triplet_it : vec_triplets_validated)
+    vec_validated_triplets.push_back(triplet_it.first);
 
   const size_t edges_end_count = relativeRotations.size();
   std::cout << "\n #Edges removed by triplet inference: " << edges_start_count - edges_end_count << std::endl;
@@ -51,9 +51,15 @@ public:
 
   /// Reject edges of the view graph that do not produce triplets with tiny
   ///  angular error once rotation composition have been computed.
+  /// The triplets of the relative rotations graph are listed and checked in
+  ///  parallel (no input triplet list).
+  /// @param[in] max_angular_error maximal composition error of a valid triplet (degree)
+  /// @param[out] vec_validated_triplets the validated triplets (lexicographic order)
+  /// @param[in,out] relativeRotations the relative rotations, only the ones used
+  ///  by a validated triplet are kept
   void TripletRotationRejection(
     const double max_angular_error,
-    std::vector<graph::Triplet> & vec_triplets,
+    std::vector<graph::Triplet> & vec_validated_triplets,
     rotation_averaging::RelativeRotations & relativeRotations) const;
 
   /// Return the pairs validated by the GlobalRotation routine (inference can remove some)
@@ -221,6 +221,29 @@ bool GlobalSfM_Translation_AveragingSolver::Translation_averaging(
       }
       break;
 
+      case TRANSLATION_AVERAGING_L1_ADMM:
+      {
+        std::vector<Vec3> vec_translations;
+        if (!solve_translations_problem_l1_admm(
+          vec_relative_motion_cpy, vec_translations, l1_admm_options_))
+        {
+          std::cerr << "Compute global translations: failed" << std::endl;
+          return false;
+        }
+        std::cout << " timing (s): " << timerLP_translation.elapsed() << "." << std::endl;
+
+        // A valid solution was found:
+        // - Update the view poses according the found camera translations
+        for (size_t i = 0; i < iNview; ++i)
+        {
+          const Vec3 & t = vec_translations[i];
+          const IndexT pose_id = reindex_backward[i];
+          const Mat3 & Ri = map_globalR.at(pose_id);
+          sfm_data.poses[pose_id] = Pose3(Ri, -Ri.transpose()*t);
+        }
+      }
+      break;
+
       case TRANSLATION_AVERAGING_L2_DISTANCE_CHORDAL:
       {
         std::vector<int> vec_edges;
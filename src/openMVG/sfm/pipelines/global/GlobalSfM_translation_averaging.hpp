@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "openMVG/multiview/translation_averaging_common.hpp"
+#include "openMVG/multiview/translation_averaging_solver.hpp"
 #include "openMVG/tracks/tracks.hpp"
 
 namespace openMVG { namespace graph { struct Triplet; } }
@@ -28,7 +29,8 @@ enum ETranslationAveragingMethod
 {
   TRANSLATION_AVERAGING_L1 = 1,
   TRANSLATION_AVERAGING_L2_DISTANCE_CHORDAL = 2,
-  TRANSLATION_AVERAGING_SOFTL1 = 3
+  TRANSLATION_AVERAGING_SOFTL1 = 3,
+  TRANSLATION_AVERAGING_L1_ADMM = 4
 };
 
 struct SfM_Data;
@@ -38,9 +40,16 @@ struct Features_Provider;
 class GlobalSfM_Translation_AveragingSolver
 {
   std::vector<RelativeInfo_Vec> vec_relative_motion_;
+  L1_ADMM_Translation_Averaging_Options l1_admm_options_;
 
 public:
 
+  /// Set the options of the TRANSLATION_AVERAGING_L1_ADMM solver
+  void SetL1_ADMM_Options(const L1_ADMM_Translation_Averaging_Options & options)
+  {
+    l1_admm_options_ = options;
+  }
+
   bool Run(
     ETranslationAveragingMethod eTranslationAveragingMethod,
     openMVG::sfm::SfM_Data & sfm_data,
@@ -242,6 +242,126 @@ TEST(GLOBAL_SFM, RotationAveragingL2_TranslationAveragingSoftL1) {
   EXPECT_TRUE( IsTracksOneCC(sfmEngine.Get_SfM_Data()));
 }
 
+TEST(GLOBAL_SFM, RotationAveragingL2_TranslationAveragingL1_ADMM) {
+
+  const int nviews = 6;
+  const int npoints = 64;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfM_Data sfm_data_2 = sfm_data;
+  sfm_data_2.poses.clear();
+  sfm_data_2.structure.clear();
+
+  GlobalSfMReconstructionEngine_RelativeMotions sfmEngine(
+    sfm_data_2,
+    "./",
+    stlplus::create_filespec("./", "Reconstruction_Report.html"));
+
+  // Configure the features_provider & the matches_provider from the synthetic dataset
+  std::shared_ptr<Features_Provider> feats_provider =
+    std::make_shared<Synthetic_Features_Provider>();
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+  dynamic_cast<Synthetic_Features_Provider*>(feats_provider.get())->load(d,distribution);
+
+  std::shared_ptr<Matches_Provider> matches_provider =
+    std::make_shared<Synthetic_Matches_Provider>();
+  dynamic_cast<Synthetic_Matches_Provider*>(matches_provider.get())->load(d);
+
+  // Configure data provider (Features and Matches)
+  sfmEngine.SetFeaturesProvider(feats_provider.get());
+  sfmEngine.SetMatchesProvider(matches_provider.get());
+
+  // Configure reconstruction parameters (intrinsic parameters are held constant)
+  sfmEngine.Set_Intrinsics_Refinement_Type(cameras::Intrinsic_Parameter_Type::NONE);
+
+  // Configure motion averaging methods
+  sfmEngine.SetRotationAveragingMethod(ROTATION_AVERAGING_L2);
+  sfmEngine.SetTranslationAveragingMethod(TRANSLATION_AVERAGING_L1_ADMM);
+
+  EXPECT_TRUE (sfmEngine.Process());
+
+  const double dResidual = RMSE(sfmEngine.Get_SfM_Data());
+  std::cout << "RMSE residual: " << dResidual << std::endl;
+  EXPECT_TRUE( dResidual < 0.5);
+  EXPECT_EQ( nviews, sfmEngine.Get_SfM_Data().GetPoses().size());
+  EXPECT_EQ( npoints, sfmEngine.Get_SfM_Data().GetLandmarks().size());
+  EXPECT_TRUE( IsTracksOneCC(sfmEngine.Get_SfM_Data()));
+}
+
+TEST(GLOBAL_SFM, Incremental_Add_Views) {
+
+  const int nviews = 6;
+  const int npoints = 64;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  // Previous reconstruction: the first four views only
+  const IndexT nviews_previous = 4;
+  SfM_Data sfm_data_2 = sfm_data;
+  for (IndexT i = nviews_previous; i < nviews; ++i)
+    sfm_data_2.poses.erase(i);
+  for (auto & landmark_it : sfm_data_2.structure)
+    for (IndexT i = nviews_previous; i < nviews; ++i)
+      landmark_it.second.obs.erase(i);
+
+  GlobalSfMReconstructionEngine_RelativeMotions sfmEngine(
+    sfm_data_2,
+    "./",
+    stlplus::create_filespec("./", "Reconstruction_Report.html"));
+
+  // Configure the features_provider & the matches_provider from the synthetic dataset
+  std::shared_ptr<Features_Provider> feats_provider =
+    std::make_shared<Synthetic_Features_Provider>();
+  // Add a tiny noise in 2D observations to make data more realistic
+  std::normal_distribution<double> distribution(0.0,0.5);
+  dynamic_cast<Synthetic_Features_Provider*>(feats_provider.get())->load(d,distribution);
+
+  std::shared_ptr<Matches_Provider> matches_provider =
+    std::make_shared<Synthetic_Matches_Provider>();
+  dynamic_cast<Synthetic_Matches_Provider*>(matches_provider.get())->load(d);
+
+  // Configure data provider (Features and Matches)
+  sfmEngine.SetFeaturesProvider(feats_provider.get());
+  sfmEngine.SetMatchesProvider(matches_provider.get());
+
+  // Configure reconstruction parameters (intrinsic parameters are held constant)
+  sfmEngine.Set_Intrinsics_Refinement_Type(cameras::Intrinsic_Parameter_Type::NONE);
+  sfmEngine.SetIncrementalMode(true);
+
+  EXPECT_TRUE (sfmEngine.Process());
+
+  const double dResidual = RMSE(sfmEngine.Get_SfM_Data());
+  std::cout << "RMSE residual: " << dResidual << std::endl;
+  EXPECT_TRUE( dResidual < 0.5);
+  EXPECT_EQ( nviews, sfmEngine.Get_SfM_Data().GetPoses().size());
+  EXPECT_EQ( npoints, sfmEngine.Get_SfM_Data().GetLandmarks().size());
+  EXPECT_TRUE( IsTracksOneCC(sfmEngine.Get_SfM_Data()));
+  // The previous poses are held as constant
+  for (IndexT i = 0; i < nviews_previous; ++i)
+  {
+    EXPECT_MATRIX_NEAR(sfm_data.poses.at(i).rotation(),
+      sfmEngine.Get_SfM_Data().poses.at(i).rotation(), 1e-12);
+    EXPECT_MATRIX_NEAR(sfm_data.poses.at(i).center(),
+      sfmEngine.Get_SfM_Data().poses.at(i).center(), 1e-12);
+  }
+  // The new poses are registered in the frame of the previous reconstruction
+  const double baseline = (sfm_data.poses.at(1).center() - sfm_data.poses.at(0).center()).norm();
+  for (IndexT i = nviews_previous; i < nviews; ++i)
+  {
+    EXPECT_TRUE((sfm_data.poses.at(i).center()
+      - sfmEngine.Get_SfM_Data().poses.at(i).center()).norm() < 0.01 * baseline);
+  }
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
@@ -12,6 +12,7 @@
 #include "openMVG/graph/graph.hpp"
 #include "openMVG/features/feature.hpp"
 #include "openMVG/matching/indMatch.hpp"
+#include "openMVG/sfm/pipelines/global/GlobalSfM_anchored_averaging.hpp"
 #include "openMVG/sfm/pipelines/global/GlobalSfM_rotation_averaging.hpp"
 #include "openMVG/sfm/pipelines/relative_pose_engine.hpp"
 #include "openMVG/sfm/pipelines/sfm_features_provider.hpp"
@@ -21,6 +22,7 @@
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/sfm/sfm_data_filters.hpp"
 #include "openMVG/sfm/sfm_data_triangulation.hpp"
+#include "openMVG/sfm/sfm_landmark_dense.hpp"
 #include "openMVG/sfm/sfm_filters.hpp"
 #include "openMVG/stl/stl.hpp"
 #include "openMVG/system/timer.hpp"
@@ -33,7 +35,9 @@
 
 #include <ceres/types.h>
 
+#include <algorithm>
 #include <iostream>
+#include <map>
 
 #ifdef _MSC_VER
 #pragma warning( once : 4267 ) //warning C4267: 'argument' : conversion from 'size_t' to 'const int', possible loss of data
@@ -69,6 +73,7 @@ GlobalSfMReconstructionEngine_RelativeMotions::GlobalSfMReconstructionEngine_Rel
   // Set default motion Averaging methods
   eRotation_averaging_method_ = ROTATION_AVERAGING_L2;
   eTranslation_averaging_method_ = TRANSLATION_AVERAGING_L1;
+  b_incremental_ = false;
 }
 
 GlobalSfMReconstructionEngine_RelativeMotions::~GlobalSfMReconstructionEngine_RelativeMotions()
@@ -107,8 +112,27 @@ void GlobalSfMReconstructionEngine_RelativeMotions::SetTranslationAveragingMetho
   eTranslation_averaging_method_ = eTranslationAveragingMethod;
 }
 
+void GlobalSfMReconstructionEngine_RelativeMotions::SetTranslationAveragingL1_ADMM_Options
+(
+  const L1_ADMM_Translation_Averaging_Options & options
+)
+{
+  translation_averaging_l1_admm_options_ = options;
+}
+
+void GlobalSfMReconstructionEngine_RelativeMotions::SetIncrementalMode
+(
+  bool bIncremental
+)
+{
+  b_incremental_ = bIncremental;
+}
+
 bool GlobalSfMReconstructionEngine_RelativeMotions::Process() {
 
+  if (b_incremental_ && !sfm_data_.GetPoses().empty())
+    return Process_Incremental();
+
   //-------------------
   // Keep only the largest biedge connected subgraph
   //-------------------
@@ -292,6 +316,7 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Compute_Global_Translations
 {
   // Translation averaging (compute translations & update them to a global common coordinates system)
   GlobalSfM_Translation_AveragingSolver translation_averaging_solver;
+  translation_averaging_solver.SetL1_ADMM_Options(translation_averaging_l1_admm_options_);
   const bool bTranslationAveraging = translation_averaging_solver.Run(
     eTranslation_averaging_method_,
     sfm_data_,
@@ -416,6 +441,8 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Adjust()
   // Refine sfm_scene (in a 3 iteration process (free the parameters regarding their incertainty order)):
 
   Bundle_Adjustment_Ceres bundle_adjustment_obj;
+  // Columnar copy of the structure shared by the adjustments and the filters (kept in sync)
+  Dense_Landmarks landmarks(sfm_data_.structure);
   // - refine only Structure and translations
   bool b_BA_Status = bundle_adjustment_obj.Adjust
     (
@@ -425,7 +452,8 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Adjust()
         Extrinsic_Parameter_Type::ADJUST_TRANSLATION, // Rotations are held as constant
         Structure_Parameter_Type::ADJUST_ALL,
         Control_Point_Parameter(),
-        this->b_use_motion_prior_)
+        this->b_use_motion_prior_),
+      landmarks
     );
   if (b_BA_Status)
   {
@@ -445,7 +473,8 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Adjust()
           Extrinsic_Parameter_Type::ADJUST_ALL,
           Structure_Parameter_Type::ADJUST_ALL,
           Control_Point_Parameter(),
-          this->b_use_motion_prior_)
+          this->b_use_motion_prior_),
+        landmarks
       );
     if (b_BA_Status && !sLogging_file_.empty())
     {
@@ -465,7 +494,8 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Adjust()
           Extrinsic_Parameter_Type::ADJUST_ALL,
           Structure_Parameter_Type::ADJUST_ALL,
           Control_Point_Parameter(),
-          this->b_use_motion_prior_)
+          this->b_use_motion_prior_),
+        landmarks
       );
     if (b_BA_Status && !sLogging_file_.empty())
     {
@@ -477,9 +507,9 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Adjust()
 
   // Remove outliers (max_angle, residual error)
   const size_t pointcount_initial = sfm_data_.structure.size();
-  RemoveOutliers_PixelResidualError(sfm_data_, 4.0);
+  RemoveOutliers_PixelResidualError(sfm_data_, landmarks, 4.0);
   const size_t pointcount_pixelresidual_filter = sfm_data_.structure.size();
-  RemoveOutliers_AngleError(sfm_data_, 2.0);
+  RemoveOutliers_AngleError(sfm_data_, landmarks, 2.0);
   const size_t pointcount_angular_filter = sfm_data_.structure.size();
   std::cout << "Outlier removal (remaining #points):\n"
     << "\t initial structure size #3DPoints: " << pointcount_initial << "\n"
@@ -496,7 +526,7 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Adjust()
   // Check that poses & intrinsic cover some measures (after outlier removal)
   const IndexT minPointPerPose = 12; // 6 min
   const IndexT minTrackLength = 3; // 2 min
-  if (eraseUnstablePosesAndObservations(sfm_data_, minPointPerPose, minTrackLength))
+  if (eraseUnstablePosesAndObservations(sfm_data_, landmarks, minPointPerPose, minTrackLength))
   {
     // TODO: must ensure that track graph is producing a single connected component
 
@@ -516,7 +546,7 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Adjust()
     Control_Point_Parameter(),
     this->b_use_motion_prior_);
 
-  b_BA_Status = bundle_adjustment_obj.Adjust(sfm_data_, ba_refine_options);
+  b_BA_Status = bundle_adjustment_obj.Adjust(sfm_data_, ba_refine_options, landmarks);
   if (b_BA_Status && !sLogging_file_.empty())
   {
     Save(sfm_data_,
@@ -527,6 +557,380 @@ bool GlobalSfMReconstructionEngine_RelativeMotions::Adjust()
   return b_BA_Status;
 }
 
+/// Incremental mode: add new poses to the existing reconstruction
+bool GlobalSfMReconstructionEngine_RelativeMotions::Process_Incremental()
+{
+  // The poses of the existing reconstruction are the anchors
+  Hash_Map<IndexT, Mat3> anchor_rotations;
+  Hash_Map<IndexT, Vec3> anchor_centers;
+  for (const auto & pose_it : sfm_data_.GetPoses())
+  {
+    anchor_rotations[pose_it.first] = pose_it.second.rotation();
+    anchor_centers[pose_it.first] = pose_it.second.center();
+  }
+
+  // Compute only the relative poses of the pose pairs involving a new pose
+  Pair_Set new_relative_pose_pairs;
+  for (const auto & matches_it : matches_provider_->pairWise_matches_)
+  {
+    const View * view_I = sfm_data_.GetViews().at(matches_it.first.first).get();
+    const View * view_J = sfm_data_.GetViews().at(matches_it.first.second).get();
+    if (view_I->id_pose != view_J->id_pose
+        && (anchor_rotations.count(view_I->id_pose) == 0
+            || anchor_rotations.count(view_J->id_pose) == 0))
+      new_relative_pose_pairs.insert({view_I->id_pose, view_J->id_pose});
+  }
+  if (new_relative_pose_pairs.empty())
+  {
+    std::cout << "GlobalSfM:: No new pose to add to the reconstruction." << std::endl;
+    return true;
+  }
+
+  const Relative_Pose_Engine::Relative_Pair_Poses relative_poses = [&]
+  {
+    Relative_Pose_Engine relative_pose_engine;
+    if (!sOut_directory_.empty())
+      relative_pose_engine.SetCacheFile(
+        stlplus::create_filespec(sOut_directory_, "relative_poses_cache", ".txt"));
+    if (!relative_pose_engine.Process(new_relative_pose_pairs,
+        sfm_data_,
+        matches_provider_,
+        features_provider_))
+      return Relative_Pose_Engine::Relative_Pair_Poses();
+    else
+      return relative_pose_engine.Get_Relative_Poses();
+  }();
+
+  rotation_averaging::RelativeRotations relatives_R;
+  RelativeInfo_Vec relative_motions;
+  for (const auto & relative_pose : relative_poses)
+  {
+    relatives_R.emplace_back(
+      relative_pose.first.first, relative_pose.first.second,
+      relative_pose.second.rotation(),
+      1.f);
+    relative_motions.emplace_back(relative_pose.first,
+      std::make_pair(relative_pose.second.rotation(), relative_pose.second.translation()));
+  }
+
+  // Averaging of the new poses (the existing poses are held as constant)
+  system::Timer t;
+  Hash_Map<IndexT, Mat3> global_rotations;
+  if (!AnchoredRotationAveraging(relatives_R, anchor_rotations, global_rotations))
+  {
+    std::cerr << "GlobalSfM:: Anchored rotation averaging failure!" << std::endl;
+    return false;
+  }
+  global_rotations.insert(anchor_rotations.cbegin(), anchor_rotations.cend());
+  Hash_Map<IndexT, Vec3> new_centers;
+  if (!AnchoredTranslationAveraging(relative_motions, global_rotations, anchor_centers, new_centers))
+  {
+    std::cerr << "GlobalSfM:: Anchored translation averaging failure!" << std::endl;
+    return false;
+  }
+  std::set<IndexT> new_pose_ids;
+  for (const auto & center_it : new_centers)
+  {
+    sfm_data_.poses[center_it.first] = Pose3(global_rotations.at(center_it.first), center_it.second);
+    new_pose_ids.insert(center_it.first);
+  }
+
+  std::cout << "\n-------------------------------" << "\n"
+    << " Incremental global SfM: " << "\n"
+    << "  #anchor poses: " << anchor_rotations.size() << "\n"
+    << "  #new relative poses: " << relative_poses.size() << "\n"
+    << "  #added poses: " << new_pose_ids.size() << "\n"
+    << "  Timing: " << t.elapsed() << " seconds" << std::endl;
+
+  if (!Extend_Structure(new_pose_ids))
+  {
+    std::cerr << "GlobalSfM:: Cannot extend the structure!" << std::endl;
+    return false;
+  }
+  if (!Adjust_Local(new_pose_ids))
+  {
+    std::cerr << "GlobalSfM:: Non-linear local adjustment failure!" << std::endl;
+    return false;
+  }
+
+  if (!sLogging_file_.empty())
+  {
+    Save(sfm_data_,
+      stlplus::create_filespec(stlplus::folder_part(sLogging_file_), "structure_incremental", "ply"),
+      ESfM_Data(EXTRINSICS | STRUCTURE));
+  }
+  return true;
+}
+
+/// Add the observations of the new poses to the structure
+bool GlobalSfMReconstructionEngine_RelativeMotions::Extend_Structure
+(
+  const std::set<IndexT> & new_pose_ids
+)
+{
+  using namespace openMVG::tracks;
+
+  const double max_reprojection_error = 4.0; // pixels
+
+  // Landmark of each existing observation
+  std::map<std::pair<IndexT, IndexT>, IndexT> observation_landmarks;
+  IndexT next_landmark_id = 0;
+  for (const auto & landmark_it : sfm_data_.GetLandmarks())
+  {
+    for (const auto & obs_it : landmark_it.second.obs)
+      observation_landmarks[{obs_it.first, obs_it.second.id_feat}] = landmark_it.first;
+    next_landmark_id = std::max(next_landmark_id, landmark_it.first + 1);
+  }
+
+  // Build tracks from the matches involving a new pose
+  STLMAPTracks map_tracks;
+  {
+    matching::PairWiseMatches new_matches;
+    for (const auto & matches_it : matches_provider_->pairWise_matches_)
+    {
+      const View * view_I = sfm_data_.GetViews().at(matches_it.first.first).get();
+      const View * view_J = sfm_data_.GetViews().at(matches_it.first.second).get();
+      if (sfm_data_.IsPoseAndIntrinsicDefined(view_I)
+          && sfm_data_.IsPoseAndIntrinsicDefined(view_J)
+          && (new_pose_ids.count(view_I->id_pose) || new_pose_ids.count(view_J->id_pose)))
+        new_matches.insert(matches_it);
+    }
+    TracksBuilder tracksBuilder;
+    tracksBuilder.Build(new_matches);
+    tracksBuilder.Filter(2);
+    tracksBuilder.ExportToSTL(map_tracks);
+  }
+
+  const SfM_Data_Structure_Computation_Robust structure_estimator(max_reprojection_error);
+  IndexT extended_landmarks = 0, added_landmarks = 0;
+  for (const auto & track_it : map_tracks)
+  {
+    // Split the track between the observations of existing landmarks and the new observations
+    std::set<IndexT> landmark_ids;
+    Observations new_obs;
+    for (const auto & feature_it : track_it.second)
+    {
+      const auto landmark_it = observation_landmarks.find({feature_it.first, feature_it.second});
+      if (landmark_it != observation_landmarks.cend())
+      {
+        landmark_ids.insert(landmark_it->second);
+      }
+      else
+      {
+        const PointFeature & pt = features_provider_->feats_per_view.at(feature_it.first)[feature_it.second];
+        new_obs[feature_it.first] = Observation(pt.coords().cast<double>(), feature_it.second);
+      }
+    }
+
+    if (landmark_ids.size() == 1)
+    {
+      // Extend the landmark with the new observations that are consistent with it
+      Landmark & landmark = sfm_data_.structure.at(*landmark_ids.cbegin());
+      bool b_extended = false;
+      for (const auto & obs_it : new_obs)
+      {
+        if (landmark.obs.count(obs_it.first))
+          continue;
+        const View * view = sfm_data_.GetViews().at(obs_it.first).get();
+        const IntrinsicBase * cam = sfm_data_.GetIntrinsics().at(view->id_intrinsic).get();
+        const Pose3 pose = sfm_data_.GetPoseOrDie(view);
+        if (CheiralityTest((*cam)(obs_it.second.x), pose, landmark.X)
+            && cam->residual(pose(landmark.X), obs_it.second.x).norm() < max_reprojection_error)
+        {
+          landmark.obs.insert(obs_it);
+          b_extended = true;
+        }
+      }
+      extended_landmarks += b_extended;
+    }
+    else if (landmark_ids.empty() && new_obs.size() >= 3)
+    {
+      // Triangulate a new landmark
+      Landmark landmark;
+      if (structure_estimator.robust_triangulation(sfm_data_, new_obs, landmark))
+      {
+        sfm_data_.structure[next_landmark_id++] = landmark;
+        ++added_landmarks;
+      }
+    }
+    // Tracks linking several landmarks are ambiguous and ignored
+  }
+
+  std::cout << "\n#extended landmarks: " << extended_landmarks << "\n"
+    << "#added landmarks: " << added_landmarks << std::endl;
+  // Not an error: the model is intact (the new poses that observe too few
+  //  landmarks are removed by the local adjustment)
+  if (extended_landmarks + added_landmarks == 0)
+    std::cout << "No new observation passed the checks, the structure is unchanged." << std::endl;
+  return true;
+}
+
+/// Adjust the new poses and the landmarks they observe (& remove outliers)
+bool GlobalSfMReconstructionEngine_RelativeMotions::Adjust_Local
+(
+  const std::set<IndexT> & new_pose_ids
+)
+{
+  // The existing poses are anchors: only the new poses are adjusted
+  std::set<IndexT> adjusted_pose_ids = new_pose_ids;
+
+  // Local scene: the landmarks observed by an adjusted pose, with the poses
+  //  and intrinsics of their observations (the other poses are constant)
+  const auto build_local_scene = [&](SfM_Data & local_scene, std::set<IndexT> & constant_pose_ids)
+  {
+    local_scene.views = sfm_data_.views;
+    for (const auto & landmark_it : sfm_data_.GetLandmarks())
+    {
+      const Observations & obs = landmark_it.second.obs;
+      const bool b_adjusted = std::any_of(obs.cbegin(), obs.cend(),
+        [&](const Observations::value_type & obs_it)
+        {
+          return adjusted_pose_ids.count(sfm_data_.GetViews().at(obs_it.first)->id_pose) == 1;
+        });
+      if (!b_adjusted)
+        continue;
+      local_scene.structure.insert(landmark_it);
+      for (const auto & obs_it : obs)
+      {
+        const View * view = sfm_data_.GetViews().at(obs_it.first).get();
+        local_scene.poses[view->id_pose] = sfm_data_.GetPoses().at(view->id_pose);
+        local_scene.intrinsics[view->id_intrinsic] = sfm_data_.GetIntrinsics().at(view->id_intrinsic);
+        if (adjusted_pose_ids.count(view->id_pose) == 0)
+          constant_pose_ids.insert(view->id_pose);
+      }
+    }
+  };
+
+  // Adjust the new poses and the landmarks they observe, the other poses
+  //  observing these landmarks are held as constant
+  const auto adjust = [&]() -> bool
+  {
+    SfM_Data local_scene;
+    // Motion priors are not used since they could move the constant poses
+    Optimize_Options options(
+      Intrinsic_Parameter_Type::NONE, // Intrinsics are held as constant
+      Extrinsic_Parameter_Type::ADJUST_ALL,
+      Structure_Parameter_Type::ADJUST_ALL,
+      Control_Point_Parameter(),
+      false);
+    build_local_scene(local_scene, options.constant_pose_ids);
+
+    std::cout << "\nLocal adjustment: #adjusted poses: " << adjusted_pose_ids.size()
+      << ", #constant poses: " << options.constant_pose_ids.size()
+      << ", #landmarks: " << local_scene.structure.size() << std::endl;
+    // No landmark is observed by the new poses: nothing to adjust
+    if (local_scene.structure.empty())
+      return true;
+
+    Bundle_Adjustment_Ceres bundle_adjustment_obj;
+    if (!bundle_adjustment_obj.Adjust(local_scene, options))
+      return false;
+
+    for (const auto & pose_it : local_scene.GetPoses())
+      if (adjusted_pose_ids.count(pose_it.first))
+        sfm_data_.poses[pose_it.first] = pose_it.second;
+    for (const auto & landmark_it : local_scene.GetLandmarks())
+      sfm_data_.structure[landmark_it.first].X = landmark_it.second.X;
+    return true;
+  };
+
+  if (!adjust())
+    return false;
+
+  // Remove outliers (max_angle, residual error) among the landmarks of the local scene
+  //  (the landmarks that are not observed by a new pose are left untouched)
+  {
+    SfM_Data local_scene;
+    std::set<IndexT> constant_pose_ids;
+    build_local_scene(local_scene, constant_pose_ids);
+    std::vector<IndexT> local_landmark_ids;
+    local_landmark_ids.reserve(local_scene.structure.size());
+    for (const auto & landmark_it : local_scene.GetLandmarks())
+      local_landmark_ids.push_back(landmark_it.first);
+
+    Dense_Landmarks landmarks(local_scene.structure);
+    const size_t pointcount_initial = local_scene.structure.size();
+    RemoveOutliers_PixelResidualError(local_scene, landmarks, 4.0);
+    const size_t pointcount_pixelresidual_filter = local_scene.structure.size();
+    RemoveOutliers_AngleError(local_scene, landmarks, 2.0);
+    const size_t pointcount_angular_filter = local_scene.structure.size();
+    std::cout << "Outlier removal (remaining #points of the local scene):\n"
+      << "\t initial structure size #3DPoints: " << pointcount_initial << "\n"
+      << "\t\t pixel residual filter  #3DPoints: " << pointcount_pixelresidual_filter << "\n"
+      << "\t\t angular filter         #3DPoints: " << pointcount_angular_filter << std::endl;
+
+    // Report the removed landmarks and observations to the scene
+    for (const IndexT landmark_id : local_landmark_ids)
+    {
+      const auto it = local_scene.structure.find(landmark_id);
+      if (it == local_scene.structure.end())
+        sfm_data_.structure.erase(landmark_id);
+      else
+        sfm_data_.structure.at(landmark_id).obs = std::move(it->second.obs);
+    }
+  }
+
+  // Check that the new poses cover some measures (after outlier removal).
+  // Only the new poses can be removed: all their observations belong to the
+  //  local scene, contrary to the ones of the constant poses.
+  const IndexT minPointPerPose = 12; // 6 min
+  const IndexT minTrackLength = 3; // 2 min
+  bool b_removed_pose = false;
+  do
+  {
+    Hash_Map<IndexT, IndexT> point_count_per_pose;
+    for (const auto & landmark_it : sfm_data_.GetLandmarks())
+    {
+      for (const auto & obs_it : landmark_it.second.obs)
+      {
+        const IndexT pose_id = sfm_data_.GetViews().at(obs_it.first)->id_pose;
+        if (adjusted_pose_ids.count(pose_id))
+          ++point_count_per_pose[pose_id];
+      }
+    }
+    std::set<IndexT> removed_pose_ids;
+    for (const IndexT pose_id : adjusted_pose_ids)
+    {
+      const auto it = point_count_per_pose.find(pose_id);
+      if (it == point_count_per_pose.end() || it->second < minPointPerPose)
+        removed_pose_ids.insert(pose_id);
+    }
+    b_removed_pose = !removed_pose_ids.empty();
+    if (!b_removed_pose)
+      break;
+
+    // Remove the poses, their observations and the landmarks that became too short
+    for (const IndexT pose_id : removed_pose_ids)
+    {
+      sfm_data_.poses.erase(pose_id);
+      adjusted_pose_ids.erase(pose_id);
+    }
+    for (auto landmark_it = sfm_data_.structure.begin(); landmark_it != sfm_data_.structure.end();)
+    {
+      Observations & obs = landmark_it->second.obs;
+      bool b_modified = false;
+      for (auto obs_it = obs.begin(); obs_it != obs.end();)
+      {
+        if (removed_pose_ids.count(sfm_data_.GetViews().at(obs_it->first)->id_pose))
+        {
+          obs_it = obs.erase(obs_it);
+          b_modified = true;
+        }
+        else
+          ++obs_it;
+      }
+      if (b_modified && obs.size() < minTrackLength)
+        landmark_it = sfm_data_.structure.erase(landmark_it);
+      else
+        ++landmark_it;
+    }
+  }
+  while (b_removed_pose && !adjusted_pose_ids.empty());
+
+  // Refine one more time, since some outliers have been removed
+  return adjust();
+}
+
 void GlobalSfMReconstructionEngine_RelativeMotions::Compute_Relative_Rotations
 (
   rotation_averaging::RelativeRotations & vec_relatives_R
@@ -536,6 +940,10 @@ void GlobalSfMReconstructionEngine_RelativeMotions::Compute_Relative_Rotations
   const Relative_Pose_Engine::Relative_Pair_Poses relative_poses = [&]
   {
     Relative_Pose_Engine relative_pose_engine;
+    // Reuse the relative poses of a previous run (i.e. with other averaging settings)
+    if (!sOut_directory_.empty())
+      relative_pose_engine.SetCacheFile(
+        stlplus::create_filespec(sOut_directory_, "relative_poses_cache", ".txt"));
     if (!relative_pose_engine.Process(sfm_data_,
         matches_provider_,
         features_provider_))
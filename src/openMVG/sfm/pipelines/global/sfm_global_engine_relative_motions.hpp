@@ -10,6 +10,7 @@
 #define OPENMVG_SFM_GLOBAL_ENGINE_RELATIVE_MOTIONS_HPP
 
 #include <memory>
+#include <set>
 #include <string>
 
 #include "openMVG/sfm/pipelines/global/GlobalSfM_rotation_averaging.hpp"
@@ -43,6 +44,14 @@ public:
 
   void SetRotationAveragingMethod(ERotationAveragingMethod eRotationAveragingMethod);
   void SetTranslationAveragingMethod(ETranslationAveragingMethod eTranslation_averaging_method_);
+  /// Options of the TRANSLATION_AVERAGING_L1_ADMM translation averaging method
+  void SetTranslationAveragingL1_ADMM_Options(const L1_ADMM_Translation_Averaging_Options & options);
+
+  /// Incremental mode: if the input scene has poses, they are kept fixed (anchors)
+  ///  and only the poses of the other views are estimated, from the relative
+  ///  motions that involve them. The structure is extended and the bundle
+  ///  adjustment is limited to the new poses and the landmarks they observe.
+  void SetIncrementalMode(bool bIncremental);
 
   bool Process() override;
 
@@ -70,6 +79,24 @@ protected:
   // Adjust the scene (& remove outliers)
   bool Adjust();
 
+  /// Incremental mode: add new poses to the existing reconstruction
+  bool Process_Incremental();
+
+  /// Add the observations of the new poses to the structure
+  ///  (extend the existing landmarks or triangulate new ones).
+  /// Adding no observation is not a failure (the structure is unchanged).
+  bool Extend_Structure
+  (
+    const std::set<IndexT> & new_pose_ids
+  );
+
+  /// Adjust the new poses and the landmarks they observe (& remove outliers),
+  ///  the other poses are held as constant
+  bool Adjust_Local
+  (
+    const std::set<IndexT> & new_pose_ids
+  );
+
 private:
   /// Compute relative rotations
   void Compute_Relative_Rotations
@@ -88,6 +115,8 @@ private:
   // Parameter
   ERotationAveragingMethod eRotation_averaging_method_;
   ETranslationAveragingMethod eTranslation_averaging_method_;
+  L1_ADMM_Translation_Averaging_Options translation_averaging_l1_admm_options_;
+  bool b_incremental_;
 
   //-- Data provider
   Features_Provider  * features_provider_;
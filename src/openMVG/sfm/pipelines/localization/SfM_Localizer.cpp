@@ -111,7 +111,8 @@ namespace sfm {
     const Pair & image_size,
     const cameras::IntrinsicBase * optional_intrinsics,
     Image_Localizer_Match_Data & resection_data,
-    geometry::Pose3 & pose
+    geometry::Pose3 & pose,
+    std::ostream & log
   )
   {
     // --
@@ -299,7 +300,7 @@ namespace sfm {
       pose = geometry::Pose3(R, -R.transpose() * t);
     }
 
-    std::cout << "\n"
+    log << "\n"
       << "-------------------------------" << "\n"
       << "-- Robust Resection " << "\n"
       << "-- Resection status: " << bResection << "\n"
@@ -317,7 +318,9 @@ namespace sfm {
     geometry::Pose3 & pose,
     Image_Localizer_Match_Data & matching_data,
     bool b_refine_pose,
-    bool b_refine_intrinsic
+    bool b_refine_intrinsic,
+    bool b_verbose,
+    bool b_multithreaded
   )
   {
     if (!b_refine_pose && !b_refine_intrinsic)
@@ -352,7 +355,8 @@ namespace sfm {
       (b_refine_pose) ? Extrinsic_Parameter_Type::ADJUST_ALL : Extrinsic_Parameter_Type::NONE,
       Structure_Parameter_Type::NONE // STRUCTURE must remain constant
     );
-    Bundle_Adjustment_Ceres bundle_adjustment_obj;
+    Bundle_Adjustment_Ceres bundle_adjustment_obj(
+      Bundle_Adjustment_Ceres::BA_Ceres_options(b_verbose, b_multithreaded));
     const bool b_BA_Status = bundle_adjustment_obj.Adjust(
       sfm_data,
       ba_refine_options);
@@ -9,6 +9,7 @@
 #ifndef OPENMVG_SFM_PIPELINES_LOCALIZATION_SFM_LOCALIZER_HPP
 #define OPENMVG_SFM_PIPELINES_LOCALIZATION_SFM_LOCALIZER_HPP
 
+#include <iostream>
 #include <limits>
 #include <vector>
 
@@ -85,6 +86,7 @@ public:
   * @param[in] optional_intrinsics camera intrinsic if known (else nullptr)
   * @param[in,out] resection_data matching data (with filled 2D-3D correspondences)
   * @param[out] pose found pose
+  * @param[out] log stream used for the resection report
   * @return True if a putative pose has been estimated
   */
   static bool Localize
@@ -93,7 +95,8 @@ public:
     const Pair & image_size,
     const cameras::IntrinsicBase * optional_intrinsics,
     Image_Localizer_Match_Data & resection_data,
-    geometry::Pose3 & pose
+    geometry::Pose3 & pose,
+    std::ostream & log = std::cout
   );
 
   /**
@@ -104,6 +107,8 @@ public:
   * @param[in] matching_data Corresponding 2D-3D data
   * @param[in] b_refine_pose tell if pose must be refined
   * @param[in] b_refine_intrinsic tell if intrinsics must be refined
+  * @param[in] b_verbose tell if the bundle adjustment statistics are displayed
+  * @param[in] b_multithreaded tell if the bundle adjustment can use many threads
   * @return True if the refinement decreased the RMSE pixel residual error
   */
   static bool RefinePose
@@ -112,7 +117,9 @@ public:
     geometry::Pose3 & pose,
     Image_Localizer_Match_Data & matching_data,
     bool b_refine_pose,
-    bool b_refine_intrinsic
+    bool b_refine_intrinsic,
+    bool b_verbose = true,
+    bool b_multithreaded = true
   );
 };
 
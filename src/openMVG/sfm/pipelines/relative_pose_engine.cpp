@@ -8,18 +8,19 @@
 
 #include "openMVG/sfm/pipelines/relative_pose_engine.hpp"
 
-#include "openMVG/multiview/essential.hpp"
-#include "openMVG/multiview/triangulation.hpp"
 #include "openMVG/sfm/pipelines/sfm_robust_model_estimation.hpp"
 #include "openMVG/sfm/pipelines/sfm_features_provider.hpp"
 #include "openMVG/sfm/pipelines/sfm_matches_provider.hpp"
+#include "openMVG/sfm/pipelines/two_view_refinement.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
-#include "openMVG/sfm/sfm_data_BA_ceres.hpp"
-#include "openMVG/sfm/sfm_data_io.hpp"
-#include "openMVG/sfm/sfm_data_triangulation.hpp"
+#include "openMVG/stl/hash.hpp"
 #include "openMVG/system/timer.hpp"
 
-#include "ceres/ceres.h"
+#include "third_party/progress/progress_display.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
 
 namespace openMVG {
 namespace sfm {
@@ -75,23 +76,41 @@ bool Relative_Pose_Engine::Relative_Pose_Engine::Process(
       posewise_matches[{v1->id_pose, v2->id_pose}].insert(pair);
   }
 
+  // Reload the relative poses computed by a previous run
+  Relative_Pose_Cache cache;
+  if (!cache_filename_.empty())
+  {
+    LoadCache(cache_filename_, cache);
+  }
+  Relative_Pose_Cache computed_poses;
+  int reused_poses_count = 0;
+
+  std::vector<PoseWiseMatches::const_iterator> pose_pairs;
+  pose_pairs.reserve(posewise_matches.size());
+  for (auto iter = posewise_matches.cbegin(); iter != posewise_matches.cend(); ++iter)
+    pose_pairs.push_back(iter);
+
   system::Timer t;
 
   std::unique_ptr<C_Progress> progress_status
     (new C_Progress_display(posewise_matches.size(),
       std::cout, "\n- Relative pose computation -\n" ));
 
-  #ifdef OPENMVG_USE_OPENMP
-    #pragma omp parallel for schedule(dynamic)
-  #endif
-  // Compute the relative pose from pairwise point matches:
-  for (int i = 0; i < static_cast<int>(posewise_matches.size()); ++i)
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel
+#endif
   {
-    ++(*progress_status);
+    // Per thread refinement buffers
+    Two_View_Refiner refiner;
+
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    // Compute the relative pose from pairwise point matches:
+    for (int i = 0; i < static_cast<int>(pose_pairs.size()); ++i)
     {
-      PoseWiseMatches::const_iterator iter (posewise_matches.begin());
-      std::advance(iter, i);
-      const auto & relative_pose_iterator(*iter);
+      ++(*progress_status);
+      const auto & relative_pose_iterator(*pose_pairs[i]);
       const Pair relative_pose_pair = relative_pose_iterator.first;
       const Pair_Set & match_pairs = relative_pose_iterator.second;
 
@@ -127,8 +146,27 @@ bool Relative_Pose_Engine::Relative_Pose_Engine::Process(
         * cam_I = sfm_data_.GetIntrinsics().at(view_I->id_intrinsic).get(),
         * cam_J = sfm_data_.GetIntrinsics().at(view_J->id_intrinsic).get();
 
-      // Compute for each feature the un-distorted camera coordinates
       const matching::IndMatches & matches = matches_provider_->pairWise_matches_.at(current_pair);
+
+      // Reuse the relative pose of a previous run if its input data did not change
+      Cached_Relative_Pose relative_pose;
+      relative_pose.signature = Signature(I, J, *cam_I, *cam_J, matches, *features_provider_);
+      const auto cached_pose = cache.find(relative_pose_pair);
+      if (cached_pose != cache.cend()
+          && cached_pose->second.signature == relative_pose.signature)
+      {
+#ifdef OPENMVG_USE_OPENMP
+        #pragma omp critical
+#endif
+        {
+          if (cached_pose->second.is_valid)
+            relative_poses_[relative_pose_pair] = cached_pose->second.pose;
+          ++reused_poses_count;
+        }
+        continue;
+      }
+
+      // Compute for each feature the un-distorted camera coordinates
       size_t number_matches = matches.size();
       Mat2X x1(2, number_matches), x2(2, number_matches);
       number_matches = 0;
@@ -142,90 +180,149 @@ bool Relative_Pose_Engine::Relative_Pose_Engine::Process(
 
       RelativePose_Info relativePose_info;
       relativePose_info.initial_residual_tolerance = Square(2.5);
-      if (!robustRelativePose(cam_I, cam_J,
-                              x1, x2, relativePose_info,
-                              {cam_I->w(), cam_I->h()},
-                              {cam_J->w(), cam_J->h()},
-                              256))
-      {
-        continue;
-      }
-      const bool bRefine_using_BA = true;
-      if (bRefine_using_BA)
+      if (robustRelativePose(cam_I, cam_J,
+                             x1, x2, relativePose_info,
+                             {cam_I->w(), cam_I->h()},
+                             {cam_J->w(), cam_J->h()},
+                             256))
       {
-        // Refine the defined scene
-        SfM_Data tiny_scene;
-        tiny_scene.views.insert(*sfm_data_.GetViews().find(view_I->id_view));
-        tiny_scene.views.insert(*sfm_data_.GetViews().find(view_J->id_view));
-        tiny_scene.intrinsics.insert(*sfm_data_.GetIntrinsics().find(view_I->id_intrinsic));
-        tiny_scene.intrinsics.insert(*sfm_data_.GetIntrinsics().find(view_J->id_intrinsic));
-
-        // Init poses
-        const Pose3 & pose_I = tiny_scene.poses[view_I->id_pose] = {Mat3::Identity(), Vec3::Zero()};
-        const Pose3 & pose_J = tiny_scene.poses[view_J->id_pose] = relativePose_info.relativePose;
-
-        // Init structure
-        Landmarks & landmarks = tiny_scene.structure;
-        for (Mat::Index k = 0; k < x1.cols(); ++k)
+        // Refine the relative pose and the structure of the inliers
+        Mat2X x1_inliers(2, relativePose_info.vec_inliers.size()),
+              x2_inliers(2, relativePose_info.vec_inliers.size());
+        for (size_t k = 0; k < relativePose_info.vec_inliers.size(); ++k)
         {
-          Vec3 X;
-          if (Triangulate2View
-          (
-            pose_I.rotation(), pose_I.translation(), (*cam_I)(x1.col(k)),
-            pose_J.rotation(), pose_J.translation(), (*cam_J)(x2.col(k)),
-            X,
-            triangulation_method_
-          ))
-          {
-            Observations obs;
-            const Vec2 obs_I = features_provider_->feats_per_view.at(I)[matches[k].i_].coords().cast<double>();
-            const Vec2 obs_J = features_provider_->feats_per_view.at(J)[matches[k].j_].coords().cast<double>();
-            obs[view_I->id_view] = {obs_I, matches[k].i_};
-            obs[view_J->id_view] = {obs_J, matches[k].j_};
-            landmarks[k].obs = obs;
-            landmarks[k].X = X;
-          }
-        }
-        // - refine only Structure and Rotations & translations (keep intrinsic constant)
-        Bundle_Adjustment_Ceres::BA_Ceres_options options(false, false);
-        options.linear_solver_type_ = ceres::DENSE_SCHUR;
-        Bundle_Adjustment_Ceres bundle_adjustment_obj(options);
-        const Optimize_Options ba_refine_options
-          (Intrinsic_Parameter_Type::NONE, // -> Keep intrinsic constant
-          Extrinsic_Parameter_Type::ADJUST_ALL, // adjust camera motion
-          Structure_Parameter_Type::ADJUST_ALL);// adjust scene structure
-        if (bundle_adjustment_obj.Adjust(tiny_scene, ba_refine_options))
-        {
-          // --> to debug: save relative pair geometry on disk
-          // std::ostringstream os;
-          // os << relative_pose_pair.first << "_" << relative_pose_pair.second << ".ply";
-          // Save(tiny_scene, os.str(), ESfM_Data(STRUCTURE | EXTRINSICS));
-          //
-          const Mat3 R1 = tiny_scene.poses[view_I->id_pose].rotation(),
-                     R2 = tiny_scene.poses[view_J->id_pose].rotation();
-          const Vec3 t1 = tiny_scene.poses[view_I->id_pose].translation(),
-                     t2 = tiny_scene.poses[view_J->id_pose].translation();
-          // Compute relative motion and save it
-          Mat3 Rrel;
-          Vec3 trel;
-          RelativeCameraMotion(R1, t1, R2, t2, &Rrel, &trel);
-          // Update found relative pose
-          relativePose_info.relativePose = Pose3(Rrel, -Rrel.transpose() * trel);
+          x1_inliers.col(k) = x1.col(relativePose_info.vec_inliers[k]);
+          x2_inliers.col(k) = x2.col(relativePose_info.vec_inliers[k]);
         }
+        refiner.Refine((*cam_I)(x1_inliers), (*cam_J)(x2_inliers),
+                       relativePose_info.relativePose, triangulation_method_);
+
+        relative_pose.is_valid = true;
+        relative_pose.pose = relativePose_info.relativePose;
       }
 #ifdef OPENMVG_USE_OPENMP
       #pragma omp critical
 #endif
       {
         // Add the relative pose to the relative 'rotation' pose graph
-        relative_poses_[relative_pose_pair] = relativePose_info.relativePose;
+        if (relative_pose.is_valid)
+          relative_poses_[relative_pose_pair] = relative_pose.pose;
+        computed_poses[relative_pose_pair] = relative_pose;
       }
     }
   }
   std::cout << "Relative motion computation took: " << t.elapsedMs() << "(ms)" << std::endl;
+
+  if (!cache_filename_.empty())
+  {
+    std::cout
+      << "#Relative poses reloaded from the cache: " << reused_poses_count << "\n"
+      << "#Relative poses computed: " << computed_poses.size() << std::endl;
+    for (const auto & pose_it : computed_poses)
+      cache[pose_it.first] = pose_it.second;
+    if (!computed_poses.empty() && !SaveCache(cache_filename_, cache))
+      std::cerr << "Cannot save the relative pose cache: " << cache_filename_ << std::endl;
+  }
   return !relative_poses_.empty();
 }
 
+std::size_t Relative_Pose_Engine::Signature
+(
+  const IndexT view_I,
+  const IndexT view_J,
+  const IntrinsicBase & cam_I,
+  const IntrinsicBase & cam_J,
+  const matching::IndMatches & matches,
+  const Features_Provider & features_provider
+) const
+{
+  const features::PointFeatures
+    & features_I = features_provider.feats_per_view.at(view_I),
+    & features_J = features_provider.feats_per_view.at(view_J);
+  std::size_t seed = 0;
+  stl::hash_combine(seed, view_I);
+  stl::hash_combine(seed, view_J);
+  stl::hash_combine(seed, cam_I.hashValue());
+  stl::hash_combine(seed, cam_J.hashValue());
+  stl::hash_combine(seed, static_cast<int>(triangulation_method_));
+  stl::hash_combine(seed, matches.size());
+  for (const auto & match : matches)
+  {
+    stl::hash_combine(seed, match.i_);
+    stl::hash_combine(seed, match.j_);
+    stl::hash_combine(seed, features_I[match.i_].x());
+    stl::hash_combine(seed, features_I[match.i_].y());
+    stl::hash_combine(seed, features_J[match.j_].x());
+    stl::hash_combine(seed, features_J[match.j_].y());
+  }
+  return seed;
+}
+
+bool Relative_Pose_Engine::LoadCache
+(
+  const std::string & filename,
+  Relative_Pose_Cache & cache
+) const
+{
+  std::ifstream stream(filename);
+  if (!stream)
+    return false;
+
+  // One pose pair per line:
+  //  I J signature is_valid R(row major, 9 values) center(3 values)
+  Pair pair;
+  Cached_Relative_Pose relative_pose;
+  Mat3 R;
+  Vec3 center;
+  while (stream >> pair.first >> pair.second
+    >> relative_pose.signature >> relative_pose.is_valid)
+  {
+    for (int k = 0; k < 9; ++k)
+      stream >> R(k / 3, k % 3);
+    stream >> center(0) >> center(1) >> center(2);
+    if (!stream)
+      break;
+    relative_pose.pose = geometry::Pose3(R, center);
+    cache[pair] = relative_pose;
+  }
+  return true;
+}
+
+bool Relative_Pose_Engine::SaveCache
+(
+  const std::string & filename,
+  const Relative_Pose_Cache & cache
+) const
+{
+  // Write a temporary file and then rename it
+  // (a valid cache is kept if the process is interrupted)
+  const std::string temporary_filename = filename + ".tmp";
+  {
+    std::ofstream stream(temporary_filename);
+    if (!stream)
+      return false;
+    stream << std::setprecision(17);
+    for (const auto & pose_it : cache)
+    {
+      const Cached_Relative_Pose & relative_pose = pose_it.second;
+      const Mat3 & R = relative_pose.pose.rotation();
+      const Vec3 & center = relative_pose.pose.center();
+      stream
+        << pose_it.first.first << ' ' << pose_it.first.second << ' '
+        << relative_pose.signature << ' ' << relative_pose.is_valid;
+      for (int k = 0; k < 9; ++k)
+        stream << ' ' << R(k / 3, k % 3);
+      stream << ' ' << center(0) << ' ' << center(1) << ' ' << center(2) << '\n';
+    }
+    if (!stream)
+      return false;
+  }
+#ifdef _WIN32
+  std::remove(filename.c_str()); // rename cannot replace an existing file
+#endif
+  return std::rename(temporary_filename.c_str(), filename.c_str()) == 0;
+}
+
 // Relative poses accessor
 const Relative_Pose_Engine::Relative_Pair_Poses&
 Relative_Pose_Engine::Get_Relative_Poses() const
@@ -9,11 +9,16 @@
 #ifndef OPENMVG_SFM_RELATIVE_POSE_ENGINE_HPP
 #define OPENMVG_SFM_RELATIVE_POSE_ENGINE_HPP
 
+#include <map>
+#include <string>
+
 #include "openMVG/types.hpp"
 #include "openMVG/geometry/pose3.hpp"
+#include "openMVG/matching/indMatch.hpp"
 #include "openMVG/multiview/triangulation_method.hpp"
 
 namespace openMVG {
+namespace cameras { struct IntrinsicBase; }
 namespace sfm {
 
 struct SfM_Data;
@@ -21,6 +26,8 @@ struct Matches_Provider;
 struct Features_Provider;
 
 /// An engine to compute relative pose
+/// The relative poses are refined with a dedicated two view bundle adjustment
+///  (see Two_View_Refiner) on the essential matrix inliers.
 class Relative_Pose_Engine
 {
 public:
@@ -52,10 +59,45 @@ public:
     triangulation_method_ = method;
   }
 
+  /// Cache the relative poses in a sidecar file (empty filename: no cache).
+  /// A pose pair is reloaded instead of being computed if its views, intrinsics,
+  ///  matches and features did not change since the run that saved it.
+  void SetCacheFile(const std::string & filename)
+  {
+    cache_filename_ = filename;
+  }
+
 private:
+  /// Relative pose of a pose pair and the signature of its input data
+  struct Cached_Relative_Pose
+  {
+    std::size_t signature = 0;
+    // false if the relative pose could not be estimated
+    bool is_valid = false;
+    geometry::Pose3 pose;
+  };
+  using Relative_Pose_Cache = std::map<Pair, Cached_Relative_Pose>;
+
+  /// Hash of the data used to compute the relative pose of a view pair
+  ///  (view ids, intrinsics, matches and matched feature positions)
+  std::size_t Signature(
+    const IndexT view_I,
+    const IndexT view_J,
+    const cameras::IntrinsicBase & cam_I,
+    const cameras::IntrinsicBase & cam_J,
+    const matching::IndMatches & matches,
+    const Features_Provider & features_provider
+  ) const;
+
+  /// Load/Save the relative pose cache
+  bool LoadCache(const std::string & filename, Relative_Pose_Cache & cache) const;
+  bool SaveCache(const std::string & filename, const Relative_Pose_Cache & cache) const;
+
   Relative_Pair_Poses relative_poses_;
 
   ETriangulationMethod triangulation_method_ = ETriangulationMethod::DEFAULT;
+
+  std::string cache_filename_;
 };
 
 } // namespace sfm
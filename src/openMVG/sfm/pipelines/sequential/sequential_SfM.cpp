@@ -19,15 +19,22 @@
 #include "openMVG/sfm/sfm_data_BA_ceres.hpp"
 #include "openMVG/sfm/sfm_data_filters.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
+#include "openMVG/sfm/sfm_landmark_dense.hpp"
+#include "openMVG/stl/hash.hpp"
 #include "openMVG/stl/stl.hpp"
+#include "openMVG/system/timer.hpp"
 
 #include "third_party/histogram/histogram.hpp"
 #include "third_party/htmlDoc/htmlDoc.hpp"
 #include "third_party/progress/progress.hpp"
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
 #include <ceres/types.h>
+#include <cstdio>
+#include <fstream>
 #include <functional>
 #include <iostream>
+#include <sstream>
 #include <utility>
 
 #ifdef _MSC_VER
@@ -99,38 +106,86 @@ bool SequentialSfMReconstructionEngine::Process() {
   if (!InitLandmarkTracks())
     return false;
 
-  // Initial pair choice
-  if (initial_pair_ == Pair(0,0))
+  size_t resectionGroupIndex = 0;
+  const std::string sCheckpoint = stlplus::create_filespec(sOut_directory_, "checkpoint", "txt");
+  if (b_resume_ && LoadCheckpoint(resectionGroupIndex))
   {
-    if (!AutomaticInitialPairChoice(initial_pair_))
+    std::cout
+      << "\nResumed from the checkpoint: " << sCheckpoint << "\n"
+      << " #resection groups: " << resectionGroupIndex << "\n"
+      << " #poses: " << sfm_data_.GetPoses().size() << "\n"
+      << " #remaining views: " << set_remaining_view_id_.size() << std::endl;
+  }
+  else
+  {
+    if (b_resume_)
+      std::cout << "\nNo valid checkpoint, the reconstruction starts from scratch." << std::endl;
+    // A checkpoint of a previous reconstruction must not be resumed
+    if (stlplus::file_exists(sCheckpoint))
+      stlplus::file_delete(sCheckpoint);
+
+    // Initial pair choice
+    if (initial_pair_ == Pair(0,0))
     {
-      // Cannot find a valid initial pair, try to set it by hand?
-      if (!ChooseInitialPair(initial_pair_))
+      if (!AutomaticInitialPairChoice(initial_pair_))
       {
-        return false;
+        // Cannot find a valid initial pair, try to set it by hand?
+        if (!ChooseInitialPair(initial_pair_))
+        {
+          return false;
+        }
       }
     }
-  }
-  // Else a starting pair was already initialized before
+    // Else a starting pair was already initialized before
 
-  // Initial pair Essential Matrix and [R|t] estimation.
-  if (!MakeInitialPair3D(initial_pair_))
-    return false;
+    // Initial pair Essential Matrix and [R|t] estimation.
+    if (!MakeInitialPair3D(initial_pair_))
+      return false;
+  }
 
   // Compute robust Resection of remaining images
   // - group of images will be selected and resection + scene completion will be tried
-  size_t resectionGroupIndex = 0;
+  system::Timer checkpoint_timer;
   std::vector<uint32_t> vec_possible_resection_indexes;
   while (FindImagesWithPossibleResection(vec_possible_resection_indexes))
   {
-    bool bImageAdded = false;
-    // Add images to the 3D reconstruction
-    for (const auto & iter : vec_possible_resection_indexes)
+    // Robust pose estimation of the candidate views (the scene is not modified)
+    std::vector<ResectionResult> resection_results(vec_possible_resection_indexes.size());
+    std::vector<uint8_t> resection_status(vec_possible_resection_indexes.size(), 0);
+    // The pose refinements are single threaded if many views are localized at once
+    const bool b_concurrent_resection = vec_possible_resection_indexes.size() > 1;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic) if (b_concurrent_resection)
+#endif
+    for (int i = 0; i < static_cast<int>(vec_possible_resection_indexes.size()); ++i)
     {
-      bImageAdded |= Resection(iter);
-      set_remaining_view_id_.erase(iter);
+      resection_status[i] =
+        ComputeResection(vec_possible_resection_indexes[i], resection_results[i],
+                         b_concurrent_resection);
     }
 
+    // Add the localized images to the 3D reconstruction (in a deterministic order)
+    std::vector<uint32_t> vec_added_view_indexes;
+    for (size_t i = 0; i < vec_possible_resection_indexes.size(); ++i)
+    {
+      std::cout << resection_results[i].log << std::flush;
+      if (!sLogging_file_.empty() && !resection_results[i].html_log.empty())
+      {
+        html_doc_stream_->pushInfo(resection_results[i].html_log);
+      }
+      if (resection_status[i])
+      {
+        CommitResection(resection_results[i]);
+        vec_added_view_indexes.push_back(vec_possible_resection_indexes[i]);
+      }
+      set_remaining_view_id_.erase(vec_possible_resection_indexes[i]);
+      reconstructed_track_counter_->RemoveView(vec_possible_resection_indexes[i]);
+    }
+
+    // Triangulate the new tracks of all the added images at once
+    TriangulateNewTracks(vec_added_view_indexes);
+
+    const bool bImageAdded = !vec_added_view_indexes.empty();
     if (bImageAdded)
     {
       // Scene logging as ply for visual debug
@@ -139,19 +194,33 @@ bool SequentialSfMReconstructionEngine::Process() {
       Save(sfm_data_, stlplus::create_filespec(sOut_directory_, os.str(), ".ply"), ESfM_Data(ALL));
 
       // Perform BA until all point are under the given precision
+      //  (one columnar copy of the structure is shared by the BA and the filters)
+      Dense_Landmarks landmarks(sfm_data_.structure);
       do
       {
-        BundleAdjustment();
+        BundleAdjustment(landmarks);
       }
-      while (badTrackRejector(4.0, 50));
-      eraseUnstablePosesAndObservations(sfm_data_);
+      while (badTrackRejector(landmarks, 4.0, 50));
+      std::vector<IndexT> removed_landmark_ids;
+      eraseUnstablePosesAndObservations(sfm_data_, landmarks, 6, 2, &removed_landmark_ids);
+      DeactivateTracks(removed_landmark_ids);
     }
     ++resectionGroupIndex;
+
+    if (checkpoint_period_ >= 0.0 && checkpoint_timer.elapsed() >= checkpoint_period_)
+    {
+      if (!SaveCheckpoint(resectionGroupIndex))
+        std::cerr << "Cannot write the checkpoint: " << sCheckpoint << std::endl;
+      checkpoint_timer.reset();
+    }
   }
   // Ensure there is no remaining outliers
-  if (badTrackRejector(4.0, 0))
+  Dense_Landmarks landmarks(sfm_data_.structure);
+  if (badTrackRejector(landmarks, 4.0, 0))
   {
-    eraseUnstablePosesAndObservations(sfm_data_);
+    std::vector<IndexT> removed_landmark_ids;
+    eraseUnstablePosesAndObservations(sfm_data_, landmarks, 6, 2, &removed_landmark_ids);
+    DeactivateTracks(removed_landmark_ids);
   }
 
   //-- Reconstruction done.
@@ -335,6 +404,9 @@ bool SequentialSfMReconstructionEngine::InitLandmarkTracks()
   }
   // Initialize the shared track visibility helper
   shared_track_visibility_helper_.reset(new openMVG::tracks::SharedTrackVisibilityHelper(map_tracks_));
+  // Initialize the per view reconstructed track counter
+  reconstructed_track_counter_.reset(
+    new openMVG::tracks::ActiveTrackCountPerView(map_tracks_, set_remaining_view_id_));
   return map_tracks_.size() > 0;
 }
 
@@ -361,108 +433,149 @@ bool SequentialSfMReconstructionEngine::AutomaticInitialPairChoice(Pair & initia
     return false; // There is not view that support valid intrinsic data
   }
 
-  std::vector<std::pair<double, Pair>> scoring_per_pair;
+  // Reload the scores computed by a previous run
+  InitialPairScores pair_scores;
+  const std::string sScore_cache_file =
+    stlplus::create_filespec(sOut_directory_, "initial_pair_scores", ".txt");
+  if (initial_pair_use_score_cache_ && stlplus::is_file(sScore_cache_file))
+  {
+    LoadInitialPairScores(sScore_cache_file, pair_scores);
+  }
 
-  // Compute the relative pose & the 'baseline score'
-  C_Progress_display my_progress_bar( matches_provider_->pairWise_matches_.size(),
-    std::cout,
-    "Automatic selection of an initial pair:\n" );
-#ifdef OPENMVG_USE_OPENMP
-  #pragma omp parallel
-#endif
+  // 1. List the pairs with valid intrinsics and enough matches to be selected
+  std::vector<std::pair<uint32_t, Pair>> candidate_pairs; // (#matches, pair)
   for (const std::pair<Pair, IndMatches> & match_pair : matches_provider_->pairWise_matches_)
   {
+    const Pair current_pair(
+      std::min(match_pair.first.first, match_pair.first.second),
+      std::max(match_pair.first.first, match_pair.first.second));
+    if (match_pair.second.size() > iMin_inliers_count &&
+        valid_views.count(current_pair.first) && valid_views.count(current_pair.second))
+    {
+      const uint32_t num_matches = match_pair.second.size();
+      candidate_pairs.emplace_back(num_matches, current_pair);
+      InitialPairScore & score = pair_scores[current_pair];
+      const std::size_t signature =
+        initial_pair_use_score_cache_ ? InitialPairSignature(match_pair.first, match_pair.second) : 0;
+      if (score.signature != signature || score.num_matches != num_matches) // Not computed or outdated score
+      {
+        score = InitialPairScore();
+        score.signature = signature;
+        score.num_matches = num_matches;
+      }
+    }
+  }
+  // Sort the pairs by decreasing number of matches
+  std::sort(candidate_pairs.begin(), candidate_pairs.end(),
+    [](const std::pair<uint32_t, Pair> & a, const std::pair<uint32_t, Pair> & b)
+    {
+      return (a.first > b.first) || (a.first == b.first && a.second < b.second);
+    });
+
+  // 2. Pre-ranking: Keep the pairs having the most matches not explained by an homography
+  //  (the pairs with a large parallax)
+  if (initial_pair_max_evaluated_pairs_ > 0 &&
+      candidate_pairs.size() > initial_pair_max_evaluated_pairs_)
+  {
+    candidate_pairs.resize(
+      std::min(candidate_pairs.size(), size_t(4) * initial_pair_max_evaluated_pairs_));
+
+    std::vector<InitialPairScore *> scores_to_compute;
+    std::vector<Pair> pairs_to_compute;
+    for (const auto & candidate_pair : candidate_pairs)
+    {
+      InitialPairScore & score = pair_scores.at(candidate_pair.second);
+      if (score.homography_inlier_ratio < 0.f)
+      {
+        scores_to_compute.push_back(&score);
+        pairs_to_compute.push_back(candidate_pair.second);
+      }
+    }
+    C_Progress_display my_progress_bar( pairs_to_compute.size(),
+      std::cout,
+      "Initial pair pre-ranking (homography inlier ratio):\n" );
 #ifdef OPENMVG_USE_OPENMP
-  #pragma omp single nowait
+    #pragma omp parallel for schedule(dynamic)
 #endif
+    for (int i = 0; i < static_cast<int>(pairs_to_compute.size()); ++i)
     {
+      ComputeInitialPairHomographyRatio(pairs_to_compute[i], *scores_to_compute[i]);
       ++my_progress_bar;
+    }
 
-      const Pair current_pair = match_pair.first;
-
-      const uint32_t I = std::min(current_pair.first, current_pair.second);
-      const uint32_t J = std::max(current_pair.first, current_pair.second);
-      if (valid_views.count(I) && valid_views.count(J))
+    const auto parallax_matches = [&pair_scores](const Pair & pair)
+    {
+      const InitialPairScore & score = pair_scores.at(pair);
+      return score.num_matches * (1.f - score.homography_inlier_ratio);
+    };
+    std::stable_sort(candidate_pairs.begin(), candidate_pairs.end(),
+      [&parallax_matches](const std::pair<uint32_t, Pair> & a, const std::pair<uint32_t, Pair> & b)
       {
-        const View
-          * view_I = sfm_data_.GetViews().at(I).get(),
-          * view_J = sfm_data_.GetViews().at(J).get();
-        const Intrinsics::const_iterator
-          iterIntrinsic_I = sfm_data_.GetIntrinsics().find(view_I->id_intrinsic),
-          iterIntrinsic_J = sfm_data_.GetIntrinsics().find(view_J->id_intrinsic);
-
-        const auto
-          cam_I = iterIntrinsic_I->second.get(),
-          cam_J = iterIntrinsic_J->second.get();
-        if (cam_I && cam_J)
-        {
-          openMVG::tracks::STLMAPTracks map_tracksCommon;
-          shared_track_visibility_helper_->GetTracksInImages({I, J}, map_tracksCommon);
-
-          // Copy points correspondences to arrays for relative pose estimation
-          const size_t n = map_tracksCommon.size();
-          Mat xI(2,n), xJ(2,n);
-          size_t cptIndex = 0;
-          for (const auto & track_iter : map_tracksCommon)
-          {
-            auto iter = track_iter.second.cbegin();
-            const uint32_t i = iter->second;
-            const uint32_t j = (++iter)->second;
-
-            Vec2 feat = features_provider_->feats_per_view[I][i].coords().cast<double>();
-            xI.col(cptIndex) = cam_I->get_ud_pixel(feat);
-            feat = features_provider_->feats_per_view[J][j].coords().cast<double>();
-            xJ.col(cptIndex) = cam_J->get_ud_pixel(feat);
-            ++cptIndex;
-          }
+        return parallax_matches(a.second) > parallax_matches(b.second);
+      });
+    candidate_pairs.resize(initial_pair_max_evaluated_pairs_);
+  }
 
-          // Robust estimation of the relative pose
-          RelativePose_Info relativePose_info;
-          relativePose_info.initial_residual_tolerance = Square(4.0);
+  // 3. Compute the relative pose & the 'baseline score' of the pairs (in the ranking order).
+  //  The pairs are evaluated by chunks (in parallel), and the evaluation stops once
+  //  a chunk provides a pair with a large enough baseline.
+  //  Since the chunk size is fixed, the result does not depend on the number of threads.
+  const size_t chunk_size = 16;
+  std::vector<std::pair<double, Pair>> scoring_per_pair;
+  C_Progress_display my_progress_bar( candidate_pairs.size(),
+    std::cout,
+    "Automatic selection of an initial pair:\n" );
+  bool b_early_stop = false;
+  size_t num_evaluated_pairs = 0;
+  for (size_t chunk_begin = 0;
+       chunk_begin < candidate_pairs.size() && !b_early_stop;
+       chunk_begin += chunk_size)
+  {
+    const size_t chunk_end = std::min(chunk_begin + chunk_size, candidate_pairs.size());
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = static_cast<int>(chunk_begin); i < static_cast<int>(chunk_end); ++i)
+    {
+      const Pair & current_pair = candidate_pairs[i].second;
+      InitialPairScore & score = pair_scores.at(current_pair);
+      if (score.num_inliers < 0) // Not yet evaluated
+      {
+        ComputeInitialPairScore(current_pair, score);
+      }
+      ++my_progress_bar;
+    }
+    num_evaluated_pairs = chunk_end;
 
-          if (robustRelativePose(
-                cam_I, cam_J,
-                xI, xJ, relativePose_info,
-                {cam_I->w(), cam_I->h()}, {cam_J->w(), cam_J->h()},
-                256)
-              && relativePose_info.vec_inliers.size() > iMin_inliers_count)
-          {
-            // Triangulate inliers & compute angle between bearing vectors
-            std::vector<float> vec_angles;
-            vec_angles.reserve(relativePose_info.vec_inliers.size());
-            const Pose3 pose_I = Pose3(Mat3::Identity(), Vec3::Zero());
-            const Pose3 pose_J = relativePose_info.relativePose;
-            for (const uint32_t & inlier_idx : relativePose_info.vec_inliers)
-            {
-              openMVG::tracks::STLMAPTracks::const_iterator iterT = map_tracksCommon.begin();
-              std::advance(iterT, inlier_idx);
-              tracks::submapTrack::const_iterator iter = iterT->second.begin();
-              const Vec2 featI = features_provider_->feats_per_view[I][iter->second].coords().cast<double>();
-              const Vec2 featJ = features_provider_->feats_per_view[J][(++iter)->second].coords().cast<double>();
-              vec_angles.push_back(AngleBetweenRay(pose_I, cam_I, pose_J, cam_J,
-                cam_I->get_ud_pixel(featI), cam_J->get_ud_pixel(featJ)));
-            }
-            // Compute the median triangulation angle
-            const unsigned median_index = vec_angles.size() / 2;
-            std::nth_element(
-              vec_angles.begin(),
-              vec_angles.begin() + median_index,
-              vec_angles.end());
-            const float scoring_angle = vec_angles[median_index];
-            // Store the pair iff the pair is in the asked angle range [fRequired_min_angle;fLimit_max_angle]
-            if (scoring_angle > fRequired_min_angle &&
-                scoring_angle < fLimit_max_angle)
-            {
-  #ifdef OPENMVG_USE_OPENMP
-              #pragma omp critical
-  #endif
-              scoring_per_pair.emplace_back(scoring_angle, current_pair);
-            }
-          }
+    for (size_t i = chunk_begin; i < chunk_end; ++i)
+    {
+      const Pair & current_pair = candidate_pairs[i].second;
+      const InitialPairScore & score = pair_scores.at(current_pair);
+      // Store the pair iff the pair is in the asked angle range [fRequired_min_angle;fLimit_max_angle]
+      if (score.num_inliers > static_cast<int>(iMin_inliers_count) &&
+          score.median_angle > fRequired_min_angle &&
+          score.median_angle < fLimit_max_angle)
+      {
+        scoring_per_pair.emplace_back(score.median_angle, current_pair);
+        if (initial_pair_early_stop_angle_ > 0.f &&
+            score.median_angle >= initial_pair_early_stop_angle_)
+        {
+          b_early_stop = true;
         }
       }
-    } // omp section
+    }
+  }
+  if (b_early_stop)
+  {
+    std::cout << "\nInitial pair selection stopped after the evaluation of "
+      << num_evaluated_pairs << "/" << candidate_pairs.size() << " pairs." << std::endl;
   }
+
+  if (initial_pair_use_score_cache_)
+  {
+    SaveInitialPairScores(sScore_cache_file, pair_scores);
+  }
+
   std::sort(scoring_per_pair.begin(), scoring_per_pair.end());
   // Since scoring is ordered in increasing order, reverse the order
   std::reverse(scoring_per_pair.begin(), scoring_per_pair.end());
@@ -474,6 +587,331 @@ bool SequentialSfMReconstructionEngine::AutomaticInitialPairChoice(Pair & initia
   return false;
 }
 
+std::size_t SequentialSfMReconstructionEngine::InitialPairSignature
+(
+  const Pair & pair,
+  const matching::IndMatches & matches
+) const
+{
+  const View
+    * view_I = sfm_data_.GetViews().at(pair.first).get(),
+    * view_J = sfm_data_.GetViews().at(pair.second).get();
+  const features::PointFeatures
+    & features_I = features_provider_->feats_per_view.at(pair.first),
+    & features_J = features_provider_->feats_per_view.at(pair.second);
+  std::size_t seed = 0;
+  stl::hash_combine(seed, pair.first);
+  stl::hash_combine(seed, pair.second);
+  stl::hash_combine(seed, sfm_data_.GetIntrinsics().at(view_I->id_intrinsic)->hashValue());
+  stl::hash_combine(seed, sfm_data_.GetIntrinsics().at(view_J->id_intrinsic)->hashValue());
+  stl::hash_combine(seed, matches.size());
+  for (const auto & match : matches)
+  {
+    stl::hash_combine(seed, match.i_);
+    stl::hash_combine(seed, match.j_);
+    stl::hash_combine(seed, features_I[match.i_].x());
+    stl::hash_combine(seed, features_I[match.i_].y());
+    stl::hash_combine(seed, features_J[match.j_].x());
+    stl::hash_combine(seed, features_J[match.j_].y());
+  }
+  return seed;
+}
+
+void SequentialSfMReconstructionEngine::ComputeInitialPairHomographyRatio
+(
+  const Pair & current_pair,
+  InitialPairScore & score
+) const
+{
+  const uint32_t I = current_pair.first;
+  const uint32_t J = current_pair.second;
+  const auto
+    cam_I = sfm_data_.GetIntrinsics().at(sfm_data_.GetViews().at(I)->id_intrinsic).get(),
+    cam_J = sfm_data_.GetIntrinsics().at(sfm_data_.GetViews().at(J)->id_intrinsic).get();
+
+  openMVG::tracks::STLMAPTracks map_tracksCommon;
+  shared_track_visibility_helper_->GetTracksInImages({I, J}, map_tracksCommon);
+
+  score.homography_inlier_ratio = 1.f; // No parallax evidence by default
+  if (map_tracksCommon.empty())
+    return;
+
+  // Copy points correspondences to arrays
+  const size_t n = map_tracksCommon.size();
+  Mat xI(2,n), xJ(2,n);
+  size_t cptIndex = 0;
+  for (const auto & track_iter : map_tracksCommon)
+  {
+    auto iter = track_iter.second.cbegin();
+    const uint32_t i = iter->second;
+    const uint32_t j = (++iter)->second;
+
+    Vec2 feat = features_provider_->feats_per_view.at(I)[i].coords().cast<double>();
+    xI.col(cptIndex) = cam_I->get_ud_pixel(feat);
+    feat = features_provider_->feats_per_view.at(J)[j].coords().cast<double>();
+    xJ.col(cptIndex) = cam_J->get_ud_pixel(feat);
+    ++cptIndex;
+  }
+
+  Mat3 H;
+  std::vector<uint32_t> vec_inliers;
+  if (robustHomography(
+        xI, xJ,
+        {cam_I->w(), cam_I->h()}, {cam_J->w(), cam_J->h()},
+        H, vec_inliers, 256, Square(4.0)))
+  {
+    score.homography_inlier_ratio = vec_inliers.size() / static_cast<float>(n);
+  }
+  else
+  {
+    score.homography_inlier_ratio = 0.f;
+  }
+}
+
+void SequentialSfMReconstructionEngine::ComputeInitialPairScore
+(
+  const Pair & current_pair,
+  InitialPairScore & score
+) const
+{
+  const uint32_t I = current_pair.first;
+  const uint32_t J = current_pair.second;
+  const auto
+    cam_I = sfm_data_.GetIntrinsics().at(sfm_data_.GetViews().at(I)->id_intrinsic).get(),
+    cam_J = sfm_data_.GetIntrinsics().at(sfm_data_.GetViews().at(J)->id_intrinsic).get();
+
+  score.num_inliers = 0;
+  score.median_angle = 0.f;
+  if (!cam_I || !cam_J)
+    return;
+
+  openMVG::tracks::STLMAPTracks map_tracksCommon;
+  shared_track_visibility_helper_->GetTracksInImages({I, J}, map_tracksCommon);
+
+  // Copy points correspondences to arrays for relative pose estimation
+  const size_t n = map_tracksCommon.size();
+  Mat xI(2,n), xJ(2,n);
+  size_t cptIndex = 0;
+  for (const auto & track_iter : map_tracksCommon)
+  {
+    auto iter = track_iter.second.cbegin();
+    const uint32_t i = iter->second;
+    const uint32_t j = (++iter)->second;
+
+    Vec2 feat = features_provider_->feats_per_view.at(I)[i].coords().cast<double>();
+    xI.col(cptIndex) = cam_I->get_ud_pixel(feat);
+    feat = features_provider_->feats_per_view.at(J)[j].coords().cast<double>();
+    xJ.col(cptIndex) = cam_J->get_ud_pixel(feat);
+    ++cptIndex;
+  }
+
+  // Robust estimation of the relative pose
+  RelativePose_Info relativePose_info;
+  relativePose_info.initial_residual_tolerance = Square(4.0);
+
+  if (robustRelativePose(
+        cam_I, cam_J,
+        xI, xJ, relativePose_info,
+        {cam_I->w(), cam_I->h()}, {cam_J->w(), cam_J->h()},
+        256)
+      && !relativePose_info.vec_inliers.empty())
+  {
+    // Triangulate inliers & compute angle between bearing vectors
+    std::vector<float> vec_angles;
+    vec_angles.reserve(relativePose_info.vec_inliers.size());
+    const Pose3 pose_I = Pose3(Mat3::Identity(), Vec3::Zero());
+    const Pose3 pose_J = relativePose_info.relativePose;
+    for (const uint32_t & inlier_idx : relativePose_info.vec_inliers)
+    {
+      vec_angles.push_back(AngleBetweenRay(pose_I, cam_I, pose_J, cam_J,
+        xI.col(inlier_idx), xJ.col(inlier_idx)));
+    }
+    // Compute the median triangulation angle
+    const unsigned median_index = vec_angles.size() / 2;
+    std::nth_element(
+      vec_angles.begin(),
+      vec_angles.begin() + median_index,
+      vec_angles.end());
+    score.num_inliers = relativePose_info.vec_inliers.size();
+    score.median_angle = vec_angles[median_index];
+  }
+}
+
+bool SequentialSfMReconstructionEngine::LoadInitialPairScores
+(
+  const std::string & filename,
+  InitialPairScores & scores
+) const
+{
+  std::ifstream stream(filename);
+  if (!stream)
+    return false;
+
+  // A header line, then one pair per line:
+  //  I J signature #matches homography_inlier_ratio #inliers median_angle
+  std::string key;
+  int version;
+  if (!(stream >> key >> version) || key != "initial_pair_scores" || version != 1)
+    return false;
+  Pair pair;
+  InitialPairScore score;
+  while (stream >> pair.first >> pair.second >> score.signature >> score.num_matches
+    >> score.homography_inlier_ratio >> score.num_inliers >> score.median_angle)
+  {
+    scores[pair] = score;
+  }
+  return true;
+}
+
+bool SequentialSfMReconstructionEngine::SaveInitialPairScores
+(
+  const std::string & filename,
+  const InitialPairScores & scores
+) const
+{
+  // Write a temporary file and then rename it
+  // (a valid cache is kept if the process is interrupted)
+  const std::string temporary_filename = filename + ".tmp";
+  {
+    std::ofstream stream(temporary_filename);
+    if (!stream)
+      return false;
+    stream << "initial_pair_scores 1\n";
+    for (const auto & score_it : scores)
+    {
+      const InitialPairScore & score = score_it.second;
+      if (score.homography_inlier_ratio < 0.f && score.num_inliers < 0)
+        continue; // Nothing was computed for this pair
+      stream
+        << score_it.first.first << ' ' << score_it.first.second << ' '
+        << score.signature << ' '
+        << score.num_matches << ' ' << score.homography_inlier_ratio << ' '
+        << score.num_inliers << ' ' << score.median_angle << '\n';
+    }
+    if (!stream)
+      return false;
+  }
+#ifdef _WIN32
+  std::remove(filename.c_str()); // rename cannot replace an existing file
+#endif
+  return std::rename(temporary_filename.c_str(), filename.c_str()) == 0;
+}
+
+bool SequentialSfMReconstructionEngine::SaveCheckpoint
+(
+  const size_t resection_group_index
+)
+{
+  // The scene files alternate and the state file is written last
+  // (temporary file renamed): the state always refers to a complete scene
+  const std::string scene_name =
+    (checkpoint_scene_ == "checkpoint_0.sfmc") ? "checkpoint_1.sfmc" : "checkpoint_0.sfmc";
+  if (!Save(sfm_data_, stlplus::create_filespec(sOut_directory_, scene_name), ESfM_Data(ALL)))
+    return false;
+
+  const std::string filename = stlplus::create_filespec(sOut_directory_, "checkpoint", "txt");
+  const std::string temporary_filename = filename + ".tmp";
+  {
+    std::ofstream stream(temporary_filename);
+    if (!stream)
+      return false;
+    stream.precision(17);
+    stream
+      << "openMVG_sequential_checkpoint 1\n"
+      << "scene " << scene_name << '\n'
+      << "resection_group " << resection_group_index << '\n'
+      << "initial_pair " << initial_pair_.first << ' ' << initial_pair_.second << '\n'
+      << "track_count " << map_tracks_.size() << '\n'
+      << "remaining_views " << set_remaining_view_id_.size();
+    for (const uint32_t view_id : set_remaining_view_id_)
+      stream << ' ' << view_id;
+    // Ordered by view id (deterministic file)
+    const std::map<IndexT, double> ac_thresholds(map_ACThreshold_.cbegin(), map_ACThreshold_.cend());
+    stream << "\nac_thresholds " << ac_thresholds.size();
+    for (const auto & threshold_it : ac_thresholds)
+      stream << ' ' << threshold_it.first << ' ' << threshold_it.second;
+    stream << '\n';
+    if (!stream)
+      return false;
+  }
+#ifdef _WIN32
+  std::remove(filename.c_str()); // rename cannot replace an existing file
+#endif
+  if (std::rename(temporary_filename.c_str(), filename.c_str()) != 0)
+    return false;
+  checkpoint_scene_ = scene_name;
+  return true;
+}
+
+bool SequentialSfMReconstructionEngine::LoadCheckpoint
+(
+  size_t & resection_group_index
+)
+{
+  std::ifstream stream(stlplus::create_filespec(sOut_directory_, "checkpoint", "txt"));
+  std::string key, scene_name;
+  int version = 0;
+  Pair initial_pair;
+  size_t track_count = 0, remaining_count = 0, threshold_count = 0;
+  if (!(stream >> key >> version) || key != "openMVG_sequential_checkpoint" || version != 1
+      || !(stream >> key >> scene_name) || key != "scene"
+      || !(stream >> key >> resection_group_index) || key != "resection_group"
+      || !(stream >> key >> initial_pair.first >> initial_pair.second) || key != "initial_pair"
+      || !(stream >> key >> track_count) || key != "track_count"
+      || !(stream >> key >> remaining_count) || key != "remaining_views")
+    return false;
+
+  // The tracks are computed again from the matches: they must be the same
+  if (track_count != map_tracks_.size())
+  {
+    std::cerr << "The checkpoint does not match the current tracks." << std::endl;
+    return false;
+  }
+
+  std::set<uint32_t> remaining_view_ids;
+  for (size_t i = 0; i < remaining_count; ++i)
+  {
+    uint32_t view_id;
+    if (!(stream >> view_id) || sfm_data_.GetViews().count(view_id) == 0)
+      return false;
+    remaining_view_ids.insert(view_id);
+  }
+  Hash_Map<IndexT, double> ac_thresholds;
+  if (!(stream >> key >> threshold_count) || key != "ac_thresholds")
+    return false;
+  for (size_t i = 0; i < threshold_count; ++i)
+  {
+    IndexT view_id;
+    double threshold;
+    if (!(stream >> view_id >> threshold))
+      return false;
+    ac_thresholds[view_id] = threshold;
+  }
+
+  SfM_Data scene;
+  if (!Load(scene, stlplus::create_filespec(sOut_directory_, scene_name), ESfM_Data(ALL))
+      || scene.GetViews().size() != sfm_data_.GetViews().size())
+  {
+    std::cerr << "Invalid checkpoint scene: " << scene_name << std::endl;
+    return false;
+  }
+
+  // Restore the engine state
+  sfm_data_ = std::move(scene);
+  initial_pair_ = initial_pair;
+  map_ACThreshold_ = std::move(ac_thresholds);
+  for (const uint32_t view_id : set_remaining_view_id_)
+  {
+    if (remaining_view_ids.count(view_id) == 0)
+      reconstructed_track_counter_->RemoveView(view_id);
+  }
+  for (const auto & landmark_it : sfm_data_.GetLandmarks())
+    reconstructed_track_counter_->ActivateTrack(landmark_it.first);
+  set_remaining_view_id_ = std::move(remaining_view_ids);
+  checkpoint_scene_ = scene_name;
+  return true;
+}
+
 /// Compute the initial 3D seed (First camera t=0; R=Id, second estimated by 5 point algorithm)
 bool SequentialSfMReconstructionEngine::MakeInitialPair3D(const Pair & current_pair)
 {
@@ -624,6 +1062,8 @@ bool SequentialSfMReconstructionEngine::MakeInitialPair3D(const Pair & current_p
     map_ACThreshold_.insert({J, relativePose_info.found_residual_precision});
     set_remaining_view_id_.erase(view_I->id_view);
     set_remaining_view_id_.erase(view_J->id_view);
+    reconstructed_track_counter_->RemoveView(view_I->id_view);
+    reconstructed_track_counter_->RemoveView(view_J->id_view);
 
     // List inliers and save them
     for (const auto & landmark_entry : tiny_scene.GetLandmarks())
@@ -653,6 +1093,7 @@ bool SequentialSfMReconstructionEngine::MakeInitialPair3D(const Pair & current_p
           residual_J.norm() < relativePose_info.found_residual_precision)
       {
         sfm_data_.structure[trackId] = landmarks[trackId];
+        reconstructed_track_counter_->ActivateTrack(trackId);
       }
     }
     // Save outlier residual information
@@ -717,19 +1158,21 @@ bool SequentialSfMReconstructionEngine::MakeInitialPair3D(const Pair & current_p
 double SequentialSfMReconstructionEngine::ComputeResidualsHistogram(Histogram<double> * histo)
 {
   // Collect residuals for each observation
-  std::vector<float> vec_residuals;
-  vec_residuals.reserve(sfm_data_.structure.size());
-  for (const auto & landmark_entry : sfm_data_.GetLandmarks())
+  const Dense_Landmarks landmarks(sfm_data_.GetLandmarks());
+  std::vector<float> vec_residuals(2 * landmarks.observation_count());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 256)
+#endif
+  for (int slot = 0; slot < static_cast<int>(landmarks.size()); ++slot)
   {
-    const Observations & obs = landmark_entry.second.obs;
-    for (const auto & observation : obs)
+    for (std::size_t i = landmarks.obs_begin(slot); i < landmarks.obs_end(slot); ++i)
     {
-      const View * view = sfm_data_.GetViews().find(observation.first)->second.get();
+      const View * view = sfm_data_.GetViews().find(landmarks.obs_view_id(i))->second.get();
       const Pose3 pose = sfm_data_.GetPoseOrDie(view);
-      const auto intrinsic = sfm_data_.GetIntrinsics().find(view->id_intrinsic)->second;
-      const Vec2 residual = intrinsic->residual(pose(landmark_entry.second.X), observation.second.x);
-      vec_residuals.emplace_back( std::abs(residual(0)) );
-      vec_residuals.emplace_back( std::abs(residual(1)) );
+      const cameras::IntrinsicBase * intrinsic = sfm_data_.GetIntrinsics().find(view->id_intrinsic)->second.get();
+      const Vec2 residual = intrinsic->residual(pose(landmarks.X(slot)), landmarks.obs_x(i));
+      vec_residuals[2 * i] = std::abs(residual(0));
+      vec_residuals[2 * i + 1] = std::abs(residual(1));
     }
   }
   // Display statistics
@@ -757,17 +1200,6 @@ double SequentialSfMReconstructionEngine::ComputeResidualsHistogram(Histogram<do
   return -1.0;
 }
 
-/// Functor to sort a vector of pair given the pair's second value
-template<class T1, class T2, class Pred = std::less<T2>>
-struct sort_pair_second {
-  bool operator()(const std::pair<T1,T2>&left,
-                    const std::pair<T1,T2>&right)
-  {
-    Pred p;
-    return p(left.second, right.second);
-  }
-};
-
 /**
  * @brief Estimate images on which we can compute the resectioning safely.
  *
@@ -790,121 +1222,84 @@ bool SequentialSfMReconstructionEngine::FindImagesWithPossibleResection(
   if (set_remaining_view_id_.empty() || sfm_data_.GetLandmarks().empty())
     return false;
 
-  // Collect tracksIds
-  std::set<uint32_t> reconstructed_trackId;
-  std::transform(sfm_data_.GetLandmarks().cbegin(), sfm_data_.GetLandmarks().cend(),
-    std::inserter(reconstructed_trackId, reconstructed_trackId.begin()),
-    stl::RetrieveKey());
-
-  Pair_Vec vec_putative; // ImageId, NbPutativeCommonPoint
-#ifdef OPENMVG_USE_OPENMP
-  #pragma omp parallel
-#endif
-  for (std::set<uint32_t>::const_iterator iter = set_remaining_view_id_.begin();
-        iter != set_remaining_view_id_.end(); ++iter)
-  {
-#ifdef OPENMVG_USE_OPENMP
-  #pragma omp single nowait
-#endif
-    {
-      const uint32_t viewId = *iter;
-
-      // Compute 2D - 3D possible content
-      openMVG::tracks::STLMAPTracks map_tracksCommon;
-      shared_track_visibility_helper_->GetTracksInImages({viewId}, map_tracksCommon);
-
-      if (!map_tracksCommon.empty())
-      {
-        std::set<uint32_t> set_tracksIds;
-        tracks::TracksUtilsMap::GetTracksIdVector(map_tracksCommon, &set_tracksIds);
-
-        // Count the common possible putative point
-        //  with the already 3D reconstructed trackId
-        std::vector<uint32_t> vec_trackIdForResection;
-        std::set_intersection(set_tracksIds.cbegin(), set_tracksIds.cend(),
-          reconstructed_trackId.cbegin(), reconstructed_trackId.cend(),
-          std::back_inserter(vec_trackIdForResection));
-
-#ifdef OPENMVG_USE_OPENMP
-        #pragma omp critical
-#endif
-        {
-          vec_putative.emplace_back(viewId, vec_trackIdForResection.size());
-        }
-      }
-    }
-  }
-
-  // Sort by the number of matches to the 3D scene.
-  std::sort(vec_putative.begin(), vec_putative.end(), sort_pair_second<uint32_t, uint32_t, std::greater<uint32_t>>());
+  // The remaining views sorted by the number of matches to the 3D scene.
+  const auto & ranked_views = reconstructed_track_counter_->RankedViewsByCount();
 
   // If the list is empty or if the list contains images with no correspdences
   // -> (no resection will be possible)
-  if (vec_putative.empty() || vec_putative[0].second == 0)
+  if (ranked_views.empty() || ranked_views.cbegin()->first == 0)
   {
     // All remaining images cannot be used for pose estimation
+    for (const uint32_t view_id : set_remaining_view_id_)
+      reconstructed_track_counter_->RemoveView(view_id);
     set_remaining_view_id_.clear();
     return false;
   }
 
   // Add the image view index that share the most of 2D-3D correspondences
-  vec_possible_indexes.push_back(vec_putative[0].first);
+  vec_possible_indexes.push_back(ranked_views.cbegin()->second);
 
   // Then, add all the image view indexes that have at least N% of the number of the matches of the best image.
-  const IndexT M = vec_putative[0].second; // Number of 2D-3D correspondences
+  const IndexT M = ranked_views.cbegin()->first; // Number of 2D-3D correspondences
   const size_t threshold = static_cast<uint32_t>(dThresholdGroup * M);
-  for (size_t i = 1; i < vec_putative.size() &&
-    vec_putative[i].second > threshold; ++i)
+  for (auto ranked_view_it = std::next(ranked_views.cbegin());
+    ranked_view_it != ranked_views.cend() && ranked_view_it->first > threshold;
+    ++ranked_view_it)
   {
-    vec_possible_indexes.push_back(vec_putative[i].first);
+    vec_possible_indexes.push_back(ranked_view_it->second);
   }
   return true;
 }
 
 /**
- * @brief Add one image to the 3D reconstruction. To the resectioning of
- * the camera and triangulate all the new possible tracks.
- * @param[in] viewIndex: image index to add to the reconstruction.
+ * @brief Compute the pose of a view from its 2D-3D matches with the current reconstruction.
+ * The scene is not modified, so many views can be processed in parallel.
+ * @param[in] viewIndex: image index to localize.
+ * @param[out] resection_result: the found pose (and the intrinsic if a new one was created).
+ * @param[in] b_concurrent: true if other views are localized at the same time.
  *
  * A. Compute 2D/3D matches
  * B. Look if intrinsic data is known or not
  * C. Do the resectioning: compute the camera pose.
  * D. Refine the pose of the found camera
- * E. Update the global scene with the new camera
- * F. Update the observations into the global scene structure
- * G. Triangulate new possible 2D tracks
  */
-bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
+bool SequentialSfMReconstructionEngine::ComputeResection
+(
+  const uint32_t viewIndex,
+  ResectionResult & resection_result,
+  const bool b_concurrent
+) const
 {
   using namespace tracks;
 
+  resection_result.view_index = viewIndex;
+  // The report is buffered if many views are localized concurrently
+  std::ostringstream buffered_log;
+  std::ostream & log = b_concurrent ? buffered_log : std::cout;
+
   // A. Compute 2D/3D matches
   // A1. list tracks ids used by the view
   openMVG::tracks::STLMAPTracks map_tracksCommon;
   shared_track_visibility_helper_->GetTracksInImages({viewIndex}, map_tracksCommon);
-  std::set<uint32_t> set_tracksIds;
-  TracksUtilsMap::GetTracksIdVector(map_tracksCommon, &set_tracksIds);
 
   // A2. intersects the track list with the reconstructed
-  std::set<uint32_t> reconstructed_trackId;
-  std::transform(sfm_data_.GetLandmarks().cbegin(), sfm_data_.GetLandmarks().cend(),
-    std::inserter(reconstructed_trackId, reconstructed_trackId.begin()),
-    stl::RetrieveKey());
-
   // Get the ids of the already reconstructed tracks
   std::set<uint32_t> set_trackIdForResection;
-  std::set_intersection(set_tracksIds.cbegin(), set_tracksIds.cend(),
-    reconstructed_trackId.cbegin(), reconstructed_trackId.cend(),
-    std::inserter(set_trackIdForResection, set_trackIdForResection.begin()));
+  for (const auto & track_it : map_tracksCommon)
+  {
+    if (sfm_data_.GetLandmarks().count(track_it.first))
+      set_trackIdForResection.insert(set_trackIdForResection.end(), track_it.first);
+  }
 
   if (set_trackIdForResection.empty())
   {
     // No match. The image has no connection with already reconstructed points.
-    std::cout << std::endl
+    log << std::endl
       << "-------------------------------" << "\n"
       << "-- Resection of camera index: " << viewIndex << "\n"
       << "-- Resection status: " << "FAILED" << "\n"
       << "-------------------------------" << std::endl;
+    resection_result.log = buffered_log.str();
     return false;
   }
 
@@ -946,7 +1341,7 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
   }
 
   // C. Do the resectioning: compute the camera pose
-  std::cout << std::endl
+  log << std::endl
     << "-------------------------------" << std::endl
     << "-- Robust Resection of view: " << viewIndex << std::endl;
 
@@ -957,9 +1352,11 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
     {view_I->ui_width, view_I->ui_height},
     optional_intrinsic.get(),
     resection_data,
-    pose
+    pose,
+    log
   );
   resection_data.pt2D = std::move(pt2D_original); // restore original image domain points
+  resection_result.log = buffered_log.str();
 
   if (!sLogging_file_.empty())
   {
@@ -967,7 +1364,7 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
     std::ostringstream os;
     os << "Resection of Image index: <" << viewIndex << "> image: "
       << view_I->s_Img_path <<"<br> \n";
-    html_doc_stream_->pushInfo(htmlMarkup("h1",os.str()));
+    resection_result.html_log = htmlMarkup("h1",os.str());
 
     os.str("");
     os << std::endl
@@ -981,7 +1378,7 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
       << "-- % points validated: "
       << resection_data.vec_inliers.size()/static_cast<float>(vec_featIdForResection.size()) << "<br>"
       << "-------------------------------" << "<br>";
-    html_doc_stream_->pushInfo(os.str());
+    resection_result.html_log += os.str();
   }
 
   if (!bResection)
@@ -989,223 +1386,323 @@ bool SequentialSfMReconstructionEngine::Resection(const uint32_t viewIndex)
 
   // D. Refine the pose of the found camera.
   // We use a local scene with only the 3D points and the new camera.
+  const bool b_new_intrinsic = (optional_intrinsic == nullptr);
+  // A valid pose has been found (try to refine it):
+  // If no valid intrinsic as input:
+  //  init a new one from the projection matrix decomposition
+  // Else use the existing one and consider it as constant.
+  if (b_new_intrinsic)
   {
-    const bool b_new_intrinsic = (optional_intrinsic == nullptr);
-    // A valid pose has been found (try to refine it):
-    // If no valid intrinsic as input:
-    //  init a new one from the projection matrix decomposition
-    // Else use the existing one and consider it as constant.
-    if (b_new_intrinsic)
-    {
-      // setup a default camera model from the found projection matrix
-      Mat3 K, R;
-      Vec3 t;
-      KRt_From_P(resection_data.projection_matrix, &K, &R, &t);
+    // setup a default camera model from the found projection matrix
+    Mat3 K, R;
+    Vec3 t;
+    KRt_From_P(resection_data.projection_matrix, &K, &R, &t);
 
-      const double focal = (K(0,0) + K(1,1))/2.0;
-      const Vec2 principal_point(K(0,2), K(1,2));
+    const double focal = (K(0,0) + K(1,1))/2.0;
+    const Vec2 principal_point(K(0,2), K(1,2));
 
-      // Create the new camera intrinsic group
-      switch (cam_type_)
-      {
-        case PINHOLE_CAMERA:
-          optional_intrinsic =
-            std::make_shared<Pinhole_Intrinsic>
-            (view_I->ui_width, view_I->ui_height, focal, principal_point(0), principal_point(1));
-        break;
-        case PINHOLE_CAMERA_RADIAL1:
-          optional_intrinsic =
-            std::make_shared<Pinhole_Intrinsic_Radial_K1>
-            (view_I->ui_width, view_I->ui_height, focal, principal_point(0), principal_point(1));
-        break;
-        case PINHOLE_CAMERA_RADIAL3:
-          optional_intrinsic =
-            std::make_shared<Pinhole_Intrinsic_Radial_K3>
-            (view_I->ui_width, view_I->ui_height, focal, principal_point(0), principal_point(1));
-        break;
-        case PINHOLE_CAMERA_BROWN:
+    // Create the new camera intrinsic group
+    switch (cam_type_)
+    {
+      case PINHOLE_CAMERA:
+        optional_intrinsic =
+          std::make_shared<Pinhole_Intrinsic>
+          (view_I->ui_width, view_I->ui_height, focal, principal_point(0), principal_point(1));
+      break;
+      case PINHOLE_CAMERA_RADIAL1:
+        optional_intrinsic =
+          std::make_shared<Pinhole_Intrinsic_Radial_K1>
+          (view_I->ui_width, view_I->ui_height, focal, principal_point(0), principal_point(1));
+      break;
+      case PINHOLE_CAMERA_RADIAL3:
+        optional_intrinsic =
+          std::make_shared<Pinhole_Intrinsic_Radial_K3>
+          (view_I->ui_width, view_I->ui_height, focal, principal_point(0), principal_point(1));
+      break;
+      case PINHOLE_CAMERA_BROWN:
+        optional_intrinsic =
+          std::make_shared<Pinhole_Intrinsic_Brown_T2>
+          (view_I->ui_width, view_I->ui_height, focal, principal_point(0), principal_point(1));
+      break;
+      case PINHOLE_CAMERA_FISHEYE:
           optional_intrinsic =
-            std::make_shared<Pinhole_Intrinsic_Brown_T2>
-            (view_I->ui_width, view_I->ui_height, focal, principal_point(0), principal_point(1));
-        break;
-        case PINHOLE_CAMERA_FISHEYE:
-            optional_intrinsic =
-                std::make_shared<Pinhole_Intrinsic_Fisheye>
-            (view_I->ui_width, view_I->ui_height, focal, principal_point(0), principal_point(1));
-        break;
-        default:
-          std::cerr << "Try to create an unknown camera type." << std::endl;
-          return false;
-      }
+              std::make_shared<Pinhole_Intrinsic_Fisheye>
+          (view_I->ui_width, view_I->ui_height, focal, principal_point(0), principal_point(1));
+      break;
+      default:
+        std::cerr << "Try to create an unknown camera type." << std::endl;
+        return false;
+    }
+  }
+  const bool b_refine_pose = true;
+  const bool b_refine_intrinsics = false;
+  // The bundle adjustment report cannot be buffered:
+  //  it is only displayed if this resection does not run concurrently.
+  if (!sfm::SfM_Localizer::RefinePose(
+      optional_intrinsic.get(), pose,
+      resection_data, b_refine_pose, b_refine_intrinsics,
+      !b_concurrent, !b_concurrent))
+  {
+    return false;
+  }
+
+  resection_result.pose = pose;
+  resection_result.error_max = resection_data.error_max;
+  resection_result.intrinsic = optional_intrinsic;
+  resection_result.b_new_intrinsic = b_new_intrinsic;
+  return true;
+}
+
+/**
+ * @brief Add a localized view to the 3D reconstruction.
+ * @param[in] resection_result: the view pose found by ComputeResection.
+ *
+ * E. Update the global scene with the new camera
+ */
+void SequentialSfMReconstructionEngine::CommitResection
+(
+  const ResectionResult & resection_result
+)
+{
+  const uint32_t viewIndex = resection_result.view_index;
+  const View * view_I = sfm_data_.GetViews().at(viewIndex).get();
+
+  // E. Update the global scene with:
+  // - the new found camera pose
+  sfm_data_.poses[view_I->id_pose] = resection_result.pose;
+  // - track the view's AContrario robust estimation found threshold
+  map_ACThreshold_.insert({viewIndex, resection_result.error_max});
+  // - intrinsic parameters (if the view has no intrinsic group add a new one)
+  if (resection_result.b_new_intrinsic)
+  {
+    // Since the view have not yet an intrinsic group before, create a new one
+    IndexT new_intrinsic_id = 0;
+    if (!sfm_data_.GetIntrinsics().empty())
+    {
+      // Since some intrinsic Id already exists,
+      //  we have to create a new unique identifier following the existing one
+      std::set<IndexT> existing_intrinsicId;
+        std::transform(sfm_data_.GetIntrinsics().cbegin(), sfm_data_.GetIntrinsics().cend(),
+        std::inserter(existing_intrinsicId, existing_intrinsicId.begin()),
+        stl::RetrieveKey());
+      new_intrinsic_id = (*existing_intrinsicId.rbegin())+1;
     }
-    const bool b_refine_pose = true;
-    const bool b_refine_intrinsics = false;
-    if (!sfm::SfM_Localizer::RefinePose(
-        optional_intrinsic.get(), pose,
-        resection_data, b_refine_pose, b_refine_intrinsics))
+    sfm_data_.views.at(viewIndex)->id_intrinsic = new_intrinsic_id;
+    sfm_data_.intrinsics[new_intrinsic_id] = resection_result.intrinsic;
+  }
+}
+
+/**
+ * @brief Triangulate the new possible tracks of some localized views.
+ * The tracks are processed in parallel and the scene is updated in a deterministic order.
+ * @param[in] view_indexes: the views recently added to the reconstruction.
+ *
+ * F. List tracks that share content with the views and add observations and new 3D track if required.
+ *    - If the track already exists (look if the new view tracks observation are valid)
+ *    - If the track does not exists, try robust triangulation & add the new valid view track observation
+ */
+void SequentialSfMReconstructionEngine::TriangulateNewTracks
+(
+  const std::vector<uint32_t> & view_indexes
+)
+{
+  // Vector of all already reconstructed views
+  const std::set<IndexT> valid_views = Get_Valid_Views(sfm_data_);
+
+  // List the tracks seen by the new views (and by which new views)
+  std::map<uint32_t, std::vector<IndexT>> new_views_per_track;
+  for (const uint32_t view_index : view_indexes)
+  {
+    if (valid_views.count(view_index) == 0)
+      continue;
+    openMVG::tracks::STLMAPTracks map_tracksCommon;
+    shared_track_visibility_helper_->GetTracksInImages({view_index}, map_tracksCommon);
+    for (const auto & track_it : map_tracksCommon)
     {
-      return false;
+      new_views_per_track[track_it.first].push_back(view_index);
     }
+  }
+
+  const std::vector<std::pair<uint32_t, std::vector<IndexT>>> track_to_process(
+    new_views_per_track.cbegin(), new_views_per_track.cend());
+  new_views_per_track.clear();
 
-    // E. Update the global scene with:
-    // - the new found camera pose
-    sfm_data_.poses[view_I->id_pose] = pose;
-    // - track the view's AContrario robust estimation found threshold
-    map_ACThreshold_.insert({viewIndex, resection_data.error_max});
-    // - intrinsic parameters (if the view has no intrinsic group add a new one)
-    if (b_new_intrinsic)
+  // Triangulate (or extend) the tracks in parallel, without modifying the scene
+  std::vector<Landmark> landmarks(track_to_process.size());
+  std::vector<uint8_t> landmark_status(track_to_process.size(), 0);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 64)
+#endif
+  for (int i = 0; i < static_cast<int>(track_to_process.size()); ++i)
+  {
+    landmark_status[i] = TriangulateTrack(
+      track_to_process[i].first, track_to_process[i].second, valid_views, landmarks[i]);
+  }
+
+  // Update the scene structure (in track id order)
+  for (size_t i = 0; i < track_to_process.size(); ++i)
+  {
+    if (!landmark_status[i])
+      continue;
+    const uint32_t trackId = track_to_process[i].first;
+    auto landmark_it = sfm_data_.structure.find(trackId);
+    if (landmark_it == sfm_data_.structure.end())
     {
-      // Since the view have not yet an intrinsic group before, create a new one
-      IndexT new_intrinsic_id = 0;
-      if (!sfm_data_.GetIntrinsics().empty())
+      sfm_data_.structure[trackId] = std::move(landmarks[i]);
+      reconstructed_track_counter_->ActivateTrack(trackId);
+    }
+    else
+    {
+      for (const auto & obs_it : landmarks[i].obs)
       {
-        // Since some intrinsic Id already exists,
-        //  we have to create a new unique identifier following the existing one
-        std::set<IndexT> existing_intrinsicId;
-          std::transform(sfm_data_.GetIntrinsics().cbegin(), sfm_data_.GetIntrinsics().cend(),
-          std::inserter(existing_intrinsicId, existing_intrinsicId.begin()),
-          stl::RetrieveKey());
-        new_intrinsic_id = (*existing_intrinsicId.rbegin())+1;
+        landmark_it->second.obs[obs_it.first] = obs_it.second;
       }
-      sfm_data_.views.at(viewIndex)->id_intrinsic = new_intrinsic_id;
-      sfm_data_.intrinsics[new_intrinsic_id] = optional_intrinsic;
     }
   }
+}
+
+/**
+ * @brief Triangulate a track (if required) & list its new valid observations.
+ * @param[in] trackId: the track to process.
+ * @param[in] new_views: the newly localized views that observe the track.
+ * @param[in] valid_views: the views with a valid pose and intrinsic.
+ * @param[out] landmark: the track 3D position and its new valid observations.
+ * @return True if the landmark has some new observations to add to the scene.
+ */
+bool SequentialSfMReconstructionEngine::TriangulateTrack
+(
+  const uint32_t trackId,
+  const std::vector<IndexT> & new_views,
+  const std::set<IndexT> & valid_views,
+  Landmark & landmark
+) const
+{
+  // List the potential view observations of the track
+  const tracks::submapTrack & allViews_of_track = map_tracks_.at(trackId);
+
+  // List to save the new view observations that must be added to the track
+  std::set<IndexT> new_track_observations_valid_views;
+
+  // Is the track already reconstructed
+  const auto landmark_it = sfm_data_.GetLandmarks().find(trackId);
+  bool b_reconstructed = (landmark_it != sfm_data_.GetLandmarks().end());
+  if (b_reconstructed)
+  {
+    landmark.X = landmark_it->second.X;
+  }
 
-  // F. List tracks that share content with this view and add observations and new 3D track if required.
-  //    - If the track already exists (look if the new view tracks observation are valid)
-  //    - If the track does not exists, try robust triangulation & add the new valid view track observation
+  for (const IndexT I : new_views)
   {
-    // Get information of new view
-    const IndexT I = viewIndex;
+    // If the track was already reconstructed
+    if (b_reconstructed)
+    {
+      // Since the 3D point was triangulated before we add the new the Inth view observation
+      new_track_observations_valid_views.insert(I);
+      continue;
+    }
+
     const View * view_I = sfm_data_.GetViews().at(I).get();
     const IntrinsicBase * cam_I = sfm_data_.GetIntrinsics().at(view_I->id_intrinsic).get();
     const Pose3 pose_I = sfm_data_.GetPoseOrDie(view_I);
+    // Position of the point in view I
+    const Vec2 xI = features_provider_->feats_per_view.at(I)[allViews_of_track.at(I)].coords().cast<double>();
+    const Vec2 xI_ud = cam_I->get_ud_pixel(xI);
 
-    // Vector of all already reconstructed views
-    const std::set<IndexT> valid_views = Get_Valid_Views(sfm_data_);
-
-    // Go through each track and look if we must add new view observations or new 3D points
-    for (const std::pair<uint32_t, tracks::submapTrack>& trackIt : map_tracksCommon)
+    // Go through the views that observe this track & look if a successful triangulation can be done
+    for (const std::pair<IndexT, IndexT>& trackViewIt : allViews_of_track)
     {
-      const uint32_t trackId = trackIt.first;
-      const tracks::submapTrack & track = trackIt.second;
-
-      // List the potential view observations of the track
-      const tracks::submapTrack & allViews_of_track = map_tracks_[trackId];
-
-      // List to save the new view observations that must be added to the track
-      std::set<IndexT> new_track_observations_valid_views;
-
-      // If the track was already reconstructed
-      if (sfm_data_.structure.count(trackId) != 0)
-      {
-        // Since the 3D point was triangulated before we add the new the Inth view observation
-        new_track_observations_valid_views.insert(I);
-      }
-      else
+      const IndexT & J = trackViewIt.first;
+      // If view is valid try triangulation
+      if (J != I && valid_views.count(J) != 0)
       {
-        // Go through the views that observe this track & look if a successful triangulation can be done
-        for (const std::pair<IndexT, IndexT>& trackViewIt : allViews_of_track)
+        // If successfuly triangulated add the observation from J view
+        if (b_reconstructed)
         {
-          const IndexT & J = trackViewIt.first;
-          // If view is valid try triangulation
-          if (J != I && valid_views.count(J) != 0)
-          {
-            // If successfuly triangulated add the observation from J view
-            if (sfm_data_.structure.count(trackId) != 0)
-            {
-              new_track_observations_valid_views.insert(J);
-            }
-            else
-            {
-              const View * view_J = sfm_data_.GetViews().at(J).get();
-              const IntrinsicBase * cam_J = sfm_data_.GetIntrinsics().at(view_J->id_intrinsic).get();
-              const Pose3 pose_J = sfm_data_.GetPoseOrDie(view_J);
-              const Vec2 xJ = features_provider_->feats_per_view.at(J)[allViews_of_track.at(J)].coords().cast<double>();
-
-              // Position of the point in view I
-              const Vec2 xI = features_provider_->feats_per_view.at(I)[track.at(I)].coords().cast<double>();
-
-              // Try to triangulate a 3D point from J view
-              // A new 3D point must be added
-              // Triangulate it
-              const Vec2
-                xI_ud = cam_I->get_ud_pixel(xI),
-                xJ_ud = cam_J->get_ud_pixel(xJ);
-              Vec3 X = Vec3::Zero();
-
-              if (Triangulate2View(
-                    pose_I.rotation(),
-                    pose_I.translation(),
-                    (*cam_I)(xI_ud),
-                    pose_J.rotation(),
-                    pose_J.translation(),
-                    (*cam_J)(xJ_ud),
-                    X,
-                    triangulation_method_))
-              {
-                // Check triangulation result
-                const double angle = AngleBetweenRay(
-                  pose_I, cam_I, pose_J, cam_J, xI_ud, xJ_ud);
-                const Vec2 residual_I = cam_I->residual(pose_I(X), xI);
-                const Vec2 residual_J = cam_J->residual(pose_J(X), xJ);
-                if (
-                    //  - Check angle (small angle leads to imprecise triangulation)
-                    angle > 2.0 &&
-                    //  - Check residual values (must be inferior to the found view's AContrario threshold)
-                    residual_I.norm() < std::max(4.0, map_ACThreshold_.at(I)) &&
-                    residual_J.norm() < std::max(4.0, map_ACThreshold_.at(J))
-                    // Cheirality as been tested already in Triangulate2View
-                   )
-                {
-                  // Add a new track
-                  Landmark & landmark = sfm_data_.structure[trackId];
-                  landmark.X = X;
-                  new_track_observations_valid_views.insert(I);
-                  new_track_observations_valid_views.insert(J);
-                } // 3D point is valid
-              }
-              else
-              {
-                // We mark the view to add the observations once the point is triangulated
-                new_track_observations_valid_views.insert(J);
-              } // 3D point is invalid
-            }
-          }
-        }// Go through all the views
-      }// If new point
-
-      // If successfuly triangulated, add the valid view observations
-      if (sfm_data_.structure.count(trackId) != 0 &&
-          !new_track_observations_valid_views.empty())
-      {
-        Landmark & landmark = sfm_data_.structure[trackId];
-        // Check if view feature point observations of the track are valid (residual, depth) or not
-        for (const IndexT & J: new_track_observations_valid_views)
+          new_track_observations_valid_views.insert(J);
+        }
+        else
         {
           const View * view_J = sfm_data_.GetViews().at(J).get();
           const IntrinsicBase * cam_J = sfm_data_.GetIntrinsics().at(view_J->id_intrinsic).get();
           const Pose3 pose_J = sfm_data_.GetPoseOrDie(view_J);
           const Vec2 xJ = features_provider_->feats_per_view.at(J)[allViews_of_track.at(J)].coords().cast<double>();
-          const Vec2 xJ_ud = cam_J->get_ud_pixel(xJ);
 
-          const Vec2 residual = cam_J->residual(pose_J(landmark.X), xJ);
-          if (CheiralityTest((*cam_J)(xJ_ud), pose_J, landmark.X)
-              && residual.norm() < std::max(4.0, map_ACThreshold_.at(J))
-             )
+          // Try to triangulate a 3D point from J view
+          // A new 3D point must be added
+          // Triangulate it
+          const Vec2 xJ_ud = cam_J->get_ud_pixel(xJ);
+          Vec3 X = Vec3::Zero();
+
+          if (Triangulate2View(
+                pose_I.rotation(),
+                pose_I.translation(),
+                (*cam_I)(xI_ud),
+                pose_J.rotation(),
+                pose_J.translation(),
+                (*cam_J)(xJ_ud),
+                X,
+                triangulation_method_))
           {
-            landmark.obs[J] = Observation(xJ, allViews_of_track.at(J));
+            // Check triangulation result
+            const double angle = AngleBetweenRay(
+              pose_I, cam_I, pose_J, cam_J, xI_ud, xJ_ud);
+            const Vec2 residual_I = cam_I->residual(pose_I(X), xI);
+            const Vec2 residual_J = cam_J->residual(pose_J(X), xJ);
+            if (
+                //  - Check angle (small angle leads to imprecise triangulation)
+                angle > 2.0 &&
+                //  - Check residual values (must be inferior to the found view's AContrario threshold)
+                residual_I.norm() < std::max(4.0, map_ACThreshold_.at(I)) &&
+                residual_J.norm() < std::max(4.0, map_ACThreshold_.at(J))
+                // Cheirality as been tested already in Triangulate2View
+               )
+            {
+              // Add a new track
+              landmark.X = X;
+              b_reconstructed = true;
+              new_track_observations_valid_views.insert(I);
+              new_track_observations_valid_views.insert(J);
+            } // 3D point is valid
           }
+          else
+          {
+            // We mark the view to add the observations once the point is triangulated
+            new_track_observations_valid_views.insert(J);
+          } // 3D point is invalid
         }
       }
-    }// All the tracks in the view
+    }// Go through all the views
   }
-  return true;
+
+  // If successfuly triangulated, add the valid view observations
+  if (!b_reconstructed || new_track_observations_valid_views.empty())
+    return false;
+
+  // Check if view feature point observations of the track are valid (residual, depth) or not
+  for (const IndexT & J: new_track_observations_valid_views)
+  {
+    const View * view_J = sfm_data_.GetViews().at(J).get();
+    const IntrinsicBase * cam_J = sfm_data_.GetIntrinsics().at(view_J->id_intrinsic).get();
+    const Pose3 pose_J = sfm_data_.GetPoseOrDie(view_J);
+    const Vec2 xJ = features_provider_->feats_per_view.at(J)[allViews_of_track.at(J)].coords().cast<double>();
+    const Vec2 xJ_ud = cam_J->get_ud_pixel(xJ);
+
+    const Vec2 residual = cam_J->residual(pose_J(landmark.X), xJ);
+    if (CheiralityTest((*cam_J)(xJ_ud), pose_J, landmark.X)
+        && residual.norm() < std::max(4.0, map_ACThreshold_.at(J))
+       )
+    {
+      landmark.obs[J] = Observation(xJ, allViews_of_track.at(J));
+    }
+  }
+  return !landmark.obs.empty();
 }
 
 /// Bundle adjustment to refine Structure; Motion and Intrinsics
-bool SequentialSfMReconstructionEngine::BundleAdjustment()
+bool SequentialSfMReconstructionEngine::BundleAdjustment
+(
+  Dense_Landmarks & landmarks
+)
 {
   Bundle_Adjustment_Ceres::BA_Ceres_options options;
   if ( sfm_data_.GetPoses().size() > 100 &&
@@ -1230,7 +1727,7 @@ bool SequentialSfMReconstructionEngine::BundleAdjustment()
       Control_Point_Parameter(),
       this->b_use_motion_prior_
     );
-  return bundle_adjustment_obj.Adjust(sfm_data_, ba_refine_options);
+  return bundle_adjustment_obj.Adjust(sfm_data_, ba_refine_options, landmarks);
 }
 
 /**
@@ -1242,13 +1739,32 @@ bool SequentialSfMReconstructionEngine::BundleAdjustment()
  *
  * @return True if more than 'count' outliers have been removed.
  */
-bool SequentialSfMReconstructionEngine::badTrackRejector(double dPrecision, size_t count)
+bool SequentialSfMReconstructionEngine::badTrackRejector
+(
+  Dense_Landmarks & landmarks,
+  double dPrecision,
+  size_t count
+)
 {
-  const size_t nbOutliers_residualErr = RemoveOutliers_PixelResidualError(sfm_data_, dPrecision, 2);
-  const size_t nbOutliers_angleErr = RemoveOutliers_AngleError(sfm_data_, 2.0);
+  std::vector<IndexT> removed_landmark_ids;
+  const size_t nbOutliers_residualErr =
+    RemoveOutliers_PixelResidualError(sfm_data_, landmarks, dPrecision, 2, &removed_landmark_ids);
+  const size_t nbOutliers_angleErr =
+    RemoveOutliers_AngleError(sfm_data_, landmarks, 2.0, &removed_landmark_ids);
+  DeactivateTracks(removed_landmark_ids);
 
   return (nbOutliers_residualErr + nbOutliers_angleErr) > count;
 }
 
+/// Update the per view reconstructed track count with some removed landmarks
+void SequentialSfMReconstructionEngine::DeactivateTracks
+(
+  const std::vector<IndexT> & removed_landmark_ids
+)
+{
+  for (const IndexT landmark_id : removed_landmark_ids)
+    reconstructed_track_counter_->DeactivateTrack(landmark_id);
+}
+
 } // namespace sfm
 } // namespace openMVG
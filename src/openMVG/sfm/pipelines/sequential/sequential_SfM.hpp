@@ -9,14 +9,18 @@
 #ifndef OPENMVG_SFM_LOCALIZATION_SEQUENTIAL_SFM_HPP
 #define OPENMVG_SFM_LOCALIZATION_SEQUENTIAL_SFM_HPP
 
+#include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
 
 #include "openMVG/sfm/pipelines/sfm_engine.hpp"
 #include "openMVG/cameras/cameras.hpp"
+#include "openMVG/geometry/pose3.hpp"
 #include "openMVG/multiview/solver_resection.hpp"
 #include "openMVG/multiview/triangulation_method.hpp"
+#include "openMVG/sfm/sfm_landmark.hpp"
 #include "openMVG/tracks/tracks.hpp"
 
 namespace htmlDocument { class htmlDocumentStream; }
@@ -27,6 +31,7 @@ namespace sfm {
 
 struct Features_Provider;
 struct Matches_Provider;
+class Dense_Landmarks;
 
 /// Sequential SfM Pipeline Reconstruction Engine.
 class SequentialSfMReconstructionEngine : public ReconstructionEngine
@@ -85,25 +90,149 @@ public:
     resection_method_ = method;
   }
 
+  /**
+   * Configure the automatic initial pair selection.
+   *
+   * The pairs are pre-ranked by their number of matches that are not explained
+   * by an homography (parallax), then only the best ones are evaluated.
+   * By default all the pairs are evaluated, without early stop nor cache.
+   *
+   * @param[in] max_evaluated_pairs number of pre-ranked pairs for which a relative pose is evaluated (0 means all)
+   * @param[in] early_stop_angle the evaluation stops once a pair with such a median triangulation angle (degree) is found (0 disables it)
+   * @param[in] use_score_cache save/reload the pair scores in the output directory (restarted runs skip the evaluated pairs
+   *  whose views, intrinsics, matches and features did not change)
+   */
+  void SetInitialPairSelectionParameters
+  (
+    const unsigned int max_evaluated_pairs,
+    const float early_stop_angle,
+    const bool use_score_cache
+  )
+  {
+    initial_pair_max_evaluated_pairs_ = max_evaluated_pairs;
+    initial_pair_early_stop_angle_ = early_stop_angle;
+    initial_pair_use_score_cache_ = use_score_cache;
+  }
+
+  /**
+   * Configure the checkpoints of the reconstruction.
+   *
+   * A checkpoint (the scene and the engine state) is written in the output
+   * directory after a resection group, once checkpoint_period seconds have
+   * elapsed since the previous one. The checkpoints are disabled by default.
+   *
+   * @param[in] checkpoint_period minimal time between two checkpoints (seconds, negative disables them)
+   * @param[in] b_resume resume the reconstruction from the checkpoint of the output directory
+   */
+  void SetCheckpointParameters
+  (
+    const double checkpoint_period,
+    const bool b_resume
+  )
+  {
+    checkpoint_period_ = checkpoint_period;
+    b_resume_ = b_resume;
+  }
+
 protected:
 
 
 private:
 
+  /// Score of a putative initial pair
+  struct InitialPairScore
+  {
+    // Hash of the data the score is computed from (see InitialPairSignature)
+    std::size_t signature = 0;
+    uint32_t num_matches = 0;
+    // Ratio of the matches that are homography inliers (-1: not yet computed)
+    float homography_inlier_ratio = -1.f;
+    // Number of relative pose inliers (-1: not yet evaluated)
+    int num_inliers = -1;
+    // Median triangulation angle of the relative pose inliers (degree)
+    float median_angle = 0.f;
+  };
+  using InitialPairScores = std::map<Pair, InitialPairScore>;
+
+  /// Hash of the data used to score a pair: view ids, intrinsics, matches and
+  ///  matched feature positions (a cached score is reused only if it is unchanged)
+  std::size_t InitialPairSignature
+  (
+    const Pair & pair,
+    const matching::IndMatches & matches
+  ) const;
+
+  /// Compute the homography inlier ratio of a pair (must have valid intrinsics)
+  void ComputeInitialPairHomographyRatio(const Pair & pair, InitialPairScore & score) const;
+
+  /// Compute the relative pose of a pair (must have valid intrinsics) and its baseline score
+  void ComputeInitialPairScore(const Pair & pair, InitialPairScore & score) const;
+
+  /// Load/Save the initial pair scores (cache of a previous run)
+  bool LoadInitialPairScores(const std::string & filename, InitialPairScores & scores) const;
+  bool SaveInitialPairScores(const std::string & filename, const InitialPairScores & scores) const;
+
+  /// Save/Load a checkpoint of the reconstruction (scene and engine state)
+  bool SaveCheckpoint(const size_t resection_group_index);
+  bool LoadCheckpoint(size_t & resection_group_index);
+
   /// Return MSE (Mean Square Error) and a histogram of residual values.
   double ComputeResidualsHistogram(Histogram<double> * histo);
 
   /// List the images that the greatest number of matches to the current 3D reconstruction.
   bool FindImagesWithPossibleResection(std::vector<uint32_t> & vec_possible_indexes);
 
-  /// Add a single Image to the scene and triangulate new possible tracks.
-  bool Resection(const uint32_t imageIndex);
+  /// Pose of a view estimated from its 2D-3D matches with the reconstruction
+  struct ResectionResult
+  {
+    uint32_t view_index = UndefinedIndexT;
+    geometry::Pose3 pose;
+    // A-Contrario robust estimation found threshold
+    double error_max = 0.0;
+    // Intrinsic used for the pose refinement (new one if b_new_intrinsic)
+    std::shared_ptr<cameras::IntrinsicBase> intrinsic;
+    bool b_new_intrinsic = false;
+    // Resection report for the console (displayed in the commit order)
+    std::string log;
+    // Resection report for the HTML logger
+    std::string html_log;
+  };
+
+  /// Compute the pose of an Image (the scene is not modified, thread safe).
+  /// If b_concurrent is true, other resections run at the same time and the
+  ///  pose refinement is single threaded.
+  bool ComputeResection
+  (
+    const uint32_t imageIndex,
+    ResectionResult & resection_result,
+    const bool b_concurrent = false
+  ) const;
+
+  /// Add a localized Image to the scene.
+  void CommitResection(const ResectionResult & resection_result);
+
+  /// Triangulate the new possible tracks of some localized Images.
+  void TriangulateNewTracks(const std::vector<uint32_t> & imageIndexes);
+
+  /// Triangulate a track if required and list its new valid observations (thread safe).
+  bool TriangulateTrack
+  (
+    const uint32_t trackId,
+    const std::vector<IndexT> & new_views,
+    const std::set<IndexT> & valid_views,
+    Landmark & landmark
+  ) const;
 
   /// Bundle adjustment to refine Structure; Motion and Intrinsics
-  bool BundleAdjustment();
+  /// (landmarks: columnar copy of the structure, kept in sync)
+  bool BundleAdjustment(Dense_Landmarks & landmarks);
 
   /// Discard track with too large residual error
-  bool badTrackRejector(double dPrecision, size_t count = 0);
+  /// (landmarks: columnar copy of the structure, kept in sync)
+  bool badTrackRejector(Dense_Landmarks & landmarks, double dPrecision, size_t count = 0);
+
+  /// Report the removed landmarks to the per view reconstructed track counter
+  void DeactivateTracks(const std::vector<IndexT> & removed_landmark_ids);
 
   //----
   //-- Data
@@ -127,6 +256,10 @@ private:
   // Helper to compute if some image have some track in common
   std::unique_ptr<openMVG::tracks::SharedTrackVisibilityHelper> shared_track_visibility_helper_;
 
+  // Per remaining view count of the tracks already reconstructed (resection candidates ranking)
+  // (updated where the landmarks are added to or removed from the scene)
+  std::unique_ptr<openMVG::tracks::ActiveTrackCountPerView> reconstructed_track_counter_;
+
   Hash_Map<IndexT, double> map_ACThreshold_; // Per camera confidence (A contrario estimated threshold error)
 
   std::set<uint32_t> set_remaining_view_id_;     // Remaining camera index that can be used for resection
@@ -134,6 +267,16 @@ private:
   ETriangulationMethod triangulation_method_ = ETriangulationMethod::DEFAULT;
 
   resection::SolverType resection_method_ = resection::SolverType::DEFAULT;
+
+  // Automatic initial pair selection parameters (by default all the pairs are evaluated)
+  unsigned int initial_pair_max_evaluated_pairs_ = 0;
+  float initial_pair_early_stop_angle_ = 0.0f;
+  bool initial_pair_use_score_cache_ = false;
+
+  // Checkpoint parameters
+  double checkpoint_period_ = -1.0;
+  bool b_resume_ = false;
+  std::string checkpoint_scene_; // Scene file of the last checkpoint
 };
 
 } // namespace sfm
@@ -17,6 +17,7 @@
 #include "openMVG/sfm/sfm_data_filters.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/sfm/sfm_data_triangulation.hpp"
+#include "openMVG/sfm/sfm_landmark_dense.hpp"
 #include "openMVG/stl/stl.hpp"
 
 #include "third_party/histogram/histogram.hpp"
@@ -115,8 +116,9 @@ bool SequentialSfMReconstructionEngine2::Process() {
     {
       const bool bTriangulation = Triangulation();
       Save(sfm_data_, stlplus::create_filespec(sOut_directory_, "Initialization", ".ply"), ESfM_Data(ALL));
-      RemoveOutliers_AngleError(sfm_data_, Square(2.0));
-      RemoveOutliers_PixelResidualError(sfm_data_, Square(4.0));
+      Dense_Landmarks landmarks(sfm_data_.structure);
+      RemoveOutliers_AngleError(sfm_data_, landmarks, Square(2.0));
+      RemoveOutliers_PixelResidualError(sfm_data_, landmarks, Square(4.0));
 
       //-- Display some statistics
       std::cout << "\n\n-------------------------------" << "\n"
@@ -162,9 +164,11 @@ bool SequentialSfMReconstructionEngine2::Process() {
       // Adjust the scene
       BundleAdjustment();
       // Remove unstable triangulations and camera poses
-      RemoveOutliers_AngleError(sfm_data_, 2.0);
-      RemoveOutliers_PixelResidualError(sfm_data_, 4.0);
-      eraseUnstablePosesAndObservations(sfm_data_);
+      //  (one columnar copy of the structure is shared by the filters)
+      Dense_Landmarks landmarks(sfm_data_.structure);
+      RemoveOutliers_AngleError(sfm_data_, landmarks, 2.0);
+      RemoveOutliers_PixelResidualError(sfm_data_, landmarks, 4.0);
+      eraseUnstablePosesAndObservations(sfm_data_, landmarks);
 
       std::ostringstream os;
       os << std::setw(8) << std::setfill('0') << resection_round << "_Resection";
@@ -16,6 +16,9 @@
 //   - mean residual error is below the gaussian noise added to observation
 //   - the desired number of tracks are found,
 //   - the desired number of poses are found.
+// - Resume a reconstruction from its last checkpoint
+// - Resume a reconstruction from a mid-run checkpoint
+// - Automatic initial pair selection (pre-ranking, early stop, score cache)
 //-----------------
 
 #include "openMVG/sfm/pipelines/pipelines_test.hpp"
@@ -25,7 +28,13 @@
 
 #include <cmath>
 #include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
 
 using namespace openMVG;
 using namespace openMVG::cameras;
@@ -148,6 +157,278 @@ TEST(SEQUENTIAL_SFM, Partially_Known_Intrinsics) {
   EXPECT_TRUE( IsTracksOneCC(sfmEngine.Get_SfM_Data()));
 }
 
+// Test the reconstruction resumed from a checkpoint
+TEST(SEQUENTIAL_SFM, Checkpoint_Resume) {
+
+  const int nviews = 6;
+  const int npoints = 32;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  const SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  // Remove poses and structure
+  SfM_Data sfm_data_2 = sfm_data;
+  sfm_data_2.poses.clear();
+  sfm_data_2.structure.clear();
+
+  const std::string sOutDir = "./sequential_checkpoint";
+  stlplus::folder_create(sOutDir);
+
+  // Configure the features_provider & the matches_provider from the synthetic dataset
+  std::shared_ptr<Features_Provider> feats_provider =
+    std::make_shared<Synthetic_Features_Provider>();
+  std::normal_distribution<double> distribution(0.0,0.5);
+  dynamic_cast<Synthetic_Features_Provider*>(feats_provider.get())->load(d,distribution);
+
+  std::shared_ptr<Matches_Provider> matches_provider =
+    std::make_shared<Synthetic_Matches_Provider>();
+  dynamic_cast<Synthetic_Matches_Provider*>(matches_provider.get())->load(d);
+
+  // A checkpoint after every resection group
+  SfM_Data sfm_data_checkpointed;
+  {
+    SequentialSfMReconstructionEngine sfmEngine(sfm_data_2, sOutDir);
+    sfmEngine.SetFeaturesProvider(feats_provider.get());
+    sfmEngine.SetMatchesProvider(matches_provider.get());
+    sfmEngine.Set_Intrinsics_Refinement_Type(cameras::Intrinsic_Parameter_Type::NONE);
+    sfmEngine.setInitialPair({sfm_data_2.GetViews().at(0)->id_view,
+                              sfm_data_2.GetViews().at(1)->id_view});
+    sfmEngine.SetCheckpointParameters(0.0, false);
+    EXPECT_TRUE (sfmEngine.Process());
+    sfm_data_checkpointed = sfmEngine.Get_SfM_Data();
+  }
+  EXPECT_TRUE( stlplus::file_exists(stlplus::create_filespec(sOutDir, "checkpoint", "txt")));
+
+  // The resumed reconstruction starts from the checkpoint (no initial pair is given)
+  SequentialSfMReconstructionEngine sfmEngine(sfm_data_2, sOutDir);
+  sfmEngine.SetFeaturesProvider(feats_provider.get());
+  sfmEngine.SetMatchesProvider(matches_provider.get());
+  sfmEngine.Set_Intrinsics_Refinement_Type(cameras::Intrinsic_Parameter_Type::NONE);
+  sfmEngine.SetCheckpointParameters(-1.0, true);
+  EXPECT_TRUE (sfmEngine.Process());
+
+  EXPECT_TRUE( RMSE(sfmEngine.Get_SfM_Data()) < 0.5);
+  EXPECT_EQ( sfm_data_checkpointed.GetPoses().size(), sfmEngine.Get_SfM_Data().GetPoses().size());
+  EXPECT_EQ( sfm_data_checkpointed.GetLandmarks().size(), sfmEngine.Get_SfM_Data().GetLandmarks().size());
+  EXPECT_TRUE( sfmEngine.Get_SfM_Data().GetPoses().size() == nviews);
+}
+
+// Test the reconstruction resumed from a mid-run checkpoint: the last
+//  checkpoint of a reconstruction is edited as if the run had been stopped
+//  before the resection of some views
+TEST(SEQUENTIAL_SFM, Checkpoint_Resume_Mid_Run) {
+
+  const int nviews = 6;
+  const int npoints = 32;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+  sfm_data.poses.clear();
+  sfm_data.structure.clear();
+
+  const std::string sOutDir = "./sequential_checkpoint_mid_run";
+  stlplus::folder_create(sOutDir);
+  const std::string sCheckpoint = stlplus::create_filespec(sOutDir, "checkpoint", "txt");
+
+  std::shared_ptr<Features_Provider> feats_provider =
+    std::make_shared<Synthetic_Features_Provider>();
+  std::normal_distribution<double> distribution(0.0,0.5);
+  dynamic_cast<Synthetic_Features_Provider*>(feats_provider.get())->load(d,distribution);
+
+  std::shared_ptr<Matches_Provider> matches_provider =
+    std::make_shared<Synthetic_Matches_Provider>();
+  dynamic_cast<Synthetic_Matches_Provider*>(matches_provider.get())->load(d);
+
+  {
+    SequentialSfMReconstructionEngine sfmEngine(sfm_data, sOutDir);
+    sfmEngine.SetFeaturesProvider(feats_provider.get());
+    sfmEngine.SetMatchesProvider(matches_provider.get());
+    sfmEngine.Set_Intrinsics_Refinement_Type(cameras::Intrinsic_Parameter_Type::NONE);
+    sfmEngine.setInitialPair({sfm_data.GetViews().at(0)->id_view,
+                              sfm_data.GetViews().at(1)->id_view});
+    sfmEngine.SetCheckpointParameters(0.0, false);
+    EXPECT_TRUE (sfmEngine.Process());
+  }
+
+  // Read the last checkpoint state (one "key values..." line per entry)
+  std::vector<std::string> keys, values;
+  {
+    std::ifstream stream(sCheckpoint);
+    std::string line;
+    while (std::getline(stream, line))
+    {
+      const std::string::size_type separator = line.find(' ');
+      keys.push_back(line.substr(0, separator));
+      values.push_back(separator == std::string::npos ? "" : line.substr(separator + 1));
+    }
+  }
+  EXPECT_TRUE( keys.size() == 7);
+  const std::string sScene = stlplus::create_filespec(sOutDir, values[1]);
+  EXPECT_EQ(std::string("scene"), keys[1]);
+  EXPECT_EQ(std::string("remaining_views"), keys[5]);
+  EXPECT_EQ(std::string("ac_thresholds"), keys[6]);
+
+  // Remove the last two views from the checkpoint scene, as if they were
+  //  not yet localized
+  const std::set<IndexT> removed_views =
+    {sfm_data.GetViews().at(4)->id_view, sfm_data.GetViews().at(5)->id_view};
+  SfM_Data scene;
+  EXPECT_TRUE( Load(scene, sScene, ESfM_Data(ALL)));
+  EXPECT_TRUE( scene.GetPoses().size() == nviews);
+  for (const IndexT view_id : removed_views)
+  {
+    scene.poses.erase(scene.GetViews().at(view_id)->id_pose);
+  }
+  for (auto landmark_it = scene.structure.begin(); landmark_it != scene.structure.end();)
+  {
+    for (const IndexT view_id : removed_views)
+      landmark_it->second.obs.erase(view_id);
+    if (landmark_it->second.obs.size() < 2)
+      landmark_it = scene.structure.erase(landmark_it);
+    else
+      ++landmark_it;
+  }
+  EXPECT_TRUE( Save(scene, sScene, ESfM_Data(ALL)));
+
+  // Rewrite the state: early resection group, the removed views are remaining
+  //  and have no A-Contrario threshold
+  {
+    std::istringstream threshold_stream(values[6]);
+    size_t threshold_count = 0;
+    threshold_stream >> threshold_count;
+    std::ostringstream thresholds;
+    size_t kept_count = 0;
+    for (size_t i = 0; i < threshold_count; ++i)
+    {
+      IndexT view_id;
+      std::string threshold;
+      threshold_stream >> view_id >> threshold;
+      if (removed_views.count(view_id) == 0)
+      {
+        thresholds << ' ' << view_id << ' ' << threshold;
+        ++kept_count;
+      }
+    }
+    EXPECT_TRUE( kept_count == nviews - removed_views.size());
+
+    std::ostringstream remaining_views;
+    remaining_views << removed_views.size();
+    for (const IndexT view_id : removed_views)
+      remaining_views << ' ' << view_id;
+
+    values[2] = "100";
+    values[5] = remaining_views.str();
+    values[6] = std::to_string(kept_count) + thresholds.str();
+    std::ofstream stream(sCheckpoint);
+    for (size_t i = 0; i < keys.size(); ++i)
+      stream << keys[i] << ' ' << values[i] << '\n';
+  }
+
+  // The resumed reconstruction localizes the remaining views
+  SequentialSfMReconstructionEngine sfmEngine(sfm_data, sOutDir);
+  sfmEngine.SetFeaturesProvider(feats_provider.get());
+  sfmEngine.SetMatchesProvider(matches_provider.get());
+  sfmEngine.Set_Intrinsics_Refinement_Type(cameras::Intrinsic_Parameter_Type::NONE);
+  sfmEngine.SetCheckpointParameters(0.0, true);
+  EXPECT_TRUE (sfmEngine.Process());
+
+  EXPECT_TRUE( RMSE(sfmEngine.Get_SfM_Data()) < 0.5);
+  EXPECT_TRUE( sfmEngine.Get_SfM_Data().GetPoses().size() == nviews);
+  EXPECT_TRUE( sfmEngine.Get_SfM_Data().GetLandmarks().size() == npoints);
+
+  // The resection groups are counted from the checkpoint (not restarted)
+  {
+    std::ifstream stream(sCheckpoint);
+    std::string key, scene_key, scene_name, group_key;
+    int version = 0;
+    size_t resection_group = 0;
+    stream >> key >> version >> scene_key >> scene_name >> group_key >> resection_group;
+    EXPECT_EQ(std::string("resection_group"), group_key);
+    EXPECT_TRUE( resection_group > 100);
+  }
+}
+
+// Test the staged automatic initial pair selection and its score cache
+TEST(SEQUENTIAL_SFM, Automatic_Initial_Pair_Selection) {
+
+  // Enough points to have pairs with more than 100 matches, and enough views
+  //  to have pairs with a median triangulation angle below 60 degrees
+  const int nviews = 12;
+  const int npoints = 128;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+  sfm_data.poses.clear();
+  sfm_data.structure.clear();
+
+  const std::string sOutDir = "./sequential_initial_pair";
+  stlplus::folder_create(sOutDir);
+  const std::string sScore_cache_file =
+    stlplus::create_filespec(sOutDir, "initial_pair_scores", ".txt");
+  if (stlplus::file_exists(sScore_cache_file))
+    stlplus::file_delete(sScore_cache_file);
+
+  std::shared_ptr<Features_Provider> feats_provider =
+    std::make_shared<Synthetic_Features_Provider>();
+  std::normal_distribution<double> distribution(0.0,0.5);
+  dynamic_cast<Synthetic_Features_Provider*>(feats_provider.get())->load(d,distribution);
+
+  std::shared_ptr<Matches_Provider> matches_provider =
+    std::make_shared<Synthetic_Matches_Provider>();
+  dynamic_cast<Synthetic_Matches_Provider*>(matches_provider.get())->load(d);
+
+  const auto choose_initial_pair =
+    [&](const unsigned int max_evaluated_pairs, const float early_stop_angle,
+        const bool use_score_cache, Pair & initial_pair)
+  {
+    SequentialSfMReconstructionEngine sfmEngine(sfm_data, sOutDir);
+    sfmEngine.SetFeaturesProvider(feats_provider.get());
+    sfmEngine.SetMatchesProvider(matches_provider.get());
+    sfmEngine.SetInitialPairSelectionParameters(
+      max_evaluated_pairs, early_stop_angle, use_score_cache);
+    return sfmEngine.InitLandmarkTracks()
+      && sfmEngine.AutomaticInitialPairChoice(initial_pair);
+  };
+
+  // Exhaustive evaluation (default parameters): no cache is written
+  Pair exhaustive_pair;
+  EXPECT_TRUE(choose_initial_pair(0, 0.f, false, exhaustive_pair));
+  EXPECT_FALSE(stlplus::file_exists(sScore_cache_file));
+
+  // Evaluate only the 4 pairs with the largest parallax (among the 24 pairs)
+  Pair staged_pair;
+  EXPECT_TRUE(choose_initial_pair(4, 0.f, true, staged_pair));
+  EXPECT_TRUE(stlplus::file_exists(sScore_cache_file));
+
+  // The cached scores give the same pair
+  Pair cached_pair;
+  EXPECT_TRUE(choose_initial_pair(4, 0.f, true, cached_pair));
+  EXPECT_TRUE(staged_pair == cached_pair);
+
+  // The evaluation stops at the first pair above the early stop angle
+  Pair early_stop_pair;
+  EXPECT_TRUE(choose_initial_pair(0, 1.f, false, early_stop_pair));
+
+  // Features re-extracted with the same matches: the cached scores are outdated
+  const auto read_file = [](const std::string & filename)
+  {
+    std::ifstream stream(filename);
+    return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+  };
+  const std::string cached_scores = read_file(sScore_cache_file);
+  std::normal_distribution<double> other_distribution(0.0,0.25);
+  feats_provider->feats_per_view.clear();
+  dynamic_cast<Synthetic_Features_Provider*>(feats_provider.get())->load(d,other_distribution);
+  EXPECT_TRUE(choose_initial_pair(4, 0.f, true, cached_pair));
+  EXPECT_TRUE(cached_scores != read_file(sScore_cache_file));
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
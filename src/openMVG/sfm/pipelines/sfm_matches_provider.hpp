@@ -12,6 +12,7 @@
 #include <string>
 
 #include "openMVG/matching/indMatch.hpp"
+#include "openMVG/matching/indMatch_store.hpp"
 #include "openMVG/matching/indMatch_utils.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/types.hpp"
@@ -31,6 +32,23 @@ struct Matches_Provider
   // Load matches from the provided matches file
   virtual bool load(const SfM_Data & sfm_data, const std::string & matchesfile)
   {
+    if (stlplus::extension_part(matchesfile) == "bmat")
+    {
+      // Match store: only the pairs of the SfM_Data views are read
+      matching::Matches_Store store;
+      if (!store.Open(matchesfile)) {
+        std::cerr<< "Unable to read the matches store:" << matchesfile << std::endl;
+        return false;
+      }
+      const Views & views = sfm_data.GetViews();
+      pairWise_matches_.clear();
+      for (const Pair & pair : store.GetPairs())
+      {
+        if (views.count(pair.first) && views.count(pair.second))
+          store.Get(pair, pairWise_matches_[pair]);
+      }
+      return true;
+    }
     if (!stlplus::is_file(matchesfile))
     {
       return false;
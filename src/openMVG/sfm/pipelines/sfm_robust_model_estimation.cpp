@@ -16,6 +16,7 @@
 #include "openMVG/multiview/solver_essential_eight_point.hpp"
 #include "openMVG/multiview/solver_essential_kernel.hpp"
 #include "openMVG/multiview/solver_fundamental_kernel.hpp"
+#include "openMVG/multiview/solver_homography_kernel.hpp"
 #include "openMVG/numeric/numeric.h"
 #include "openMVG/robust_estimation/robust_estimator_ACRansac.hpp"
 #include "openMVG/robust_estimation/robust_estimator_ACRansacKernelAdaptator.hpp"
@@ -119,5 +120,42 @@ bool robustRelativePose
   return true;
 }
 
+bool robustHomography
+(
+  const Mat & x1,
+  const Mat & x2,
+  const std::pair<size_t, size_t> & size_ima1,
+  const std::pair<size_t, size_t> & size_ima2,
+  Mat3 & H,
+  std::vector<uint32_t> & vec_inliers,
+  const size_t max_iteration_count,
+  const double precision
+)
+{
+  // Define the AContrario adapted Homography matrix solver
+  using KernelType =
+    robust::ACKernelAdaptor<
+      openMVG::homography::kernel::FourPointSolver,
+      openMVG::homography::kernel::AsymmetricError,
+      UnnormalizerI,
+      Mat3>;
+
+  KernelType kernel(
+    x1, size_ima1.first, size_ima1.second,
+    x2, size_ima2.first, size_ima2.second,
+    false); // configure as point to point error model.
+
+  // Robustly estimate the Homography matrix with A Contrario ransac
+  robust::ACRANSAC(kernel, vec_inliers, max_iteration_count, &H,
+    precision, false);
+
+  if (vec_inliers.size() < 2.5 * KernelType::MINIMUM_SAMPLES)
+  {
+    vec_inliers.clear();
+    return false; // no sufficient coverage (the model does not support enough samples)
+  }
+  return true;
+}
+
 } // namespace sfm
 } // namespace openMVG
@@ -60,6 +60,34 @@ bool robustRelativePose
   const size_t max_iteration_count = 4096
 );
 
+/**
+ * @brief Robust estimation of the homography between two views from point matches.
+ *  The ratio of inliers is a good indicator of the parallax of the pair:
+ *  a pure rotation or a planar scene leads to a large ratio.
+ *
+ * @param[in] x1 image points in image 1
+ * @param[in] x2 image points in image 2
+ * @param[in] size_ima1 width, height of image 1
+ * @param[in] size_ima2 width, height of image 2
+ * @param[out] H the found homography (x2 = H x1)
+ * @param[out] vec_inliers the homography inliers
+ * @param[in] max iteration count
+ * @param[in] precision upper bound of the inlier residual error (squared pixels).
+ *  It must be bounded: else the a contrario threshold can grow up to the
+ *  parallax of the pair and the inlier ratio is over estimated.
+ */
+bool robustHomography
+(
+  const Mat & x1,
+  const Mat & x2,
+  const std::pair<size_t, size_t> & size_ima1,
+  const std::pair<size_t, size_t> & size_ima2,
+  Mat3 & H,
+  std::vector<uint32_t> & vec_inliers,
+  const size_t max_iteration_count = 256,
+  const double precision = 4.0 * 4.0
+);
+
 } // namespace sfm
 } // namespace openMVG
 
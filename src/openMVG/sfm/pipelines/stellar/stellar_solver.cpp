@@ -20,6 +20,7 @@
 #include "openMVG/sfm/sfm_data_filters.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/sfm/sfm_data_triangulation.hpp"
+#include "openMVG/sfm/sfm_landmark_dense.hpp"
 
 #include "openMVG/tracks/tracks.hpp"
 #include "openMVG/types.hpp"
@@ -595,14 +596,16 @@ bool Stellar_Solver::Optimize
       min_track_length);
 
     // Remove outliers (max_angle, residual error)
+    //  (one columnar copy of the structure is shared by the filters and the BA)
     const size_t pointcount_initial = stellar_pod_reconstruction.structure.size();
-    RemoveOutliers_PixelResidualError(stellar_pod_reconstruction, 4.0);
-    RemoveOutliers_AngleError(stellar_pod_reconstruction, 2.0);
+    Dense_Landmarks landmarks(stellar_pod_reconstruction.structure);
+    RemoveOutliers_PixelResidualError(stellar_pod_reconstruction, landmarks, 4.0);
+    RemoveOutliers_AngleError(stellar_pod_reconstruction, landmarks, 2.0);
 
     // Remove poses that does not cover a sufficient number of observations (some observations are removed too)
-    eraseUnstablePosesAndObservations(stellar_pod_reconstruction, min_point_per_pose, min_track_length);
+    eraseUnstablePosesAndObservations(stellar_pod_reconstruction, landmarks, min_point_per_pose, min_track_length);
 
-    if (!bundle_adjustment_obj.Adjust(stellar_pod_reconstruction, ba_refine_parameter_options))
+    if (!bundle_adjustment_obj.Adjust(stellar_pod_reconstruction, ba_refine_parameter_options, landmarks))
     {
       return false;
     }
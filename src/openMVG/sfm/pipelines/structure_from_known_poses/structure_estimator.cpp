@@ -323,37 +323,23 @@ void SfM_Data_Structure_Estimation_From_Known_Poses::triangulate(
   C_Progress_display my_progress_bar( map_tracksCommon.size(), std::cout,
     "Tracks to structure conversion:\n" );
   // Fill sfm_data with the computed tracks (no 3D yet)
-#ifdef OPENMVG_USE_OPENMP
-  #pragma omp parallel for schedule(dynamic)
-#endif // OPENMVG_USE_OPENMP
-  for (int i = 0; i < map_tracksCommon.size(); ++i)
+  for (const auto & track_it : map_tracksCommon)
   {
     ++my_progress_bar;
 
-    tracks::STLMAPTracks::const_iterator itTracks = map_tracksCommon.begin();
-    std::advance(itTracks, i);
+    const tracks::submapTrack & track = track_it.second;
+    Observations & obs = sfm_data.structure[track_it.first].obs;
+    for (const auto & track_obs : track)
     {
-      const tracks::submapTrack & track = itTracks->second;
-
-      Observations obs;
-      for (const auto & track_obs : track)
-      {
-        const IndexT imaIndex = track_obs.first;
-        const IndexT featIndex = track_obs.second;
-        const std::shared_ptr<features::Regions> regions = regions_provider->get(imaIndex);
-        const Vec2 pt = regions->GetRegionPosition(featIndex);
-        obs[imaIndex] = Observation(pt, featIndex);
-      }
-      Landmark landmark;
-      if (structure_estimator.robust_triangulation(sfm_data, obs, landmark))
-      #ifdef OPENMVG_USE_OPENMP
-      #pragma omp critical
-      #endif // OPENMVG_USE_OPENMP
-      {
-        sfm_data.structure[itTracks->first] = landmark;
-      }
+      const IndexT imaIndex = track_obs.first;
+      const IndexT featIndex = track_obs.second;
+      const std::shared_ptr<features::Regions> regions = regions_provider->get(imaIndex);
+      const Vec2 pt = regions->GetRegionPosition(featIndex);
+      obs[imaIndex] = Observation(pt, featIndex);
     }
   }
+  // Robust triangulation of the tracks (unsuccessful tracks are removed)
+  structure_estimator.triangulate(sfm_data);
 }
 
 } // namespace sfm
@@ -0,0 +1,234 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/pipelines/two_view_refinement.hpp"
+
+#include "openMVG/multiview/triangulation.hpp"
+#include "openMVG/numeric/numeric.h"
+
+#include <cmath>
+#include <limits>
+
+namespace openMVG {
+namespace sfm {
+
+namespace {
+
+using Mat23 = Eigen::Matrix<double, 2, 3>;
+using Mat25 = Eigen::Matrix<double, 2, 5>;
+using Mat53 = Eigen::Matrix<double, 5, 3>;
+using Mat5 = Eigen::Matrix<double, 5, 5>;
+using Vec5 = Eigen::Matrix<double, 5, 1>;
+
+// Orthonormal basis (rows) of the plane orthogonal to the unit vector n
+Mat23 TangentBasis(const Vec3 & n)
+{
+  const Vec3 a = (std::abs(n.x()) < 0.9) ? Vec3::UnitX() : Vec3::UnitY();
+  Mat23 basis;
+  basis.row(0) = n.cross(a).normalized();
+  basis.row(1) = n.cross(basis.row(0).transpose());
+  return basis;
+}
+
+// Residual of the point X (camera frame) observed along the bearing b:
+//  the projection of X in the plane tangent to b at unit distance.
+// Return false if the point is not in front of the camera.
+bool TangentResidual
+(
+  const Vec3 & b,
+  const Vec3 & X,
+  Vec2 & residual,
+  Mat23 * jacobian = nullptr
+)
+{
+  const double depth = b.dot(X);
+  if (depth <= std::numeric_limits<double>::epsilon())
+    return false;
+  const Mat23 basis = TangentBasis(b);
+  residual = basis * X / depth;
+  if (jacobian)
+    *jacobian = (basis - residual * b.transpose()) / depth;
+  return true;
+}
+
+} // namespace
+
+Two_View_Refiner::Two_View_Refiner
+(
+  const Two_View_Refinement_Options & options
+): options_(options)
+{
+}
+
+double Two_View_Refiner::Cost
+(
+  const Mat3 & R,
+  const Vec3 & t,
+  const std::vector<Vec3> & points
+) const
+{
+  double cost = 0.0;
+  Vec2 residual;
+  for (size_t k = 0; k < points.size(); ++k)
+  {
+    if (!TangentResidual(bearing1_[k], points[k], residual))
+      return std::numeric_limits<double>::infinity();
+    cost += residual.squaredNorm();
+    if (!TangentResidual(bearing2_[k], R * points[k] + t, residual))
+      return std::numeric_limits<double>::infinity();
+    cost += residual.squaredNorm();
+  }
+  return cost;
+}
+
+bool Two_View_Refiner::Refine
+(
+  const Mat3X & bearing1,
+  const Mat3X & bearing2,
+  geometry::Pose3 & relative_pose,
+  const ETriangulationMethod triangulation_method
+)
+{
+  points_.clear();
+  bearing1_.clear();
+  bearing2_.clear();
+  initial_rmse_ = final_rmse_ = 0.0;
+
+  Mat3 R = relative_pose.rotation();
+  Vec3 t = relative_pose.translation();
+  const double translation_norm = t.norm();
+  if (translation_norm <= std::numeric_limits<double>::epsilon())
+    return false;
+  t /= translation_norm;
+
+  // Initialize the structure (keep only the points in front of the cameras)
+  for (Mat3X::Index k = 0; k < bearing1.cols(); ++k)
+  {
+    const Vec3 b1 = bearing1.col(k).normalized(), b2 = bearing2.col(k).normalized();
+    Vec3 X;
+    if (Triangulate2View(Mat3::Identity(), Vec3::Zero(), b1, R, t, b2, X, triangulation_method)
+        && b1.dot(X) > 0.0 && b2.dot(R * X + t) > 0.0)
+    {
+      bearing1_.push_back(b1);
+      bearing2_.push_back(b2);
+      points_.push_back(X);
+    }
+  }
+  const size_t nb_points = points_.size();
+  if (nb_points < options_.min_points)
+    return false;
+
+  point_hessians_.resize(nb_points);
+  point_hessians_inverse_.resize(nb_points);
+  pose_point_hessians_.resize(nb_points);
+  point_gradients_.resize(nb_points);
+  candidate_points_.resize(nb_points);
+
+  double cost = Cost(R, t, points_);
+  if (!std::isfinite(cost))
+    return false;
+  const double initial_cost = cost;
+
+  double lambda = 1e-4;
+  for (int iteration = 0; iteration < options_.max_iterations; ++iteration)
+  {
+    //-- Build the normal equations:
+    // [A   B] [dp]   [gp]
+    // [B^t C] [dx] = [gx]
+    // The pose update dp is (rotation: 3, translation direction: 2),
+    //  C is block diagonal (one 3x3 block per point).
+    const Eigen::Matrix<double, 3, 2> translation_basis = TangentBasis(t).transpose();
+    Mat5 A = Mat5::Zero();
+    Vec5 gp = Vec5::Zero();
+    Vec2 residual1, residual2;
+    Mat23 J1, J2;
+    for (size_t k = 0; k < nb_points; ++k)
+    {
+      const Vec3 & X = points_[k];
+      const Vec3 RX = R * X;
+      TangentResidual(bearing1_[k], X, residual1, &J1);
+      TangentResidual(bearing2_[k], RX + t, residual2, &J2);
+
+      // Second view Jacobians (left rotation update: exp([w]x) R)
+      Mat25 Jp;
+      Jp.leftCols<3>() = - J2 * CrossProductMatrix(RX);
+      Jp.rightCols<2>() = J2 * translation_basis;
+      const Mat23 J2_X = J2 * R;
+
+      A.noalias() += Jp.transpose() * Jp;
+      gp.noalias() += Jp.transpose() * residual2;
+      point_hessians_[k].noalias() = J1.transpose() * J1 + J2_X.transpose() * J2_X;
+      pose_point_hessians_[k].noalias() = Jp.transpose() * J2_X;
+      point_gradients_[k].noalias() =
+        J1.transpose() * residual1 + J2_X.transpose() * residual2;
+    }
+
+    //-- Solve the damped system by eliminating the points (Schur complement)
+    // until a step decreases the cost
+    bool step_accepted = false;
+    bool converged = false;
+    while (!step_accepted && lambda < 1e10)
+    {
+      Mat5 S = A;
+      S.diagonal() += lambda * A.diagonal();
+      Vec5 rhs = -gp;
+      for (size_t k = 0; k < nb_points; ++k)
+      {
+        Mat3 C = point_hessians_[k];
+        C.diagonal() += lambda * point_hessians_[k].diagonal();
+        point_hessians_inverse_[k] = C.inverse();
+        const Mat53 B_Cinv = pose_point_hessians_[k] * point_hessians_inverse_[k];
+        S.noalias() -= B_Cinv * pose_point_hessians_[k].transpose();
+        rhs.noalias() += B_Cinv * point_gradients_[k];
+      }
+      const Vec5 dp = S.ldlt().solve(rhs);
+      if (!dp.allFinite())
+      {
+        lambda *= 10.0;
+        continue;
+      }
+
+      // Candidate update
+      const Vec3 w = dp.head<3>();
+      const double angle = w.norm();
+      const Mat3 candidate_R = (angle > 0.0) ?
+        Mat3(Eigen::AngleAxisd(angle, w / angle).toRotationMatrix() * R) : R;
+      const Vec3 candidate_t = (t + translation_basis * dp.tail<2>()).normalized();
+      for (size_t k = 0; k < nb_points; ++k)
+      {
+        candidate_points_[k] = points_[k] - point_hessians_inverse_[k]
+          * (point_gradients_[k] + pose_point_hessians_[k].transpose() * dp);
+      }
+
+      const double candidate_cost = Cost(candidate_R, candidate_t, candidate_points_);
+      if (candidate_cost < cost)
+      {
+        converged = (cost - candidate_cost) < options_.function_tolerance * cost;
+        R = candidate_R;
+        t = candidate_t;
+        points_.swap(candidate_points_);
+        cost = candidate_cost;
+        lambda = std::max(lambda / 10.0, 1e-10);
+        step_accepted = true;
+      }
+      else
+      {
+        lambda *= 10.0;
+      }
+    }
+    if (!step_accepted || converged)
+      break;
+  }
+
+  initial_rmse_ = std::sqrt(initial_cost / (2 * nb_points));
+  final_rmse_ = std::sqrt(cost / (2 * nb_points));
+
+  relative_pose = geometry::Pose3(R, - translation_norm * R.transpose() * t);
+  return true;
+}
+
+} // namespace sfm
+} // namespace openMVG
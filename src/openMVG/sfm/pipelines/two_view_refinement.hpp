@@ -0,0 +1,99 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_TWO_VIEW_REFINEMENT_HPP
+#define OPENMVG_SFM_TWO_VIEW_REFINEMENT_HPP
+
+#include <vector>
+
+#include "openMVG/geometry/pose3.hpp"
+#include "openMVG/multiview/triangulation_method.hpp"
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+
+namespace openMVG {
+namespace sfm {
+
+/// Options of the two view (relative pose and structure) refinement
+struct Two_View_Refinement_Options
+{
+  int max_iterations = 20;
+  // Stop once the relative decrease of the cost is below this value
+  double function_tolerance = 1e-8;
+  // Minimal number of triangulated points required to run the refinement
+  unsigned int min_points = 8;
+};
+
+/**
+* @brief Refine a relative pose and its structure from the inlier bearing
+*  vectors of a pair of views (a dedicated two view bundle adjustment).
+*
+* The first camera is fixed to [I|0] and the second camera translation is kept
+*  on the unit sphere, so the problem has 5 pose parameters plus 3 parameters
+*  per point. The residuals are measured in the tangent plane of each observed
+*  bearing vector (valid for any camera model providing bearing vectors).
+* It runs a Levenberg-Marquardt damped Gauss-Newton with analytic Jacobians:
+*  the point blocks are eliminated (Schur complement) and only a 5x5 system is
+*  solved per iteration.
+*
+* The buffers are kept between the calls: use one refiner per thread.
+*/
+class Two_View_Refiner
+{
+public:
+  explicit Two_View_Refiner
+  (
+    const Two_View_Refinement_Options & options = Two_View_Refinement_Options()
+  );
+
+  /**
+  * @brief Triangulate the correspondences and refine the relative pose.
+  * @param[in] bearing1 bearing vectors of the first view (3 x N, one per column)
+  * @param[in] bearing2 corresponding bearing vectors of the second view
+  * @param[in,out] relative_pose pose of the second camera (the first camera is
+  *   the identity). The norm of its translation is kept.
+  * @param[in] triangulation_method method used to initialize the structure
+  * @return true if the pose has been refined
+  */
+  bool Refine
+  (
+    const Mat3X & bearing1,
+    const Mat3X & bearing2,
+    geometry::Pose3 & relative_pose,
+    const ETriangulationMethod triangulation_method = ETriangulationMethod::DEFAULT
+  );
+
+  /// Number of points used by the last refinement
+  size_t NumPoints() const { return points_.size(); }
+
+  /// Initial and final root mean square residual of the last refinement (radians)
+  double InitialRMSE() const { return initial_rmse_; }
+  double FinalRMSE() const { return final_rmse_; }
+
+private:
+  /// Sum of the squared residuals (infinity if a point is behind a camera)
+  double Cost
+  (
+    const Mat3 & R,
+    const Vec3 & t,
+    const std::vector<Vec3> & points
+  ) const;
+
+  Two_View_Refinement_Options options_;
+
+  // Per point buffers (reused between the calls)
+  std::vector<Vec3> bearing1_, bearing2_;
+  std::vector<Vec3> points_, candidate_points_;
+  std::vector<Mat3> point_hessians_, point_hessians_inverse_;
+  std::vector<Eigen::Matrix<double, 5, 3>> pose_point_hessians_;
+  std::vector<Vec3> point_gradients_;
+
+  double initial_rmse_ = 0.0, final_rmse_ = 0.0;
+};
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_TWO_VIEW_REFINEMENT_HPP
@@ -0,0 +1,107 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/pipelines/two_view_refinement.hpp"
+#include "openMVG/multiview/test_data_sets.hpp"
+#include "openMVG/numeric/numeric.h"
+
+#include "testing/testing.h"
+
+#include <random>
+
+using namespace openMVG;
+using namespace openMVG::geometry;
+using namespace openMVG::sfm;
+
+// Return the bearing vectors of the scene points seen by the camera (R, t),
+//  perturbed by an angular noise of noise_sigma radians
+Mat3X NoisyBearings
+(
+  const NViewDataSet & d,
+  const size_t camera,
+  const double noise_sigma,
+  std::mt19937 & random_generator
+)
+{
+  std::normal_distribution<double> noise(0.0, noise_sigma);
+  Mat3X bearings(3, d._X.cols());
+  for (Mat3X::Index k = 0; k < d._X.cols(); ++k)
+  {
+    const Vec3 b = (d._R[camera] * d._X.col(k) + d._t[camera]).normalized();
+    const Vec3 perturbation(noise(random_generator), noise(random_generator), noise(random_generator));
+    bearings.col(k) = (b + perturbation - b.dot(perturbation) * b).normalized();
+  }
+  return bearings;
+}
+
+// Angular error (degrees) between the rotations and the translation directions of two poses
+std::pair<double, double> PoseError(const Pose3 & pose, const Pose3 & pose_gt)
+{
+  return {
+    R2D(getRotationMagnitude(pose.rotation() * pose_gt.rotation().transpose())),
+    R2D(std::acos(clamp(pose.translation().normalized().dot(
+      pose_gt.translation().normalized()), -1.0, 1.0)))};
+}
+
+TEST(Two_View_Refiner, Refine_Perturbed_Pose) {
+
+  const NViewDataSet d = NRealisticCamerasRing(2, 200);
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  const double noise_sigma = 0.5 / 1000.0; // ~0.5 pixel for a 1000 pixels focal length
+  const Mat3X bearing1 = NoisyBearings(d, 0, noise_sigma, random_generator);
+  const Mat3X bearing2 = NoisyBearings(d, 1, noise_sigma, random_generator);
+
+  // Ground truth relative pose (second camera in the first camera frame)
+  const Mat3 R_gt = d._R[1] * d._R[0].transpose();
+  const Vec3 t_gt = d._t[1] - R_gt * d._t[0];
+  const Pose3 pose_gt(R_gt, -R_gt.transpose() * t_gt);
+
+  // Perturbed initial pose
+  const Mat3 R = Mat3(Eigen::AngleAxisd(D2R(1.0), Vec3(1, 2, 3).normalized())) * R_gt;
+  const Vec3 t = (t_gt + 0.05 * t_gt.norm() * Vec3(0.3, -0.5, 0.2)).normalized() * 2.0;
+  Pose3 pose(R, -R.transpose() * t);
+  const std::pair<double, double> initial_error = PoseError(pose, pose_gt);
+
+  Two_View_Refiner refiner;
+  EXPECT_TRUE(refiner.Refine(bearing1, bearing2, pose));
+  EXPECT_EQ(200, refiner.NumPoints());
+
+  const std::pair<double, double> final_error = PoseError(pose, pose_gt);
+  EXPECT_TRUE(final_error.first < initial_error.first / 10.0);
+  EXPECT_TRUE(final_error.second < initial_error.second / 10.0);
+  EXPECT_TRUE(refiner.FinalRMSE() < refiner.InitialRMSE());
+  // The residuals are at the noise level
+  EXPECT_TRUE(refiner.FinalRMSE() < 2.0 * noise_sigma);
+  // The translation norm is kept
+  EXPECT_NEAR(2.0, pose.translation().norm(), 1e-8);
+
+  // The refiner buffers can be reused for another problem
+  Pose3 pose_exact = pose_gt;
+  const Mat3X exact_bearing1 = NoisyBearings(d, 0, 0.0, random_generator);
+  const Mat3X exact_bearing2 = NoisyBearings(d, 1, 0.0, random_generator);
+  EXPECT_TRUE(refiner.Refine(exact_bearing1, exact_bearing2, pose_exact));
+  EXPECT_TRUE(PoseError(pose_exact, pose_gt).first < 1e-6);
+  EXPECT_TRUE(refiner.FinalRMSE() < 1e-8);
+}
+
+TEST(Two_View_Refiner, Not_Enough_Points) {
+
+  const NViewDataSet d = NRealisticCamerasRing(2, 5);
+  std::mt19937 random_generator(std::mt19937::default_seed);
+  const Mat3 R_gt = d._R[1] * d._R[0].transpose();
+  const Vec3 t_gt = d._t[1] - R_gt * d._t[0];
+  Pose3 pose(R_gt, -R_gt.transpose() * t_gt);
+
+  Two_View_Refiner refiner;
+  EXPECT_FALSE(refiner.Refine(
+    NoisyBearings(d, 0, 0.0, random_generator),
+    NoisyBearings(d, 1, 0.0, random_generator),
+    pose));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -12,6 +12,8 @@
 #include <omp.h>
 #endif
 
+#include "ceres/iteration_callback.h"
+#include "ceres/ordered_groups.h"
 #include "ceres/problem.h"
 #include "ceres/solver.h"
 #include "openMVG/cameras/Camera_Common.hpp"
@@ -23,13 +25,18 @@
 #include "openMVG/sfm/sfm_data_BA_ceres_camera_functor.hpp"
 #include "openMVG/sfm/sfm_data_transform.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_landmark_dense.hpp"
+#include "openMVG/system/memory.hpp"
 #include "openMVG/types.hpp"
 
 #include <ceres/rotation.h>
 #include <ceres/types.h>
 
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
 #include <limits>
+#include <sstream>
 
 namespace openMVG {
 namespace sfm {
@@ -76,6 +83,30 @@ struct PoseCenterConstraintCostFunction
   }
 };
 
+// Ceres IterationCallback used to display the time and memory used by each iteration
+class BA_IterationStatisticsCallback : public ceres::IterationCallback
+{
+public:
+  ceres::CallbackReturnType operator()
+  (
+    const ceres::IterationSummary& summary
+  ) override
+  {
+    std::ostringstream os;
+    os
+      << " BA iteration: " << std::setw(4) << summary.iteration
+      << " cost: " << std::scientific << std::setprecision(6) << summary.cost
+      << std::fixed << std::setprecision(3)
+      << " iter time (s): " << summary.iteration_time_in_seconds
+      << " solver time (s): " << summary.step_solver_time_in_seconds
+      << " linear iter: " << summary.linear_solver_iterations
+      << " memory (MiB): " << std::setprecision(1)
+      << system::BytesToMiB(system::CurrentResidentMemory());
+    std::cout << os.str() << std::endl;
+    return ceres::SOLVER_CONTINUE;
+  }
+};
+
 /// Create the appropriate cost functor according the provided input camera intrinsic model.
 /// The residual can be weighetd if desired (default 0.0 means no weight).
 ceres::CostFunction * IntrinsicsToCostFunction
@@ -112,7 +143,13 @@ Bundle_Adjustment_Ceres::BA_Ceres_options::BA_Ceres_options
 : bVerbose_(bVerbose),
   nb_threads_(1),
   parameter_tolerance_(1e-8), //~= numeric_limits<float>::epsilon()
-  bUse_loss_function_(true)
+  bUse_loss_function_(true),
+  bAutomatic_solver_selection_(true),
+  max_schur_complement_memory_mb_(4096.0),
+  iterative_solver_pose_threshold_(20000),
+  cluster_jacobi_pose_threshold_(5000),
+  bReport_solver_selection_(false),
+  bReport_iteration_statistics_(false)
 {
   #ifdef OPENMVG_USE_OPENMP
     nb_threads_ = omp_get_max_threads();
@@ -125,6 +162,7 @@ Bundle_Adjustment_Ceres::BA_Ceres_options::BA_Ceres_options
   // Default configuration use a DENSE representation
   linear_solver_type_ = ceres::DENSE_SCHUR;
   preconditioner_type_ = ceres::JACOBI;
+  sparse_linear_algebra_library_type_ = ceres::NO_SPARSE;
   // If Sparse linear solver are available
   // Descending priority order by efficiency (SUITE_SPARSE > CX_SPARSE > EIGEN_SPARSE)
   if (ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::SUITE_SPARSE))
@@ -162,11 +200,163 @@ Bundle_Adjustment_Ceres::ceres_options()
   return ceres_options_;
 }
 
+double Bundle_Adjustment_Ceres::Problem_Size_Statistics::EstimatedSchurComplementMemoryMB
+(
+  const bool dense_storage
+) const
+{
+  // A pose is a 6x6 block of the reduced camera matrix
+  const double block_bytes = 6. * 6. * sizeof(double);
+  if (dense_storage)
+  {
+    const double dim = 6. * num_poses;
+    return dim * dim * sizeof(double) / (1024. * 1024.);
+  }
+  // Sparse storage: diagonal blocks + upper triangular covisibility blocks.
+  // The Cholesky factorization creates fill-in, a conservative factor is used.
+  const double fill_in_factor = 3.0;
+  return fill_in_factor * (num_poses + num_covisible_pose_pairs) * block_bytes
+    / (1024. * 1024.);
+}
+
+Bundle_Adjustment_Ceres::Problem_Size_Statistics
+Bundle_Adjustment_Ceres::ComputeProblemSizeStatistics
+(
+  const SfM_Data & sfm_data,
+  const bool bCount_covisible_pose_pairs
+)
+{
+  Problem_Size_Statistics statistics;
+  statistics.num_poses = sfm_data.GetPoses().size();
+  statistics.num_landmarks = sfm_data.GetLandmarks().size();
+
+  if (!bCount_covisible_pose_pairs)
+  {
+    // Bound the covisibility by all the pose pairs,
+    //  it avoids building the pose <-> landmark adjacency lists.
+    for (const auto & landmark_it : sfm_data.GetLandmarks())
+      statistics.num_observations += landmark_it.second.obs.size();
+    statistics.num_covisible_pose_pairs =
+      statistics.num_poses * (statistics.num_poses - (statistics.num_poses > 0)) / 2;
+    statistics.bCovisible_pose_pairs_upper_bound = true;
+    return statistics;
+  }
+
+  // Assign a contiguous index to the poses
+  Hash_Map<IndexT, IndexT> pose_index;
+  for (const auto & pose_it : sfm_data.GetPoses())
+  {
+    const IndexT index = pose_index.size();
+    pose_index[pose_it.first] = index;
+  }
+
+  // Build the pose <-> landmark visibility adjacency lists
+  std::vector<std::vector<IndexT>> landmark_to_poses;
+  landmark_to_poses.reserve(sfm_data.GetLandmarks().size());
+  std::vector<std::vector<IndexT>> pose_to_landmarks(pose_index.size());
+  for (const auto & landmark_it : sfm_data.GetLandmarks())
+  {
+    const IndexT landmark_index = landmark_to_poses.size();
+    landmark_to_poses.emplace_back();
+    landmark_to_poses.back().reserve(landmark_it.second.obs.size());
+    for (const auto & obs_it : landmark_it.second.obs)
+    {
+      ++statistics.num_observations;
+      const auto view_it = sfm_data.GetViews().find(obs_it.first);
+      if (view_it == sfm_data.GetViews().end())
+        continue;
+      const auto pose_index_it = pose_index.find(view_it->second->id_pose);
+      if (pose_index_it == pose_index.end())
+        continue;
+      landmark_to_poses.back().push_back(pose_index_it->second);
+      pose_to_landmarks[pose_index_it->second].push_back(landmark_index);
+    }
+  }
+
+  // Count the pose pairs sharing at least one landmark
+  // (the off-diagonal non-zero blocks of the reduced camera matrix)
+  std::size_t num_covisible_pose_pairs = 0;
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic) reduction(+:num_covisible_pose_pairs)
+#endif
+  for (int i = 0; i < static_cast<int>(pose_to_landmarks.size()); ++i)
+  {
+    std::vector<IndexT> neighbors;
+    for (const IndexT landmark_index : pose_to_landmarks[i])
+    {
+      for (const IndexT j : landmark_to_poses[landmark_index])
+      {
+        if (j > static_cast<IndexT>(i))
+          neighbors.push_back(j);
+      }
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    num_covisible_pose_pairs +=
+      std::distance(neighbors.begin(), std::unique(neighbors.begin(), neighbors.end()));
+  }
+  statistics.num_covisible_pose_pairs = num_covisible_pose_pairs;
+  return statistics;
+}
+
+Bundle_Adjustment_Ceres::BA_Ceres_options
+Bundle_Adjustment_Ceres::SelectLinearSolver
+(
+  const Problem_Size_Statistics & statistics
+) const
+{
+  BA_Ceres_options options = ceres_options_;
+  if (!options.bAutomatic_solver_selection_)
+    return options;
+
+  // Only the Schur based solvers are considered
+  const auto linear_solver_type =
+    static_cast<ceres::LinearSolverType>(options.linear_solver_type_);
+  if (linear_solver_type != ceres::DENSE_SCHUR &&
+      linear_solver_type != ceres::SPARSE_SCHUR)
+    return options;
+
+  const double schur_memory_mb = statistics.EstimatedSchurComplementMemoryMB(
+    linear_solver_type == ceres::DENSE_SCHUR);
+
+  if (statistics.num_poses >= options.iterative_solver_pose_threshold_ ||
+      schur_memory_mb > options.max_schur_complement_memory_mb_)
+  {
+    // The reduced camera matrix is never factorized:
+    // - it is solved with a Conjugate Gradient,
+    // - CLUSTER_JACOBI (requires SuiteSparse) gives a better conditioning
+    //   but its construction cost grows with the number of poses.
+    options.linear_solver_type_ = ceres::ITERATIVE_SCHUR;
+    if (ceres::IsSparseLinearAlgebraLibraryTypeAvailable(ceres::SUITE_SPARSE) &&
+        statistics.num_poses <= options.cluster_jacobi_pose_threshold_)
+    {
+      options.preconditioner_type_ = ceres::CLUSTER_JACOBI;
+      options.sparse_linear_algebra_library_type_ = ceres::SUITE_SPARSE;
+    }
+    else
+    {
+      options.preconditioner_type_ = ceres::SCHUR_JACOBI;
+    }
+  }
+
+  return options;
+}
+
 bool Bundle_Adjustment_Ceres::Adjust
 (
   SfM_Data & sfm_data,     // the SfM scene to refine
   const Optimize_Options & options
 )
+{
+  Dense_Landmarks landmarks(sfm_data.structure);
+  return Adjust(sfm_data, options, landmarks);
+}
+
+bool Bundle_Adjustment_Ceres::Adjust
+(
+  SfM_Data & sfm_data,     // the SfM scene to refine
+  const Optimize_Options & options,
+  Dense_Landmarks & landmarks
+)
 {
   //----------
   // Add camera parameters
@@ -230,6 +420,7 @@ bool Bundle_Adjustment_Ceres::Adjust
           }
           sim_to_center = openMVG::geometry::Similarity3(openMVG::sfm::Pose3(Mat3::Identity(), pose_centroid), 1.0);
           openMVG::sfm::ApplySimilarity(sim_to_center, sfm_data, true);
+          landmarks.ReadPositions(sfm_data.structure);
         }
       }
     }
@@ -257,7 +448,8 @@ bool Bundle_Adjustment_Ceres::Adjust
 
     double * parameter_block = &map_poses.at(indexPose)[0];
     problem.AddParameterBlock(parameter_block, 6);
-    if (options.extrinsics_opt == Extrinsic_Parameter_Type::NONE)
+    if (options.extrinsics_opt == Extrinsic_Parameter_Type::NONE
+        || options.constant_pose_ids.count(indexPose))
     {
       // set the whole parameter block as constant for best performance
       problem.SetParameterBlockConstant(parameter_block);
@@ -331,21 +523,23 @@ bool Bundle_Adjustment_Ceres::Adjust
       : nullptr;
 
   // For all visibility add reprojections errors:
-  for (auto & structure_landmark_it : sfm_data.structure)
+  //  (the landmark positions are adjusted in the columnar copy of the structure,
+  //   the cost functors keep a pointer to its observations)
+  for (IndexT slot = 0; slot < landmarks.size(); ++slot)
   {
-    const Observations & obs = structure_landmark_it.second.obs;
+    double * landmark_X = landmarks.X(slot).data();
 
-    for (const auto & obs_it : obs)
+    for (std::size_t i = landmarks.obs_begin(slot); i < landmarks.obs_end(slot); ++i)
     {
       // Build the residual block corresponding to the track observation:
-      const View * view = sfm_data.views.at(obs_it.first).get();
+      const View * view = sfm_data.views.at(landmarks.obs_view_id(i)).get();
 
       // Each Residual block takes a point and a camera as input and outputs a 2
       // dimensional residual. Internally, the cost function stores the observed
       // image location and compares the reprojection against the observation.
       ceres::CostFunction* cost_function =
         IntrinsicsToCostFunction(sfm_data.intrinsics.at(view->id_intrinsic).get(),
-                                 obs_it.second.x);
+                                 landmarks.obs_x(i));
 
       if (cost_function)
       {
@@ -355,14 +549,14 @@ bool Bundle_Adjustment_Ceres::Adjust
             p_LossFunction,
             &map_intrinsics.at(view->id_intrinsic)[0],
             &map_poses.at(view->id_pose)[0],
-            structure_landmark_it.second.X.data());
+            landmark_X);
         }
         else
         {
           problem.AddResidualBlock(cost_function,
             p_LossFunction,
             &map_poses.at(view->id_pose)[0],
-            structure_landmark_it.second.X.data());
+            landmark_X);
         }
       }
       else
@@ -372,7 +566,7 @@ bool Bundle_Adjustment_Ceres::Adjust
       }
     }
     if (options.structure_opt == Structure_Parameter_Type::NONE)
-      problem.SetParameterBlockConstant(structure_landmark_it.second.X.data());
+      problem.SetParameterBlockConstant(landmark_X);
   }
 
   if (options.control_point_opt.bUse_control_points)
@@ -452,23 +646,108 @@ bool Bundle_Adjustment_Ceres::Adjust
     }
   }
 
+  // Select the linear solver according the problem size
+  BA_Ceres_options solver_options = ceres_options_;
+  if (ceres_options_.bAutomatic_solver_selection_)
+  {
+    // Start with the bound of the pose covisibility (cheap) and count the
+    // covisible pose pairs only if the bound alone discards the sparse solver.
+    Problem_Size_Statistics statistics =
+      ComputeProblemSizeStatistics(sfm_data, false);
+    solver_options = SelectLinearSolver(statistics);
+    if (solver_options.linear_solver_type_ != ceres_options_.linear_solver_type_ &&
+        ceres_options_.linear_solver_type_ == ceres::SPARSE_SCHUR &&
+        statistics.num_poses < ceres_options_.iterative_solver_pose_threshold_)
+    {
+      statistics = ComputeProblemSizeStatistics(sfm_data, true);
+      solver_options = SelectLinearSolver(statistics);
+    }
+
+    // Report the selection if asked, or if the iterative solver is used
+    if (ceres_options_.bReport_solver_selection_ ||
+        (ceres_options_.bVerbose_ &&
+         solver_options.linear_solver_type_ != ceres_options_.linear_solver_type_))
+    {
+      const bool dense_storage =
+        static_cast<ceres::LinearSolverType>(ceres_options_.linear_solver_type_)
+          == ceres::DENSE_SCHUR;
+      std::cout
+        << "Bundle Adjustment linear solver selection:\n"
+        << " #poses: " << statistics.num_poses << "\n"
+        << " #landmarks: " << statistics.num_landmarks << "\n"
+        << " #observations: " << statistics.num_observations << "\n"
+        << " #covisible pose pairs"
+        << (statistics.bCovisible_pose_pairs_upper_bound ? " (upper bound): " : ": ")
+        << statistics.num_covisible_pose_pairs << "\n"
+        << " Estimated reduced camera matrix memory (MiB): "
+        << statistics.EstimatedSchurComplementMemoryMB(dense_storage) << "\n"
+        << " Linear solver: " << ceres::LinearSolverTypeToString(
+          static_cast<ceres::LinearSolverType>(solver_options.linear_solver_type_)) << "\n"
+        << " Preconditioner: " << ceres::PreconditionerTypeToString(
+          static_cast<ceres::PreconditionerType>(solver_options.preconditioner_type_)) << std::endl;
+    }
+  }
+
   // Configure a BA engine and run it
-  //  Make Ceres automatically detect the bundle structure.
   ceres::Solver::Options ceres_config_options;
   ceres_config_options.max_num_iterations = 500;
   ceres_config_options.preconditioner_type =
-    static_cast<ceres::PreconditionerType>(ceres_options_.preconditioner_type_);
+    static_cast<ceres::PreconditionerType>(solver_options.preconditioner_type_);
   ceres_config_options.linear_solver_type =
-    static_cast<ceres::LinearSolverType>(ceres_options_.linear_solver_type_);
+    static_cast<ceres::LinearSolverType>(solver_options.linear_solver_type_);
   ceres_config_options.sparse_linear_algebra_library_type =
-    static_cast<ceres::SparseLinearAlgebraLibraryType>(ceres_options_.sparse_linear_algebra_library_type_);
-  ceres_config_options.minimizer_progress_to_stdout = ceres_options_.bVerbose_;
+    static_cast<ceres::SparseLinearAlgebraLibraryType>(solver_options.sparse_linear_algebra_library_type_);
+  ceres_config_options.minimizer_progress_to_stdout = solver_options.bVerbose_;
   ceres_config_options.logging_type = ceres::SILENT;
-  ceres_config_options.num_threads = ceres_options_.nb_threads_;
+  ceres_config_options.num_threads = solver_options.nb_threads_;
 #if CERES_VERSION_MAJOR < 2
-  ceres_config_options.num_linear_solver_threads = ceres_options_.nb_threads_;
+  ceres_config_options.num_linear_solver_threads = solver_options.nb_threads_;
 #endif
-  ceres_config_options.parameter_tolerance = ceres_options_.parameter_tolerance_;
+  ceres_config_options.parameter_tolerance = solver_options.parameter_tolerance_;
+
+  // Explicit elimination ordering for the Schur based solvers:
+  //  the landmarks are eliminated first, then the cameras (poses & intrinsics).
+  //  (Avoid the automatic independent set detection of Ceres on large problems)
+  const auto linear_solver_type =
+    static_cast<ceres::LinearSolverType>(solver_options.linear_solver_type_);
+  if (linear_solver_type == ceres::DENSE_SCHUR ||
+      linear_solver_type == ceres::SPARSE_SCHUR ||
+      linear_solver_type == ceres::ITERATIVE_SCHUR)
+  {
+    ceres::ParameterBlockOrdering * ordering = new ceres::ParameterBlockOrdering;
+    for (IndexT slot = 0; slot < landmarks.size(); ++slot)
+    {
+      if (problem.HasParameterBlock(landmarks.X(slot).data()))
+        ordering->AddElementToGroup(landmarks.X(slot).data(), 0);
+    }
+    if (options.control_point_opt.bUse_control_points)
+    {
+      for (auto & gcp_landmark_it : sfm_data.control_points)
+      {
+        if (problem.HasParameterBlock(gcp_landmark_it.second.X.data()))
+          ordering->AddElementToGroup(gcp_landmark_it.second.X.data(), 0);
+      }
+    }
+    for (auto & pose_it : map_poses)
+    {
+      ordering->AddElementToGroup(&pose_it.second[0], 1);
+    }
+    for (auto & intrinsic_it : map_intrinsics)
+    {
+      if (!intrinsic_it.second.empty())
+        ordering->AddElementToGroup(&intrinsic_it.second[0], 1);
+    }
+    if (ordering->GroupSize(0) > 0)
+      ceres_config_options.linear_solver_ordering.reset(ordering);
+    else
+      delete ordering;
+  }
+
+  BA_IterationStatisticsCallback iteration_statistics_callback;
+  if (solver_options.bReport_iteration_statistics_)
+  {
+    ceres_config_options.callbacks.push_back(&iteration_statistics_callback);
+  }
 
   // Solve BA
   ceres::Solver::Summary summary;
@@ -481,6 +760,8 @@ bool Bundle_Adjustment_Ceres::Adjust
   {
     if (ceres_options_.bVerbose_)
       std::cout << "Bundle Adjustment failed." << std::endl;
+    // Discard the partial solution of the landmarks
+    landmarks.ReadPositions(sfm_data.structure);
     return false;
   }
   else // Solution is usable
@@ -498,6 +779,10 @@ bool Bundle_Adjustment_Ceres::Adjust
         << " Initial RMSE: " << std::sqrt( summary.initial_cost / summary.num_residuals) << "\n"
         << " Final RMSE: " << std::sqrt( summary.final_cost / summary.num_residuals) << "\n"
         << " Time (s): " << summary.total_time_in_seconds << "\n"
+        << " #iterations: " << summary.iterations.size() << "\n"
+        << " Linear solver: " << ceres::LinearSolverTypeToString(summary.linear_solver_type_used) << "\n"
+        << " Preconditioner: " << ceres::PreconditionerTypeToString(summary.preconditioner_type_used) << "\n"
+        << " Peak memory (MiB): " << system::BytesToMiB(system::PeakResidentMemory()) << "\n"
         << std::endl;
       if (options.use_motion_priors_opt)
         std::cout << "Usable motion priors: " << (int)b_usable_prior << std::endl;
@@ -509,6 +794,8 @@ bool Bundle_Adjustment_Ceres::Adjust
       for (auto & pose_it : sfm_data.poses)
       {
         const IndexT indexPose = pose_it.first;
+        if (options.constant_pose_ids.count(indexPose))
+          continue;
 
         Mat3 R_refined;
         ceres::AngleAxisToRotationMatrix(&map_poses.at(indexPose)[0], R_refined.data());
@@ -546,12 +833,17 @@ bool Bundle_Adjustment_Ceres::Adjust
       }
     }
 
-    // Structure is already updated directly if needed (no data wrapping)
+    // Update the structure with refined data
+    if (options.structure_opt != Structure_Parameter_Type::NONE)
+    {
+      landmarks.UpdatePositions(sfm_data.structure);
+    }
 
     if (b_usable_prior)
     {
       // set back to the original scene centroid
       openMVG::sfm::ApplySimilarity(sim_to_center.inverse(), sfm_data, true);
+      landmarks.ReadPositions(sfm_data.structure);
 
       //--
       // - Compute some fitting statistics
@@ -12,9 +12,11 @@
 #include "openMVG/numeric/eigen_alias_definition.hpp"
 #include "openMVG/sfm/sfm_data_BA.hpp"
 
+#include <cstddef>
+
 namespace ceres { class CostFunction; }
 namespace openMVG { namespace cameras { struct IntrinsicBase; } }
-namespace openMVG { namespace sfm { struct SfM_Data; } }
+namespace openMVG { namespace sfm { struct SfM_Data; class Dense_Landmarks; } }
 
 namespace openMVG {
 namespace sfm {
@@ -42,6 +44,23 @@ class Bundle_Adjustment_Ceres : public Bundle_Adjustment
     double parameter_tolerance_;
     bool bUse_loss_function_;
 
+    // Automatic linear solver selection according to the problem size.
+    // If enabled, large problems (whose reduced camera system cannot be
+    // factorized in the memory budget) are solved with ITERATIVE_SCHUR
+    // and a Schur based preconditioner (SCHUR_JACOBI or CLUSTER_JACOBI).
+    bool bAutomatic_solver_selection_;
+    // Memory budget (in MiB) allowed for the reduced camera matrix factorization
+    double max_schur_complement_memory_mb_;
+    // Number of poses from which the iterative solver is always used
+    unsigned int iterative_solver_pose_threshold_;
+    // Number of poses up to which CLUSTER_JACOBI is preferred to SCHUR_JACOBI
+    unsigned int cluster_jacobi_pose_threshold_;
+    // Display the problem statistics & the selected solver for every problem
+    // (else they are displayed only if the iterative solver is selected)
+    bool bReport_solver_selection_;
+    // Display the time and memory used by each solver iteration
+    bool bReport_iteration_statistics_;
+
     BA_Ceres_options(const bool bVerbose = true, bool bmultithreaded = true);
   };
   private:
@@ -56,6 +75,39 @@ class Bundle_Adjustment_Ceres : public Bundle_Adjustment
 
   BA_Ceres_options & ceres_options();
 
+  /// Statistics used to choose the linear solver of a BA problem
+  struct Problem_Size_Statistics
+  {
+    std::size_t num_poses = 0;
+    std::size_t num_landmarks = 0;
+    std::size_t num_observations = 0;
+    // Number of non-zero blocks of the reduced camera matrix
+    // (pairs of poses that share at least one landmark)
+    std::size_t num_covisible_pose_pairs = 0;
+    // True if num_covisible_pose_pairs counts all the pose pairs
+    // (the covisibility has not been computed)
+    bool bCovisible_pose_pairs_upper_bound = false;
+
+    /// Estimated memory (MiB) of the factorized reduced camera matrix
+    double EstimatedSchurComplementMemoryMB(const bool dense_storage) const;
+  };
+
+  /// Compute the problem size statistics of a SfM scene.
+  /// If bCount_covisible_pose_pairs is false, the covisible pose pairs are
+  /// bounded by the number of pose pairs (no adjacency lists are built).
+  static Problem_Size_Statistics ComputeProblemSizeStatistics
+  (
+    const sfm::SfM_Data & sfm_data,
+    const bool bCount_covisible_pose_pairs = true
+  );
+
+  /// Select the linear solver & preconditioner according the problem size.
+  /// Return the options that will be used by the solver.
+  BA_Ceres_options SelectLinearSolver
+  (
+    const Problem_Size_Statistics & statistics
+  ) const;
+
   bool Adjust
   (
     // the SfM scene to refine
@@ -63,6 +115,16 @@ class Bundle_Adjustment_Ceres : public Bundle_Adjustment
     // tell which parameter needs to be adjusted
     const Optimize_Options & options
   ) override;
+
+  /// Adjust the scene with an existing columnar copy of its structure
+  /// (in sync with sfm_data.structure; its positions are kept in sync, even on failure),
+  /// so the copy can be shared with the outlier filters that follow.
+  bool Adjust
+  (
+    sfm::SfM_Data & sfm_data,
+    const Optimize_Options & options,
+    Dense_Landmarks & landmarks
+  );
 };
 
 } // namespace sfm
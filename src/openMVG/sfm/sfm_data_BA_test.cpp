@@ -23,6 +23,7 @@
 #include "testing/testing.h"
 
 #include <cmath>
+#include <cstddef>
 #include <cstdio>
 #include <iostream>
 #include <random>
@@ -306,6 +307,59 @@ TEST(BUNDLE_ADJUSTMENT, EffectiveMinimization_Pinhole_PosePriors) {
 }
 
 
+//-- Test the automatic linear solver selection (force the iterative solver)
+TEST(BUNDLE_ADJUSTMENT, EffectiveMinimization_Pinhole_IterativeSchur) {
+
+  const int nviews = 12;
+  const int npoints = 6;
+  const nViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfM_Data scene
+  SfM_Data sfm_data = getInputScene(d, config, PINHOLE_CAMERA);
+
+  // All the points are visible in all the views
+  const Bundle_Adjustment_Ceres::Problem_Size_Statistics statistics =
+    Bundle_Adjustment_Ceres::ComputeProblemSizeStatistics(sfm_data);
+  EXPECT_EQ(static_cast<std::size_t>(nviews), statistics.num_poses);
+  EXPECT_EQ(static_cast<std::size_t>(npoints), statistics.num_landmarks);
+  EXPECT_EQ(static_cast<std::size_t>(nviews * npoints), statistics.num_observations);
+  EXPECT_EQ(static_cast<std::size_t>(nviews * (nviews - 1) / 2),
+    statistics.num_covisible_pose_pairs);
+  EXPECT_FALSE(statistics.bCovisible_pose_pairs_upper_bound);
+
+  // Without the covisibility count, all the pose pairs are used as a bound
+  const Bundle_Adjustment_Ceres::Problem_Size_Statistics bounded_statistics =
+    Bundle_Adjustment_Ceres::ComputeProblemSizeStatistics(sfm_data, false);
+  EXPECT_EQ(statistics.num_observations, bounded_statistics.num_observations);
+  EXPECT_EQ(statistics.num_covisible_pose_pairs,
+    bounded_statistics.num_covisible_pose_pairs);
+  EXPECT_TRUE(bounded_statistics.bCovisible_pose_pairs_upper_bound);
+
+  const double dResidual_before = RMSE(sfm_data);
+
+  const bool bVerbose = true;
+  const bool bMultithread = false;
+  Bundle_Adjustment_Ceres::BA_Ceres_options ceres_options(bVerbose, bMultithread);
+  ceres_options.iterative_solver_pose_threshold_ = 2;
+  ceres_options.bReport_iteration_statistics_ = true;
+  Bundle_Adjustment_Ceres ba_object(ceres_options);
+
+  // The iterative solver must be selected since the scene is "large"
+  EXPECT_TRUE(ba_object.SelectLinearSolver(statistics).linear_solver_type_
+    != ceres_options.linear_solver_type_);
+
+  EXPECT_TRUE( ba_object.Adjust(sfm_data,
+    Optimize_Options(
+      Intrinsic_Parameter_Type::ADJUST_ALL,
+      Extrinsic_Parameter_Type::ADJUST_ALL,
+      Structure_Parameter_Type::ADJUST_ALL)) );
+
+  const double dResidual_after = RMSE(sfm_data);
+  EXPECT_TRUE( dResidual_before > dResidual_after);
+}
+
+
 /// Compute the Root Mean Square Error of the residuals
 double RMSE(const SfM_Data & sfm_data)
 {
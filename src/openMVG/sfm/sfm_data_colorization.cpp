@@ -13,11 +13,15 @@
 #include "openMVG/image/image_io.hpp"
 #include "openMVG/image/pixel_types.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
-#include "openMVG/stl/stl.hpp"
+#include "openMVG/sfm/sfm_landmark_dense.hpp"
 
 #include "third_party/progress/progress_display.hpp"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <queue>
+#include <utility>
+#include <vector>
+
 namespace openMVG {
 namespace sfm {
 
@@ -25,117 +29,204 @@ namespace sfm {
 bool ColorizeTracks(
   const SfM_Data & sfm_data,
   std::vector<Vec3> & vec_3dPoints,
-  std::vector<Vec3> & vec_tracksColor)
+  std::vector<Vec3> & vec_tracksColor,
+  const system::Pipeline_Options & options,
+  const bool b_average_colors)
+{
+  const Dense_Landmarks landmarks(sfm_data.GetLandmarks());
+  vec_3dPoints = landmarks.positions();
+  return ColorizeTracks(sfm_data, landmarks, vec_tracksColor, options, b_average_colors);
+}
+
+/// Find the color of columnar landmarks
+bool ColorizeTracks(
+  const SfM_Data & sfm_data,
+  const Dense_Landmarks & landmarks,
+  std::vector<Vec3> & vec_tracksColor,
+  const system::Pipeline_Options & options,
+  const bool b_average_colors)
 {
   // Colorize each track
-  // Start with the most representative image
-  //   and iterate to provide a color to each 3D point
+  // 1. List the observations of each view
+  // 2. Assign each track to a view: start with the most representative image
+  //    and iterate until each 3D point is seen by an assigned view
+  //    (or assign the tracks to all the observing views for color averaging)
+  // 3. Read the images and sample the observed pixels in parallel
 
-  {
-    C_Progress_display my_progress_bar(sfm_data.GetLandmarks().size(),
-                                       std::cout,
-                                       "\nCompute scene structure color\n");
-
-    vec_tracksColor.resize(sfm_data.GetLandmarks().size());
-    vec_3dPoints.resize(sfm_data.GetLandmarks().size());
-
-    //Build a list of contiguous index for the trackIds
-    std::map<IndexT, IndexT> trackIds_to_contiguousIndexes;
-    IndexT cpt = 0;
-    for (Landmarks::const_iterator it = sfm_data.GetLandmarks().begin();
-      it != sfm_data.GetLandmarks().end(); ++it, ++cpt)
-    {
-      trackIds_to_contiguousIndexes[it->first] = cpt;
-      vec_3dPoints[cpt] = it->second.X;
-    }
+  vec_tracksColor.assign(landmarks.size(), Vec3::Zero());
 
-    // The track list that will be colored (point removed during the process)
-    std::set<IndexT> remainingTrackToColor;
-    std::transform(sfm_data.GetLandmarks().begin(), sfm_data.GetLandmarks().end(),
-      std::inserter(remainingTrackToColor, remainingTrackToColor.begin()),
-      stl::RetrieveKey());
+  // An observation to sample: the track slot and the pixel position
+  using Track_Sample = std::pair<IndexT, const Vec2 *>;
 
-    while ( !remainingTrackToColor.empty() )
+  // Contiguous indexes of the views and their observations
+  std::vector<IndexT> view_ids;
+  std::vector<std::vector<Track_Sample>> view_samples;
+  std::vector<IndexT> obs_view_indexes(landmarks.observation_count());
+  {
+    Hash_Map<IndexT, IndexT> viewIds_to_contiguousIndexes;
+    for (IndexT slot = 0; slot < landmarks.size(); ++slot)
     {
-      // Find the most representative image (for the remaining 3D points)
-      //  a. Count the number of observation per view for each 3Dpoint Index
-      //  b. Sort to find the most representative view index
-
-      std::map<IndexT, IndexT> map_IndexCardinal; // ViewId, Cardinal
-      for (const auto & track_to_color_it : remainingTrackToColor)
+      for (std::size_t i = landmarks.obs_begin(slot); i < landmarks.obs_end(slot); ++i)
       {
-        const auto trackId = track_to_color_it;
-        const Observations & obs = sfm_data.GetLandmarks().at(trackId).obs;
-        for (const auto & obs_it : obs)
+        const auto view_it = viewIds_to_contiguousIndexes.emplace(
+          landmarks.obs_view_id(i), static_cast<IndexT>(view_ids.size()));
+        if (view_it.second)
         {
-          const auto viewId = obs_it.first;
-          if (map_IndexCardinal.find(viewId) == map_IndexCardinal.end())
-            map_IndexCardinal[viewId] = 1;
-          else
-            ++map_IndexCardinal[viewId];
+          view_ids.push_back(landmarks.obs_view_id(i));
+          view_samples.emplace_back();
         }
+        obs_view_indexes[i] = view_it.first->second;
+        view_samples[view_it.first->second].emplace_back(slot, &landmarks.obs_x(i));
       }
+    }
+  }
 
-      // Find the View index that is the most represented
-      std::vector<IndexT> vec_cardinal;
-      std::transform(map_IndexCardinal.begin(),
-        map_IndexCardinal.end(),
-        std::back_inserter(vec_cardinal),
-        stl::RetrieveValue());
-      using namespace stl::indexed_sort;
-      std::vector<sort_index_packet_descend<IndexT, IndexT>> packet_vec(vec_cardinal.size());
-      sort_index_helper(packet_vec, &vec_cardinal[0], 1);
-
-      // First image index with the most of occurence
-      std::map<IndexT, IndexT>::const_iterator iterTT = map_IndexCardinal.begin();
-      std::advance(iterTT, packet_vec[0].index);
-      const size_t view_index = iterTT->first;
-      const View * view = sfm_data.GetViews().at(view_index).get();
-      const std::string sView_filename = stlplus::create_filespec(sfm_data.s_root_path,
-        view->s_Img_path);
-      image::Image<image::RGBColor> image_rgb;
-      image::Image<unsigned char> image_gray;
-      const bool b_rgb_image = ReadImage(sView_filename.c_str(), &image_rgb);
-      if (!b_rgb_image) //try Gray level
+  // The views to read, with the observations to sample
+  std::vector<std::pair<IndexT, std::vector<Track_Sample>>> views_to_read;
+  if (b_average_colors)
+  {
+    for (size_t i = 0; i < view_ids.size(); ++i)
+      views_to_read.emplace_back(view_ids[i], std::move(view_samples[i]));
+  }
+  else
+  {
+    // Greedy set cover computed once: the number of uncolored tracks seen by
+    //  each view is updated when a view is selected, and a max heap with
+    //  lazy updates (outdated entries are pushed again) gives the next view.
+    std::vector<IndexT> remaining_count(view_ids.size());
+    std::priority_queue<std::pair<IndexT, IndexT>> heap; // (count, view index)
+    for (size_t i = 0; i < view_ids.size(); ++i)
+    {
+      remaining_count[i] = view_samples[i].size();
+      heap.emplace(remaining_count[i], i);
+    }
+    std::vector<bool> assigned(landmarks.size(), false);
+    while (!heap.empty())
+    {
+      const std::pair<IndexT, IndexT> top = heap.top();
+      heap.pop();
+      const IndexT view_index = top.second;
+      if (remaining_count[view_index] == 0)
+        continue;
+      if (top.first != remaining_count[view_index])
       {
-        const bool b_gray_image = ReadImage(sView_filename.c_str(), &image_gray);
-        if (!b_gray_image)
-        {
-          std::cerr << "Cannot open provided the image." << std::endl;
-          return false;
-        }
+        heap.emplace(remaining_count[view_index], view_index);
+        continue;
       }
+      // Assign the remaining tracks seen by this view to it
+      std::vector<Track_Sample> samples;
+      samples.reserve(remaining_count[view_index]);
+      for (const Track_Sample & sample : view_samples[view_index])
+      {
+        if (assigned[sample.first])
+          continue;
+        assigned[sample.first] = true;
+        samples.push_back(sample);
+        for (std::size_t i = landmarks.obs_begin(sample.first); i < landmarks.obs_end(sample.first); ++i)
+          --remaining_count[obs_view_indexes[i]];
+      }
+      views_to_read.emplace_back(view_ids[view_index], std::move(samples));
+    }
+  }
+  view_samples.clear();
+  view_samples.shrink_to_fit();
+
+  // Color the tracks view by view: the images are read, the observed pixels
+  //  are sampled and the colors are stored by the pipeline stages
+  struct ViewImage
+  {
+    image::Image<image::RGBColor> image_rgb;
+    image::Image<unsigned char> image_gray;
+    bool b_rgb_image = true;
+  };
+  using Track_Colors = std::vector<image::RGBColor>;
 
-      // Iterate through the remaining track to color
-      // - look if the current view is present to color the track
-      std::set<IndexT> set_toRemove;
-      for (const auto & track_to_color_it : remainingTrackToColor)
+  C_Progress_display my_progress_bar(views_to_read.size(),
+                                     std::cout,
+                                     "\nCompute scene structure color\n");
+
+  const auto decode = [&](std::size_t i, ViewImage & view_image)
+  {
+    const View * view = sfm_data.GetViews().at(views_to_read[i].first).get();
+    const std::string sView_filename = stlplus::create_filespec(sfm_data.s_root_path,
+      view->s_Img_path);
+    view_image.b_rgb_image = ReadImage(sView_filename.c_str(), &view_image.image_rgb);
+    if (!view_image.b_rgb_image) //try Gray level
+    {
+      const bool b_gray_image = ReadImage(sView_filename.c_str(), &view_image.image_gray);
+      if (!b_gray_image)
       {
-        const auto trackId = track_to_color_it;
-        const Observations & obs = sfm_data.GetLandmarks().at(trackId).obs;
-        Observations::const_iterator it = obs.find(view_index);
+        std::cerr << "Cannot open provided the image: " << sView_filename << std::endl;
+        ++my_progress_bar;
+        return false;
+      }
+    }
+    return true;
+  };
+
+  const auto transform = [&]
+  (
+    std::size_t i,
+    ViewImage & view_image,
+    Track_Colors & colors
+  )
+  {
+    const std::vector<Track_Sample> & samples = views_to_read[i].second;
+    colors.resize(samples.size());
+    for (size_t k = 0; k < samples.size(); ++k)
+    {
+      const Vec2 & pt = *samples[k].second;
+      colors[k] =
+        view_image.b_rgb_image
+        ? view_image.image_rgb(pt.y(), pt.x())
+        : image::RGBColor(view_image.image_gray(pt.y(), pt.x()));
+    }
+    return true;
+  };
 
-        if (it != obs.end())
-        {
-          // Color the track
-          const Vec2 & pt = it->second.x;
-          const image::RGBColor color =
-            b_rgb_image
-            ? image_rgb(pt.y(), pt.x())
-            : image::RGBColor(image_gray(pt.y(), pt.x()));
-
-          vec_tracksColor[trackIds_to_contiguousIndexes.at(trackId)] =
-            Vec3(color.r(), color.g(), color.b());
-          set_toRemove.insert(trackId);
-          ++my_progress_bar;
-        }
+  // Number of colors accumulated per track (color averaging)
+  std::vector<IndexT> color_counts(b_average_colors ? landmarks.size() : 0, 0);
+
+  const auto encode = [&](std::size_t i, Track_Colors & colors)
+  {
+    const std::vector<Track_Sample> & samples = views_to_read[i].second;
+    for (size_t k = 0; k < samples.size(); ++k)
+    {
+      const Vec3 color(colors[k].r(), colors[k].g(), colors[k].b());
+      if (b_average_colors)
+      {
+        vec_tracksColor[samples[k].first] += color;
+        ++color_counts[samples[k].first];
       }
-      // Remove colored track
-      for (const auto & to_remove_it : set_toRemove)
+      else
       {
-        remainingTrackToColor.erase(to_remove_it);
+        // Each track is colored by a single view: no concurrent write
+        vec_tracksColor[samples[k].first] = color;
       }
     }
+    ++my_progress_bar;
+    return true;
+  };
+
+  // The color sums are accumulated by a single storing thread
+  system::Pipeline_Options pipeline_options = options;
+  if (b_average_colors)
+    pipeline_options.encoders = 1;
+
+  system::Pipeline<ViewImage, Track_Colors> pipeline(pipeline_options);
+  if (pipeline.Run(views_to_read.size(), decode, transform, encode)
+      != views_to_read.size())
+  {
+    return false;
+  }
+
+  if (b_average_colors)
+  {
+    for (size_t i = 0; i < vec_tracksColor.size(); ++i)
+    {
+      if (color_counts[i] > 0)
+        vec_tracksColor[i] /= color_counts[i];
+    }
   }
   return true;
 }
@@ -11,16 +11,48 @@
 #define OPENMVG_SFM_SFM_DATA_COLORIZATION_HPP
 
 #include "openMVG/numeric/eigen_alias_definition.hpp"
+#include "openMVG/system/pipeline.hpp"
 
 namespace openMVG {
 namespace sfm {
 
 struct SfM_Data;
-
+class Dense_Landmarks;
+
+/**
+* @brief Find the color of the SfM_Data Landmarks/structure.
+*  Each landmark is assigned up front to one of its observing views: a greedy
+*  set cover picks the views that see the most of the remaining landmarks, so
+*  few images are read. The images are then read and only the observed pixels
+*  are sampled in parallel (see system::Pipeline).
+*
+* @param[in] sfm_data scene (views and landmarks)
+* @param[out] vec_3dPoints landmark positions (in the landmarks order)
+* @param[out] vec_tracksColor landmark colors (in the landmarks order)
+* @param[in] options number of threads of the reading, sampling and storing stages
+* @param[in] b_average_colors if true, the color of a landmark is the mean of
+*   its colors in all the observing views (all the images are read)
+* @return true if all the required images are read
+*/
 bool ColorizeTracks(
   const SfM_Data & sfm_data,
   std::vector<Vec3> & vec_3dPoints,
-  std::vector<Vec3> & vec_tracksColor);
+  std::vector<Vec3> & vec_tracksColor,
+  const system::Pipeline_Options & options = system::Pipeline_Options(),
+  const bool b_average_colors = false);
+
+/**
+* @brief Find the color of columnar landmarks (see above).
+* @param[in] sfm_data scene (views)
+* @param[in] landmarks landmarks to colorize
+* @param[out] vec_tracksColor landmark colors (in the slots order)
+*/
+bool ColorizeTracks(
+  const SfM_Data & sfm_data,
+  const Dense_Landmarks & landmarks,
+  std::vector<Vec3> & vec_tracksColor,
+  const system::Pipeline_Options & options = system::Pipeline_Options(),
+  const bool b_average_colors = false);
 
 } // namespace sfm
 } // namespace openMVG
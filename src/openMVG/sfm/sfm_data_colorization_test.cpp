@@ -0,0 +1,115 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/image/image_io.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_colorization.hpp"
+
+#include "testing/testing.h"
+
+#include <cstdio>
+#include <string>
+
+using namespace openMVG;
+using namespace openMVG::image;
+using namespace openMVG::sfm;
+
+// Three views with a uniform color (red, green, blue):
+//  - 10 landmarks are seen by the views 0 and 1,
+//  - 5 landmarks are seen by the views 1 and 2,
+//  - 3 landmarks are seen by the view 2.
+bool ColorizationScene(SfM_Data & sfm_data)
+{
+  sfm_data.s_root_path = ".";
+  const RGBColor colors[3] = {RED, GREEN, BLUE};
+  for (IndexT i = 0; i < 3; ++i)
+  {
+    const std::string filename = "colorization_view" + std::to_string(i) + ".png";
+    Image<RGBColor> image(8, 8, true, colors[i]);
+    if (!WriteImage(filename.c_str(), image))
+      return false;
+    sfm_data.views[i] = std::make_shared<View>(filename, i, 0, i, 8, 8);
+  }
+  IndexT track_id = 0;
+  const auto add_track = [&](const std::vector<IndexT> & view_ids)
+  {
+    Landmark landmark;
+    landmark.X = Vec3(track_id, 0, 0);
+    for (const IndexT view_id : view_ids)
+      landmark.obs[view_id] = Observation(Vec2(track_id % 8, 4), 0);
+    sfm_data.structure[track_id++] = landmark;
+  };
+  for (int i = 0; i < 10; ++i) add_track({0, 1});
+  for (int i = 0; i < 5; ++i) add_track({1, 2});
+  for (int i = 0; i < 3; ++i) add_track({2});
+  return true;
+}
+
+// Delete the images written by ColorizationScene
+void RemoveColorizationScene()
+{
+  for (IndexT i = 0; i < 3; ++i)
+    std::remove(("colorization_view" + std::to_string(i) + ".png").c_str());
+}
+
+TEST(ColorizeTracks, Greedy_View_Assignment) {
+
+  SfM_Data sfm_data;
+  EXPECT_TRUE(ColorizationScene(sfm_data));
+  system::Pipeline_Options options;
+  options.decoders = options.transformers = options.encoders = 2;
+  std::vector<Vec3> points, colors;
+  EXPECT_TRUE(ColorizeTracks(sfm_data, points, colors, options));
+  EXPECT_EQ(sfm_data.structure.size(), colors.size());
+
+  size_t i = 0;
+  for (const auto & landmark : sfm_data.structure)
+  {
+    EXPECT_MATRIX_NEAR(landmark.second.X, points[i], 1e-8);
+    // The view 1 sees the most tracks, then the view 2 is used for the rest
+    const Vec3 expected = landmark.second.obs.count(1) ?
+      Vec3(0, 255, 0) : Vec3(0, 0, 255);
+    EXPECT_MATRIX_NEAR(expected, colors[i], 1e-8);
+    ++i;
+  }
+  RemoveColorizationScene();
+}
+
+TEST(ColorizeTracks, Average_Colors) {
+
+  SfM_Data sfm_data;
+  EXPECT_TRUE(ColorizationScene(sfm_data));
+  std::vector<Vec3> points, colors;
+  EXPECT_TRUE(ColorizeTracks(sfm_data, points, colors,
+    system::Pipeline_Options(), true));
+
+  size_t i = 0;
+  for (const auto & landmark : sfm_data.structure)
+  {
+    Vec3 expected = Vec3::Zero();
+    if (landmark.second.obs.count(0)) expected += Vec3(255, 0, 0);
+    if (landmark.second.obs.count(1)) expected += Vec3(0, 255, 0);
+    if (landmark.second.obs.count(2)) expected += Vec3(0, 0, 255);
+    expected /= landmark.second.obs.size();
+    EXPECT_MATRIX_NEAR(expected, colors[i], 1e-8);
+    ++i;
+  }
+  RemoveColorizationScene();
+}
+
+TEST(ColorizeTracks, Missing_Image) {
+
+  SfM_Data sfm_data;
+  EXPECT_TRUE(ColorizationScene(sfm_data));
+  sfm_data.views[2]->s_Img_path = "colorization_missing_view.png";
+  std::vector<Vec3> points, colors;
+  EXPECT_FALSE(ColorizeTracks(sfm_data, points, colors));
+  RemoveColorizationScene();
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
@@ -8,14 +8,149 @@
 
 #include "openMVG/sfm/sfm_data_filters.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_landmark_dense.hpp"
 #include "openMVG/stl/stl.hpp"
 #include "openMVG/tracks/union_find.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <utility>
 
 namespace openMVG {
 namespace sfm {
 
+namespace {
+
+// Pose and intrinsic of a view (looked up once for all its observations)
+struct View_Camera
+{
+  geometry::Pose3 pose;
+  const cameras::IntrinsicBase * intrinsic;
+};
+
+// Camera of the views that have a valid pose and intrinsic
+Hash_Map<IndexT, View_Camera> Get_View_Cameras
+(
+  const SfM_Data & sfm_data
+)
+{
+  Hash_Map<IndexT, View_Camera> cameras;
+  for (const auto & view_it : sfm_data.GetViews())
+  {
+    const View * view = view_it.second.get();
+    if (sfm_data.IsPoseAndIntrinsicDefined(view))
+    {
+      cameras[view_it.first] =
+        {sfm_data.GetPoseOrDie(view), sfm_data.GetIntrinsics().at(view->id_intrinsic).get()};
+    }
+  }
+  return cameras;
+}
+
+bool eraseMissingPoses
+(
+  SfM_Data & sfm_data,
+  const Dense_Landmarks & landmarks,
+  const IndexT min_points_per_pose
+)
+{
+  IndexT removed_elements = 0;
+
+  // Count the observation poses occurrence
+  Hash_Map<IndexT, IndexT> map_PoseId_Count;
+  // Init with 0 count (in order to be able to remove non referenced elements)
+  for (const auto & pose_it : sfm_data.GetPoses())
+  {
+    map_PoseId_Count[pose_it.first] = 0;
+  }
+
+  // Count occurrence of the poses in the Landmark observations
+  for (const IndexT view_id : landmarks.obs_view_ids())
+  {
+    const View * v = sfm_data.GetViews().at(view_id).get();
+    map_PoseId_Count[v->id_pose] += 1; // Default initialization is 0
+  }
+  // If usage count is smaller than the threshold, remove the Pose
+  for (const auto & it : map_PoseId_Count)
+  {
+    if (it.second < min_points_per_pose)
+    {
+      sfm_data.poses.erase(it.first);
+      ++removed_elements;
+    }
+  }
+  return removed_elements > 0;
+}
+
+bool eraseObservationsWithMissingPoses
+(
+  SfM_Data & sfm_data,
+  Dense_Landmarks & landmarks,
+  const IndexT min_points_per_landmark,
+  std::vector<IndexT> * removed_landmark_ids = nullptr
+)
+{
+  // Keep the observations of the views that have a pose
+  Dense_Landmarks::Mask keep_observations(landmarks.observation_count());
+  for (std::size_t i = 0; i < keep_observations.size(); ++i)
+  {
+    const View * v = sfm_data.GetViews().at(landmarks.obs_view_id(i)).get();
+    keep_observations[i] = sfm_data.GetPoses().count(v->id_pose) != 0;
+  }
+  // Remove the tracks that become empty or too short
+  const std::size_t removed_elements =
+    landmarks.Filter(
+      keep_observations,
+      std::max<std::size_t>(min_points_per_landmark, 1),
+      &sfm_data.structure,
+      removed_landmark_ids);
+  return removed_elements > 0;
+}
+
+// Compute the Connected Component of the views from the tracks
+// Return the contiguous view index in [0,n] of the views used in the observations
+Hash_Map<IndexT, IndexT> Link_Track_Views
+(
+  const Dense_Landmarks & landmarks,
+  UnionFind & uf_tree
+)
+{
+  // Build a table to have contiguous view index in [0,n]
+  // (Use only the view index used in the observations)
+  Hash_Map<IndexT, IndexT> view_renumbering;
+  IndexT cpt = 0;
+  for (const IndexT view_id : landmarks.obs_view_ids())
+  {
+    if (view_renumbering.count(view_id) == 0)
+    {
+      view_renumbering[view_id] = cpt++;
+    }
+  }
+
+  uf_tree.InitSets(view_renumbering.size());
+
+  // Link track observations in connected component
+  std::vector<IndexT> id_to_link;
+  for (IndexT slot = 0; slot < landmarks.size(); ++slot)
+  {
+    id_to_link.clear();
+    for (std::size_t i = landmarks.obs_begin(slot); i < landmarks.obs_end(slot); ++i)
+    {
+      id_to_link.push_back(view_renumbering.at(landmarks.obs_view_id(i)));
+    }
+    std::sort(id_to_link.begin(), id_to_link.end());
+    id_to_link.erase(std::unique(id_to_link.begin(), id_to_link.end()), id_to_link.end());
+    for (std::size_t j = 1; j < id_to_link.size(); ++j)
+    {
+      // Link I => J
+      uf_tree.Union(id_to_link[0], id_to_link[j]);
+    }
+  }
+  return view_renumbering;
+}
+
+} // namespace
+
 /// List the view indexes that have valid camera intrinsic and pose.
 std::set<IndexT> Get_Valid_Views
 (
@@ -40,35 +175,50 @@ IndexT RemoveOutliers_PixelResidualError
 (
   SfM_Data & sfm_data,
   const double dThresholdPixel,
-  const unsigned int minTrackLength
+  const unsigned int minTrackLength,
+  std::vector<IndexT> * removed_landmark_ids
 )
 {
-  IndexT outlier_count = 0;
-  Landmarks::iterator iterTracks = sfm_data.structure.begin();
-  while (iterTracks != sfm_data.structure.end())
+  Dense_Landmarks landmarks(sfm_data.structure);
+  return RemoveOutliers_PixelResidualError(
+    sfm_data, landmarks, dThresholdPixel, minTrackLength, removed_landmark_ids);
+}
+
+IndexT RemoveOutliers_PixelResidualError
+(
+  SfM_Data & sfm_data,
+  Dense_Landmarks & landmarks,
+  const double dThresholdPixel,
+  const unsigned int minTrackLength,
+  std::vector<IndexT> * removed_landmark_ids
+)
+{
+  const Hash_Map<IndexT, View_Camera> cameras = Get_View_Cameras(sfm_data);
+
+  Dense_Landmarks::Mask keep_observations(landmarks.observation_count(), 1);
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 256)
+#endif
+  for (int slot = 0; slot < static_cast<int>(landmarks.size()); ++slot)
   {
-    Observations & obs = iterTracks->second.obs;
-    Observations::iterator itObs = obs.begin();
-    while (itObs != obs.end())
+    for (std::size_t i = landmarks.obs_begin(slot); i < landmarks.obs_end(slot); ++i)
     {
-      const View * view = sfm_data.views.at(itObs->first).get();
-      const geometry::Pose3 pose = sfm_data.GetPoseOrDie(view);
-      const cameras::IntrinsicBase * intrinsic = sfm_data.intrinsics.at(view->id_intrinsic).get();
-      const Vec2 residual = intrinsic->residual(pose(iterTracks->second.X), itObs->second.x);
-      if (residual.norm() > dThresholdPixel)
-      {
-        ++outlier_count;
-        itObs = obs.erase(itObs);
-      }
-      else
-        ++itObs;
+      // Observations of undefined camera are left to eraseObservationsWithMissingPoses
+      const auto camera_it = cameras.find(landmarks.obs_view_id(i));
+      if (camera_it == cameras.end())
+        continue;
+      const View_Camera & camera = camera_it->second;
+      const Vec2 residual = camera.intrinsic->residual(camera.pose(landmarks.X(slot)), landmarks.obs_x(i));
+      keep_observations[i] = residual.norm() <= dThresholdPixel;
     }
-    if (obs.empty() || obs.size() < minTrackLength)
-      iterTracks = sfm_data.structure.erase(iterTracks);
-    else
-      ++iterTracks;
   }
-  return outlier_count;
+  const std::size_t outlier_count =
+    landmarks.Filter(
+      keep_observations,
+      std::max<std::size_t>(minTrackLength, 1),
+      &sfm_data.structure,
+      removed_landmark_ids);
+  return static_cast<IndexT>(outlier_count);
 }
 
 // Remove tracks that have a small angle (tracks with tiny angle leads to instable 3D points)
@@ -76,45 +226,55 @@ IndexT RemoveOutliers_PixelResidualError
 IndexT RemoveOutliers_AngleError
 (
   SfM_Data & sfm_data,
-  const double dMinAcceptedAngle
+  const double dMinAcceptedAngle,
+  std::vector<IndexT> * removed_landmark_ids
+)
+{
+  Dense_Landmarks landmarks(sfm_data.structure);
+  return RemoveOutliers_AngleError(sfm_data, landmarks, dMinAcceptedAngle, removed_landmark_ids);
+}
+
+IndexT RemoveOutliers_AngleError
+(
+  SfM_Data & sfm_data,
+  Dense_Landmarks & landmarks,
+  const double dMinAcceptedAngle,
+  std::vector<IndexT> * removed_landmark_ids
 )
 {
-  IndexT removedTrack_count = 0;
-  Landmarks::iterator iterTracks = sfm_data.structure.begin();
-  while (iterTracks != sfm_data.structure.end())
+  const Hash_Map<IndexT, View_Camera> cameras = Get_View_Cameras(sfm_data);
+
+  Dense_Landmarks::Mask keep_landmarks(landmarks.size());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 256)
+#endif
+  for (int slot = 0; slot < static_cast<int>(landmarks.size()); ++slot)
   {
-    Observations & obs = iterTracks->second.obs;
+    // Camera and undistorted position of the observations
+    std::vector<std::pair<const View_Camera *, Vec2>> rays;
+    for (std::size_t i = landmarks.obs_begin(slot); i < landmarks.obs_end(slot); ++i)
+    {
+      const auto camera_it = cameras.find(landmarks.obs_view_id(i));
+      if (camera_it == cameras.end())
+        continue;
+      const View_Camera & camera = camera_it->second;
+      rays.emplace_back(&camera, camera.intrinsic->get_ud_pixel(landmarks.obs_x(i)));
+    }
     double max_angle = 0.0;
-    for (Observations::const_iterator itObs1 = obs.begin();
-      itObs1 != obs.end(); ++itObs1)
+    for (std::size_t i = 0; i < rays.size(); ++i)
     {
-      const View * view1 = sfm_data.views.at(itObs1->first).get();
-      const geometry::Pose3 pose1 = sfm_data.GetPoseOrDie(view1);
-      const cameras::IntrinsicBase * intrinsic1 = sfm_data.intrinsics.at(view1->id_intrinsic).get();
-
-      Observations::const_iterator itObs2 = itObs1;
-      ++itObs2;
-      for (; itObs2 != obs.end(); ++itObs2)
+      for (std::size_t j = i + 1; j < rays.size(); ++j)
       {
-        const View * view2 = sfm_data.views.at(itObs2->first).get();
-        const geometry::Pose3 pose2 = sfm_data.GetPoseOrDie(view2);
-        const cameras::IntrinsicBase * intrinsic2 = sfm_data.intrinsics.at(view2->id_intrinsic).get();
-
         const double angle = AngleBetweenRay(
-          pose1, intrinsic1, pose2, intrinsic2,
-          intrinsic1->get_ud_pixel(itObs1->second.x), intrinsic2->get_ud_pixel(itObs2->second.x));
+          rays[i].first->pose, rays[i].first->intrinsic,
+          rays[j].first->pose, rays[j].first->intrinsic,
+          rays[i].second, rays[j].second);
         max_angle = std::max(angle, max_angle);
       }
     }
-    if (max_angle < dMinAcceptedAngle)
-    {
-      iterTracks = sfm_data.structure.erase(iterTracks);
-      ++removedTrack_count;
-    }
-    else
-      ++iterTracks;
+    keep_landmarks[slot] = max_angle >= dMinAcceptedAngle;
   }
-  return removedTrack_count;
+  return landmarks.FilterLandmarks(keep_landmarks, &sfm_data.structure, removed_landmark_ids);
 }
 
 bool eraseMissingPoses
@@ -123,38 +283,8 @@ bool eraseMissingPoses
   const IndexT min_points_per_pose
 )
 {
-  IndexT removed_elements = 0;
-  const Landmarks & landmarks = sfm_data.structure;
-
-  // Count the observation poses occurrence
-  Hash_Map<IndexT, IndexT> map_PoseId_Count;
-  // Init with 0 count (in order to be able to remove non referenced elements)
-  for (const auto & pose_it : sfm_data.GetPoses())
-  {
-    map_PoseId_Count[pose_it.first] = 0;
-  }
-
-  // Count occurrence of the poses in the Landmark observations
-  for (const auto & lanmark_it : landmarks)
-  {
-    const Observations & obs = lanmark_it.second.obs;
-    for (const auto obs_it : obs)
-    {
-      const IndexT ViewId = obs_it.first;
-      const View * v = sfm_data.GetViews().at(ViewId).get();
-      map_PoseId_Count[v->id_pose] += 1; // Default initialization is 0
-    }
-  }
-  // If usage count is smaller than the threshold, remove the Pose
-  for (const auto & it : map_PoseId_Count)
-  {
-    if (it.second < min_points_per_pose)
-    {
-      sfm_data.poses.erase(it.first);
-      ++removed_elements;
-    }
-  }
-  return removed_elements > 0;
+  const Dense_Landmarks landmarks(sfm_data.structure);
+  return eraseMissingPoses(sfm_data, landmarks, min_points_per_pose);
 }
 
 bool eraseObservationsWithMissingPoses
@@ -163,58 +293,32 @@ bool eraseObservationsWithMissingPoses
   const IndexT min_points_per_landmark
 )
 {
-  IndexT removed_elements = 0;
-
-  std::set<IndexT> pose_Index;
-  std::transform(sfm_data.poses.cbegin(), sfm_data.poses.cend(),
-    std::inserter(pose_Index, pose_Index.begin()), stl::RetrieveKey());
-
-  // For each landmark:
-  //  - Check if we need to keep the observations & the track
-  Landmarks::iterator itLandmarks = sfm_data.structure.begin();
-  while (itLandmarks != sfm_data.structure.end())
-  {
-    Observations & obs = itLandmarks->second.obs;
-    Observations::iterator itObs = obs.begin();
-    while (itObs != obs.end())
-    {
-      const IndexT ViewId = itObs->first;
-      const View * v = sfm_data.GetViews().at(ViewId).get();
-      if (pose_Index.count(v->id_pose) == 0)
-      {
-        itObs = obs.erase(itObs);
-        ++removed_elements;
-      }
-      else
-        ++itObs;
-    }
-    if (obs.empty() || obs.size() < min_points_per_landmark)
-      itLandmarks = sfm_data.structure.erase(itLandmarks);
-    else
-      ++itLandmarks;
-  }
-  return removed_elements > 0;
+  Dense_Landmarks landmarks(sfm_data.structure);
+  return eraseObservationsWithMissingPoses(sfm_data, landmarks, min_points_per_landmark);
 }
 
 /// Remove unstable content from analysis of the sfm_data structure
 bool eraseUnstablePosesAndObservations
 (
   SfM_Data & sfm_data,
+  Dense_Landmarks & landmarks,
   const IndexT min_points_per_pose,
-  const IndexT min_points_per_landmark
+  const IndexT min_points_per_landmark,
+  std::vector<IndexT> * removed_landmark_ids
 )
 {
   // First remove orphan observation(s) (observation using an undefined pose)
-  eraseObservationsWithMissingPoses(sfm_data, min_points_per_landmark);
+  eraseObservationsWithMissingPoses(sfm_data, landmarks, min_points_per_landmark, removed_landmark_ids);
   // Then iteratively remove orphan poses & observations
   IndexT remove_iteration = 0;
   bool bRemovedContent = false;
   do
   {
     bRemovedContent = false;
-    if (eraseMissingPoses(sfm_data, min_points_per_pose))
+    if (eraseMissingPoses(sfm_data, landmarks, min_points_per_pose))
     {
-      bRemovedContent = eraseObservationsWithMissingPoses(sfm_data, min_points_per_landmark);
+      bRemovedContent = eraseObservationsWithMissingPoses(
+        sfm_data, landmarks, min_points_per_landmark, removed_landmark_ids);
       // Erase some observations can make some Poses index disappear so perform the process in a loop
     }
     remove_iteration += bRemovedContent ? 1 : 0;
@@ -224,6 +328,19 @@ bool eraseUnstablePosesAndObservations
   return remove_iteration > 0;
 }
 
+bool eraseUnstablePosesAndObservations
+(
+  SfM_Data & sfm_data,
+  const IndexT min_points_per_pose,
+  const IndexT min_points_per_landmark,
+  std::vector<IndexT> * removed_landmark_ids
+)
+{
+  Dense_Landmarks landmarks(sfm_data.structure);
+  return eraseUnstablePosesAndObservations(
+    sfm_data, landmarks, min_points_per_pose, min_points_per_landmark, removed_landmark_ids);
+}
+
 /// Tell if the sfm_data structure is one CC or not
 bool IsTracksOneCC
 (
@@ -231,46 +348,9 @@ bool IsTracksOneCC
 )
 {
   // Compute the Connected Component from the tracks
-
-  // Build a table to have contiguous view index in [0,n]
-  // (Use only the view index used in the observations)
-  Hash_Map<IndexT, IndexT> view_renumbering;
-  IndexT cpt = 0;
-  const Landmarks & landmarks = sfm_data.structure;
-  for (const auto & Landmark_it : landmarks)
-  {
-    const Observations & obs = Landmark_it.second.obs;
-    for (const auto & obs_it : obs)
-    {
-      if (view_renumbering.count(obs_it.first) == 0)
-      {
-        view_renumbering[obs_it.first] = cpt++;
-      }
-    }
-  }
-
+  const Dense_Landmarks landmarks(sfm_data.structure);
   UnionFind uf_tree;
-  uf_tree.InitSets(view_renumbering.size());
-
-  // Link track observations in connected component
-  for (const auto & Landmark_it : landmarks)
-  {
-    const Observations & obs = Landmark_it.second.obs;
-    std::set<IndexT> id_to_link;
-    for (const auto & obs_it : obs)
-    {
-      id_to_link.insert(view_renumbering.at(obs_it.first));
-    }
-    std::set<IndexT>::const_iterator iterI = id_to_link.cbegin();
-    std::set<IndexT>::const_iterator iterJ = id_to_link.cbegin();
-    std::advance(iterJ, 1);
-    while (iterJ != id_to_link.cend())
-    {
-      // Link I => J
-      uf_tree.Union(*iterI, *iterJ);
-      ++iterJ;
-    }
-  }
+  Link_Track_Views(landmarks, uf_tree);
 
   // Run path compression to identify all the CC id belonging to every item
   for (unsigned int i = 0; i < uf_tree.GetNumNodes(); ++i)
@@ -290,49 +370,9 @@ void KeepLargestViewCCTracks
 )
 {
   // Compute the Connected Component from the tracks
-
-  // Build a table to have contiguous view index in [0,n]
-  // (Use only the view index used in the observations)
-  Hash_Map<IndexT, IndexT> view_renumbering;
-  {
-    IndexT cpt = 0;
-    const Landmarks & landmarks = sfm_data.structure;
-    for (const auto & Landmark_it : landmarks)
-    {
-      const Observations & obs = Landmark_it.second.obs;
-      for (const auto & obs_it : obs)
-      {
-        if (view_renumbering.count(obs_it.first) == 0)
-        {
-          view_renumbering[obs_it.first] = cpt++;
-        }
-      }
-    }
-  }
-
+  Dense_Landmarks landmarks(sfm_data.structure);
   UnionFind uf_tree;
-  uf_tree.InitSets(view_renumbering.size());
-
-  // Link track observations in connected component
-  Landmarks & landmarks = sfm_data.structure;
-  for (const auto & Landmark_it : landmarks)
-  {
-    const Observations & obs = Landmark_it.second.obs;
-    std::set<IndexT> id_to_link;
-    for (const auto & obs_it : obs)
-    {
-      id_to_link.insert(view_renumbering.at(obs_it.first));
-    }
-    std::set<IndexT>::const_iterator iterI = id_to_link.cbegin();
-    std::set<IndexT>::const_iterator iterJ = id_to_link.cbegin();
-    std::advance(iterJ, 1);
-    while (iterJ != id_to_link.cend())
-    {
-      // Link I => J
-      uf_tree.Union(*iterI, *iterJ);
-      ++iterJ;
-    }
-  }
+  const Hash_Map<IndexT, IndexT> view_renumbering = Link_Track_Views(landmarks, uf_tree);
 
   // Count the number of CC
   const std::set<unsigned int> parent_id(uf_tree.m_cc_parent.cbegin(), uf_tree.m_cc_parent.cend());
@@ -354,26 +394,19 @@ void KeepLargestViewCCTracks
     if (max_cc.first != UndefinedIndexT)
     {
       const unsigned int parent_id_largest_cc = max_cc.first;
-      Landmarks::iterator itLandmarks = landmarks.begin();
-      while (itLandmarks != landmarks.end())
+      Dense_Landmarks::Mask keep_landmarks(landmarks.size(), 1);
+      for (IndexT slot = 0; slot < landmarks.size(); ++slot)
       {
         // Since we built a view 'track' graph thanks to the UF tree,
         //  checking the CC of each track is equivalent to check the CC of any observation of it.
         // So we check only the first
-        const Observations & obs = itLandmarks->second.obs;
-        Observations::const_iterator itObs = obs.begin();
-        if (!obs.empty())
+        if (landmarks.track_length(slot) > 0)
         {
-          if (uf_tree.Find(view_renumbering.at(itObs->first)) != parent_id_largest_cc)
-          {
-            itLandmarks = landmarks.erase(itLandmarks);
-          }
-          else
-          {
-            ++itLandmarks;
-          }
+          const IndexT view_id = landmarks.obs_view_id(landmarks.obs_begin(slot));
+          keep_landmarks[slot] = uf_tree.Find(view_renumbering.at(view_id)) == parent_id_largest_cc;
         }
       }
+      landmarks.FilterLandmarks(keep_landmarks, &sfm_data.structure);
     }
   }
 }
@@ -395,25 +428,34 @@ double DepthCleaning
   const IndexT k_min_track_length
 )
 {
+  Dense_Landmarks landmarks(sfm_data.structure);
+  const Hash_Map<IndexT, View_Camera> cameras = Get_View_Cameras(sfm_data);
+
+  // Compute the camera/point depth of each observation
+  // (observations of undefined camera get a NaN depth)
+  std::vector<double> depths(landmarks.observation_count());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 256)
+#endif
+  for (int slot = 0; slot < static_cast<int>(landmarks.size()); ++slot)
+  {
+    for (std::size_t i = landmarks.obs_begin(slot); i < landmarks.obs_end(slot); ++i)
+    {
+      const auto camera_it = cameras.find(landmarks.obs_view_id(i));
+      depths[i] = (camera_it == cameras.end()) ?
+        std::numeric_limits<double>::quiet_NaN() :
+        Depth(camera_it->second.pose.rotation(), camera_it->second.pose.translation(), landmarks.X(slot));
+    }
+  }
+
+  // Accumulate the camera/point depth info for each view
   using DepthAccumulatorT = std::vector<double>;
   std::map<IndexT, DepthAccumulatorT > map_depth_accumulator;
-
-  // For each landmark accumulate the camera/point depth info for each view
-  for (const auto & landmark_it : sfm_data.structure)
+  for (std::size_t i = 0; i < depths.size(); ++i)
   {
-    const Observations & obs = landmark_it.second.obs;
-    for (const auto & obs_it : obs)
+    if (depths[i] > 0)
     {
-      const View * view = sfm_data.views.at(obs_it.first).get();
-      if (sfm_data.IsPoseAndIntrinsicDefined(view))
-      {
-        const Pose3 pose = sfm_data.GetPoseOrDie(view);
-        const double depth = Depth(pose.rotation(), pose.translation(), landmark_it.second.X);
-        if (depth > 0)
-        {
-          map_depth_accumulator[view->id_view].push_back(depth);
-        }
-      }
+      map_depth_accumulator[landmarks.obs_view_id(i)].push_back(depths[i]);
     }
   }
 
@@ -439,31 +481,26 @@ double DepthCleaning
   map_depth_accumulator.clear();
 
   // Delete invalid observations
+  // (the observations of undefined camera are removed without being counted)
   size_t cpt = 0;
-  for (auto & landmark_it : sfm_data.structure)
+  Dense_Landmarks::Mask keep_observations(landmarks.observation_count(), 0);
+  for (std::size_t i = 0; i < depths.size(); ++i)
   {
-    Observations obs;
-    for (auto & obs_it : landmark_it.second.obs)
-    {
-      const View * view = sfm_data.views.at(obs_it.first).get();
-      if (sfm_data.IsPoseAndIntrinsicDefined(view))
-      {
-        const Pose3 pose = sfm_data.GetPoseOrDie(view);
-        const double depth = Depth(pose.rotation(), pose.translation(), landmark_it.second.X);
-        if ( depth > 0
-            && map_median_depth.count(view->id_view)
-            && depth < map_median_depth[view->id_view])
-          obs.insert(obs_it);
-        else
-          ++cpt;
-      }
-    }
-    landmark_it.second.obs.swap(obs);
+    if (std::isnan(depths[i]))
+      continue;
+    const auto median_it = map_median_depth.find(landmarks.obs_view_id(i));
+    if (depths[i] > 0
+        && median_it != map_median_depth.end()
+        && depths[i] < median_it->second)
+      keep_observations[i] = 1;
+    else
+      ++cpt;
   }
+  landmarks.Filter(keep_observations, 0, &sfm_data.structure);
   std::cout << "#point depth filter: " << cpt << " measurements removed" <<std::endl;
 
   // Remove orphans
-  eraseUnstablePosesAndObservations(sfm_data, k_min_point_per_pose, k_min_track_length);
+  eraseUnstablePosesAndObservations(sfm_data, landmarks, k_min_point_per_pose, k_min_track_length);
 
   return min_median_value;
 }
@@ -10,10 +10,11 @@
 #define OPENMVG_SFM_SFM_DATA_FILTERS_HPP
 
 #include <set>
+#include <vector>
 
 #include "openMVG/types.hpp"
 
-namespace openMVG { namespace sfm { struct SfM_Data; } }
+namespace openMVG { namespace sfm { struct SfM_Data; class Dense_Landmarks; } }
 
 namespace openMVG {
 namespace sfm {
@@ -44,19 +45,43 @@ Pair_Set Pair_filter
 
 // Remove tracks that have a small angle (tracks with tiny angle leads to instable 3D points)
 // Return the number of removed tracks
+// If set, removed_landmark_ids gets the ids of the removed landmarks (appended)
 IndexT RemoveOutliers_PixelResidualError
 (
   SfM_Data & sfm_data,
   const double dThresholdPixel,
-  const unsigned int minTrackLength = 2
+  const unsigned int minTrackLength = 2,
+  std::vector<IndexT> * removed_landmark_ids = nullptr
+);
+
+// Same filter on a columnar copy of the structure (kept in sync with it),
+//  so consecutive filters do not rebuild the copy
+IndexT RemoveOutliers_PixelResidualError
+(
+  SfM_Data & sfm_data,
+  Dense_Landmarks & landmarks,
+  const double dThresholdPixel,
+  const unsigned int minTrackLength = 2,
+  std::vector<IndexT> * removed_landmark_ids = nullptr
 );
 
 // Remove tracks that have a small angle (tracks with tiny angle leads to instable 3D points)
 // Return the number of removed tracks
+// If set, removed_landmark_ids gets the ids of the removed landmarks (appended)
+IndexT RemoveOutliers_AngleError
+(
+  SfM_Data & sfm_data,
+  const double dMinAcceptedAngle,
+  std::vector<IndexT> * removed_landmark_ids = nullptr
+);
+
+// Same filter on a columnar copy of the structure (kept in sync with it)
 IndexT RemoveOutliers_AngleError
 (
   SfM_Data & sfm_data,
-  const double dMinAcceptedAngle
+  Dense_Landmarks & landmarks,
+  const double dMinAcceptedAngle,
+  std::vector<IndexT> * removed_landmark_ids = nullptr
 );
 
 /// Erase pose with insufficient track observations
@@ -74,11 +99,23 @@ bool eraseObservationsWithMissingPoses
 );
 
 /// Remove unstable content from analysis of the sfm_data structure
+/// If set, removed_landmark_ids gets the ids of the removed landmarks (appended)
 bool eraseUnstablePosesAndObservations
 (
   SfM_Data & sfm_data,
   const IndexT min_points_per_pose = 6,
-  const IndexT min_points_per_landmark = 2
+  const IndexT min_points_per_landmark = 2,
+  std::vector<IndexT> * removed_landmark_ids = nullptr
+);
+
+/// Same filter on a columnar copy of the structure (kept in sync with it)
+bool eraseUnstablePosesAndObservations
+(
+  SfM_Data & sfm_data,
+  Dense_Landmarks & landmarks,
+  const IndexT min_points_per_pose = 6,
+  const IndexT min_points_per_landmark = 2,
+  std::vector<IndexT> * removed_landmark_ids = nullptr
 );
 
 /// Tell if the sfm_data structure is one CC or not
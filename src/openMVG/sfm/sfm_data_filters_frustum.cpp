@@ -9,6 +9,7 @@
 #include "openMVG/sfm/sfm_data_filters_frustum.hpp"
 
 #include "openMVG/cameras/Camera_Pinhole.hpp"
+#include "openMVG/geometry/aabb_tree.hpp"
 #include "openMVG/geometry/pose3.hpp"
 #include "openMVG/image/pixel_types.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
@@ -16,6 +17,7 @@
 
 #include "third_party/progress/progress_display.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <iterator>
@@ -91,38 +93,55 @@ Pair_Set Frustum_Filter::getFrustumIntersectionPairs
 const
 {
   Pair_Set pairs;
-  // List active view Id
+  // List active view Id (the views with a frustum)
   std::vector<IndexT> viewIds;
-  viewIds.reserve(z_near_z_far_perView.size());
-  std::transform(z_near_z_far_perView.cbegin(), z_near_z_far_perView.cend(),
+  viewIds.reserve(frustum_perView.size());
+  std::transform(frustum_perView.cbegin(), frustum_perView.cend(),
     std::back_inserter(viewIds), stl::RetrieveKey());
+  std::sort(viewIds.begin(), viewIds.end());
+
+  // Broad phase: list the view pairs with overlapping frustum bounding boxes
+  std::vector<AABB> boxes;
+  boxes.reserve(viewIds.size());
+  for (const IndexT view_id : viewIds)
+    boxes.push_back(frustum_perView.at(view_id).bounding_box());
+  const std::vector<std::pair<IndexT, IndexT>> candidates =
+    AABB_Tree(boxes).OverlappingPairs();
+  if (!_bTruncated)
+  {
+    std::cout << "Infinite frustums: their bounding boxes are unbounded, "
+      << candidates.size() << " candidate pairs for " << viewIds.size() << " views "
+      << "(set the near & far planes to bound them)." << std::endl;
+  }
 
   C_Progress_display my_progress_bar(
-    viewIds.size() * (viewIds.size()-1)/2,
+    candidates.size(),
     std::cout, "\nCompute frustum intersection\n");
 
-  // Exhaustive comparison (use the fact that the intersect function is symmetric)
+  // Narrow phase: exact half-space intersection test of the candidate pairs
 #ifdef OPENMVG_USE_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel
 #endif
-  for (int i = 0; i < (int)viewIds.size(); ++i)
   {
-    // Prepare vector of intersecting objects (within loop to keep it
-    // thread-safe)
+    // Prepare vector of intersecting objects (one per thread)
     std::vector<HalfPlaneObject> objects = bounding_volume;
-    objects.insert(objects.end(),
-                   { frustum_perView.at(viewIds[i]), HalfPlaneObject() });
-
-    for (size_t j = i+1; j < viewIds.size(); ++j)
+    objects.resize(bounding_volume.size() + 2);
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    for (int k = 0; k < static_cast<int>(candidates.size()); ++k)
     {
-      objects.back() = frustum_perView.at(viewIds[j]);
+      const IndexT view_i = viewIds[candidates[k].first];
+      const IndexT view_j = viewIds[candidates[k].second];
+      objects[bounding_volume.size()] = frustum_perView.at(view_i);
+      objects[bounding_volume.size() + 1] = frustum_perView.at(view_j);
       if (intersect(objects))
       {
 #ifdef OPENMVG_USE_OPENMP
         #pragma omp critical
 #endif
         {
-          pairs.insert({viewIds[i], viewIds[j]});
+          pairs.insert({view_i, view_j});
         }
       }
       // Progress bar update
@@ -45,6 +45,10 @@ public:
   // Return intersecting View frustum pairs. An optional bounding volume
   // defined as a vector of half-plane objects can also be provided to further
   // limit the intersection area.
+  // The candidate pairs are the ones with overlapping frustum bounding boxes
+  // (found with a bounding volume hierarchy), and only those are tested exactly.
+  // The boxes of infinite frustums (no structure and no near & far planes) are
+  // unbounded along the viewing rays, so almost all their pairs are candidates.
   Pair_Set getFrustumIntersectionPairs(
     const std::vector<geometry::halfPlane::HalfPlaneObject>& bounding_volume = {}
   ) const;
@@ -9,6 +9,7 @@
 #include "openMVG/cameras/Camera_Pinhole.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_filters.hpp"
+#include "openMVG/sfm/sfm_landmark_dense.hpp"
 
 #include "testing/testing.h"
 
@@ -164,6 +165,61 @@ TEST(SFM_DATA_FILTERS, eraseUnstablePosesAndObservations)
   EXPECT_EQ(0, sfm_data.structure.count(5));
 }
 
+TEST(SFM_DATA_FILTERS, SharedDenseLandmarks)
+{
+  // 4 views along the x axis, landmarks in front of them
+  SfM_Data sfm_data;
+  init_scene(sfm_data, 4);
+  sfm_data.intrinsics[0] = std::make_shared<Pinhole_Intrinsic>(1000, 1000, 1000, 500, 500);
+  for (IndexT i = 0; i < 4; ++i)
+    sfm_data.poses[i] = Pose3(Mat3::Identity(), Vec3(i, 0, 0));
+  for (IndexT j = 0; j < 50; ++j)
+  {
+    Landmark & landmark = sfm_data.structure[3 * j];
+    // Some landmarks are too far away to be triangulated with a large angle
+    landmark.X = Vec3::Random() + Vec3(0, 0, (j % 10 == 0) ? 1e5 : 5);
+    for (IndexT i = 0; i < 4; ++i)
+    {
+      const Pose3 & pose = sfm_data.poses.at(i);
+      Vec2 x = sfm_data.intrinsics.at(0)->project(pose(landmark.X));
+      // Some observations are outliers
+      if ((j + i) % 7 == 0)
+        x += Vec2(20, -20);
+      landmark.obs[i] = Observation(x, j);
+    }
+  }
+
+  // The filters sharing a columnar copy of the structure give the same result
+  //  as the filters building their own copy
+  SfM_Data sfm_data_shared = sfm_data;
+  std::vector<IndexT> removed_ids, removed_ids_shared;
+  const IndexT residual_outliers =
+    RemoveOutliers_PixelResidualError(sfm_data, 4.0, 2, &removed_ids);
+  const IndexT angle_outliers =
+    RemoveOutliers_AngleError(sfm_data, 2.0, &removed_ids);
+  eraseUnstablePosesAndObservations(sfm_data, 6, 3, &removed_ids);
+
+  Dense_Landmarks landmarks(sfm_data_shared.structure);
+  EXPECT_EQ(residual_outliers,
+    RemoveOutliers_PixelResidualError(sfm_data_shared, landmarks, 4.0, 2, &removed_ids_shared));
+  EXPECT_EQ(angle_outliers,
+    RemoveOutliers_AngleError(sfm_data_shared, landmarks, 2.0, &removed_ids_shared));
+  eraseUnstablePosesAndObservations(sfm_data_shared, landmarks, 6, 3, &removed_ids_shared);
+
+  EXPECT_TRUE(residual_outliers > 0);
+  EXPECT_TRUE(angle_outliers > 0);
+  EXPECT_TRUE(removed_ids == removed_ids_shared);
+  EXPECT_EQ(sfm_data.poses.size(), sfm_data_shared.poses.size());
+  EXPECT_EQ(sfm_data.structure.size(), sfm_data_shared.structure.size());
+  EXPECT_EQ(sfm_data.structure.size(), landmarks.size());
+  for (const auto & landmark_it : sfm_data.structure)
+  {
+    const IndexT slot = landmarks.Slot(landmark_it.first);
+    EXPECT_TRUE(slot != UndefinedIndexT);
+    EXPECT_EQ(landmark_it.second.obs.size(), landmarks.track_length(slot));
+    EXPECT_EQ(landmark_it.second.obs.size(), sfm_data_shared.structure.at(landmark_it.first).obs.size());
+  }
+}
 
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
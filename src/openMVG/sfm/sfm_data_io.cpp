@@ -15,6 +15,7 @@
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/sfm/sfm_data_io_baf.hpp"
 #include "openMVG/sfm/sfm_data_io_cereal.hpp"
+#include "openMVG/sfm/sfm_data_io_chunked.hpp"
 #include "openMVG/sfm/sfm_data_io_ply.hpp"
 #include "openMVG/stl/stlMap.hpp"
 #include "openMVG/types.hpp"
@@ -91,6 +92,10 @@ bool Load(SfM_Data & sfm_data, const std::string & filename, ESfM_Data flags_par
     bStatus = Load_Cereal<cereal::PortableBinaryInputArchive>(sfm_data, filename, flags_part);
   else if (ext == "xml")
     bStatus = Load_Cereal<cereal::XMLInputArchive>(sfm_data, filename, flags_part);
+  else if (ext == "sfmc") // Chunked binary
+    bStatus = Load_Chunked(sfm_data, filename, flags_part);
+  else if (ext == "ply") // Point cloud (STRUCTURE only, other flags are rejected)
+    bStatus = Load_PLY(sfm_data, filename, flags_part);
   else
   {
     std::cerr << "Unknown sfm_data input format: " << ext << std::endl;
@@ -117,6 +122,8 @@ bool Save(const SfM_Data & sfm_data, const std::string & filename, ESfM_Data fla
     return Save_Cereal<cereal::PortableBinaryOutputArchive>(sfm_data, filename, flags_part);
   else if (ext == "xml")
     return Save_Cereal<cereal::XMLOutputArchive>(sfm_data, filename, flags_part);
+  else if (ext == "sfmc") // Chunked binary
+    return Save_Chunked(sfm_data, filename, flags_part);
   else if (ext == "ply")
     return Save_PLY(sfm_data, filename, flags_part);
   else if (ext == "baf") // Bundle Adjustment file
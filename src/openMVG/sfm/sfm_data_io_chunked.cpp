@@ -0,0 +1,488 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// The <cereal/archives> headers are special and must be included first.
+#include <cereal/archives/portable_binary.hpp>
+
+#include "openMVG/sfm/sfm_data_io_chunked.hpp"
+
+#include "openMVG/cameras/cameras_io.hpp"
+#include "openMVG/geometry/pose3.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_view_io.hpp"
+#include "openMVG/sfm/sfm_view_priors_io.hpp"
+
+#include <cereal/types/map.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/unordered_map.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+namespace openMVG {
+namespace sfm {
+
+namespace
+{
+
+const char kMagic[8] = {'O', 'M', 'V', 'G', 'S', 'F', 'M', 'C'};
+const uint32_t kVersion = 1;
+const uint32_t kByteOrderMark = 0x01020304;
+// Section types: the root path, then the ESfM_Data values
+const uint32_t kRootPathSection = 0;
+// Alignment of the sections and of the landmark columns
+const uint64_t kAlignment = 64;
+// Number of landmarks written by a task
+const size_t kLandmarkBlockSize = 1 << 16;
+
+struct Header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t section_count;
+  uint32_t reserved;
+};
+
+struct Section_Entry
+{
+  uint32_t type;
+  uint32_t reserved;
+  uint64_t offset;
+  uint64_t size;
+};
+
+struct Pose_Record
+{
+  IndexT id;
+  uint32_t reserved;
+  double rotation[9]; // column major
+  double center[3];
+};
+
+uint64_t Align(const uint64_t value)
+{
+  return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+/// Byte offsets of the columns of a landmark section
+struct Landmark_Layout
+{
+  uint64_t ids, X, obs_offsets, obs_view_ids, obs_feat_ids, obs_x, size;
+
+  Landmark_Layout(const uint64_t landmark_count, const uint64_t observation_count)
+  {
+    // The section starts with the landmark and observation counts
+    ids = Align(2 * sizeof(uint64_t));
+    X = Align(ids + landmark_count * sizeof(IndexT));
+    obs_offsets = Align(X + 3 * landmark_count * sizeof(double));
+    obs_view_ids = Align(obs_offsets + (landmark_count + 1) * sizeof(uint64_t));
+    obs_feat_ids = Align(obs_view_ids + observation_count * sizeof(IndexT));
+    obs_x = Align(obs_feat_ids + observation_count * sizeof(IndexT));
+    size = obs_x + 2 * observation_count * sizeof(double);
+  }
+};
+
+template <typename T>
+std::string SaveBlob(const char * name, const T & value)
+{
+  std::ostringstream stream;
+  {
+    cereal::PortableBinaryOutputArchive archive(stream);
+    archive(cereal::make_nvp(name, value));
+  }
+  return stream.str();
+}
+
+template <typename T>
+bool LoadBlob(const char * data, const uint64_t size, const char * name, T & value)
+{
+  std::istringstream stream(std::string(data, size));
+  try
+  {
+    cereal::PortableBinaryInputArchive archive(stream);
+    archive(cereal::make_nvp(name, value));
+  }
+  catch (const cereal::Exception & e)
+  {
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool WriteAt(std::ostream & stream, const uint64_t offset, const void * data, const uint64_t size)
+{
+  if (size == 0)
+    return true;
+  stream.seekp(offset);
+  stream.write(static_cast<const char *>(data), size);
+  return stream.good();
+}
+
+/// A part of the file written by a thread with its own stream
+using Write_Task = std::function<bool(std::ostream &)>;
+
+/// Add the tasks writing a landmark section (sorted by id, by blocks)
+uint64_t AddLandmarkTasks
+(
+  const Landmarks & landmarks,
+  const uint64_t section_offset,
+  std::vector<Write_Task> & tasks
+)
+{
+  using Landmark_Ptr = const Landmarks::value_type *;
+  auto sorted_landmarks = std::make_shared<std::vector<Landmark_Ptr>>();
+  sorted_landmarks->reserve(landmarks.size());
+  for (const auto & landmark : landmarks)
+    sorted_landmarks->push_back(&landmark);
+  std::sort(sorted_landmarks->begin(), sorted_landmarks->end(),
+    [](Landmark_Ptr a, Landmark_Ptr b) { return a->first < b->first; });
+
+  auto obs_offsets = std::make_shared<std::vector<uint64_t>>(landmarks.size() + 1, 0);
+  for (size_t i = 0; i < sorted_landmarks->size(); ++i)
+    (*obs_offsets)[i + 1] = (*obs_offsets)[i] + (*sorted_landmarks)[i]->second.obs.size();
+
+  const uint64_t counts[2] = {landmarks.size(), obs_offsets->back()};
+  const Landmark_Layout layout(counts[0], counts[1]);
+
+  tasks.emplace_back([=](std::ostream & stream)
+  {
+    return WriteAt(stream, section_offset, counts, sizeof(counts))
+      && WriteAt(stream, section_offset + layout.obs_offsets,
+           obs_offsets->data(), obs_offsets->size() * sizeof(uint64_t));
+  });
+
+  for (size_t begin = 0; begin < sorted_landmarks->size(); begin += kLandmarkBlockSize)
+  {
+    const size_t end = std::min(begin + kLandmarkBlockSize, sorted_landmarks->size());
+    tasks.emplace_back([=](std::ostream & stream)
+    {
+      const size_t count = end - begin;
+      const uint64_t obs_begin = (*obs_offsets)[begin];
+      const uint64_t obs_count = (*obs_offsets)[end] - obs_begin;
+      std::vector<IndexT> ids(count), obs_view_ids(obs_count), obs_feat_ids(obs_count);
+      std::vector<double> X(3 * count), obs_x(2 * obs_count);
+      uint64_t k = 0;
+      for (size_t i = 0; i < count; ++i)
+      {
+        const auto & landmark = *(*sorted_landmarks)[begin + i];
+        ids[i] = landmark.first;
+        std::copy(landmark.second.X.data(), landmark.second.X.data() + 3, &X[3 * i]);
+        for (const auto & obs : landmark.second.obs)
+        {
+          obs_view_ids[k] = obs.first;
+          obs_feat_ids[k] = obs.second.id_feat;
+          obs_x[2 * k] = obs.second.x(0);
+          obs_x[2 * k + 1] = obs.second.x(1);
+          ++k;
+        }
+      }
+      return WriteAt(stream, section_offset + layout.ids + begin * sizeof(IndexT),
+          ids.data(), ids.size() * sizeof(IndexT))
+        && WriteAt(stream, section_offset + layout.X + 3 * begin * sizeof(double),
+          X.data(), X.size() * sizeof(double))
+        && WriteAt(stream, section_offset + layout.obs_view_ids + obs_begin * sizeof(IndexT),
+          obs_view_ids.data(), obs_count * sizeof(IndexT))
+        && WriteAt(stream, section_offset + layout.obs_feat_ids + obs_begin * sizeof(IndexT),
+          obs_feat_ids.data(), obs_count * sizeof(IndexT))
+        && WriteAt(stream, section_offset + layout.obs_x + 2 * obs_begin * sizeof(double),
+          obs_x.data(), obs_x.size() * sizeof(double));
+    });
+  }
+  return layout.size;
+}
+
+void ReadLandmarks(const Landmark_Columns & columns, Landmarks & landmarks)
+{
+  for (uint64_t i = 0; i < columns.landmark_count; ++i)
+  {
+    Landmark landmark;
+    landmark.X = Eigen::Map<const Vec3>(&columns.X[3 * i]);
+    for (uint64_t k = columns.obs_offsets[i]; k < columns.obs_offsets[i + 1]; ++k)
+    {
+      landmark.obs.emplace_hint(landmark.obs.end(), columns.obs_view_ids[k],
+        Observation(Eigen::Map<const Vec2>(&columns.obs_x[2 * k]), columns.obs_feat_ids[k]));
+    }
+    // The ids are sorted: insert at the end
+    landmarks.emplace_hint(landmarks.end(), columns.ids[i], std::move(landmark));
+  }
+}
+
+} // namespace
+
+bool SfM_Data_Chunked_Reader::Open(const std::string & filename)
+{
+  sections_.clear();
+  if (!file_.Open(filename) || file_.size() < sizeof(Header))
+    return false;
+
+  Header header;
+  std::memcpy(&header, file_.data(), sizeof(Header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.byte_order != kByteOrderMark ||
+      header.version > kVersion ||
+      file_.size() < sizeof(Header) + header.section_count * sizeof(Section_Entry))
+  {
+    std::cerr << "Invalid or unsupported chunked sfm_data file: " << filename << std::endl;
+    file_.Close();
+    return false;
+  }
+  for (uint32_t i = 0; i < header.section_count; ++i)
+  {
+    Section_Entry entry;
+    std::memcpy(&entry,
+      file_.data() + sizeof(Header) + i * sizeof(Section_Entry), sizeof(Section_Entry));
+    if (entry.offset > file_.size() || entry.size > file_.size() - entry.offset)
+    {
+      std::cerr << "Truncated chunked sfm_data file: " << filename << std::endl;
+      file_.Close();
+      sections_.clear();
+      return false;
+    }
+    sections_[entry.type] = {entry.offset, entry.size};
+  }
+  return true;
+}
+
+bool SfM_Data_Chunked_Reader::HasSection(ESfM_Data section) const
+{
+  return sections_.count(section) != 0;
+}
+
+bool SfM_Data_Chunked_Reader::GetLandmarkColumns
+(
+  ESfM_Data section,
+  Landmark_Columns & columns
+) const
+{
+  const auto it = sections_.find(section);
+  if ((section != STRUCTURE && section != CONTROL_POINTS) ||
+      it == sections_.cend() || it->second.second < 2 * sizeof(uint64_t))
+    return false;
+
+  const char * data = file_.data() + it->second.first;
+  const uint64_t section_size = it->second.second;
+  uint64_t counts[2];
+  std::memcpy(counts, data, sizeof(counts));
+  // Bound the counts by the section size before computing the layout (no overflow)
+  if (counts[0] > section_size / (sizeof(IndexT) + 4 * sizeof(double)) ||
+      counts[1] > section_size / (2 * sizeof(IndexT) + 2 * sizeof(double)))
+    return false;
+  const Landmark_Layout layout(counts[0], counts[1]);
+  if (layout.size > section_size)
+    return false;
+
+  // The observation offsets must delimit valid ranges of the observation columns
+  const uint64_t * obs_offsets = reinterpret_cast<const uint64_t *>(data + layout.obs_offsets);
+  if (obs_offsets[0] != 0 || obs_offsets[counts[0]] != counts[1] ||
+      !std::is_sorted(obs_offsets, obs_offsets + counts[0] + 1))
+  {
+    std::cerr << "Invalid observation offsets in the chunked sfm_data landmarks" << std::endl;
+    return false;
+  }
+
+  columns.landmark_count = counts[0];
+  columns.observation_count = counts[1];
+  columns.ids = reinterpret_cast<const IndexT *>(data + layout.ids);
+  columns.X = reinterpret_cast<const double *>(data + layout.X);
+  columns.obs_offsets = obs_offsets;
+  columns.obs_view_ids = reinterpret_cast<const IndexT *>(data + layout.obs_view_ids);
+  columns.obs_feat_ids = reinterpret_cast<const IndexT *>(data + layout.obs_feat_ids);
+  columns.obs_x = reinterpret_cast<const double *>(data + layout.obs_x);
+  return true;
+}
+
+bool SfM_Data_Chunked_Reader::Read(SfM_Data & sfm_data, ESfM_Data flags_part) const
+{
+  if (!file_.IsOpen())
+    return false;
+
+  const auto section_data = [&](const uint32_t type) -> std::pair<const char *, uint64_t>
+  {
+    const auto it = sections_.find(type);
+    if (it == sections_.cend())
+      return {nullptr, 0};
+    return {file_.data() + it->second.first, it->second.second};
+  };
+
+  const auto root_path = section_data(kRootPathSection);
+  if (root_path.first)
+    sfm_data.s_root_path.assign(root_path.first, root_path.second);
+
+  const auto views = section_data(VIEWS);
+  if ((flags_part & VIEWS) == VIEWS && views.first &&
+      !LoadBlob(views.first, views.second, "views", sfm_data.views))
+    return false;
+
+  const auto intrinsics = section_data(INTRINSICS);
+  if ((flags_part & INTRINSICS) == INTRINSICS && intrinsics.first &&
+      !LoadBlob(intrinsics.first, intrinsics.second, "intrinsics", sfm_data.intrinsics))
+    return false;
+
+  const auto poses = section_data(EXTRINSICS);
+  if ((flags_part & EXTRINSICS) == EXTRINSICS && poses.first)
+  {
+    const uint64_t pose_count = poses.second / sizeof(Pose_Record);
+    for (uint64_t i = 0; i < pose_count; ++i)
+    {
+      Pose_Record record;
+      std::memcpy(&record, poses.first + i * sizeof(Pose_Record), sizeof(Pose_Record));
+      sfm_data.poses[record.id] = geometry::Pose3(
+        Eigen::Map<const Mat3>(record.rotation),
+        Eigen::Map<const Vec3>(record.center));
+    }
+  }
+
+  for (const ESfM_Data section : {STRUCTURE, CONTROL_POINTS})
+  {
+    if ((flags_part & section) != section || !HasSection(section))
+      continue;
+    Landmark_Columns columns;
+    if (!GetLandmarkColumns(section, columns))
+      return false;
+    ReadLandmarks(columns,
+      section == STRUCTURE ? sfm_data.structure : sfm_data.control_points);
+  }
+  return true;
+}
+
+bool Load_Chunked(
+  SfM_Data & sfm_data,
+  const std::string & filename,
+  ESfM_Data flags_part)
+{
+  SfM_Data_Chunked_Reader reader;
+  return reader.Open(filename) && reader.Read(sfm_data, flags_part);
+}
+
+bool Save_Chunked(
+  const SfM_Data & sfm_data,
+  const std::string & filename,
+  ESfM_Data flags_part)
+{
+  // Layout of the sections and the tasks that write them
+  std::vector<Section_Entry> entries;
+  std::vector<Write_Task> tasks;
+
+  // The section table lists the root path and the requested parts
+  uint32_t section_count = 1;
+  for (const ESfM_Data part : {VIEWS, INTRINSICS, EXTRINSICS, STRUCTURE, CONTROL_POINTS})
+  {
+    if ((flags_part & part) == part)
+      ++section_count;
+  }
+  uint64_t offset = Align(sizeof(Header) + section_count * sizeof(Section_Entry));
+  const auto add_section = [&](const uint32_t type, const uint64_t size)
+  {
+    entries.push_back({type, 0, offset, size});
+    offset = Align(offset + size);
+    return entries.back().offset;
+  };
+  const auto add_blob = [&](const uint32_t type, std::string && blob)
+  {
+    const auto data = std::make_shared<std::string>(std::move(blob));
+    const uint64_t section_offset = add_section(type, data->size());
+    tasks.emplace_back([=](std::ostream & stream)
+    {
+      return WriteAt(stream, section_offset, data->data(), data->size());
+    });
+  };
+
+  add_blob(kRootPathSection, std::string(sfm_data.s_root_path));
+  if ((flags_part & VIEWS) == VIEWS)
+    add_blob(VIEWS, SaveBlob("views", sfm_data.views));
+  if ((flags_part & INTRINSICS) == INTRINSICS)
+    add_blob(INTRINSICS, SaveBlob("intrinsics", sfm_data.intrinsics));
+  if ((flags_part & EXTRINSICS) == EXTRINSICS)
+  {
+    const uint64_t section_offset =
+      add_section(EXTRINSICS, sfm_data.poses.size() * sizeof(Pose_Record));
+    tasks.emplace_back([=, &sfm_data](std::ostream & stream)
+    {
+      std::vector<Pose_Record> records;
+      records.reserve(sfm_data.poses.size());
+      for (const auto & pose : sfm_data.poses)
+      {
+        Pose_Record record;
+        record.id = pose.first;
+        record.reserved = 0;
+        Eigen::Map<Mat3>(record.rotation) = pose.second.rotation();
+        Eigen::Map<Vec3>(record.center) = pose.second.center();
+        records.push_back(record);
+      }
+      return WriteAt(stream, section_offset, records.data(),
+        records.size() * sizeof(Pose_Record));
+    });
+  }
+  for (const ESfM_Data section : {STRUCTURE, CONTROL_POINTS})
+  {
+    if ((flags_part & section) != section)
+      continue;
+    const Landmarks & landmarks =
+      section == STRUCTURE ? sfm_data.structure : sfm_data.control_points;
+    // The section size is known once the tasks are listed
+    entries.push_back({static_cast<uint32_t>(section), 0, offset, 0});
+    entries.back().size = AddLandmarkTasks(landmarks, offset, tasks);
+    offset = Align(offset + entries.back().size);
+  }
+
+  // Header, section table and file size
+  assert(entries.size() == section_count);
+  {
+    std::ofstream stream(filename.c_str(), std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!stream.is_open())
+      return false;
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byte_order = kByteOrderMark;
+    header.section_count = static_cast<uint32_t>(entries.size());
+    header.reserved = 0;
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    stream.write(reinterpret_cast<const char *>(entries.data()),
+      entries.size() * sizeof(Section_Entry));
+    stream.seekp(offset - 1);
+    stream.put('\0');
+    if (!stream.good())
+      return false;
+  }
+
+  // Write the sections in parallel (one stream per thread)
+  bool bOk = true;
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel
+#endif
+  {
+    std::fstream stream(filename.c_str(), std::ios::binary | std::ios::in | std::ios::out);
+    bool bThreadOk = stream.is_open();
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    for (int i = 0; i < static_cast<int>(tasks.size()); ++i)
+    {
+      if (bThreadOk)
+        bThreadOk = tasks[i](stream);
+    }
+    bThreadOk = bThreadOk && stream.flush().good();
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp critical
+#endif
+    bOk &= bThreadOk;
+  }
+  return bOk;
+}
+
+} // namespace sfm
+} // namespace openMVG
@@ -0,0 +1,95 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_DATA_IO_CHUNKED_HPP
+#define OPENMVG_SFM_SFM_DATA_IO_CHUNKED_HPP
+
+#include "openMVG/sfm/sfm_data_io.hpp"
+#include "openMVG/system/mapped_file.hpp"
+#include "openMVG/types.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace openMVG {
+namespace sfm {
+
+struct SfM_Data;
+
+/**
+* Chunked binary SfM_Data format (.sfmc)
+*
+* The file starts with a header and a section table, then each section is
+* stored at a 64 bytes aligned offset:
+*  - the root path,
+*  - VIEWS and INTRINSICS: cereal portable binary archives (polymorphic types),
+*  - EXTRINSICS: array of (pose id, rotation, center) records,
+*  - STRUCTURE and CONTROL_POINTS: columnar landmarks (sorted by id):
+*     ids[N], X[3N], observation offsets[N+1],
+*     observation view ids[M], feature ids[M], positions[2M].
+*
+* Only the requested sections are read. The landmark columns are not parsed:
+* they can be accessed in place from a memory mapping of the file
+* (see SfM_Data_Chunked_Reader::GetLandmarkColumns), so the observations can
+* be streamed without loading them in a SfM_Data.
+* The sections (and the landmark blocks) are written in parallel.
+* The data is stored in the host byte order (the reader checks it).
+*/
+
+/// Columnar landmarks of a chunked file section (pointers in the mapped file)
+struct Landmark_Columns
+{
+  uint64_t landmark_count = 0;
+  uint64_t observation_count = 0;
+  const IndexT * ids = nullptr;          // [landmark_count]
+  const double * X = nullptr;            // [3 * landmark_count]
+  const uint64_t * obs_offsets = nullptr; // [landmark_count + 1]
+  const IndexT * obs_view_ids = nullptr; // [observation_count]
+  const IndexT * obs_feat_ids = nullptr; // [observation_count]
+  const double * obs_x = nullptr;        // [2 * observation_count]
+};
+
+/// Memory mapped reader of a chunked SfM_Data file
+class SfM_Data_Chunked_Reader
+{
+public:
+  /// Map the file and read its section table
+  bool Open(const std::string & filename);
+
+  /// Tell if a section (VIEWS, INTRINSICS, ...) is stored in the file
+  bool HasSection(ESfM_Data section) const;
+
+  /// Read the requested sections in a SfM_Data (the root path is always read)
+  bool Read(SfM_Data & sfm_data, ESfM_Data flags_part) const;
+
+  /// Access in place to the landmark columns of the STRUCTURE or CONTROL_POINTS section
+  /// (false if the section is missing, truncated or has invalid observation offsets)
+  bool GetLandmarkColumns(ESfM_Data section, Landmark_Columns & columns) const;
+
+private:
+  system::MappedFile file_;
+  // Section type -> (offset, size) in bytes
+  std::map<uint32_t, std::pair<uint64_t, uint64_t>> sections_;
+};
+
+/// Load a SfM_Data SfM scene from a chunked binary file
+bool Load_Chunked(
+  SfM_Data & sfm_data,
+  const std::string & filename,
+  ESfM_Data flags_part);
+
+/// Save a SfM_Data SfM scene to a chunked binary file
+bool Save_Chunked(
+  const SfM_Data & sfm_data,
+  const std::string & filename,
+  ESfM_Data flags_part);
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_DATA_IO_CHUNKED_HPP
@@ -9,12 +9,14 @@
 #ifndef OPENMVG_SFM_SFM_DATA_IO_PLY_HPP
 #define OPENMVG_SFM_SFM_DATA_IO_PLY_HPP
 
+#include "openMVG/geometry/ply_point_cloud.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 
-#include <fstream>
-#include <iomanip>
-#include <limits>
+#include <algorithm>
+#include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace openMVG {
 namespace sfm {
@@ -35,149 +37,129 @@ inline bool Save_PLY
   if (!(b_structure || b_extrinsics || b_control_points))
     return false; // No 3D points to display, so it would produce an empty PLY file
 
-  // Create the stream and check its status
-  std::ofstream stream(filename.c_str(), std::ios::out | std::ios::binary);
-  if (!stream.is_open())
-    return false;
-
-  bool bOk = false;
+  // Count how many views having valid poses:
+  IndexT view_with_pose_count = 0;
+  IndexT view_with_pose_prior_count = 0;
+  if (b_extrinsics)
   {
-    // Count how many views having valid poses:
-    IndexT view_with_pose_count = 0;
-    IndexT view_with_pose_prior_count = 0;
-    if (b_extrinsics)
+    for (const auto & view : sfm_data.GetViews())
     {
-      for (const auto & view : sfm_data.GetViews())
-      {
-        view_with_pose_count += sfm_data.IsPoseAndIntrinsicDefined(view.second.get());
-      }
+      view_with_pose_count += sfm_data.IsPoseAndIntrinsicDefined(view.second.get());
+    }
 
-      for (const auto & view : sfm_data.GetViews())
+    for (const auto & view : sfm_data.GetViews())
+    {
+      if (const sfm::ViewPriors *prior = dynamic_cast<sfm::ViewPriors*>(view.second.get()))
       {
-        if (const sfm::ViewPriors *prior = dynamic_cast<sfm::ViewPriors*>(view.second.get()))
-        {
-            view_with_pose_prior_count += prior->b_use_pose_center_;
-        }
+          view_with_pose_prior_count += prior->b_use_pose_center_;
       }
     }
+  }
+
+  geometry::Ply_Point_Writer writer;
+  // Vertex count: (#landmark + #GCP + #view_with_valid_pose)
+  if (!writer.Open(filename,
+        (b_structure ? sfm_data.GetLandmarks().size() : 0)
+        + (b_control_points ? sfm_data.GetControl_Points().size() : 0)
+        + view_with_pose_count
+        + view_with_pose_prior_count,
+        b_write_in_ascii))
+    return false;
 
-    stream << std::fixed << std::setprecision (std::numeric_limits<double>::digits10 + 1);
-
-    using Vec3uc = Eigen::Matrix<unsigned char, 3, 1>;
-
-    stream << "ply"
-      << '\n' << "format "
-              << (b_write_in_ascii ? "ascii 1.0" : "binary_little_endian 1.0")
-      << '\n' << "comment generated by OpenMVG"
-      << '\n' << "element vertex "
-        // Vertex count: (#landmark + #GCP + #view_with_valid_pose)
-        << (  (b_structure ? sfm_data.GetLandmarks().size() : 0)
-            + (b_control_points ? sfm_data.GetControl_Points().size() : 0)
-            + view_with_pose_count
-            + view_with_pose_prior_count)
-      << '\n' << "property double x"
-      << '\n' << "property double y"
-      << '\n' << "property double z"
-      << '\n' << "property uchar red"
-      << '\n' << "property uchar green"
-      << '\n' << "property uchar blue"
-      << '\n' << "end_header" << std::endl;
-
-      if (b_extrinsics)
+  bool bOk = true;
+  if (b_extrinsics)
+  {
+    for (const auto & view : sfm_data.GetViews())
+    {
+      // Export pose as Green points
+      if (sfm_data.IsPoseAndIntrinsicDefined(view.second.get()))
       {
-        for (const auto & view : sfm_data.GetViews())
-        {
-          // Export pose as Green points
-          if (sfm_data.IsPoseAndIntrinsicDefined(view.second.get()))
-          {
-            const geometry::Pose3 pose = sfm_data.GetPoseOrDie(view.second.get());
-            if (b_write_in_ascii)
-            {
-              stream
-                << pose.center()(0) << ' '
-                << pose.center()(1) << ' '
-                << pose.center()(2) << ' '
-                << "0 255 0\n";
-            }
-            else
-            {
-              stream.write( reinterpret_cast<const char*> ( pose.center().data() ), sizeof( Vec3 ) );
-              stream.write( reinterpret_cast<const char*> ( Vec3uc(0, 255, 0).data() ), sizeof( Vec3uc ) );
-            }
-          }
-
-          // Export pose priors as Blue points
-          if (const sfm::ViewPriors *prior = dynamic_cast<sfm::ViewPriors*>(view.second.get()))
-          {
-            if (prior->b_use_pose_center_)
-            {
-              if (b_write_in_ascii)
-              {
-                stream
-                  << prior->pose_center_(0) << ' '
-                  << prior->pose_center_(1) << ' '
-                  << prior->pose_center_(2) << ' '
-                  << "0 0 255\n";
-              }
-              else
-              {
-                stream.write( reinterpret_cast<const char*> ( prior->pose_center_.data() ), sizeof( Vec3 ) );
-                stream.write( reinterpret_cast<const char*> ( Vec3uc(0, 0, 255).data() ), sizeof( Vec3uc ) );
-              }
-            }
-          }
-        }
+        const geometry::Pose3 pose = sfm_data.GetPoseOrDie(view.second.get());
+        bOk &= writer.Write(pose.center(), geometry::Ply_Color(0, 255, 0));
       }
 
-      if (b_structure)
+      // Export pose priors as Blue points
+      if (const sfm::ViewPriors *prior = dynamic_cast<sfm::ViewPriors*>(view.second.get()))
       {
-        // Export structure points as White points
-        const Landmarks & landmarks = sfm_data.GetLandmarks();
-        for ( const auto & iterLandmarks : landmarks )
+        if (prior->b_use_pose_center_)
         {
-          if (b_write_in_ascii)
-          {
-            stream
-              << iterLandmarks.second.X(0) << ' '
-              << iterLandmarks.second.X(1) << ' '
-              << iterLandmarks.second.X(2) << ' '
-              << "255 255 255\n";
-          }
-          else
-          {
-            stream.write( reinterpret_cast<const char*> ( iterLandmarks.second.X.data() ), sizeof( Vec3 ) );
-            stream.write( reinterpret_cast<const char*> ( Vec3uc(255, 255, 255).data() ), sizeof( Vec3uc ) );
-          }
+          bOk &= writer.Write(prior->pose_center_, geometry::Ply_Color(0, 0, 255));
         }
       }
+    }
+  }
 
-      if (b_control_points)
+  // Write the landmark positions by large chunks (formatted in parallel)
+  const auto write_landmarks = [&writer](const Landmarks & landmarks, const geometry::Ply_Color & color)
+  {
+    const std::size_t chunk_size = 1 << 18;
+    std::vector<Vec3> points;
+    points.reserve(std::min(landmarks.size(), chunk_size));
+    bool bWriteOk = true;
+    for (const auto & iterLandmarks : landmarks)
+    {
+      points.push_back(iterLandmarks.second.X);
+      if (points.size() == chunk_size)
       {
-        // Export GCP as Red points
-        const Landmarks & landmarks = sfm_data.GetControl_Points();
-        for ( const auto & iterGCP : landmarks )
-        {
-          if (b_write_in_ascii)
-          {
-            stream
-              << iterGCP.second.X(0) << ' '
-              << iterGCP.second.X(1) << ' '
-              << iterGCP.second.X(2) << ' '
-              << "255 0 0\n";
-          }
-          else
-          {
-            stream.write( reinterpret_cast<const char*> ( iterGCP.second.X.data() ), sizeof( Vec3 ) );
-            stream.write( reinterpret_cast<const char*> ( Vec3uc(255, 0, 0).data() ), sizeof( Vec3uc ) );
-          }
-        }
+        bWriteOk &= writer.Write(points, color);
+        points.clear();
       }
+    }
+    return writer.Write(points, color) && bWriteOk;
+  };
 
-      stream.flush();
-      bOk = stream.good();
-      stream.close();
+  if (b_structure)
+  {
+    // Export structure points as White points
+    bOk &= write_landmarks(sfm_data.GetLandmarks(), geometry::Ply_Color(255, 255, 255));
+  }
+
+  if (b_control_points)
+  {
+    // Export GCP as Red points
+    bOk &= write_landmarks(sfm_data.GetControl_Points(), geometry::Ply_Color(255, 0, 0));
+  }
+
+  return writer.Close() && bOk;
+}
+
+/**
+* @brief Load the vertices of a PLY file as the structure of a SfM_Data container.
+*  The landmarks (ids 0 to #vertices-1) have no observation: they can be used
+*  as 3D point priors. Only the STRUCTURE part can be loaded: the other
+*  flags (i.e. ALL) are rejected since a PLY file cannot provide them.
+*/
+inline bool Load_PLY
+(
+  SfM_Data & sfm_data,
+  const std::string & filename,
+  ESfM_Data flags_part
+)
+{
+  if (flags_part != STRUCTURE)
+  {
+    std::cerr << "A PLY file can only provide the STRUCTURE part of a scene." << std::endl;
+    return false;
+  }
+
+  geometry::Ply_Point_Reader reader;
+  if (!reader.Open(filename))
+    return false;
+
+  Landmarks & landmarks = sfm_data.structure;
+  landmarks.clear();
+  IndexT landmark_id = 0;
+  std::vector<Vec3> points;
+  while (reader.Read(1 << 20, points) > 0)
+  {
+    for (const Vec3 & X : points)
+    {
+      Landmark landmark;
+      landmark.X = X;
+      landmarks.emplace_hint(landmarks.end(), landmark_id++, std::move(landmark));
+    }
   }
-  return bOk;
+  return reader.IsComplete();
 }
 
 } // namespace sfm
@@ -9,11 +9,14 @@
 #include "openMVG/cameras/Camera_Pinhole.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
+#include "openMVG/sfm/sfm_data_io_chunked.hpp"
 #include "openMVG/cameras/Camera_Intrinsics.hpp"
 
 #include "testing/testing.h"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <fstream>
+#include <iterator>
 #include <sstream>
 
 using namespace openMVG;
@@ -63,7 +66,7 @@ SfM_Data create_test_scene(IndexT viewsCount, bool bSharedIntrinsic)
 
 TEST(SfM_Data_IO, SAVE_LOAD_JSON) {
 
-  const std::vector<std::string> ext_Type = {"json", "bin", "xml"};
+  const std::vector<std::string> ext_Type = {"json", "bin", "xml", "sfmc"};
 
   for (size_t i=0; i < ext_Type.size(); ++i)
   {
@@ -164,6 +167,88 @@ TEST(SfM_Data_IO, SAVE_LOAD_JSON) {
   }
 }
 
+TEST(SfM_Data_IO, SAVE_LOAD_CHUNKED) {
+
+  const std::string filename = "SAVE_LOAD_CHUNKED.sfmc";
+  SfM_Data sfm_data = create_test_scene(3, false);
+  sfm_data.poses[1] = Pose3(RotationAroundZ(0.5), Vec3(1, 2, 3));
+  sfm_data.structure[7].X = Vec3(-1, 0, 1);
+  sfm_data.structure[7].obs[2] = Observation(Vec2(5, 6), 42);
+  sfm_data.control_points[3].X = Vec3(4, 5, 6);
+  sfm_data.control_points[3].obs[1] = Observation(Vec2(1, 2), UndefinedIndexT);
+  EXPECT_TRUE( Save(sfm_data, filename, ALL) );
+
+  // Round trip of the values
+  SfM_Data sfm_data_load;
+  EXPECT_TRUE( Load(sfm_data_load, filename, ALL) );
+  EXPECT_EQ( sfm_data.s_root_path, sfm_data_load.s_root_path );
+  EXPECT_MATRIX_NEAR( sfm_data.poses[1].rotation(), sfm_data_load.poses[1].rotation(), 1e-12 );
+  EXPECT_MATRIX_NEAR( sfm_data.poses[1].center(), sfm_data_load.poses[1].center(), 1e-12 );
+  EXPECT_EQ( sfm_data.structure.size(), sfm_data_load.structure.size() );
+  for (const auto & landmark : sfm_data.structure)
+  {
+    const Landmark & landmark_load = sfm_data_load.structure.at(landmark.first);
+    EXPECT_MATRIX_NEAR( landmark.second.X, landmark_load.X, 1e-12 );
+    EXPECT_EQ( landmark.second.obs.size(), landmark_load.obs.size() );
+    for (const auto & obs : landmark.second.obs)
+    {
+      EXPECT_MATRIX_NEAR( obs.second.x, landmark_load.obs.at(obs.first).x, 1e-12 );
+      EXPECT_EQ( obs.second.id_feat, landmark_load.obs.at(obs.first).id_feat );
+    }
+  }
+  EXPECT_EQ( 1, sfm_data_load.control_points.size() );
+  EXPECT_EQ( UndefinedIndexT, sfm_data_load.control_points.at(3).obs.at(1).id_feat );
+
+  // In place access to the landmark columns (sorted by landmark id)
+  SfM_Data_Chunked_Reader reader;
+  EXPECT_TRUE( reader.Open(filename) );
+  EXPECT_TRUE( reader.HasSection(STRUCTURE) );
+  Landmark_Columns columns;
+  EXPECT_TRUE( reader.GetLandmarkColumns(STRUCTURE, columns) );
+  EXPECT_EQ( 2, columns.landmark_count );
+  EXPECT_EQ( 3, columns.observation_count );
+  EXPECT_EQ( 0, columns.ids[0] );
+  EXPECT_EQ( 7, columns.ids[1] );
+  EXPECT_EQ( 2, columns.obs_offsets[1] );
+  EXPECT_EQ( 2, columns.obs_view_ids[2] );
+  EXPECT_EQ( 42, columns.obs_feat_ids[2] );
+  EXPECT_EQ( 6.0, columns.obs_x[5] );
+
+  // Corrupted observation offsets are rejected: find the structure offsets
+  // {0, 2, 3} in the file and make them exceed the observation count
+  {
+    std::string bytes;
+    {
+      std::ifstream stream(filename, std::ios::binary);
+      bytes.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+    const uint64_t obs_offsets[3] = {0, 2, 3};
+    const std::size_t pos =
+      bytes.find(std::string(reinterpret_cast<const char *>(obs_offsets), sizeof(obs_offsets)));
+    EXPECT_TRUE( pos != std::string::npos );
+    const uint64_t bad_offset = 5;
+    bytes.replace(pos + sizeof(uint64_t), sizeof(uint64_t),
+      reinterpret_cast<const char *>(&bad_offset), sizeof(uint64_t));
+    const std::string corrupted_filename = "SAVE_LOAD_CHUNKED_corrupted.sfmc";
+    {
+      std::ofstream stream(corrupted_filename, std::ios::binary);
+      stream.write(bytes.data(), bytes.size());
+    }
+    SfM_Data_Chunked_Reader corrupted_reader;
+    EXPECT_TRUE( corrupted_reader.Open(corrupted_filename) );
+    EXPECT_FALSE( corrupted_reader.GetLandmarkColumns(STRUCTURE, columns) );
+    SfM_Data sfm_data_corrupted;
+    EXPECT_FALSE( Load(sfm_data_corrupted, corrupted_filename, ALL) );
+    EXPECT_TRUE( Load(sfm_data_corrupted, corrupted_filename, ESfM_Data(VIEWS | INTRINSICS)) );
+  }
+
+  // A section that is not saved is not in the file
+  EXPECT_TRUE( Save(sfm_data, filename, ESfM_Data(VIEWS | INTRINSICS)) );
+  EXPECT_TRUE( reader.Open(filename) );
+  EXPECT_FALSE( reader.HasSection(STRUCTURE) );
+  EXPECT_FALSE( reader.GetLandmarkColumns(STRUCTURE, columns) );
+}
+
 TEST(SfM_Data_IO, SAVE_PLY) {
 
   // SAVE as PLY
@@ -177,6 +262,18 @@ TEST(SfM_Data_IO, SAVE_PLY) {
     ESfM_Data flags_part = ESfM_Data(EXTRINSICS | STRUCTURE);
     EXPECT_TRUE( Save(sfm_data, filename, flags_part) );
     EXPECT_TRUE( stlplus::is_file(filename) );
+
+    // LOAD the PLY points as landmarks (the camera centers come first)
+    SfM_Data sfm_data_load;
+    EXPECT_FALSE( Load(sfm_data_load, filename, ESfM_Data(VIEWS)) );
+    // The parts a PLY file cannot provide are not silently left out
+    EXPECT_FALSE( Load(sfm_data_load, filename, ESfM_Data(ALL)) );
+    EXPECT_TRUE( Load(sfm_data_load, filename, ESfM_Data(STRUCTURE)) );
+    EXPECT_EQ( sfm_data.GetPoses().size() + sfm_data.GetLandmarks().size(),
+      sfm_data_load.GetLandmarks().size() );
+    EXPECT_MATRIX_EQ( sfm_data.GetLandmarks().at(0).X,
+      sfm_data_load.GetLandmarks().at(sfm_data.GetPoses().size()).X );
+    EXPECT_TRUE( sfm_data_load.GetLandmarks().at(0).obs.empty() );
   }
 }
 
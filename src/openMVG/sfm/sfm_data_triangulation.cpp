@@ -8,11 +8,12 @@
 
 #include "openMVG/sfm/sfm_data_triangulation.hpp"
 
-#include <deque>
-#include <functional>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
 
 #include "openMVG/geometry/pose3.hpp"
-#include "openMVG/multiview/triangulation_nview.hpp"
 #include "openMVG/multiview/triangulation.hpp"
 #include "openMVG/robust_estimation/rand_sampling.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
@@ -42,127 +43,233 @@ SfM_Data_Structure_Computation_Blind::SfM_Data_Structure_Computation_Blind
 {
 }
 
-/// Triangulate a given set of observations
-bool track_triangulation
+/// Data of a view having a valid pose and intrinsic, computed once per scene
+/// and shared (read-only) by all the triangulation threads.
+struct TriangulationView
+{
+  const IntrinsicBase * cam;
+  Pose3 pose;
+  Mat34 P;
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+using TriangulationViews =
+  std::vector<TriangulationView, Eigen::aligned_allocator<TriangulationView>>;
+
+/// Cache the pose, projection matrix and intrinsic of the scene views.
+/// view_to_index gives the position of a view in the returned array
+/// (views without valid pose or intrinsic are not listed).
+static TriangulationViews ComputeTriangulationViews
 (
   const SfM_Data & sfm_data,
-  const Observations & obs,
-  Vec3 & X,
-  const ETriangulationMethod & etri_method = ETriangulationMethod::DEFAULT
+  Hash_Map<IndexT, uint32_t> & view_to_index
 )
 {
-  if (obs.size() >= 2)
+  TriangulationViews views;
+  views.reserve(sfm_data.GetViews().size());
+  for (const auto & view_it : sfm_data.GetViews())
   {
-    std::vector<Vec3> bearing;
-    std::vector<Mat34> poses;
-    std::vector<Pose3> poses_;
-    bearing.reserve(obs.size());
-    poses.reserve(obs.size());
-    for (const auto& observation : obs)
-    {
-      const View * view = sfm_data.views.at(observation.first).get();
-      if (!sfm_data.IsPoseAndIntrinsicDefined(view))
-        return false;
-      const IntrinsicBase * cam = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
-      const Pose3 pose = sfm_data.GetPoseOrDie(view);
-      bearing.emplace_back((*cam)(cam->get_ud_pixel(observation.second.x)));
-      poses.emplace_back(pose.asMatrix());
-      poses_.emplace_back(pose);
-    }
-    if (bearing.size() > 2)
+    const View * view = view_it.second.get();
+    if (!sfm_data.IsPoseAndIntrinsicDefined(view))
+      continue;
+    TriangulationView data;
+    data.cam = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
+    data.pose = sfm_data.GetPoseOrDie(view);
+    data.P = data.pose.asMatrix();
+    view_to_index[view_it.first] = static_cast<uint32_t>(views.size());
+    views.push_back(data);
+  }
+  return views;
+}
+
+/// Per thread scratch memory used to triangulate a track.
+/// The observations of the track are stored as a structure of arrays
+/// (in the Observations map order) and the buffers are reused from one track
+/// to the next, so the triangulation loop does not allocate once warmed up.
+struct TrackTriangulationBuffer
+{
+  std::vector<const TriangulationView *> views; // nullptr: undefined pose or intrinsic
+  std::vector<Vec2> x;                          // observed pixels
+  std::vector<Vec3> bearing;                    // bearing of the undistorted pixels
+  std::vector<Vec3> bearing_cheirality;         // bearing used by the cheirality test
+  std::vector<uint32_t> samples;
+  std::vector<uint32_t> inliers;
+  std::vector<uint32_t> best_inliers;
+
+  void Fill
+  (
+    const Observations & obs,
+    const TriangulationViews & scene_views,
+    const Hash_Map<IndexT, uint32_t> & view_to_index
+  )
+  {
+    views.clear();
+    x.clear();
+    bearing.clear();
+    bearing_cheirality.clear();
+    for (const auto & obs_it : obs)
     {
-      const Eigen::Map<const Mat3X> bearing_matrix(bearing[0].data(), 3, bearing.size());
-      Vec4 Xhomogeneous;
-      if (TriangulateNViewAlgebraic
-      (
-        bearing_matrix,
-        poses,
-        &Xhomogeneous))
+      const auto it = view_to_index.find(obs_it.first);
+      const TriangulationView * view =
+        (it == view_to_index.end()) ? nullptr : &scene_views[it->second];
+      views.push_back(view);
+      x.push_back(obs_it.second.x);
+      if (view)
       {
-        X = Xhomogeneous.hnormalized();
-        return true;
+        const IntrinsicBase & cam = *view->cam;
+        bearing.push_back(cam(cam.get_ud_pixel(obs_it.second.x)));
+        bearing_cheirality.push_back(cam(obs_it.second.x));
+      }
+      else
+      {
+        bearing.push_back(Vec3::Zero());
+        bearing_cheirality.push_back(Vec3::Zero());
       }
     }
-    else
-    {
-      return Triangulate2View
-      (
-        poses_.front().rotation(),
-        poses_.front().translation(),
-        bearing.front(),
-        poses_.back().rotation(),
-        poses_.back().translation(),
-        bearing.back(),
-        X,
-        etri_method
-      );
-    }
   }
-  return false;
+};
+
+/// Triangulate the observations of a buffer listed by indexes
+/// - 2 observations: use the requested two view triangulation method
+/// - N observations: algebraic N-view triangulation (TriangulateNViewAlgebraic)
+///   accumulated in place over the buffer to avoid temporaries.
+static bool TriangulateObservations
+(
+  const TrackTriangulationBuffer & buffer,
+  const uint32_t * indexes,
+  const std::size_t count,
+  const ETriangulationMethod etri_method,
+  Vec3 & X
+)
+{
+  if (count < 2)
+    return false;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (!buffer.views[indexes[i]])
+      return false;
+  }
+  if (count == 2)
+  {
+    const TriangulationView & view0 = *buffer.views[indexes[0]];
+    const TriangulationView & view1 = *buffer.views[indexes[1]];
+    return Triangulate2View
+    (
+      view0.pose.rotation(),
+      view0.pose.translation(),
+      buffer.bearing[indexes[0]],
+      view1.pose.rotation(),
+      view1.pose.translation(),
+      buffer.bearing[indexes[1]],
+      X,
+      etri_method
+    );
+  }
+
+  Mat4 AtA = Mat4::Zero();
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const Mat34 & P = buffer.views[indexes[i]]->P;
+    const Vec3 point_norm = buffer.bearing[indexes[i]].normalized();
+    const Mat34 cost = P - point_norm * (point_norm.transpose() * P);
+    AtA.noalias() += cost.transpose() * cost;
+  }
+  const Eigen::SelfAdjointEigenSolver<Mat4> eigen_solver(AtA);
+  if (eigen_solver.info() != Eigen::Success)
+    return false;
+  X = eigen_solver.eigenvectors().col(0).hnormalized();
+  return true;
 }
 
-// Test if a predicate is true for each observation
-// i.e: predicate could be:
-// - cheirality test (depth test): cheirality_predicate
-// - cheirality and residual error: ResidualAndCheiralityPredicate::predicate
-bool track_check_predicate
+/// Return true if all the listed observations (with a defined view) see X in
+/// front of the camera and, if check_residual is set, with a residual lower
+/// than squared_pixel_threshold.
+/// indexes can be nullptr to list the count first observations.
+/// Return false if none of the listed observations can be evaluated.
+static bool CheckObservations
 (
-  const Observations & obs,
-  const SfM_Data & sfm_data,
+  const TrackTriangulationBuffer & buffer,
+  const uint32_t * indexes,
+  const std::size_t count,
   const Vec3 & X,
-  std::function<bool(
-    const IntrinsicBase&,
-    const Pose3&,
-    const Vec2&,
-    const Vec3&)> predicate
+  const bool check_residual,
+  const double squared_pixel_threshold
 )
 {
   bool visibility = false; // assume that no observation has been looked yet
-  for (const auto & obs_it : obs)
+  for (std::size_t i = 0; i < count; ++i)
   {
-    const View * view = sfm_data.views.at(obs_it.first).get();
-    if (!sfm_data.IsPoseAndIntrinsicDefined(view))
+    const uint32_t idx = indexes ? indexes[i] : static_cast<uint32_t>(i);
+    const TriangulationView * view = buffer.views[idx];
+    if (!view)
       continue;
     visibility = true; // at least an observation is evaluated
-    const IntrinsicBase * cam = sfm_data.intrinsics.at(view->id_intrinsic).get();
-    const Pose3 pose = sfm_data.GetPoseOrDie(view);
-    if (!predicate(*cam, pose, obs_it.second.x, X))
+    if (!CheiralityTest(buffer.bearing_cheirality[idx], view->pose, X))
+      return false;
+    if (check_residual &&
+        view->cam->residual(view->pose(X), buffer.x[idx]).squaredNorm() >=
+          squared_pixel_threshold)
       return false;
   }
   return visibility;
 }
 
-bool cheirality_predicate
+/// Blind triangulation of the observations stored in the buffer
+static bool BlindTriangulation
 (
-  const IntrinsicBase& cam,
-  const Pose3& pose,
-  const Vec2& x,
-  const Vec3& X
+  TrackTriangulationBuffer & buffer,
+  Vec3 & X
 )
 {
-  return CheiralityTest(cam(x), pose, X);
+  buffer.samples.resize(buffer.views.size());
+  std::iota(buffer.samples.begin(), buffer.samples.end(), 0);
+  // Keep the point only if it has a positive depth for all obs
+  return TriangulateObservations(
+           buffer, buffer.samples.data(), buffer.samples.size(),
+           ETriangulationMethod::DEFAULT, X) &&
+         CheckObservations(
+           buffer, nullptr, buffer.views.size(), X, false, 0.0);
 }
 
-struct ResidualAndCheiralityPredicate
+/// Landmark processing status of a parallel triangulation
+enum ETrackStatus : uint8_t
 {
-  const double squared_pixel_threshold_;
+  TRACK_REJECTED = 0,
+  TRACK_KEPT = 1
+};
 
-  ResidualAndCheiralityPredicate(const double squared_pixel_threshold)
-    :squared_pixel_threshold_(squared_pixel_threshold){}
+/// Flatten the landmarks in a random access array to split them in chunks
+static std::vector<std::pair<IndexT, Landmark *>> ListLandmarks
+(
+  Landmarks & landmarks
+)
+{
+  std::vector<std::pair<IndexT, Landmark *>> list;
+  list.reserve(landmarks.size());
+  for (auto & landmark_it : landmarks)
+    list.emplace_back(landmark_it.first, &landmark_it.second);
+  return list;
+}
 
-  bool predicate
-  (
-    const IntrinsicBase& cam,
-    const Pose3& pose,
-    const Vec2& x,
-    const Vec3& X
-  )
+/// Erase the landmarks having a TRACK_REJECTED status
+static void EraseRejectedLandmarks
+(
+  const std::vector<std::pair<IndexT, Landmark *>> & landmarks,
+  const std::vector<uint8_t> & status,
+  Landmarks & structure
+)
+{
+  for (std::size_t i = 0; i < landmarks.size(); ++i)
   {
-    const Vec2 residual = cam.residual(pose(X), x);
-    return CheiralityTest(cam(x), pose, X) &&
-           residual.squaredNorm() < squared_pixel_threshold_;
+    if (status[i] == TRACK_REJECTED)
+      structure.erase(landmarks[i].first);
   }
-};
+}
+
+// Number of landmarks processed by a thread in a row.
+// Large enough to amortize the scheduling, small enough to balance the
+// heterogeneous track lengths.
+static const int kTriangulationChunkSize = 64;
 
 void SfM_Data_Structure_Computation_Blind::triangulate
 (
@@ -170,57 +277,45 @@ void SfM_Data_Structure_Computation_Blind::triangulate
 )
 const
 {
-  std::deque<IndexT> rejectedId;
+  Hash_Map<IndexT, uint32_t> view_to_index;
+  const TriangulationViews views = ComputeTriangulationViews(sfm_data, view_to_index);
+  const auto landmarks = ListLandmarks(sfm_data.structure);
+  std::vector<uint8_t> status(landmarks.size(), TRACK_REJECTED);
+
   std::unique_ptr<C_Progress> my_progress_bar;
   if (bConsole_verbose_)
     my_progress_bar.reset(
       new C_Progress_display(
-        sfm_data.structure.size(),
+        landmarks.size(),
         std::cout,
         "Blind triangulation progress:\n" ));
 #ifdef OPENMVG_USE_OPENMP
   #pragma omp parallel
 #endif
-  for (auto& tracks_it :sfm_data.structure)
   {
+    TrackTriangulationBuffer buffer;
 #ifdef OPENMVG_USE_OPENMP
-  #pragma omp single nowait
+    #pragma omp for schedule(dynamic, kTriangulationChunkSize)
 #endif
+    for (int i = 0; i < static_cast<int>(landmarks.size()); ++i)
     {
       if (bConsole_verbose_)
       {
         ++(*my_progress_bar);
       }
-
-      const Observations & obs = tracks_it.second.obs;
-      bool bKeep = false;
-      {
-        // Generate the track 3D hypothesis
-        Vec3 X;
-        if (track_triangulation(sfm_data, obs, X))
-        {
-          // Keep the point only if it has a positive depth for all obs
-          if (track_check_predicate(obs, sfm_data, X, cheirality_predicate))
-          {
-            tracks_it.second.X = X;
-            bKeep = true;
-          }
-        }
-      }
-      if (!bKeep)
+      Landmark & landmark = *landmarks[i].second;
+      buffer.Fill(landmark.obs, views, view_to_index);
+      // Generate the track 3D hypothesis
+      Vec3 X;
+      if (BlindTriangulation(buffer, X))
       {
-#ifdef OPENMVG_USE_OPENMP
-        #pragma omp critical
-#endif
-        rejectedId.push_front(tracks_it.first);
+        landmark.X = X;
+        status[i] = TRACK_KEPT;
       }
     }
   }
   // Erase the unsuccessful triangulated tracks
-  for (auto& it : rejectedId)
-  {
-    sfm_data.structure.erase(it);
-  }
+  EraseRejectedLandmarks(landmarks, status, sfm_data.structure);
 }
 
 SfM_Data_Structure_Computation_Robust::SfM_Data_Structure_Computation_Robust
@@ -248,112 +343,39 @@ const
   robust_triangulation(sfm_data);
 }
 
-/// Robust triangulation of track data contained in the structure
-/// All observations must have View with valid Intrinsic and Pose data
-/// Invalid landmark are removed.
-void SfM_Data_Structure_Computation_Robust::robust_triangulation
+/// Robustly try to estimate the best 3D point of the observations stored in
+/// the buffer using a ransac scheme.
+/// The sampling only depends on the track (fixed seed), so the result does
+/// not depend on the thread that processes the track.
+/// On success, buffer.best_inliers lists the indexes of the inlier observations.
+static bool RobustTrackTriangulation
 (
-  SfM_Data & sfm_data
-)
-const
-{
-  std::deque<IndexT> rejectedId;
-  std::unique_ptr<C_Progress_display> my_progress_bar;
-  if (bConsole_verbose_)
-    my_progress_bar.reset(
-      new C_Progress_display(
-        sfm_data.structure.size(),
-        std::cout,
-        "Robust triangulation progress:\n" ));
-#ifdef OPENMVG_USE_OPENMP
-  #pragma omp parallel
-#endif
-  for (auto& tracks_it :sfm_data.structure)
-  {
-#ifdef OPENMVG_USE_OPENMP
-  #pragma omp single nowait
-#endif
-    {
-      if (bConsole_verbose_)
-      {
-        ++(*my_progress_bar);
-      }
-      Landmark landmark;
-      if (robust_triangulation(sfm_data, tracks_it.second.obs, landmark))
-      {
-        tracks_it.second = landmark;
-      }
-      else
-      {
-        // Track must be deleted
-#ifdef OPENMVG_USE_OPENMP
-        #pragma omp critical
-#endif
-        rejectedId.push_front(tracks_it.first);
-      }
-    }
-  }
-  // Erase the unsuccessful triangulated tracks
-  for (auto& it : rejectedId)
-  {
-    sfm_data.structure.erase(it);
-  }
-}
-
-Observations ObservationsSampler
-(
-  const Observations & obs,
-  const std::vector<std::uint32_t> & samples
+  TrackTriangulationBuffer & buffer,
+  const double squared_pixel_threshold,
+  const IndexT min_required_inliers,
+  const IndexT min_sample_index,
+  const ETriangulationMethod etri_method,
+  Vec3 & X
 )
 {
-  Observations sampled_obs;
-  for (const auto& idx : samples)
-  {
-    Observations::const_iterator obs_it = obs.cbegin();
-    std::advance(obs_it, idx);
-    sampled_obs.insert(*obs_it);
-  }
-  return sampled_obs;
-}
-
-/// Robustly try to estimate the best 3D point using a ransac scheme
-/// A point must be seen in at least min_required_inliers views
-/// Return true for a successful triangulation
-bool SfM_Data_Structure_Computation_Robust::robust_triangulation
-(
-  const SfM_Data & sfm_data,
-  const Observations & obs,
-  Landmark & landmark // X & valid observations
-)
-const
-{
-  if (obs.size() < min_required_inliers_ || obs.size() < min_sample_index_)
+  const std::size_t nb_obs = buffer.views.size();
+  buffer.best_inliers.clear();
+  if (nb_obs < min_required_inliers || nb_obs < min_sample_index)
   {
     return false;
   }
 
-  const double dSquared_pixel_threshold = Square(max_reprojection_error_);
-
-  // Predicate to validate a sample (cheirality and residual error)
-  ResidualAndCheiralityPredicate predicate(dSquared_pixel_threshold);
-  auto predicate_binding = std::bind(&ResidualAndCheiralityPredicate::predicate,
-                                     predicate,
-                                     std::placeholders::_1,
-                                     std::placeholders::_2,
-                                     std::placeholders::_3,
-                                     std::placeholders::_4);
-
   // Handle the case where all observations must be used
-  if (min_required_inliers_ == min_sample_index_ &&
-      obs.size() == min_required_inliers_)
+  if (min_required_inliers == min_sample_index &&
+      nb_obs == min_required_inliers)
   {
     // Generate the 3D point hypothesis by triangulating all the observations
-    Vec3 X;
-    if (track_triangulation(sfm_data, obs, X, etri_method_) &&
-        track_check_predicate(obs, sfm_data, X, predicate_binding))
+    buffer.samples.resize(nb_obs);
+    std::iota(buffer.samples.begin(), buffer.samples.end(), 0);
+    if (TriangulateObservations(buffer, buffer.samples.data(), nb_obs, etri_method, X) &&
+        CheckObservations(buffer, nullptr, nb_obs, X, true, squared_pixel_threshold))
     {
-      landmark.X = X;
-      landmark.obs = obs;
+      buffer.best_inliers = buffer.samples;
       return true;
     }
     return false;
@@ -362,11 +384,10 @@ const
   // else we perform a robust estimation since
   //  there is more observations than the minimal number of required sample.
 
-  const IndexT nbIter = obs.size() * 2; // TODO: automatic computation of the number of iterations?
+  const IndexT nbIter = nb_obs * 2; // TODO: automatic computation of the number of iterations?
 
   // - Ransac variables
   Vec3 best_model = Vec3::Zero();
-  std::deque<IndexT> best_inlier_set;
   double best_error = std::numeric_limits<double>::max();
 
   //--
@@ -376,64 +397,176 @@ const
   // - Ransac loop
   for (IndexT i = 0; i < nbIter; ++i)
   {
-    std::vector<uint32_t> samples;
-    robust::UniformSample(min_sample_index_, obs.size(), random_generator, &samples);
+    robust::UniformSample(min_sample_index, nb_obs, random_generator, &buffer.samples);
+    // Use the observation order (as a sampled Observations map would do)
+    std::sort(buffer.samples.begin(), buffer.samples.end());
 
-    Vec3 X;
+    Vec3 X_hypothesis;
     // Hypothesis generation
-    const auto minimal_sample = ObservationsSampler(obs, samples);
-
-    if (!track_triangulation(sfm_data, minimal_sample, X, etri_method_))
+    if (!TriangulateObservations(buffer, buffer.samples.data(), buffer.samples.size(),
+                                 etri_method, X_hypothesis))
       continue;
 
     // Test validity of the hypothesis
-    if (!track_check_predicate(minimal_sample, sfm_data, X, predicate_binding))
+    if (!CheckObservations(buffer, buffer.samples.data(), buffer.samples.size(),
+                           X_hypothesis, true, squared_pixel_threshold))
       continue;
 
-    std::deque<IndexT> inlier_set;
+    buffer.inliers.clear();
     double current_error = 0.0;
     // inlier/outlier classification according pixel residual errors.
-    for (const auto & obs_it : obs)
+    for (uint32_t j = 0; j < nb_obs; ++j)
     {
-      const View * view = sfm_data.views.at(obs_it.first).get();
-      if (!sfm_data.IsPoseAndIntrinsicDefined(view))
+      const TriangulationView * view = buffer.views[j];
+      if (!view)
         continue;
-      const IntrinsicBase & cam =  *sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
-      const Pose3 pose = sfm_data.GetPoseOrDie(view);
-      if (!CheiralityTest(cam(obs_it.second.x), pose, X))
+      if (!CheiralityTest(buffer.bearing_cheirality[j], view->pose, X_hypothesis))
         continue;
-      const double residual_sq = cam.residual(pose(X), obs_it.second.x).squaredNorm();
-      if (residual_sq < dSquared_pixel_threshold)
+      const double residual_sq =
+        view->cam->residual(view->pose(X_hypothesis), buffer.x[j]).squaredNorm();
+      if (residual_sq < squared_pixel_threshold)
       {
-        inlier_set.push_front(obs_it.first);
+        buffer.inliers.push_back(j);
         current_error += residual_sq;
       }
       else
       {
-        current_error += dSquared_pixel_threshold;
+        current_error += squared_pixel_threshold;
       }
     }
     // Does the hypothesis:
     // - is the best one we have seen so far.
     // - has sufficient inliers.
     if (current_error < best_error &&
-      inlier_set.size() >= min_required_inliers_)
+      buffer.inliers.size() >= min_required_inliers)
     {
-      best_model = X;
-      best_inlier_set = inlier_set;
+      best_model = X_hypothesis;
+      buffer.best_inliers.swap(buffer.inliers);
       best_error = current_error;
     }
   }
-  if (!best_inlier_set.empty() && best_inlier_set.size() >= min_required_inliers_)
+  X = best_model;
+  return !buffer.best_inliers.empty();
+}
+
+/// Keep the inlier observations of the buffer in the landmark
+static void KeepInlierObservations
+(
+  const TrackTriangulationBuffer & buffer,
+  const Observations & obs,
+  Observations & inlier_obs
+)
+{
+  Observations::const_iterator obs_it = obs.cbegin();
+  uint32_t obs_index = 0;
+  for (const uint32_t idx : buffer.best_inliers) // sorted indexes
+  {
+    std::advance(obs_it, idx - obs_index);
+    obs_index = idx;
+    inlier_obs.insert(inlier_obs.end(), *obs_it);
+  }
+}
+
+/// Robust triangulation of track data contained in the structure
+/// All observations must have View with valid Intrinsic and Pose data
+/// Invalid landmark are removed.
+void SfM_Data_Structure_Computation_Robust::robust_triangulation
+(
+  SfM_Data & sfm_data
+)
+const
+{
+  Hash_Map<IndexT, uint32_t> view_to_index;
+  const TriangulationViews views = ComputeTriangulationViews(sfm_data, view_to_index);
+  const auto landmarks = ListLandmarks(sfm_data.structure);
+  std::vector<uint8_t> status(landmarks.size(), TRACK_REJECTED);
+  const double dSquared_pixel_threshold = Square(max_reprojection_error_);
+
+  std::unique_ptr<C_Progress_display> my_progress_bar;
+  if (bConsole_verbose_)
+    my_progress_bar.reset(
+      new C_Progress_display(
+        landmarks.size(),
+        std::cout,
+        "Robust triangulation progress:\n" ));
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel
+#endif
   {
-    // Update information (3D landmark position & valid observations)
-    landmark.X = best_model;
-    for (const IndexT & val : best_inlier_set)
+    TrackTriangulationBuffer buffer;
+#ifdef OPENMVG_USE_OPENMP
+    #pragma omp for schedule(dynamic, kTriangulationChunkSize)
+#endif
+    for (int i = 0; i < static_cast<int>(landmarks.size()); ++i)
     {
-      landmark.obs[val] = obs.at(val);
+      if (bConsole_verbose_)
+      {
+        ++(*my_progress_bar);
+      }
+      // Each landmark is only accessed by the thread that processes it
+      Landmark & landmark = *landmarks[i].second;
+      buffer.Fill(landmark.obs, views, view_to_index);
+      Vec3 X;
+      if (RobustTrackTriangulation(buffer, dSquared_pixel_threshold,
+            min_required_inliers_, min_sample_index_, etri_method_, X))
+      {
+        Observations inlier_obs;
+        KeepInlierObservations(buffer, landmark.obs, inlier_obs);
+        landmark.X = X;
+        landmark.obs = std::move(inlier_obs);
+        status[i] = TRACK_KEPT;
+      }
     }
   }
-  return !best_inlier_set.empty();
+  // Erase the unsuccessful triangulated tracks
+  EraseRejectedLandmarks(landmarks, status, sfm_data.structure);
+}
+
+/// Robustly try to estimate the best 3D point using a ransac scheme
+/// A point must be seen in at least min_required_inliers views
+/// Return true for a successful triangulation
+bool SfM_Data_Structure_Computation_Robust::robust_triangulation
+(
+  const SfM_Data & sfm_data,
+  const Observations & obs,
+  Landmark & landmark // X & valid observations
+)
+const
+{
+  if (obs.size() < min_required_inliers_ || obs.size() < min_sample_index_)
+  {
+    return false;
+  }
+
+  // Only cache the views used by this track
+  Hash_Map<IndexT, uint32_t> view_to_index;
+  TriangulationViews views;
+  views.reserve(obs.size());
+  for (const auto & obs_it : obs)
+  {
+    const View * view = sfm_data.views.at(obs_it.first).get();
+    if (!sfm_data.IsPoseAndIntrinsicDefined(view))
+      continue;
+    TriangulationView data;
+    data.cam = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
+    data.pose = sfm_data.GetPoseOrDie(view);
+    data.P = data.pose.asMatrix();
+    view_to_index[obs_it.first] = static_cast<uint32_t>(views.size());
+    views.push_back(data);
+  }
+
+  TrackTriangulationBuffer buffer;
+  buffer.Fill(obs, views, view_to_index);
+  Vec3 X;
+  if (!RobustTrackTriangulation(buffer, Square(max_reprojection_error_),
+        min_required_inliers_, min_sample_index_, etri_method_, X))
+  {
+    return false;
+  }
+  // Update information (3D landmark position & valid observations)
+  landmark.X = X;
+  KeepInlierObservations(buffer, obs, landmark.obs);
+  return true;
 }
 
 } // namespace sfm
@@ -0,0 +1,216 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/sfm_landmark_dense.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace openMVG {
+namespace sfm {
+
+Dense_Landmarks::Dense_Landmarks(const Landmarks & landmarks)
+{
+  std::size_t observation_count = 0;
+  for (const auto & landmark_it : landmarks)
+    observation_count += landmark_it.second.obs.size();
+
+  ids_.reserve(landmarks.size());
+  X_.reserve(landmarks.size());
+  obs_offsets_.reserve(landmarks.size() + 1);
+  obs_view_ids_.reserve(observation_count);
+  obs_feat_ids_.reserve(observation_count);
+  obs_x_.reserve(observation_count);
+
+  for (const auto & landmark_it : landmarks)
+  {
+    ids_.push_back(landmark_it.first);
+    X_.push_back(landmark_it.second.X);
+    for (const auto & obs_it : landmark_it.second.obs)
+    {
+      obs_view_ids_.push_back(obs_it.first);
+      obs_feat_ids_.push_back(obs_it.second.id_feat);
+      obs_x_.push_back(obs_it.second.x);
+    }
+    obs_offsets_.push_back(obs_view_ids_.size());
+  }
+  BuildIdIndex();
+}
+
+void Dense_Landmarks::ToLandmarks(Landmarks & landmarks) const
+{
+  landmarks.clear();
+  for (IndexT slot = 0; slot < size(); ++slot)
+  {
+    Landmark & landmark = landmarks[ids_[slot]];
+    landmark.X = X_[slot];
+    for (std::size_t i = obs_begin(slot); i < obs_end(slot); ++i)
+      landmark.obs[obs_view_ids_[i]] = Observation(obs_x_[i], obs_feat_ids_[i]);
+  }
+}
+
+void Dense_Landmarks::UpdatePositions(Landmarks & landmarks) const
+{
+  IndexT slot = 0;
+  for (auto & landmark_it : landmarks)
+  {
+    // The slots usually follow the collection order (no id lookup)
+    if (slot >= size() || ids_[slot] != landmark_it.first)
+      slot = Slot(landmark_it.first);
+    if (slot == UndefinedIndexT)
+    {
+      slot = 0;
+      continue;
+    }
+    landmark_it.second.X = X_[slot];
+    ++slot;
+  }
+}
+
+void Dense_Landmarks::ReadPositions(const Landmarks & landmarks)
+{
+  IndexT slot = 0;
+  for (const auto & landmark_it : landmarks)
+  {
+    // The slots usually follow the collection order (no id lookup)
+    if (slot >= size() || ids_[slot] != landmark_it.first)
+      slot = Slot(landmark_it.first);
+    if (slot == UndefinedIndexT)
+    {
+      slot = 0;
+      continue;
+    }
+    X_[slot] = landmark_it.second.X;
+    ++slot;
+  }
+}
+
+IndexT Dense_Landmarks::Slot(const IndexT landmark_id) const
+{
+  const auto it = std::lower_bound(id_index_.cbegin(), id_index_.cend(),
+    std::make_pair(landmark_id, IndexT(0)));
+  if (it == id_index_.cend() || it->first != landmark_id)
+    return UndefinedIndexT;
+  return it->second;
+}
+
+std::size_t Dense_Landmarks::Filter
+(
+  const Mask & keep_observations,
+  const std::size_t min_track_length,
+  Landmarks * landmarks,
+  std::vector<IndexT> * removed_ids
+)
+{
+  Compact(nullptr, &keep_observations, min_track_length, landmarks, removed_ids);
+  // The remaining observations of the removed short tracks are not counted
+  return std::count(keep_observations.cbegin(), keep_observations.cend(), 0);
+}
+
+IndexT Dense_Landmarks::FilterLandmarks
+(
+  const Mask & keep_landmarks,
+  Landmarks * landmarks,
+  std::vector<IndexT> * removed_ids
+)
+{
+  const IndexT landmark_count_before = size();
+  Compact(&keep_landmarks, nullptr, 0, landmarks, removed_ids);
+  return landmark_count_before - size();
+}
+
+void Dense_Landmarks::Compact
+(
+  const Mask * keep_landmarks,
+  const Mask * keep_observations,
+  const std::size_t min_track_length,
+  Landmarks * landmarks,
+  std::vector<IndexT> * removed_ids
+)
+{
+  // The landmark collection is walked along the slots (same iteration order)
+  Landmarks::iterator landmark_it;
+  if (landmarks)
+    landmark_it = landmarks->begin();
+
+  const bool b_colors = HasColors();
+  IndexT slot_count = 0;
+  std::size_t obs_count = 0;
+  std::size_t slot_obs_begin = 0;
+  for (IndexT slot = 0; slot < size(); ++slot)
+  {
+    // Read the range before its offsets are overwritten
+    const std::size_t slot_obs_end = obs_offsets_[slot + 1];
+    const std::size_t first_obs = obs_count;
+    // The collection must iterate in the slot order (same container, only filtered
+    //  through the columns since they were built)
+    assert(!landmarks || (landmark_it != landmarks->end() && landmark_it->first == ids_[slot]));
+    if (!keep_landmarks || (*keep_landmarks)[slot])
+    {
+      Observations::iterator obs_it;
+      if (landmarks)
+        obs_it = landmark_it->second.obs.begin();
+      for (std::size_t i = slot_obs_begin; i < slot_obs_end; ++i)
+      {
+        assert(!landmarks || (obs_it != landmark_it->second.obs.end() && obs_it->first == obs_view_ids_[i]));
+        if (!keep_observations || (*keep_observations)[i])
+        {
+          obs_view_ids_[obs_count] = obs_view_ids_[i];
+          obs_feat_ids_[obs_count] = obs_feat_ids_[i];
+          obs_x_[obs_count] = obs_x_[i];
+          ++obs_count;
+          if (landmarks)
+            ++obs_it;
+        }
+        else if (landmarks)
+        {
+          obs_it = landmark_it->second.obs.erase(obs_it);
+        }
+      }
+    }
+    slot_obs_begin = slot_obs_end;
+
+    if ((keep_landmarks && !(*keep_landmarks)[slot])
+        || obs_count - first_obs < min_track_length)
+    {
+      // Remove the landmark and its remaining observations
+      obs_count = first_obs;
+      if (landmarks)
+        landmark_it = landmarks->erase(landmark_it);
+      if (removed_ids)
+        removed_ids->push_back(ids_[slot]);
+      continue;
+    }
+    ids_[slot_count] = ids_[slot];
+    X_[slot_count] = X_[slot];
+    if (b_colors)
+      colors_[slot_count] = colors_[slot];
+    obs_offsets_[slot_count + 1] = obs_count;
+    ++slot_count;
+    if (landmarks)
+      ++landmark_it;
+  }
+
+  ids_.resize(slot_count);
+  X_.resize(slot_count);
+  colors_.resize(b_colors ? slot_count : 0);
+  obs_offsets_.resize(slot_count + 1);
+  obs_view_ids_.resize(obs_count);
+  obs_feat_ids_.resize(obs_count);
+  obs_x_.resize(obs_count);
+  BuildIdIndex();
+}
+
+void Dense_Landmarks::BuildIdIndex()
+{
+  id_index_.resize(ids_.size());
+  for (IndexT slot = 0; slot < size(); ++slot)
+    id_index_[slot] = {ids_[slot], slot};
+  std::sort(id_index_.begin(), id_index_.end());
+}
+
+} // namespace sfm
+} // namespace openMVG
@@ -0,0 +1,159 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SFM_SFM_LANDMARK_DENSE_HPP
+#define OPENMVG_SFM_SFM_LANDMARK_DENSE_HPP
+
+#include "openMVG/numeric/eigen_alias_definition.hpp"
+#include "openMVG/sfm/sfm_landmark.hpp"
+#include "openMVG/types.hpp"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace openMVG {
+namespace sfm {
+
+/**
+* @brief Columnar (structure of arrays) copy of a landmark collection.
+*
+* Landmarks are stored in contiguous slots (in the iteration order of the
+*  source Landmarks container) and their observations are stored contiguously
+*  per slot:
+*  - ids, positions and RGB colors (optional) of the landmarks,
+*  - observation offsets: the observations of the slot s are the indexes
+*    [obs_begin(s), obs_end(s)),
+*  - view ids, feature ids and positions of the observations.
+*
+* The loops over the observations are linear memory walks (no hashing, no
+*  pointer chasing) and can be split among threads.
+*
+* Usage:
+* @code
+* const Dense_Landmarks landmarks(sfm_data.GetLandmarks());
+* for (IndexT slot = 0; slot < landmarks.size(); ++slot)
+*   for (std::size_t i = landmarks.obs_begin(slot); i < landmarks.obs_end(slot); ++i)
+*     // landmarks.X(slot), landmarks.obs_view_id(i), landmarks.obs_x(i) ...
+* @endcode
+*/
+class Dense_Landmarks
+{
+public:
+  using Color = Eigen::Matrix<unsigned char, 3, 1>;
+  /// Per slot or per observation flags (one byte per item, so they can be set from many threads)
+  using Mask = std::vector<unsigned char>;
+
+  Dense_Landmarks() = default;
+
+  /// Build the columns from a landmark collection
+  explicit Dense_Landmarks(const Landmarks & landmarks);
+
+  /// Export the columns as a landmark collection
+  void ToLandmarks(Landmarks & landmarks) const;
+
+  /// Copy the positions to the landmarks of the same id
+  void UpdatePositions(Landmarks & landmarks) const;
+
+  /// Copy the positions of the landmarks of the same id to the slots
+  /// (the landmarks were moved since the columns were built)
+  void ReadPositions(const Landmarks & landmarks);
+
+  /// Number of landmarks
+  IndexT size() const { return static_cast<IndexT>(ids_.size()); }
+  bool empty() const { return ids_.empty(); }
+
+  /// Number of observations (of all the landmarks)
+  std::size_t observation_count() const { return obs_view_ids_.size(); }
+
+  /// Slot of a landmark id (UndefinedIndexT if the id is not stored)
+  IndexT Slot(const IndexT landmark_id) const;
+
+  // Landmark columns
+  IndexT id(const IndexT slot) const { return ids_[slot]; }
+  Vec3 & X(const IndexT slot) { return X_[slot]; }
+  const Vec3 & X(const IndexT slot) const { return X_[slot]; }
+  const std::vector<Vec3> & positions() const { return X_; }
+
+  // Optional landmark colors
+  bool HasColors() const { return colors_.size() == X_.size() && !empty(); }
+  /// Allocate the color column (black colors)
+  void InitColors() { colors_.assign(X_.size(), Color::Zero()); }
+  Color & color(const IndexT slot) { return colors_[slot]; }
+  const Color & color(const IndexT slot) const { return colors_[slot]; }
+
+  // Observations of a slot
+  std::size_t obs_begin(const IndexT slot) const { return obs_offsets_[slot]; }
+  std::size_t obs_end(const IndexT slot) const { return obs_offsets_[slot + 1]; }
+  std::size_t track_length(const IndexT slot) const { return obs_end(slot) - obs_begin(slot); }
+
+  // Observation columns
+  IndexT obs_view_id(const std::size_t i) const { return obs_view_ids_[i]; }
+  IndexT obs_feat_id(const std::size_t i) const { return obs_feat_ids_[i]; }
+  const Vec2 & obs_x(const std::size_t i) const { return obs_x_[i]; }
+  const std::vector<IndexT> & obs_view_ids() const { return obs_view_ids_; }
+
+  /**
+  * @brief Keep only some observations and the landmarks that are long enough.
+  *  The remaining slots are compacted (their order is kept).
+  * @param keep_observations flag of each observation (observation indexes)
+  * @param min_track_length landmarks with less kept observations are removed
+  *   (0 keeps the landmarks without observation)
+  * @param[in,out] landmarks if set, the same removals are applied to this
+  *   collection (the one the columns are built from, only filtered since by
+  *   Filter or FilterLandmarks: its iteration order must match the slots)
+  * @param[out] removed_ids if set, the ids of the removed landmarks are appended
+  * @return the number of removed observations
+  */
+  std::size_t Filter
+  (
+    const Mask & keep_observations,
+    const std::size_t min_track_length,
+    Landmarks * landmarks = nullptr,
+    std::vector<IndexT> * removed_ids = nullptr
+  );
+
+  /**
+  * @brief Keep only some landmarks (see Filter).
+  * @param keep_landmarks flag of each slot
+  * @param[in,out] landmarks if set, the same removals are applied to this collection
+  * @param[out] removed_ids if set, the ids of the removed landmarks are appended
+  * @return the number of removed landmarks
+  */
+  IndexT FilterLandmarks
+  (
+    const Mask & keep_landmarks,
+    Landmarks * landmarks = nullptr,
+    std::vector<IndexT> * removed_ids = nullptr
+  );
+
+private:
+  // Compact the kept slots and observations (a null mask keeps everything)
+  void Compact
+  (
+    const Mask * keep_landmarks,
+    const Mask * keep_observations,
+    const std::size_t min_track_length,
+    Landmarks * landmarks,
+    std::vector<IndexT> * removed_ids
+  );
+  void BuildIdIndex();
+
+  std::vector<IndexT> ids_;
+  std::vector<Vec3> X_;
+  std::vector<Color> colors_;
+  std::vector<std::size_t> obs_offsets_ = {0};
+  std::vector<IndexT> obs_view_ids_;
+  std::vector<IndexT> obs_feat_ids_;
+  std::vector<Vec2> obs_x_;
+  // (landmark id, slot) sorted by id
+  std::vector<std::pair<IndexT, IndexT>> id_index_;
+};
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SFM_SFM_LANDMARK_DENSE_HPP
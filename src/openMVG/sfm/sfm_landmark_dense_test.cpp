@@ -0,0 +1,167 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/sfm/sfm_landmark_dense.hpp"
+
+#include "CppUnitLite/TestHarness.h"
+#include "testing/testing.h"
+
+#include <algorithm>
+
+using namespace openMVG;
+using namespace openMVG::sfm;
+
+// Landmark i has i observations (view ids 0...i-1)
+Landmarks create_test_landmarks(IndexT landmark_count)
+{
+  Landmarks landmarks;
+  for (IndexT i = 0; i < landmark_count; ++i)
+  {
+    Landmark & landmark = landmarks[10 * i];
+    landmark.X = Vec3(i, 2 * i, 3 * i);
+    for (IndexT j = 0; j < i; ++j)
+      landmark.obs[j] = Observation(Vec2(i, j), 100 * i + j);
+  }
+  return landmarks;
+}
+
+bool same_landmarks(const Landmarks & a, const Landmarks & b)
+{
+  if (a.size() != b.size())
+    return false;
+  for (const auto & landmark_it : a)
+  {
+    const auto it = b.find(landmark_it.first);
+    if (it == b.end()
+        || landmark_it.second.X != it->second.X
+        || landmark_it.second.obs.size() != it->second.obs.size())
+      return false;
+    for (const auto & obs_it : landmark_it.second.obs)
+    {
+      const auto obs = it->second.obs.find(obs_it.first);
+      if (obs == it->second.obs.end()
+          || obs->second.x != obs_it.second.x
+          || obs->second.id_feat != obs_it.second.id_feat)
+        return false;
+    }
+  }
+  return true;
+}
+
+TEST(Dense_Landmarks, Columns)
+{
+  const Landmarks landmarks = create_test_landmarks(5);
+  const Dense_Landmarks dense(landmarks);
+
+  EXPECT_EQ(5, dense.size());
+  EXPECT_EQ(10, dense.observation_count());
+  EXPECT_FALSE(dense.HasColors());
+  for (const auto & landmark_it : landmarks)
+  {
+    const IndexT slot = dense.Slot(landmark_it.first);
+    EXPECT_TRUE(slot != UndefinedIndexT);
+    EXPECT_EQ(landmark_it.first, dense.id(slot));
+    EXPECT_MATRIX_EQ(landmark_it.second.X, dense.X(slot));
+    EXPECT_EQ(landmark_it.second.obs.size(), dense.track_length(slot));
+    for (std::size_t i = dense.obs_begin(slot); i < dense.obs_end(slot); ++i)
+    {
+      const Observation & obs = landmark_it.second.obs.at(dense.obs_view_id(i));
+      EXPECT_MATRIX_EQ(obs.x, dense.obs_x(i));
+      EXPECT_EQ(obs.id_feat, dense.obs_feat_id(i));
+    }
+  }
+  EXPECT_EQ(UndefinedIndexT, dense.Slot(5));
+
+  // Round trip
+  Landmarks landmarks_back;
+  dense.ToLandmarks(landmarks_back);
+  EXPECT_TRUE(same_landmarks(landmarks, landmarks_back));
+}
+
+TEST(Dense_Landmarks, FilterLandmarks)
+{
+  Landmarks landmarks = create_test_landmarks(4);
+  Dense_Landmarks dense(landmarks);
+  Dense_Landmarks::Mask keep(dense.size(), 1);
+  keep[dense.Slot(0)] = 0;
+  keep[dense.Slot(20)] = 0;
+  std::vector<IndexT> removed_ids;
+  EXPECT_EQ(2, dense.FilterLandmarks(keep, &landmarks, &removed_ids));
+  std::sort(removed_ids.begin(), removed_ids.end());
+  EXPECT_EQ(2, removed_ids.size());
+  EXPECT_EQ(0, removed_ids[0]);
+  EXPECT_EQ(20, removed_ids[1]);
+  EXPECT_EQ(2, dense.size());
+  EXPECT_EQ(4, dense.observation_count());
+  EXPECT_EQ(0, dense.Slot(10));
+  EXPECT_EQ(1, dense.Slot(30));
+  EXPECT_EQ(2, landmarks.size());
+  EXPECT_EQ(1, landmarks.count(10));
+  EXPECT_EQ(1, landmarks.count(30));
+}
+
+TEST(Dense_Landmarks, Filter)
+{
+  Landmarks landmarks = create_test_landmarks(6);
+  Dense_Landmarks dense(landmarks);
+  dense.InitColors();
+  for (IndexT slot = 0; slot < dense.size(); ++slot)
+    dense.color(slot).setConstant(dense.id(slot));
+
+  // Remove the observations of the view 0, and the tracks shorter than 2
+  Dense_Landmarks::Mask keep(dense.observation_count());
+  for (std::size_t i = 0; i < keep.size(); ++i)
+    keep[i] = dense.obs_view_id(i) != 0;
+  EXPECT_EQ(5, dense.Filter(keep, 2, &landmarks));
+
+  // Landmarks 30, 40 & 50 remain (2, 3 & 4 observations)
+  EXPECT_EQ(3, dense.size());
+  EXPECT_EQ(9, dense.observation_count());
+  EXPECT_EQ(3, landmarks.size());
+  EXPECT_TRUE(dense.HasColors());
+  EXPECT_EQ(UndefinedIndexT, dense.Slot(20));
+  for (const IndexT id : {30, 40, 50})
+  {
+    const IndexT slot = dense.Slot(id);
+    EXPECT_TRUE(slot != UndefinedIndexT);
+    EXPECT_EQ(id, dense.color(slot)(0));
+    EXPECT_EQ(landmarks.at(id).obs.size(), dense.track_length(slot));
+    EXPECT_EQ(0, landmarks.at(id).obs.count(0));
+  }
+
+  // The filtered columns and the filtered collection match
+  Landmarks landmarks_back;
+  dense.ToLandmarks(landmarks_back);
+  EXPECT_TRUE(same_landmarks(landmarks, landmarks_back));
+
+  // Positions update
+  Dense_Landmarks moved(landmarks);
+  moved.X(moved.Slot(40)) = Vec3(-1, -1, -1);
+  moved.UpdatePositions(landmarks);
+  EXPECT_MATRIX_EQ(Vec3(-1, -1, -1), landmarks.at(40).X);
+  EXPECT_MATRIX_EQ(Vec3(3, 6, 9), landmarks.at(30).X);
+
+  // Positions read back from the collection
+  landmarks.at(50).X = Vec3(2, 2, 2);
+  moved.ReadPositions(landmarks);
+  EXPECT_MATRIX_EQ(Vec3(2, 2, 2), moved.X(moved.Slot(50)));
+  EXPECT_MATRIX_EQ(Vec3(-1, -1, -1), moved.X(moved.Slot(40)));
+}
+
+TEST(Dense_Landmarks, Empty)
+{
+  Dense_Landmarks dense((Landmarks()));
+  EXPECT_TRUE(dense.empty());
+  EXPECT_EQ(0, dense.observation_count());
+  EXPECT_EQ(0, dense.Filter({}, 2));
+  Landmarks landmarks;
+  dense.ToLandmarks(landmarks);
+  EXPECT_TRUE(landmarks.empty());
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
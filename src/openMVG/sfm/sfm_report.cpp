@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_landmark_dense.hpp"
 
 #include "third_party/histogram/histogram.hpp"
 #include "third_party/htmlDoc/htmlDoc.hpp"
@@ -32,22 +33,35 @@ bool Generate_SfM_Report
   // Computes:
   // - Statistics per view (mean, max, median residual values)
   // - Global tracks length statistic (length occurence)
-  IndexT residualCount = 0;
-  Hash_Map<IndexT, std::vector<double>> residuals_per_view;
-  std::map<IndexT, IndexT> track_length_occurences;
-  for ( const auto & iterTracks : sfm_data.GetLandmarks() )
+  const Dense_Landmarks landmarks(sfm_data.GetLandmarks());
+  // Absolute residual of each observation
+  std::vector<Vec2> residuals_per_observation(landmarks.observation_count());
+#ifdef OPENMVG_USE_OPENMP
+  #pragma omp parallel for schedule(dynamic, 256)
+#endif
+  for (int slot = 0; slot < static_cast<int>(landmarks.size()); ++slot)
   {
-    const Observations & obs = iterTracks.second.obs;
-    track_length_occurences[obs.size()] += 1;
-    for ( const auto & itObs : obs )
+    for (std::size_t i = landmarks.obs_begin(slot); i < landmarks.obs_end(slot); ++i)
     {
-      const View * view = sfm_data.GetViews().at(itObs.first).get();
+      const View * view = sfm_data.GetViews().at(landmarks.obs_view_id(i)).get();
       const geometry::Pose3 pose = sfm_data.GetPoseOrDie(view);
       const cameras::IntrinsicBase * intrinsic = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
       // Use absolute values
-      const Vec2 residual = intrinsic->residual(pose(iterTracks.second.X), itObs.second.x).array().abs();
-      residuals_per_view[itObs.first].push_back(residual(0));
-      residuals_per_view[itObs.first].push_back(residual(1));
+      residuals_per_observation[i] = intrinsic->residual(pose(landmarks.X(slot)), landmarks.obs_x(i)).array().abs();
+    }
+  }
+
+  IndexT residualCount = 0;
+  Hash_Map<IndexT, std::vector<double>> residuals_per_view;
+  std::map<IndexT, IndexT> track_length_occurences;
+  for (IndexT slot = 0; slot < landmarks.size(); ++slot)
+  {
+    track_length_occurences[landmarks.track_length(slot)] += 1;
+    for (std::size_t i = landmarks.obs_begin(slot); i < landmarks.obs_end(slot); ++i)
+    {
+      std::vector<double> & residuals = residuals_per_view[landmarks.obs_view_id(i)];
+      residuals.push_back(residuals_per_observation[i](0));
+      residuals.push_back(residuals_per_observation[i](1));
       ++residualCount;
     }
   }
@@ -0,0 +1,61 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SYSTEM_MAPPED_FILE_HPP
+#define OPENMVG_SYSTEM_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace openMVG
+{
+namespace system
+{
+
+/**
+* @brief Read-only memory mapping of a whole file.
+*  The file content is paged in by the OS on access, so large files can be
+*  streamed without reading them entirely.
+*/
+class MappedFile
+{
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile & operator=(const MappedFile &) = delete;
+
+  /**
+  * @brief Map a file (the previous mapping is released)
+  * @return true if the file is mapped (an empty file cannot be mapped)
+  */
+  bool Open(const std::string & filename);
+
+  /// Release the mapping
+  void Close();
+
+  bool IsOpen() const { return data_ != nullptr; }
+
+  /// Beginning of the mapped content
+  const char * data() const { return data_; }
+
+  /// Size of the mapped content in bytes
+  std::size_t size() const { return size_; }
+
+private:
+  const char * data_ = nullptr;
+  std::size_t size_ = 0;
+#if defined _WIN32
+  void * file_handle_ = nullptr;
+  void * mapping_handle_ = nullptr;
+#endif
+};
+
+} // namespace system
+} // namespace openMVG
+
+#endif // OPENMVG_SYSTEM_MAPPED_FILE_HPP
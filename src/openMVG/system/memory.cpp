@@ -0,0 +1,82 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2020 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/system/memory.hpp"
+
+#if defined _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+  #define PSAPI_VERSION 2
+  #include <psapi.h>
+#elif defined __APPLE__
+  #include <mach/mach.h>
+  #include <sys/resource.h>
+#elif defined __linux__
+  #include <sys/resource.h>
+  #include <unistd.h>
+  #include <cstdio>
+#endif
+
+namespace openMVG {
+namespace system {
+
+std::size_t CurrentResidentMemory()
+{
+#if defined _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return counters.WorkingSetSize;
+  return 0;
+#elif defined __APPLE__
+  mach_task_basic_info info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS)
+    return info.resident_size;
+  return 0;
+#elif defined __linux__
+  // statm second field is the number of resident pages
+  std::FILE * file = std::fopen("/proc/self/statm", "r");
+  if (!file)
+    return 0;
+  long pages_total = 0, pages_resident = 0;
+  const int n_read = std::fscanf(file, "%ld %ld", &pages_total, &pages_resident);
+  std::fclose(file);
+  if (n_read != 2)
+    return 0;
+  return static_cast<std::size_t>(pages_resident) * sysconf(_SC_PAGESIZE);
+#else
+  return 0;
+#endif
+}
+
+std::size_t PeakResidentMemory()
+{
+#if defined _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return counters.PeakWorkingSetSize;
+  return 0;
+#elif defined __APPLE__ || defined __linux__
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined __APPLE__
+  return static_cast<std::size_t>(usage.ru_maxrss); // bytes
+#else
+  return static_cast<std::size_t>(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#else
+  return 0;
+#endif
+}
+
+} // namespace system
+} // namespace openMVG
@@ -0,0 +1,42 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// Copyright (c) 2020 Pierre MOULON.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SYSTEM_MEMORY_HPP
+#define OPENMVG_SYSTEM_MEMORY_HPP
+
+#include <cstddef>
+
+namespace openMVG
+{
+namespace system
+{
+
+/**
+* @brief Get the current resident memory (RSS) used by the process.
+* @return Memory in bytes, 0 if the information is not available on this platform
+*/
+std::size_t CurrentResidentMemory();
+
+/**
+* @brief Get the peak resident memory used by the process since its start.
+* @return Memory in bytes, 0 if the information is not available on this platform
+*/
+std::size_t PeakResidentMemory();
+
+/**
+* @brief Convert a memory amount expressed in bytes to MiB.
+*/
+inline double BytesToMiB(const std::size_t bytes)
+{
+  return bytes / (1024.0 * 1024.0);
+}
+
+} // namespace system
+} // namespace openMVG
+
+#endif // OPENMVG_SYSTEM_MEMORY_HPP
@@ -0,0 +1,229 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SYSTEM_PIPELINE_HPP
+#define OPENMVG_SYSTEM_PIPELINE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace openMVG {
+namespace system {
+
+/// Blocking FIFO queue shared by several producer and consumer threads.
+/// Once closed, Pop returns false when the queue is empty.
+template <typename T>
+class BlockingQueue
+{
+public:
+  void Push(T value)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      values_.push_back(std::move(value));
+    }
+    condition_.notify_one();
+  }
+
+  /// Wait for a value (return false if the queue is closed and empty)
+  bool Pop(T & value)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this] { return !values_.empty() || closed_; });
+    if (values_.empty())
+      return false;
+    value = std::move(values_.front());
+    values_.pop_front();
+    return true;
+  }
+
+  void Close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    condition_.notify_all();
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<T> values_;
+  bool closed_ = false;
+};
+
+/// Degree of parallelism of the pipeline stages and number of buffers
+struct Pipeline_Options
+{
+  unsigned int decoders = 1;
+  unsigned int transformers = 1;
+  unsigned int encoders = 1;
+  // Number of decoded (resp. transformed) buffers: it bounds the number of
+  //  items in flight, so the memory usage. 0 means one per thread of the
+  //  producer and consumer stages (plus one).
+  unsigned int buffers = 0;
+};
+
+/**
+* @brief Three stage pipeline (i.e. read -> process -> write images):
+*  the items [0, count) are decoded by a pool of decoder threads, transformed
+*  by a pool of transform threads and encoded by a pool of encoder threads.
+*  The stages overlap: an item is transformed while the next ones are decoded
+*  and the previous ones are encoded.
+*  The Decoded and Transformed buffers are allocated once and recycled, so the
+*  memory usage is bounded by the number of buffers (items in flight).
+*  A stage functor returns false if it fails: the item is dropped and the
+*  processing of the other items goes on. Exceptions are considered as failures.
+*
+* Functor signatures:
+*  - bool decode(std::size_t item, Decoded & decoded)
+*  - bool transform(std::size_t item, Decoded & decoded, Transformed & transformed)
+*  - bool encode(std::size_t item, Transformed & transformed)
+*/
+template <typename Decoded, typename Transformed>
+class Pipeline
+{
+public:
+  using Decode_Functor = std::function<bool(std::size_t, Decoded &)>;
+  using Transform_Functor = std::function<bool(std::size_t, Decoded &, Transformed &)>;
+  using Encode_Functor = std::function<bool(std::size_t, Transformed &)>;
+
+  explicit Pipeline(const Pipeline_Options & options = Pipeline_Options())
+    : options_(options)
+  {
+    options_.decoders = std::max(1u, options_.decoders);
+    options_.transformers = std::max(1u, options_.transformers);
+    options_.encoders = std::max(1u, options_.encoders);
+  }
+
+  /// Process the items [0, count), return the number of items that went through
+  ///  the three stages successfully
+  std::size_t Run
+  (
+    const std::size_t count,
+    const Decode_Functor & decode,
+    const Transform_Functor & transform,
+    const Encode_Functor & encode
+  )
+  {
+    // Recycled buffers
+    const unsigned int nb_decoded_buffers = options_.buffers > 0 ?
+      options_.buffers : options_.decoders + options_.transformers + 1;
+    const unsigned int nb_transformed_buffers = options_.buffers > 0 ?
+      options_.buffers : options_.transformers + options_.encoders + 1;
+    std::vector<std::unique_ptr<Decoded>> decoded_buffers(nb_decoded_buffers);
+    std::vector<std::unique_ptr<Transformed>> transformed_buffers(nb_transformed_buffers);
+    BlockingQueue<Decoded *> free_decoded;
+    BlockingQueue<Transformed *> free_transformed;
+    for (auto & buffer : decoded_buffers)
+    {
+      buffer.reset(new Decoded);
+      free_decoded.Push(buffer.get());
+    }
+    for (auto & buffer : transformed_buffers)
+    {
+      buffer.reset(new Transformed);
+      free_transformed.Push(buffer.get());
+    }
+
+    // Queues between the stages
+    BlockingQueue<std::pair<std::size_t, Decoded *>> decoded_queue;
+    BlockingQueue<std::pair<std::size_t, Transformed *>> transformed_queue;
+
+    std::atomic<std::size_t> next_item(0), succeeded(0);
+    std::atomic<unsigned int> running_decoders(options_.decoders);
+    std::atomic<unsigned int> running_transformers(options_.transformers);
+
+    const auto decoder = [&]
+    {
+      for (std::size_t item = next_item++; item < count; item = next_item++)
+      {
+        Decoded * buffer = nullptr;
+        free_decoded.Pop(buffer);
+        if (Call([&] { return decode(item, *buffer); }))
+          decoded_queue.Push({item, buffer});
+        else
+          free_decoded.Push(buffer);
+      }
+      if (--running_decoders == 0)
+        decoded_queue.Close();
+    };
+
+    const auto transformer = [&]
+    {
+      std::pair<std::size_t, Decoded *> decoded;
+      while (decoded_queue.Pop(decoded))
+      {
+        Transformed * buffer = nullptr;
+        free_transformed.Pop(buffer);
+        const bool b_transformed =
+          Call([&] { return transform(decoded.first, *decoded.second, *buffer); });
+        free_decoded.Push(decoded.second);
+        if (b_transformed)
+          transformed_queue.Push({decoded.first, buffer});
+        else
+          free_transformed.Push(buffer);
+      }
+      if (--running_transformers == 0)
+        transformed_queue.Close();
+    };
+
+    const auto encoder = [&]
+    {
+      std::pair<std::size_t, Transformed *> transformed;
+      while (transformed_queue.Pop(transformed))
+      {
+        if (Call([&] { return encode(transformed.first, *transformed.second); }))
+          ++succeeded;
+        free_transformed.Push(transformed.second);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < options_.decoders; ++i)
+      threads.emplace_back(decoder);
+    for (unsigned int i = 0; i < options_.transformers; ++i)
+      threads.emplace_back(transformer);
+    for (unsigned int i = 0; i < options_.encoders; ++i)
+      threads.emplace_back(encoder);
+    for (auto & thread : threads)
+      thread.join();
+
+    return succeeded;
+  }
+
+private:
+  template <typename Functor>
+  static bool Call(const Functor & functor)
+  {
+    try
+    {
+      return functor();
+    }
+    catch (const std::exception &)
+    {
+      return false;
+    }
+  }
+
+  Pipeline_Options options_;
+};
+
+} // namespace system
+} // namespace openMVG
+
+#endif // OPENMVG_SYSTEM_PIPELINE_HPP
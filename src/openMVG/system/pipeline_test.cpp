@@ -0,0 +1,102 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/system/pipeline.hpp"
+
+#include "testing/testing.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace openMVG::system;
+
+TEST(Pipeline, Process_All_Items) {
+
+  Pipeline_Options options;
+  options.decoders = 3;
+  options.transformers = 2;
+  options.encoders = 2;
+  options.buffers = 4;
+
+  const std::size_t count = 1000;
+  std::vector<int> results(count, -1);
+  std::atomic<int> in_flight(0), max_in_flight(0);
+
+  Pipeline<std::vector<int>, int> pipeline(options);
+  const std::size_t succeeded = pipeline.Run(count,
+    [&](std::size_t item, std::vector<int> & decoded)
+    {
+      const int current = ++in_flight;
+      int previous_max = max_in_flight;
+      while (current > previous_max && !max_in_flight.compare_exchange_weak(previous_max, current));
+      decoded.assign(3, static_cast<int>(item));
+      return true;
+    },
+    [&](std::size_t, std::vector<int> & decoded, int & transformed)
+    {
+      transformed = decoded[0] + decoded[1] + decoded[2];
+      --in_flight;
+      return true;
+    },
+    [&](std::size_t item, int & transformed)
+    {
+      results[item] = transformed;
+      return true;
+    });
+
+  EXPECT_EQ(count, succeeded);
+  for (std::size_t i = 0; i < count; ++i)
+    EXPECT_EQ(3 * static_cast<int>(i), results[i]);
+  // The number of decoded items in flight is bounded by the number of buffers
+  EXPECT_TRUE(max_in_flight <= 4);
+}
+
+TEST(Pipeline, Failures) {
+
+  const std::size_t count = 100;
+  std::vector<int> results(count, -1);
+
+  Pipeline<int, int> pipeline;
+  const std::size_t succeeded = pipeline.Run(count,
+    [&](std::size_t item, int & decoded)
+    {
+      decoded = static_cast<int>(item);
+      return item % 10 != 1;
+    },
+    [&](std::size_t item, int & decoded, int & transformed)
+    {
+      if (item % 10 == 2)
+        throw std::runtime_error("transform failure");
+      transformed = decoded;
+      return true;
+    },
+    [&](std::size_t item, int & transformed)
+    {
+      results[item] = transformed;
+      return item % 10 != 3;
+    });
+
+  EXPECT_EQ(count - 30, succeeded);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const int expected = (i % 10 == 1 || i % 10 == 2) ? -1 : static_cast<int>(i);
+    EXPECT_EQ(expected, results[i]);
+  }
+}
+
+TEST(Pipeline, No_Item) {
+
+  Pipeline<int, int> pipeline;
+  EXPECT_EQ(0, pipeline.Run(0,
+    [](std::size_t, int &) { return true; },
+    [](std::size_t, int &, int &) { return true; },
+    [](std::size_t, int &) { return true; }));
+}
+
+/* ************************************************************************* */
+int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
+/* ************************************************************************* */
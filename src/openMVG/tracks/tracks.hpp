@@ -296,6 +296,113 @@ public:
   }
 };
 
+// This helper maintains incrementally, for a set of views, the number of their
+//  tracks that are "active" (i.e. tracks already triangulated in a SfM scene).
+// The owner of the active tracks reports each track activation/deactivation.
+// The views are kept ranked by decreasing number of active tracks, so the best
+//  candidate views are available without recomputing the intersection of the
+//  view tracks with the active tracks.
+struct ActiveTrackCountPerView
+{
+  // Ranking order: decreasing active track count, then increasing view id
+  struct CountDescending
+  {
+    bool operator()
+    (
+      const std::pair<uint32_t, uint32_t> & a,
+      const std::pair<uint32_t, uint32_t> & b
+    ) const
+    {
+      return (a.first > b.first) || (a.first == b.first && a.second < b.second);
+    }
+  };
+  // {active track count, view id}
+  using RankedViews = std::set<std::pair<uint32_t, uint32_t>, CountDescending>;
+
+private:
+  const STLMAPTracks & tracks_;
+  std::set<uint32_t> active_track_ids_;
+  std::map<uint32_t, uint32_t> count_per_view_;
+  RankedViews ranked_views_;
+
+  void UpdateViewCount(const uint32_t view_id, const bool increment)
+  {
+    auto count_it = count_per_view_.find(view_id);
+    if (count_it == count_per_view_.end())
+      return; // The view is not (or no longer) considered
+    ranked_views_.erase({count_it->second, view_id});
+    if (increment)
+      ++count_it->second;
+    else
+      --count_it->second;
+    ranked_views_.insert({count_it->second, view_id});
+  }
+
+public:
+
+  ActiveTrackCountPerView
+  (
+    const STLMAPTracks & tracks,
+    const std::set<uint32_t> & view_ids
+  ): tracks_(tracks)
+  {
+    for (const uint32_t view_id : view_ids)
+    {
+      count_per_view_[view_id] = 0;
+      ranked_views_.insert({0, view_id});
+    }
+  }
+
+  /// Mark a track as active (return false if it was already active)
+  bool ActivateTrack(const uint32_t track_id)
+  {
+    const auto track_it = tracks_.find(track_id);
+    if (track_it == tracks_.end() || !active_track_ids_.insert(track_id).second)
+      return false;
+    for (const auto & track_obs_it : track_it->second)
+      UpdateViewCount(track_obs_it.first, true);
+    return true;
+  }
+
+  /// Mark a track as inactive (return false if it was not active)
+  bool DeactivateTrack(const uint32_t track_id)
+  {
+    if (active_track_ids_.erase(track_id) == 0)
+      return false;
+    for (const auto & track_obs_it : tracks_.at(track_id))
+      UpdateViewCount(track_obs_it.first, false);
+    return true;
+  }
+
+  /// Stop considering a view
+  void RemoveView(const uint32_t view_id)
+  {
+    const auto count_it = count_per_view_.find(view_id);
+    if (count_it == count_per_view_.end())
+      return;
+    ranked_views_.erase({count_it->second, view_id});
+    count_per_view_.erase(count_it);
+  }
+
+  /// Number of active tracks seen by a view
+  uint32_t Count(const uint32_t view_id) const
+  {
+    const auto count_it = count_per_view_.find(view_id);
+    return (count_it != count_per_view_.end()) ? count_it->second : 0;
+  }
+
+  /// Return the considered views sorted by decreasing active track count
+  const RankedViews & RankedViewsByCount() const
+  {
+    return ranked_views_;
+  }
+
+  std::size_t NbActiveTracks() const
+  {
+    return active_track_ids_.size();
+  }
+};
+
 struct TracksUtilsMap
 {
   /**
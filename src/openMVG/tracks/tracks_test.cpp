@@ -211,6 +211,54 @@ TEST(Tracks, TracksInImages) {
   }
 }
 
+TEST(Tracks, ActiveTrackCountPerView) {
+
+  const STLMAPTracks tracks_in =
+  {
+    {0, {{0,0},{1,1}}}, // Track Id 0: with image observations in view 0 and 1
+    {1, {{0,0},{1,1}}}, // Track Id 1: with image observations in view 0 and 1
+    {2, {{0,0},{2,2}}}, // Track Id 2: with image observations in view 0 and 2
+    {3, {{0,0},{1,1}}}  // Track Id 3: with image observations in view 0 and 1
+  };
+
+  // Consider only the view 1 and 2
+  ActiveTrackCountPerView track_counter(tracks_in, {1, 2});
+  EXPECT_EQ(0, track_counter.Count(1));
+  EXPECT_EQ(0, track_counter.Count(2));
+  EXPECT_EQ(2, track_counter.RankedViewsByCount().size());
+
+  // Activate some tracks
+  EXPECT_TRUE(track_counter.ActivateTrack(0));
+  EXPECT_FALSE(track_counter.ActivateTrack(0)); // Already active
+  EXPECT_TRUE(track_counter.ActivateTrack(2));
+  EXPECT_FALSE(track_counter.ActivateTrack(99)); // Unknown track
+  EXPECT_EQ(1, track_counter.Count(1));
+  EXPECT_EQ(1, track_counter.Count(2));
+  EXPECT_EQ(0, track_counter.Count(0)); // view 0 is not considered
+  // In case of equality the views are ranked by increasing view id
+  EXPECT_EQ(1, track_counter.RankedViewsByCount().begin()->second);
+
+  // Change the active tracks: {0, 2} => {1, 2, 3}
+  EXPECT_TRUE(track_counter.DeactivateTrack(0));
+  EXPECT_TRUE(track_counter.ActivateTrack(1));
+  EXPECT_TRUE(track_counter.ActivateTrack(3));
+  EXPECT_EQ(3, track_counter.NbActiveTracks());
+  EXPECT_EQ(2, track_counter.Count(1));
+  EXPECT_EQ(1, track_counter.Count(2));
+  EXPECT_EQ(1, track_counter.RankedViewsByCount().begin()->second);
+  EXPECT_EQ(2, track_counter.RankedViewsByCount().begin()->first);
+
+  // Remove a view
+  track_counter.RemoveView(1);
+  EXPECT_EQ(0, track_counter.Count(1));
+  EXPECT_EQ(1, track_counter.RankedViewsByCount().size());
+  EXPECT_EQ(2, track_counter.RankedViewsByCount().begin()->second);
+
+  EXPECT_TRUE(track_counter.DeactivateTrack(2));
+  EXPECT_FALSE(track_counter.DeactivateTrack(2));
+  EXPECT_EQ(0, track_counter.Count(2));
+}
+
 /* ************************************************************************* */
 int main() { TestResult tr; return TestRegistry::runAllTests(tr);}
 /* ************************************************************************* */
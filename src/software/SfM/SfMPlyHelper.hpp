@@ -9,10 +9,9 @@
 #ifndef OPENMVG_SFM_PLY_HELPER_H
 #define OPENMVG_SFM_PLY_HELPER_H
 
+#include "openMVG/geometry/ply_point_cloud.hpp"
 #include "openMVG/numeric/numeric.h"
 
-#include <fstream>
-#include <iomanip>
 #include <string>
 #include <vector>
 
@@ -28,34 +27,12 @@ exportToPly
   const std::string & sFileName
 )
 {
-  std::ofstream outfile(sFileName.c_str());
-  if (!outfile.is_open())
+  geometry::Ply_Point_Writer writer;
+  if (!writer.Open(sFileName, vec_points.size()))
     return false;
 
-  outfile << "ply"
-    << std::endl << "format ascii 1.0"
-    << std::endl << "element vertex " << vec_points.size()
-    << std::endl << "property double x"
-    << std::endl << "property double y"
-    << std::endl << "property double z"
-    << std::endl << "property uchar red"
-    << std::endl << "property uchar green"
-    << std::endl << "property uchar blue"
-    << std::endl << "end_header" << std::endl;
-
-  outfile << std::fixed << std::setprecision (std::numeric_limits<double>::digits10 + 1);
-
-  for (size_t i=0; i < vec_points.size(); ++i)
-  {
-    outfile
-      << vec_points[i](0) << ' '
-      << vec_points[i](1) << ' '
-      << vec_points[i](2) << ' '
-      << "255 255 255" << "\n";
-  }
-  const bool bOk = outfile.good();
-  outfile.close();
-  return bOk;
+  const bool bOk = writer.Write(vec_points);
+  return writer.Close() && bOk;
 }
 
 /// Export 3D point vector and camera position to PLY format
@@ -67,52 +44,15 @@ inline bool exportToPly
   const std::vector<Vec3> * vec_coloredPoints = nullptr
 )
 {
-  std::ofstream outfile(sFileName.c_str());
-  if (!outfile.is_open())
+  geometry::Ply_Point_Writer writer;
+  if (!writer.Open(sFileName, vec_points.size()+vec_camPos.size()))
     return false;
 
-  outfile << "ply"
-    << '\n' << "format ascii 1.0"
-    << '\n' << "element vertex " << vec_points.size()+vec_camPos.size()
-    << '\n' << "property double x"
-    << '\n' << "property double y"
-    << '\n' << "property double z"
-    << '\n' << "property uchar red"
-    << '\n' << "property uchar green"
-    << '\n' << "property uchar blue"
-    << '\n' << "end_header" << std::endl;
-
-  outfile << std::fixed << std::setprecision (std::numeric_limits<double>::digits10 + 1);
-
-  for (size_t i=0; i < vec_points.size(); ++i)  {
-    if (vec_coloredPoints == nullptr)
-      outfile
-        << vec_points[i](0) << ' '
-        << vec_points[i](1) << ' '
-        << vec_points[i](2) << ' '
-        << "255 255 255\n";
-    else
-      outfile
-        << vec_points[i](0) << ' '
-        << vec_points[i](1) << ' '
-        << vec_points[i](2) << ' '
-        << static_cast<int>((*vec_coloredPoints)[i](0)) << ' '
-        << static_cast<int>((*vec_coloredPoints)[i](1)) << ' '
-        << static_cast<int>((*vec_coloredPoints)[i](2))
-        << "\n";
-  }
-
-  for (size_t i=0; i < vec_camPos.size(); ++i)  {
-    outfile
-      << vec_camPos[i](0) << ' '
-      << vec_camPos[i](1) << ' '
-      << vec_camPos[i](2) << ' '
-      << "0 255 0\n";
-  }
-  outfile.flush();
-  const bool bOk = outfile.good();
-  outfile.close();
-  return bOk;
+  bool bOk = (vec_coloredPoints == nullptr) ?
+    writer.Write(vec_points) :
+    writer.Write(vec_points, *vec_coloredPoints);
+  bOk &= writer.Write(vec_camPos, geometry::Ply_Color(0, 255, 0));
+  return writer.Close() && bOk;
 }
 
 } // namespace plyHelper
@@ -0,0 +1,135 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef OPENMVG_SOFTWARE_SFM_EXPORT_UNDISTORT_IMAGES_PIPELINE_HPP
+#define OPENMVG_SOFTWARE_SFM_EXPORT_UNDISTORT_IMAGES_PIPELINE_HPP
+
+#include "openMVG/cameras/Camera_undistort_image.hpp"
+#include "openMVG/image/image_io.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/system/pipeline.hpp"
+
+#include "third_party/progress/progress_display.hpp"
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace openMVG {
+namespace sfm {
+
+/// An image read as RGB, or as gray level if the RGB reading fails
+struct UndistortImageBuffer
+{
+  image::Image<image::RGBColor> rgb;
+  image::Image<uint8_t> gray;
+  bool b_gray = false;
+};
+
+/**
+* @brief Undistort the images of some views and save them.
+*  Reading, undistortion and writing are run by three pools of threads
+*  (see system::Pipeline), so the disk accesses overlap the computations.
+*  Each undistortion is single threaded: the parallelism is the number of
+*  transformer threads.
+*  The images of the views without distortion are just copied.
+*
+* @param[in] sfm_data scene (the views and their intrinsic)
+* @param[in] view_outputs (view id, output image path) of the images to export
+* @param[in] options number of threads of each stage
+* @param[in] progress progress display (incremented once per image)
+* @return true if all the images are exported
+*/
+inline bool UndistortImagesToFiles
+(
+  const SfM_Data & sfm_data,
+  const std::vector<std::pair<IndexT, std::string>> & view_outputs,
+  const system::Pipeline_Options & options,
+  C_Progress_display & progress
+)
+{
+  // Views with distortion go through the pipeline, others are just copied
+  std::vector<std::pair<IndexT, std::string>> to_undistort;
+  bool bOk = true;
+  for (const auto & view_output : view_outputs)
+  {
+    const View * view = sfm_data.GetViews().at(view_output.first).get();
+    const auto iterIntrinsic = sfm_data.GetIntrinsics().find(view->id_intrinsic);
+    if (iterIntrinsic != sfm_data.GetIntrinsics().end() &&
+        iterIntrinsic->second->have_disto())
+    {
+      to_undistort.push_back(view_output);
+    }
+    else
+    {
+      const std::string srcImage =
+        stlplus::create_filespec(sfm_data.s_root_path, view->s_Img_path);
+      bOk &= stlplus::file_copy(srcImage, view_output.second);
+      ++progress;
+    }
+  }
+
+  // Undistortion maps shared by the views having the same intrinsic
+  cameras::UndistortionMapCache undistortion_maps;
+
+  const auto decode = [&](std::size_t i, UndistortImageBuffer & image)
+  {
+    const View * view = sfm_data.GetViews().at(to_undistort[i].first).get();
+    const std::string srcImage =
+      stlplus::create_filespec(sfm_data.s_root_path, view->s_Img_path);
+    // If RGBColor reading fails, try to read as gray image
+    image.b_gray = !image::ReadImage(srcImage.c_str(), &image.rgb);
+    const bool bRes = !image.b_gray || image::ReadImage(srcImage.c_str(), &image.gray);
+    if (!bRes)
+      ++progress;
+    return bRes;
+  };
+
+  const auto transform = [&]
+  (
+    std::size_t i,
+    UndistortImageBuffer & image,
+    UndistortImageBuffer & image_ud
+  )
+  {
+    const View * view = sfm_data.GetViews().at(to_undistort[i].first).get();
+    const cameras::IntrinsicBase * cam =
+      sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
+    image_ud.b_gray = image.b_gray;
+    // Serial kernel: each transformer thread undistorts one image
+    //  (else each of them would start a full OpenMP team)
+    const bool bRes = image.b_gray ?
+      cameras::UndistortImage(image.gray,
+        *undistortion_maps.Get(cam, image.gray.Width(), image.gray.Height()),
+        image_ud.gray, image::BLACK, false) :
+      cameras::UndistortImage(image.rgb,
+        *undistortion_maps.Get(cam, image.rgb.Width(), image.rgb.Height()),
+        image_ud.rgb, image::BLACK, false);
+    if (!bRes)
+      ++progress;
+    return bRes;
+  };
+
+  const auto encode = [&](std::size_t i, UndistortImageBuffer & image_ud)
+  {
+    const std::string & dstImage = to_undistort[i].second;
+    const bool bRes = image_ud.b_gray ?
+      image::WriteImage(dstImage.c_str(), image_ud.gray) :
+      image::WriteImage(dstImage.c_str(), image_ud.rgb);
+    ++progress;
+    return bRes;
+  };
+
+  system::Pipeline<UndistortImageBuffer, UndistortImageBuffer> pipeline(options);
+  return pipeline.Run(to_undistort.size(), decode, transform, encode)
+    == to_undistort.size() && bOk;
+}
+
+} // namespace sfm
+} // namespace openMVG
+
+#endif // OPENMVG_SOFTWARE_SFM_EXPORT_UNDISTORT_IMAGES_PIPELINE_HPP
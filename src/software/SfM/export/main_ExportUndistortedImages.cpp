@@ -6,22 +6,19 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
-#include "openMVG/cameras/Camera_undistort_image.hpp"
-#include "openMVG/image/image_io.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/system/timer.hpp"
+#include "software/SfM/export/UndistortImagesPipeline.hpp"
 
 #include "third_party/cmdLine/cmdLine.h"
 #include "third_party/progress/progress_display.hpp"
 #include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
 
+#include <algorithm>
 #include <cstdlib>
 #include <string>
-
-#ifdef OPENMVG_USE_OPENMP
-#include <omp.h>
-#endif
+#include <thread>
 
 using namespace openMVG;
 using namespace openMVG::cameras;
@@ -29,27 +26,22 @@ using namespace openMVG::geometry;
 using namespace openMVG::image;
 using namespace openMVG::sfm;
 
-#ifdef OPENMVG_USE_OPENMP
-#include <omp.h>
-#endif
-
 int main(int argc, char *argv[]) {
 
   CmdLine cmd;
   std::string sSfM_Data_Filename;
   std::string sOutDir = "";
   bool bExportOnlyReconstructedViews = false;
-#ifdef OPENMVG_USE_OPENMP
   int iNumThreads = 0;
-#endif
+  int iNumReadThreads = 2;
+  int iNumWriteThreads = 2;
 
   cmd.add( make_option('i', sSfM_Data_Filename, "sfmdata") );
   cmd.add( make_option('o', sOutDir, "outdir") );
   cmd.add( make_option('r', bExportOnlyReconstructedViews, "exportOnlyReconstructed") );
-
-#ifdef OPENMVG_USE_OPENMP
   cmd.add( make_option('n', iNumThreads, "numThreads") );
-#endif
+  cmd.add( make_option('R', iNumReadThreads, "numReadThreads") );
+  cmd.add( make_option('W', iNumWriteThreads, "numWriteThreads") );
 
   try {
       if (argc == 1) throw std::string("Invalid command line parameter.");
@@ -61,9 +53,9 @@ int main(int argc, char *argv[]) {
       << "[-i|--sfmdata] filename, the SfM_Data file to convert\n"
       << "[-o|--outdir] path\n"
       << "[-r|--exportOnlyReconstructed] boolean 1/0 (default = 0)\n"
-#ifdef OPENMVG_USE_OPENMP
-      << "[-n|--numThreads] number of thread(s)\n"
-#endif
+      << "[-n|--numThreads] number of undistortion thread(s) (default = 0: all the cores)\n"
+      << "[-R|--numReadThreads] number of image reading thread(s) (default = 2)\n"
+      << "[-W|--numWriteThreads] number of image writing thread(s) (default = 2)\n"
       << std::endl;
 
       std::cerr << s << std::endl;
@@ -85,27 +77,10 @@ int main(int argc, char *argv[]) {
   {
     system::Timer timer;
     // Export views as undistorted images (those with valid Intrinsics)
-    Image<RGBColor> image, image_ud;
-    Image<uint8_t> image_gray, image_gray_ud;
-    C_Progress_display my_progress_bar( sfm_data.GetViews().size(), std::cout, "\n- EXTRACT UNDISTORTED IMAGES -\n" );
-
-    #ifdef OPENMVG_USE_OPENMP
-    const unsigned int nb_max_thread = omp_get_max_threads();
-    #endif
-
-#ifdef OPENMVG_USE_OPENMP
-    omp_set_num_threads(iNumThreads);
-    #pragma omp parallel for schedule(dynamic) if (iNumThreads > 0) private(image, image_ud, image_gray, image_gray_ud)
-#endif
-    for (int i = 0; i < static_cast<int>(sfm_data.views.size()); ++i)
+    std::vector<std::pair<IndexT, std::string>> view_outputs;
+    for (const auto & view_it : sfm_data.GetViews())
     {
-#ifdef OPENMVG_USE_OPENMP
-      if (iNumThreads == 0) omp_set_num_threads(nb_max_thread);
-#endif
-      Views::const_iterator iterViews = sfm_data.views.begin();
-      std::advance(iterViews, i);
-
-      const View * view = iterViews->second.get();
+      const View * view = view_it.second.get();
       // Check if the view is in reconstruction
       if (bExportOnlyReconstructedViews && !sfm_data.IsPoseAndIntrinsicDefined(view))
         continue;
@@ -115,43 +90,21 @@ int main(int argc, char *argv[]) {
       if (!bIntrinsicDefined)
         continue;
 
-      Intrinsics::const_iterator iterIntrinsic = sfm_data.GetIntrinsics().find(view->id_intrinsic);
-
-      const std::string srcImage = stlplus::create_filespec(sfm_data.s_root_path, view->s_Img_path);
-      const std::string dstImage = stlplus::create_filespec(
-        sOutDir, stlplus::filename_part(srcImage));
-
-      const IntrinsicBase * cam = iterIntrinsic->second.get();
-      if (cam->have_disto())
-      {
-        // undistort the image and save it
-        if (ReadImage( srcImage.c_str(), &image))
-        {
-          UndistortImage(image, cam, image_ud, BLACK);
-          const bool bRes = WriteImage(dstImage.c_str(), image_ud);
-#ifdef OPENMVG_USE_OPENMP
-          #pragma omp critical
-#endif
-          bOk &= bRes;
-        }
-        else // If RGBColor reading fails, we try to read a gray image
-        if (ReadImage( srcImage.c_str(), &image_gray))
-        {
-          UndistortImage(image_gray, cam, image_gray_ud, BLACK);
-          const bool bRes = WriteImage(dstImage.c_str(), image_gray_ud);
-#ifdef OPENMVG_USE_OPENMP
-          #pragma omp critical
-#endif
-          bOk &= bRes;
-        }
-      }
-      else // (no distortion)
-      {
-        // copy the image since there is no distortion
-        stlplus::file_copy(srcImage, dstImage);
-      }
-      ++my_progress_bar;
+      view_outputs.emplace_back(view->id_view,
+        stlplus::create_filespec(sOutDir, stlplus::filename_part(view->s_Img_path)));
     }
+
+    // Read, undistort and write the images in parallel
+    system::Pipeline_Options pipeline_options;
+    pipeline_options.decoders = std::max(1, iNumReadThreads);
+    pipeline_options.transformers = (iNumThreads > 0) ?
+      iNumThreads : std::max(1u, std::thread::hardware_concurrency());
+    pipeline_options.encoders = std::max(1, iNumWriteThreads);
+    // Bound the number of images in memory
+    pipeline_options.buffers = pipeline_options.transformers + 2;
+
+    C_Progress_display my_progress_bar( view_outputs.size(), std::cout, "\n- EXTRACT UNDISTORTED IMAGES -\n" );
+    bOk = UndistortImagesToFiles(sfm_data, view_outputs, pipeline_options, my_progress_bar);
     std::cout << "Task done in (s): " << timer.elapsed() << std::endl;
   }
 
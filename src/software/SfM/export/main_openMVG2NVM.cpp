@@ -13,6 +13,7 @@
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
 #include "openMVG/sfm/sfm_data_colorization.hpp"
+#include "openMVG/sfm/sfm_landmark_dense.hpp"
 
 #include "third_party/cmdLine/cmdLine.h"
 #include "third_party/progress/progress_display.hpp"
@@ -202,40 +203,35 @@ bool CreateNVMFile( const SfM_Data & sfm_data ,
   // Number of points
   // For each points : X Y Z R G B Nm [ measurements ]
   // mesurements : Img_idx Feat_idx X Y
-  const Landmarks & landmarks = sfm_data.GetLandmarks();
+  const Dense_Landmarks landmarks(sfm_data.GetLandmarks());
   const size_t featureCount = landmarks.size();
   file << featureCount << std::endl;
 
-  std::vector<Vec3> vec_3dPoints, vec_tracksColor;
-  if (!ColorizeTracks(sfm_data, vec_3dPoints, vec_tracksColor)) {
+  std::vector<Vec3> vec_tracksColor;
+  if (!ColorizeTracks(sfm_data, landmarks, vec_tracksColor)) {
     return false;
   }
-  int point_index = 0;
   C_Progress_display my_progress_bar( featureCount, std::cout, "\n- EXPORT LANDMARKS DATA -\n" );
-  for ( Landmarks::const_iterator iterLandmarks = landmarks.begin();
-        iterLandmarks != landmarks.end(); ++iterLandmarks, ++my_progress_bar )
+  for ( IndexT slot = 0; slot < landmarks.size(); ++slot, ++my_progress_bar )
   {
-    const Vec3 exportPoint = iterLandmarks->second.X;
+    const Vec3 & exportPoint = landmarks.X(slot);
     file << exportPoint.x() << " " << exportPoint.y() << " " << exportPoint.z() << " ";
 
     file 
-      << static_cast<int>(vec_tracksColor.at(point_index)(0)) << " " 
-      << static_cast<int>(vec_tracksColor.at(point_index)(1)) << " " 
-      << static_cast<int>(vec_tracksColor.at(point_index)(2)) << " ";
-    ++point_index;
+      << static_cast<int>(vec_tracksColor.at(slot)(0)) << " " 
+      << static_cast<int>(vec_tracksColor.at(slot)(1)) << " " 
+      << static_cast<int>(vec_tracksColor.at(slot)(2)) << " ";
 
     // Tally set of feature observations
-    const Observations & obs = iterLandmarks->second.obs;
-    const size_t featureCount = std::distance( obs.begin(), obs.end() );
-    file << featureCount;
+    file << landmarks.track_length(slot);
 
-    for ( Observations::const_iterator itObs = obs.begin(); itObs != obs.end(); ++itObs )
+    for ( std::size_t i = landmarks.obs_begin(slot); i < landmarks.obs_end(slot); ++i )
     {
-      const IndexT viewId = map_viewIdToContiguous.at(itObs->first);
-      const IndexT featId = itObs->second.id_feat;
-      const Observation & ob = itObs->second;
+      const IndexT viewId = map_viewIdToContiguous.at(landmarks.obs_view_id(i));
+      const IndexT featId = landmarks.obs_feat_id(i);
+      const Vec2 & x = landmarks.obs_x(i);
 
-      file << " " << viewId << " " << featId << " " << ob.x( 0 ) << " " << ob.x( 1 ) << " ";
+      file << " " << viewId << " " << featId << " " << x( 0 ) << " " << x( 1 ) << " ";
     }
     file << "\n";
   }
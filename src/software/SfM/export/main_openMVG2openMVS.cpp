@@ -7,10 +7,10 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include "openMVG/cameras/Camera_Pinhole.hpp"
-#include "openMVG/cameras/Camera_undistort_image.hpp"
 #include "openMVG/image/image_io.hpp"
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
+#include "software/SfM/export/UndistortImagesPipeline.hpp"
 
 #define _USE_EIGEN
 #include "InterfaceMVS.h"
@@ -25,19 +25,18 @@ using namespace openMVG::geometry;
 using namespace openMVG::image;
 using namespace openMVG::sfm;
 
-#include <atomic>
+#include <algorithm>
 #include <cstdlib>
 #include <string>
-
-#ifdef OPENMVG_USE_OPENMP
-#include <omp.h>
-#endif
+#include <thread>
 
 bool exportToOpenMVS(
   const SfM_Data & sfm_data,
   const std::string & sOutFile,
   const std::string & sOutDir,
-  const int iNumThreads = 0
+  const int iNumThreads = 0,
+  const int iNumReadThreads = 2,
+  const int iNumWriteThreads = 2
   )
 {
   // Create undistorted images directory structure
@@ -124,79 +123,39 @@ bool exportToOpenMVS(
   }
 
   // Export undistorted images
-  C_Progress_display my_progress_bar_images(sfm_data.views.size(),
-      std::cout, "\n- UNDISTORT IMAGES -\n" );
-  std::atomic<bool> bOk(true); // Use a boolean to track the status of the loop process
-#ifdef OPENMVG_USE_OPENMP
-  const unsigned int nb_max_thread = (iNumThreads > 0)? iNumThreads : omp_get_max_threads();
-
-  #pragma omp parallel for schedule(dynamic) num_threads(nb_max_thread)
-#endif
-  for (int i = 0; i < static_cast<int>(sfm_data.views.size()); ++i)
+  // (read, undistort and write the images in parallel)
+  std::vector<std::pair<IndexT, std::string>> view_outputs;
+  for (const auto & view : sfm_data.GetViews())
   {
-    ++my_progress_bar_images;
-
-    if (!bOk)
-      continue;
-
-    Views::const_iterator iterViews = sfm_data.views.begin();
-    std::advance(iterViews, i);
-    const View * view = iterViews->second.get();
-
-    // Get image paths
-    const std::string srcImage = stlplus::create_filespec(sfm_data.s_root_path, view->s_Img_path);
-    const std::string imageName = stlplus::create_filespec(sOutDir, view->s_Img_path);
-
-    if (sfm_data.IsPoseAndIntrinsicDefined(view))
+    const std::string imageName =
+      stlplus::create_filespec(sOutDir, view.second->s_Img_path);
+    if (sfm_data.IsPoseAndIntrinsicDefined(view.second.get()))
     {
-      // export undistorted images
-      const openMVG::cameras::IntrinsicBase * cam = sfm_data.GetIntrinsics().at(view->id_intrinsic).get();
-      if (cam->have_disto())
-      {
-        // undistort image and save it
-        Image<openMVG::image::RGBColor> imageRGB, imageRGB_ud;
-        Image<uint8_t> image_gray, image_gray_ud;
-        try
-        {
-          if (ReadImage(srcImage.c_str(), &imageRGB))
-          {
-            UndistortImage(imageRGB, cam, imageRGB_ud, BLACK);
-            bOk = WriteImage(imageName.c_str(), imageRGB_ud);
-          }
-          else // If RGBColor reading fails, try to read as gray image
-          if (ReadImage(srcImage.c_str(), &image_gray))
-          {
-            UndistortImage(image_gray, cam, image_gray_ud, BLACK);
-            const bool bRes = WriteImage(imageName.c_str(), image_gray_ud);
-            bOk = bOk & bRes;
-          }
-          else
-          {
-            bOk = false;
-          }
-        }
-        catch (const std::bad_alloc& e)
-        {
-          bOk = false;
-        }
-      }
-      else
-      {
-        // just copy image
-        stlplus::file_copy(srcImage, imageName);
-      }
+      view_outputs.emplace_back(view.first, imageName);
     }
     else
     {
       // just copy the image
-      stlplus::file_copy(srcImage, imageName);
+      stlplus::file_copy(
+        stlplus::create_filespec(sfm_data.s_root_path, view.second->s_Img_path),
+        imageName);
     }
   }
-
-  if (!bOk)
+  system::Pipeline_Options pipeline_options;
+  pipeline_options.decoders = std::max(1, iNumReadThreads);
+  pipeline_options.transformers = (iNumThreads > 0) ?
+    iNumThreads : std::max(1u, std::thread::hardware_concurrency());
+  pipeline_options.encoders = std::max(1, iNumWriteThreads);
+  // Bound the number of images in memory
+  pipeline_options.buffers = pipeline_options.transformers + 2;
+
+  C_Progress_display my_progress_bar_images(view_outputs.size(),
+      std::cout, "\n- UNDISTORT IMAGES -\n" );
+  if (!UndistortImagesToFiles(sfm_data, view_outputs, pipeline_options, my_progress_bar_images))
   {
-    std::cerr << "Catched a memory error in the image conversion."
-     << " Please consider to use less threads ([-n|--numThreads])." << std::endl;
+    std::cerr << "Cannot export the undistorted images."
+     << " In case of memory error, please consider to use less threads"
+     << " ([-n|--numThreads])." << std::endl;
     return false;
   }
 
@@ -254,13 +213,15 @@ int main(int argc, char *argv[])
   std::string sOutFile = "scene.mvs";
   std::string sOutDir = "undistorted_images";
   int iNumThreads = 0;
+  int iNumReadThreads = 2;
+  int iNumWriteThreads = 2;
 
   cmd.add( make_option('i', sSfM_Data_Filename, "sfmdata") );
   cmd.add( make_option('o', sOutFile, "outfile") );
   cmd.add( make_option('d', sOutDir, "outdir") );
-#ifdef OPENMVG_USE_OPENMP
   cmd.add( make_option('n', iNumThreads, "numThreads") );
-#endif
+  cmd.add( make_option('R', iNumReadThreads, "numReadThreads") );
+  cmd.add( make_option('W', iNumWriteThreads, "numWriteThreads") );
 
   try {
       if (argc == 1) throw std::string("Invalid command line parameter.");
@@ -270,9 +231,9 @@ int main(int argc, char *argv[])
       << "[-i|--sfmdata] filename, the SfM_Data file to convert\n"
       << "[-o|--outfile] OpenMVS scene file\n"
       << "[-d|--outdir] undistorted images path\n"
-#ifdef OPENMVG_USE_OPENMP
-      << "[-n|--numThreads] number of thread(s)\n"
-#endif
+      << "[-n|--numThreads] number of undistortion thread(s) (default = 0: all the cores)\n"
+      << "[-R|--numReadThreads] number of image reading thread(s) (default = 2)\n"
+      << "[-W|--numWriteThreads] number of image writing thread(s) (default = 2)\n"
       << std::endl;
 
       std::cerr << s << std::endl;
@@ -295,7 +256,7 @@ int main(int argc, char *argv[])
   }
 
   // Export OpenMVS data structure
-  if (!exportToOpenMVS(sfm_data, sOutFile, sOutDir, iNumThreads))
+  if (!exportToOpenMVS(sfm_data, sOutFile, sOutDir, iNumThreads, iNumReadThreads, iNumWriteThreads))
   {
     std::cerr << std::endl
       << "The output openMVS scene file cannot be written" << std::endl;
@@ -16,6 +16,7 @@
 #include "openMVG/matching_image_collection/Matcher_Regions.hpp"
 #include "openMVG/matching_image_collection/Cascade_Hashing_Matcher_Regions.hpp"
 #include "openMVG/matching_image_collection/GeometricFilter.hpp"
+#include "openMVG/matching_image_collection/Matching_Journal.hpp"
 #include "openMVG/sfm/pipelines/sfm_features_provider.hpp"
 #include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
 #include "openMVG/sfm/pipelines/sfm_regions_provider_cache.hpp"
@@ -82,8 +83,11 @@ int main(int argc, char **argv)
   std::string sNearestMatchingMethod = "AUTO";
   bool bForce = false;
   bool bGuided_matching = false;
+  bool bProgressive_sampling = false;
   int imax_iteration = 2048;
   unsigned int ui_max_cache_size = 0;
+  bool bJournal = false;
+  bool bResume = false;
 
   //required
   cmd.add( make_option('i', sSfM_Data_Filename, "input_file") );
@@ -96,9 +100,12 @@ int main(int argc, char **argv)
   cmd.add( make_option('n', sNearestMatchingMethod, "nearest_matching_method") );
   cmd.add( make_option('f', bForce, "force") );
   cmd.add( make_option('m', bGuided_matching, "guided_matching") );
+  cmd.add( make_option('P', bProgressive_sampling, "progressive_sampling") );
   cmd.add( make_option('I', imax_iteration, "max_iteration") );
   cmd.add( make_option('c', ui_max_cache_size, "cache_size") );
   cmd.add( make_option('F', sFeaturesDirectory, "features_dir") ); // CPM
+  cmd.add( make_switch('J', "journal") );
+  cmd.add( make_switch('R', "resume") );
 
 
   try {
@@ -141,9 +148,16 @@ int main(int argc, char **argv)
       << "    BRUTEFORCEHAMMING: BruteForce Hamming matching.\n"
       << "[-m|--guided_matching]\n"
       << "  use the found model to improve the pairwise correspondences.\n"
+      << "[-P|--progressive_sampling]\n"
+      << "  use PROSAC sampling (putative matches ranked by distance ratio)\n"
+      << "  in the robust model estimation.\n"
       << "[-c|--cache_size]\n"
       << "  Use a regions cache (only cache_size regions will be stored in memory)\n"
-      << "  If not used, all regions will be load in memory."
+      << "  If not used, all regions will be load in memory.\n"
+      << "[-J|--journal] Journal the completed pairs (in the out_dir),\n"
+      << "  so that an interrupted matching can be resumed.\n"
+      << "[-R|--resume] Resume an interrupted journaled matching (implies --journal):\n"
+      << "  the pairs completed in the matching journals are not matched again."
       << std::endl;
 
       std::cerr << s << std::endl;
@@ -151,6 +165,8 @@ int main(int argc, char **argv)
   }
   if (sFeaturesDirectory.empty())
     sFeaturesDirectory = sMatchesDirectory;
+  bResume = cmd.used('R');
+  bJournal = cmd.used('J') || bResume;
 
   std::cout << " You called : " << "\n"
             << argv[0] << "\n"
@@ -165,7 +181,10 @@ int main(int argc, char **argv)
             << "--pair_list " << sPredefinedPairList << "\n"
             << "--nearest_matching_method " << sNearestMatchingMethod << "\n"
             << "--guided_matching " << bGuided_matching << "\n"
-            << "--cache_size " << ((ui_max_cache_size == 0) ? "unlimited" : std::to_string(ui_max_cache_size)) << std::endl;
+            << "--progressive_sampling " << bProgressive_sampling << "\n"
+            << "--cache_size " << ((ui_max_cache_size == 0) ? "unlimited" : std::to_string(ui_max_cache_size)) << "\n"
+            << "--journal " << bJournal << "\n"
+            << "--resume " << bResume << std::endl;
 
   EPairMode ePairmode = (iMatchingVideoMode == -1 ) ? PAIR_EXHAUSTIVE : PAIR_CONTIGUOUS;
 
@@ -237,7 +256,15 @@ int main(int argc, char **argv)
   //---------------------------------------
   // Init the regions_type from the image describer file (used for image regions extraction)
   using namespace openMVG::features;
-  const std::string sImage_describer = stlplus::create_filespec(sMatchesDirectory, "image_describer", "json");
+  // (next to the matches or else next to the features, i.e. for the shards of a distributed matching)
+  std::string sImage_describer = stlplus::create_filespec(sMatchesDirectory, "image_describer", "json");
+  if (!stlplus::is_file(sImage_describer))
+  {
+    std::string sFeaturesDirectorySimple = sFeaturesDirectory;
+    while (!sFeaturesDirectorySimple.empty() && sFeaturesDirectorySimple.back() == '@')
+      sFeaturesDirectorySimple.pop_back();
+    sImage_describer = stlplus::create_filespec(sFeaturesDirectorySimple, "image_describer", "json");
+  }
   std::unique_ptr<Regions> regions_type = Init_region_type_from_file(sImage_describer);
   if (!regions_type)
   {
@@ -393,7 +420,30 @@ int main(int argc, char **argv)
           break;
       }
       // Photometric matching of putative pairs
-      collectionMatcher->Match(regions_provider, pairs, map_PutativesMatches, &progress);
+      // (if asked, the completed pairs are journaled to resume an interrupted matching)
+      Matching_Journal journal;
+      const std::string sJournal = stlplus::create_filespec(sMatchesDirectory, "matches.putative.journal.bmat");
+      if (bJournal)
+      {
+        if (!journal.Open(sJournal, bResume))
+          return EXIT_FAILURE;
+        if (bResume)
+          std::cout << "Resumed pairs: " << journal.Completed_pairs().size() << std::endl;
+        if (!Run_with_journal(pairs, journal,
+              [&](const Pair_Set & remaining_pairs, PairWiseMatchesContainer & output)
+              {
+                collectionMatcher->Match(regions_provider, remaining_pairs, output, &progress);
+              },
+              map_PutativesMatches))
+        {
+          std::cerr << "Cannot journal the putative matches in: " << sJournal << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      else
+      {
+        collectionMatcher->Match(regions_provider, pairs, map_PutativesMatches, &progress);
+      }
       //---------------------------------------
       //-- Export putative matches
       //---------------------------------------
@@ -404,6 +454,8 @@ int main(int argc, char **argv)
           << std::string(sMatchesDirectory + "/matches.putative.bin");
         return EXIT_FAILURE;
       }
+      if (bJournal)
+        journal.Remove();
     }
     std::cout << "Task (Regions Matching) done in (s): " << timer.elapsed() << std::endl;
   }
@@ -428,85 +480,123 @@ int main(int argc, char **argv)
   //    - Use an upper bound for the a contrario estimated threshold
   //---------------------------------------
 
-  std::unique_ptr<ImageCollectionGeometricFilter> filter_ptr(
-    new ImageCollectionGeometricFilter(&sfm_data, regions_provider));
-
-  if (filter_ptr)
   {
     system::Timer timer;
     const double d_distance_ratio = 0.6;
 
-    PairWiseMatches map_GeometricMatches;
-    switch (eGeometricModelToCompute)
+    // Geometric filtering of putative pairs
+    //  (output: if set, the filtered pairs are moved to it as they are computed)
+    ImageCollectionGeometricFilter filter(&sfm_data, regions_provider);
+    const auto geometric_filtering = [&]
+    (
+      const PairWiseMatches & putative_matches,
+      PairWiseMatchesContainer * output
+    )
     {
-      case HOMOGRAPHY_MATRIX:
+      switch (eGeometricModelToCompute)
       {
-        const bool bGeometric_only_guided_matching = true;
-        filter_ptr->Robust_model_estimation(
-          GeometricFilter_HMatrix_AC(4.0, imax_iteration),
-          map_PutativesMatches, bGuided_matching,
-          bGeometric_only_guided_matching ? -1.0 : d_distance_ratio, &progress);
-        map_GeometricMatches = filter_ptr->Get_geometric_matches();
-      }
-      break;
-      case FUNDAMENTAL_MATRIX:
-      {
-        filter_ptr->Robust_model_estimation(
-          GeometricFilter_FMatrix_AC(4.0, imax_iteration),
-          map_PutativesMatches, bGuided_matching, d_distance_ratio, &progress);
-        map_GeometricMatches = filter_ptr->Get_geometric_matches();
-      }
-      break;
-      case ESSENTIAL_MATRIX:
-      {
-        filter_ptr->Robust_model_estimation(
-          GeometricFilter_EMatrix_AC(4.0, imax_iteration),
-          map_PutativesMatches, bGuided_matching, d_distance_ratio, &progress);
-        map_GeometricMatches = filter_ptr->Get_geometric_matches();
-
-        //-- Perform an additional check to remove pairs with poor overlap
-        std::vector<PairWiseMatches::key_type> vec_toRemove;
-        for (const auto & pairwisematches_it : map_GeometricMatches)
+        case HOMOGRAPHY_MATRIX:
         {
-          const size_t putativePhotometricCount = map_PutativesMatches.find(pairwisematches_it.first)->second.size();
-          const size_t putativeGeometricCount = pairwisematches_it.second.size();
-          const float ratio = putativeGeometricCount / static_cast<float>(putativePhotometricCount);
-          if (putativeGeometricCount < 50 || ratio < .3f)  {
-            // the pair will be removed
-            vec_toRemove.push_back(pairwisematches_it.first);
-          }
+          const bool bGeometric_only_guided_matching = true;
+          filter.Robust_model_estimation(
+            GeometricFilter_HMatrix_AC(4.0, imax_iteration, bProgressive_sampling),
+            putative_matches, bGuided_matching,
+            bGeometric_only_guided_matching ? -1.0 : d_distance_ratio, &progress, output);
+        }
+        break;
+        case FUNDAMENTAL_MATRIX:
+        {
+          filter.Robust_model_estimation(
+            GeometricFilter_FMatrix_AC(4.0, imax_iteration, bProgressive_sampling),
+            putative_matches, bGuided_matching, d_distance_ratio, &progress, output);
         }
-        //-- remove discarded pairs
-        for (const auto & pair_to_remove_it : vec_toRemove)
+        break;
+        case ESSENTIAL_MATRIX:
         {
-          map_GeometricMatches.erase(pair_to_remove_it);
+          filter.Robust_model_estimation(
+            GeometricFilter_EMatrix_AC(4.0, imax_iteration, bProgressive_sampling),
+            putative_matches, bGuided_matching, d_distance_ratio, &progress, output);
         }
+        break;
+        case ESSENTIAL_MATRIX_ANGULAR:
+        {
+          filter.Robust_model_estimation(
+            GeometricFilter_ESphericalMatrix_AC_Angular<false>(4.0, imax_iteration, bProgressive_sampling),
+            putative_matches, bGuided_matching, d_distance_ratio, &progress, output);
+        }
+        break;
+        case ESSENTIAL_MATRIX_ORTHO:
+        {
+          filter.Robust_model_estimation(
+            GeometricFilter_EOMatrix_RA(2.0, imax_iteration),
+            putative_matches, bGuided_matching, d_distance_ratio, &progress, output);
+        }
+        break;
+        case ESSENTIAL_MATRIX_UPRIGHT:
+        {
+          filter.Robust_model_estimation(
+            GeometricFilter_ESphericalMatrix_AC_Angular<true>(4.0, imax_iteration, bProgressive_sampling),
+            putative_matches, bGuided_matching, d_distance_ratio, &progress, output);
+        }
+        break;
       }
-      break;
-      case ESSENTIAL_MATRIX_ANGULAR:
+    };
+
+    // If asked, the filtered pairs are journaled to resume an interrupted filtering
+    PairWiseMatches map_GeometricMatches;
+    Matching_Journal journal;
+    const std::string sJournal = stlplus::create_filespec(sMatchesDirectory,
+      stlplus::basename_part(sGeometricMatchesFilename) + ".journal.bmat");
+    if (bJournal)
+    {
+      if (!journal.Open(sJournal, bResume))
+        return EXIT_FAILURE;
+      if (bResume)
+        std::cout << "Resumed pairs: " << journal.Completed_pairs().size() << std::endl;
+      if (!Run_with_journal(getPairs(map_PutativesMatches), journal,
+            [&](const Pair_Set & remaining_pairs, PairWiseMatchesContainer & output)
+            {
+              if (remaining_pairs.size() == map_PutativesMatches.size())
+              {
+                geometric_filtering(map_PutativesMatches, &output);
+                return;
+              }
+              PairWiseMatches remaining_putatives;
+              for (const Pair & pair : remaining_pairs)
+                remaining_putatives.insert({pair, map_PutativesMatches.at(pair)});
+              geometric_filtering(remaining_putatives, &output);
+            },
+            map_GeometricMatches))
       {
-        filter_ptr->Robust_model_estimation(
-          GeometricFilter_ESphericalMatrix_AC_Angular<false>(4.0, imax_iteration),
-          map_PutativesMatches, bGuided_matching, d_distance_ratio, &progress);
-        map_GeometricMatches = filter_ptr->Get_geometric_matches();
+        std::cerr << "Cannot journal the geometric matches in: " << sJournal << std::endl;
+        return EXIT_FAILURE;
       }
-      break;
-      case ESSENTIAL_MATRIX_ORTHO:
+    }
+    else
+    {
+      geometric_filtering(map_PutativesMatches, nullptr);
+      map_GeometricMatches = std::move(filter._map_GeometricMatches);
+    }
+
+    if (eGeometricModelToCompute == ESSENTIAL_MATRIX)
+    {
+      //-- Perform an additional check to remove pairs with poor overlap
+      std::vector<PairWiseMatches::key_type> vec_toRemove;
+      for (const auto & pairwisematches_it : map_GeometricMatches)
       {
-        filter_ptr->Robust_model_estimation(
-          GeometricFilter_EOMatrix_RA(2.0, imax_iteration),
-          map_PutativesMatches, bGuided_matching, d_distance_ratio, &progress);
-        map_GeometricMatches = filter_ptr->Get_geometric_matches();
+        const size_t putativePhotometricCount = map_PutativesMatches.find(pairwisematches_it.first)->second.size();
+        const size_t putativeGeometricCount = pairwisematches_it.second.size();
+        const float ratio = putativeGeometricCount / static_cast<float>(putativePhotometricCount);
+        if (putativeGeometricCount < 50 || ratio < .3f)  {
+          // the pair will be removed
+          vec_toRemove.push_back(pairwisematches_it.first);
+        }
       }
-      break;
-      case ESSENTIAL_MATRIX_UPRIGHT:
+      //-- remove discarded pairs
+      for (const auto & pair_to_remove_it : vec_toRemove)
       {
-        filter_ptr->Robust_model_estimation(
-          GeometricFilter_ESphericalMatrix_AC_Angular<true>(4.0, imax_iteration),
-            map_PutativesMatches, bGuided_matching, d_distance_ratio, &progress);
-        map_GeometricMatches = filter_ptr->Get_geometric_matches();
+        map_GeometricMatches.erase(pair_to_remove_it);
       }
-      break;
     }
 
     //---------------------------------------
@@ -520,6 +610,8 @@ int main(int argc, char **argv)
           << std::string(sMatchesDirectory + "/" + sGeometricMatchesFilename);
       return EXIT_FAILURE;
     }
+    if (bJournal)
+      journal.Remove();
 
     std::cout << "Task done in (s): " << timer.elapsed() << std::endl;
 
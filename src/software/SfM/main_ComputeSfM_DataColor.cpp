@@ -8,12 +8,15 @@
 
 #include "openMVG/sfm/sfm_data.hpp"
 #include "openMVG/sfm/sfm_data_io.hpp"
+#include "openMVG/sfm/sfm_landmark_dense.hpp"
 #include "openMVG/types.hpp"
 #include "software/SfM/SfMPlyHelper.hpp"
 #include "third_party/cmdLine/cmdLine.h"
 
 #include "openMVG/sfm/sfm_data_colorization.hpp"
 
+#include <algorithm>
+
 using namespace openMVG;
 using namespace openMVG::sfm;
 
@@ -38,9 +41,15 @@ int main(int argc, char **argv)
   std::string
     sSfM_Data_Filename_In,
     sOutputPLY_Out;
+  int iNumReadThreads = 2;
+  int iNumSampleThreads = 1;
+  bool bAverageColors = false;
 
   cmd.add(make_option('i', sSfM_Data_Filename_In, "input_file"));
   cmd.add(make_option('o', sOutputPLY_Out, "output_file"));
+  cmd.add(make_option('R', iNumReadThreads, "numReadThreads"));
+  cmd.add(make_option('n', iNumSampleThreads, "numThreads"));
+  cmd.add(make_option('a', bAverageColors, "average_colors"));
 
   try {
       if (argc == 1) throw std::string("Invalid command line parameter.");
@@ -49,6 +58,11 @@ int main(int argc, char **argv)
       std::cerr << "Usage: " << argv[0] << '\n'
         << "[-i|--input_file] path to the input SfM_Data scene\n"
         << "[-o|--output_file] path to the output PLY file\n"
+        << "[-R|--numReadThreads] number of image reading thread(s) (default = 2)\n"
+        << "[-n|--numThreads] number of color sampling thread(s) (default = 1)\n"
+        << "[-a|--average_colors] boolean 1/0 (default = 0)\n"
+        << "  1: average the colors of each point in all its views (read all the images)\n"
+        << "  0: color each point from a single view (read a minimal set of images)\n"
         << std::endl;
 
       std::cerr << s << std::endl;
@@ -72,13 +86,18 @@ int main(int argc, char **argv)
   }
 
   // Compute the scene structure color
-  std::vector<Vec3> vec_3dPoints, vec_tracksColor, vec_camPosition;
-  if (ColorizeTracks(sfm_data, vec_3dPoints, vec_tracksColor))
+  // (the images are read and sampled in parallel)
+  system::Pipeline_Options pipeline_options;
+  pipeline_options.decoders = std::max(1, iNumReadThreads);
+  pipeline_options.transformers = std::max(1, iNumSampleThreads);
+  const Dense_Landmarks landmarks(sfm_data.GetLandmarks());
+  std::vector<Vec3> vec_tracksColor, vec_camPosition;
+  if (ColorizeTracks(sfm_data, landmarks, vec_tracksColor, pipeline_options, bAverageColors))
   {
     GetCameraPositions(sfm_data, vec_camPosition);
 
-    // Export the SfM_Data scene in the expected format
-    if (plyHelper::exportToPly(vec_3dPoints, vec_camPosition, sOutputPLY_Out, &vec_tracksColor))
+    // Export the SfM_Data scene in the expected format (binary PLY)
+    if (plyHelper::exportToPly(landmarks.positions(), vec_camPosition, sOutputPLY_Out, &vec_tracksColor))
     {
       return EXIT_SUCCESS;
     }
@@ -108,9 +108,9 @@ int main(int argc, char **argv)
               << "[-i|--input_file] path to the input SfM_Data scene\n"
               << "[-m|--merge_file] path to an optional input SfM_Data scene to merge\n"
               << "[-o|--output_file] path to the output SfM_Data scene\n"
-              << "\t .json, .bin, .xml, .ply, .baf\n"
+              << "\t .json, .bin, .xml, .sfmc, .ply, .baf\n"
               << "\n[Options to export partial data (by default all data are exported)]\n"
-              << "\nUsable for json/bin/xml format\n"
+              << "\nUsable for json/bin/xml/sfmc format\n"
               << "[-V|--VIEWS] export views\n"
               << "[-I|--INTRINSICS] export intrinsics\n"
               << "[-E|--EXTRINSICS] export extrinsics (view poses)\n"
@@ -90,6 +90,8 @@ int main(int argc, char **argv)
     << "[-o|--output_file] filename of the output pair file\n"
     << "[-n|--z_near] 'optional' distance of the near camera plane\n"
     << "[-f|--z_far] 'optional' distance of the far camera plane\n"
+    << "\t Without near & far planes and without structure, the frustums are\n"
+    << "\t infinite and almost all the pairs must be tested exactly (slower).\n"
     << std::endl;
 
     std::cerr << s << std::endl;
@@ -47,12 +47,14 @@ int main(int argc, char **argv)
   CmdLine cmd;
 
   std::string sSfM_Data_Filename;
+  std::string sPrevious_SfM_Data_Filename;
   std::string sMatchesDir, sMatchFilename, sFeaturesDir;
   std::string sOutDir = "";
   int iRotationAveragingMethod = int (ROTATION_AVERAGING_L2);
   int iTranslationAveragingMethod = int (TRANSLATION_AVERAGING_SOFTL1);
   std::string sIntrinsic_refinement_options = "ADJUST_ALL";
   bool b_use_motion_priors = false;
+  L1_ADMM_Translation_Averaging_Options l1_admm_options;
 
   cmd.add( make_option('i', sSfM_Data_Filename, "input_file") );
   cmd.add( make_option('m', sMatchesDir, "matchdir") );
@@ -63,6 +65,10 @@ int main(int argc, char **argv)
   cmd.add( make_option('f', sIntrinsic_refinement_options, "refineIntrinsics") );
   cmd.add( make_switch('P', "prior_usage") );
   cmd.add( make_option('F', sFeaturesDir, "features_dir") ); // CPM
+  cmd.add( make_option('a', sPrevious_SfM_Data_Filename, "previous_reconstruction") );
+  cmd.add( make_option('I', l1_admm_options.max_iterations, "admm_max_iterations") );
+  cmd.add( make_option('A', l1_admm_options.absolute_tolerance, "admm_absolute_tolerance") );
+  cmd.add( make_option('R', l1_admm_options.relative_tolerance, "admm_relative_tolerance") );
 
   try {
     if (argc == 1) throw std::string("Invalid parameter.");
@@ -81,6 +87,8 @@ int main(int argc, char **argv)
       << "\t 1 -> L1 minimization\n"
       << "\t 2 -> L2 minimization of sum of squared Chordal distances\n"
       << "\t 3 -> SoftL1 minimization (default)\n"
+      << "\t 4 -> L1 minimization with ADMM (sparse solver for large scenes):\n"
+      <<      "\t\t minimizes the sum of the residuals (1 minimizes their maximum)\n"
     << "[-f|--refineIntrinsics] Intrinsic parameters refinement option\n"
       << "\t ADJUST_ALL -> refine all existing parameters (default) \n"
       << "\t NONE -> intrinsic parameters are held as constant\n"
@@ -96,6 +104,15 @@ int main(int argc, char **argv)
       <<      "\t\t-> refine the principal point position & the distortion coefficient(s) (if any)\n"
     << "[-P|--prior_usage] Enable usage of motion priors (i.e GPS positions)\n"
     << "[-M|--match_file] path to the match file to use.\n"
+    << "[-a|--previous_reconstruction] path to a previous SfM_Data reconstruction of\n"
+      << "\t a subset of the input views (incremental mode): its poses are kept fixed,\n"
+      << "\t only the new views are registered and adjusted with their neighborhood.\n"
+    << "[-I|--admm_max_iterations] L1 ADMM translation averaging: maximum number of iterations\n"
+      << "\t (default " << l1_admm_options.max_iterations << ")\n"
+    << "[-A|--admm_absolute_tolerance] L1 ADMM translation averaging: absolute tolerance\n"
+      << "\t (default " << l1_admm_options.absolute_tolerance << ")\n"
+    << "[-R|--admm_relative_tolerance] L1 ADMM translation averaging: relative tolerance\n"
+      << "\t (default " << l1_admm_options.relative_tolerance << ")\n"
     << std::endl;
 
     std::cerr << s << std::endl;
@@ -119,11 +136,18 @@ int main(int argc, char **argv)
   }
 
   if (iTranslationAveragingMethod < TRANSLATION_AVERAGING_L1 ||
-      iTranslationAveragingMethod > TRANSLATION_AVERAGING_SOFTL1 )  {
+      iTranslationAveragingMethod > TRANSLATION_AVERAGING_L1_ADMM )  {
     std::cerr << "\n Translation averaging method is invalid" << std::endl;
     return EXIT_FAILURE;
   }
 
+  if (l1_admm_options.max_iterations <= 0 ||
+      l1_admm_options.absolute_tolerance < 0.0 ||
+      l1_admm_options.relative_tolerance < 0.0)  {
+    std::cerr << "\n L1 ADMM translation averaging options are invalid" << std::endl;
+    return EXIT_FAILURE;
+  }
+
   // Load input SfM_Data scene
   SfM_Data sfm_data;
   if (!Load(sfm_data, sSfM_Data_Filename, ESfM_Data(VIEWS|INTRINSICS))) {
@@ -132,6 +156,31 @@ int main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
+  // Incremental mode: start from the previous reconstruction
+  if (!sPrevious_SfM_Data_Filename.empty())
+  {
+    SfM_Data previous_sfm_data;
+    if (!Load(previous_sfm_data, sPrevious_SfM_Data_Filename, ESfM_Data(ALL))) {
+      std::cerr << std::endl
+        << "The previous SfM_Data file \""<< sPrevious_SfM_Data_Filename << "\" cannot be read." << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (const auto & view_it : previous_sfm_data.GetViews())
+    {
+      if (sfm_data.GetViews().count(view_it.first) == 0) {
+        std::cerr << std::endl
+          << "The previous reconstruction view " << view_it.first
+          << " is not in the input SfM_Data scene." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    // Keep the refined intrinsics, the poses and the structure
+    for (const auto & intrinsic_it : previous_sfm_data.GetIntrinsics())
+      sfm_data.intrinsics[intrinsic_it.first] = intrinsic_it.second;
+    sfm_data.poses = previous_sfm_data.poses;
+    sfm_data.structure = previous_sfm_data.structure;
+  }
+
   // Init the regions_type from the image describer file (used for image regions extraction)
   using namespace openMVG::features;
   const std::string sImage_describer = stlplus::create_filespec(sMatchesDir, "image_describer", "json");
@@ -201,6 +250,8 @@ int main(int argc, char **argv)
     ERotationAveragingMethod(iRotationAveragingMethod));
   sfmEngine.SetTranslationAveragingMethod(
     ETranslationAveragingMethod(iTranslationAveragingMethod));
+  sfmEngine.SetTranslationAveragingL1_ADMM_Options(l1_admm_options);
+  sfmEngine.SetIncrementalMode(!sPrevious_SfM_Data_Filename.empty());
 
   if (sfmEngine.Process())
   {
@@ -84,6 +84,9 @@ int main(int argc, char **argv)
   bool b_use_motion_priors = false;
   int triangulation_method = static_cast<int>(ETriangulationMethod::DEFAULT);
   int resection_method  = static_cast<int>(resection::SolverType::DEFAULT);
+  double checkpoint_period = -1.0;
+  unsigned int initial_pair_max_evaluated_pairs = 0;
+  float initial_pair_early_stop_angle = 0.0f;
 
   cmd.add( make_option('i', sSfM_Data_Filename, "input_file") );
   cmd.add( make_option('m', sMatchesDir, "matchdir") );
@@ -96,6 +99,11 @@ int main(int argc, char **argv)
   cmd.add( make_switch('P', "prior_usage") );
   cmd.add( make_option('t', triangulation_method, "triangulation_method"));
   cmd.add( make_option('r', resection_method, "resection_method"));
+  cmd.add( make_option('C', checkpoint_period, "checkpoint_period"));
+  cmd.add( make_switch('R', "resume"));
+  cmd.add( make_option('n', initial_pair_max_evaluated_pairs, "initial_pair_max_pairs"));
+  cmd.add( make_option('e', initial_pair_early_stop_angle, "initial_pair_early_stop_angle"));
+  cmd.add( make_switch('S', "initial_pair_score_cache"));
 
   try {
     if (argc == 1) throw std::string("Invalid parameter.");
@@ -140,6 +148,15 @@ int main(int argc, char **argv)
     << "\t" << static_cast<int>(resection::SolverType::P3P_KNEIP_CVPR11) << ": P3P_KNEIP_CVPR11\n"
     << "\t" << static_cast<int>(resection::SolverType::P3P_NORDBERG_ECCV18) << ": P3P_NORDBERG_ECCV18\n"
     << "\t" << static_cast<int>(resection::SolverType::UP2P_KUKELOVA_ACCV10)  << ": UP2P_KUKELOVA_ACCV10 | 2Points | upright camera\n"
+    << "[-C|--checkpoint_period] minimal time between two checkpoints of the reconstruction\n"
+    << "\t (seconds, a negative value disables them, default=" << checkpoint_period << ": disabled)\n"
+    << "[-R|--resume] resume the reconstruction from the checkpoint of the output directory\n"
+    << "[-n|--initial_pair_max_pairs] automatic initial pair selection: number of pairs\n"
+    << "\t (pre-ranked by their parallax) for which a relative pose is evaluated (default=0: all the pairs)\n"
+    << "[-e|--initial_pair_early_stop_angle] automatic initial pair selection: stop the\n"
+    << "\t evaluation once a pair with this median triangulation angle (degree) is found (default=0: disabled)\n"
+    << "[-S|--initial_pair_score_cache] automatic initial pair selection: save the pair scores\n"
+    << "\t in the output directory and reuse the ones of a previous run\n"
     << std::endl;
 
     std::cerr << s << std::endl;
@@ -238,6 +255,11 @@ int main(int argc, char **argv)
   sfmEngine.Set_Use_Motion_Prior(b_use_motion_priors);
   sfmEngine.SetTriangulationMethod(static_cast<ETriangulationMethod>(triangulation_method));
   sfmEngine.SetResectionMethod(static_cast<resection::SolverType>(resection_method));
+  sfmEngine.SetCheckpointParameters(checkpoint_period, cmd.used('R'));
+  sfmEngine.SetInitialPairSelectionParameters(
+    initial_pair_max_evaluated_pairs,
+    initial_pair_early_stop_angle,
+    cmd.used('S'));
 
   // Handle Initial pair parameter
   if (!initialPairString.first.empty() && !initialPairString.second.empty())
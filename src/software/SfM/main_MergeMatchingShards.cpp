@@ -0,0 +1,153 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/matching/indMatch_utils.hpp"
+#include "openMVG/matching_image_collection/Pair_Builder.hpp"
+#include "openMVG/matching_image_collection/Pair_Sharding.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_io.hpp"
+
+#include "third_party/cmdLine/cmdLine.h"
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <string>
+
+using namespace openMVG;
+using namespace openMVG::matching;
+using namespace openMVG::sfm;
+
+int main(int argc, char **argv)
+{
+  std::cout << std::endl
+    << "-----------------------------------------------------------\n"
+    << "Merge the matches of the shards of a distributed matching\n"
+    << "(see main_ShardMatchingPairs).\n"
+    << "-----------------------------------------------------------\n"
+    << std::endl;
+
+  CmdLine cmd;
+
+  std::string sSfM_Data_Filename;
+  std::string sPlanDirectory;
+  std::string sMatchesFilename = "matches.f.bin";
+  std::string sOutputFilename;
+
+  cmd.add( make_option('i', sSfM_Data_Filename, "input_file") );
+  cmd.add( make_option('p', sPlanDirectory, "plan_dir") );
+  cmd.add( make_option('m', sMatchesFilename, "matches_file") );
+  cmd.add( make_option('o', sOutputFilename, "output_file") );
+
+  try {
+    if (argc == 1) throw std::string("Invalid command line parameter.");
+    cmd.process(argc, argv);
+  } catch (const std::string& s) {
+    std::cerr << "Usage: " << argv[0] << '\n'
+    << "[-i|--input_file] the SfM_Data file used for the matching\n"
+    << "[-p|--plan_dir] the matching plan directory\n"
+    << "[-o|--output_file] the merged matches file (i.e ./matches.f.bin)\n"
+    << "\n[Optional]\n"
+    << "[-m|--matches_file] name of the match file of the shards (default: matches.f.bin)\n"
+    << std::endl;
+
+    std::cerr << s << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << " You called : " << "\n"
+            << argv[0] << "\n"
+            << "--input_file " << sSfM_Data_Filename << "\n"
+            << "--plan_dir " << sPlanDirectory << "\n"
+            << "--matches_file " << sMatchesFilename << "\n"
+            << "--output_file " << sOutputFilename << std::endl;
+
+  if (sOutputFilename.empty())
+  {
+    std::cerr << "\nInvalid output filename." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  SfM_Data sfm_data;
+  if (!Load(sfm_data, sSfM_Data_Filename, ESfM_Data(VIEWS))) {
+    std::cerr << std::endl
+      << "The input SfM_Data file \""<< sSfM_Data_Filename << "\" cannot be read." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Shard count of the plan
+  std::size_t shard_count = 0;
+  {
+    const std::string sPlanFile = stlplus::create_filespec(sPlanDirectory, "matching_plan", "txt");
+    std::ifstream plan_stream(sPlanFile.c_str());
+    std::string sKey;
+    if (!(plan_stream >> sKey >> shard_count) || sKey != "shard_count")
+    {
+      std::cerr << "\nInvalid matching plan: " << sPlanFile << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  //---------------------------------------
+  // Check that every shard is complete before merging
+  //---------------------------------------
+  std::vector<std::size_t> missing_shards;
+  for (std::size_t shard = 0; shard < shard_count; ++shard)
+  {
+    if (!stlplus::file_exists(
+          stlplus::create_filespec(shardDirectory(sPlanDirectory, shard), sMatchesFilename)))
+      missing_shards.push_back(shard);
+  }
+  if (!missing_shards.empty())
+  {
+    std::cerr << "\n" << missing_shards.size() << " shard(s) are not complete, run them again:" << std::endl;
+    for (const std::size_t shard : missing_shards)
+      std::cerr << shardDirectory(sPlanDirectory, shard) << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  //---------------------------------------
+  // Merge the shards (pairs are checked against the plan)
+  //---------------------------------------
+  PairWiseMatches map_Matches;
+  for (std::size_t shard = 0; shard < shard_count; ++shard)
+  {
+    const std::string sShardDirectory = shardDirectory(sPlanDirectory, shard);
+    Pair_Set shard_pairs;
+    PairWiseMatches shard_matches;
+    std::string error;
+    if (!loadPairs(sfm_data.GetViews().size(),
+          stlplus::create_filespec(sShardDirectory, "pairs", "txt"), shard_pairs))
+      return EXIT_FAILURE;
+    if (!Load(shard_matches, stlplus::create_filespec(sShardDirectory, sMatchesFilename)))
+    {
+      std::cerr << "\nCannot load the matches of the shard: " << sShardDirectory << std::endl;
+      return EXIT_FAILURE;
+    }
+    const std::size_t pair_count = shard_matches.size();
+    if (!mergeShardMatches(shard_pairs, shard_matches, map_Matches, error))
+    {
+      std::cerr << "\nInvalid shard " << sShardDirectory << ": " << error << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << sShardDirectory << ": " << pair_count << " matched pairs" << std::endl;
+  }
+
+  if (!Save(map_Matches, sOutputFilename))
+  {
+    std::cerr << "\nCannot save the merged matches: " << sOutputFilename << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The digest identifies the merged matches (i.e. to compare two runs)
+  std::cout
+    << "\n#merged pairs: " << map_Matches.size() << "\n"
+    << "matches digest: " << std::hex << std::setfill('0') << std::setw(16)
+    << matchesDigest(map_Matches) << std::dec << std::endl;
+
+  return EXIT_SUCCESS;
+}
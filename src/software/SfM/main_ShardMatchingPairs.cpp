@@ -0,0 +1,162 @@
+// This file is part of OpenMVG, an Open Multiple View Geometry C++ library.
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "openMVG/matching_image_collection/Pair_Builder.hpp"
+#include "openMVG/matching_image_collection/Pair_Sharding.hpp"
+#include "openMVG/sfm/pipelines/sfm_regions_provider.hpp"
+#include "openMVG/sfm/sfm_data.hpp"
+#include "openMVG/sfm/sfm_data_io.hpp"
+
+#include "third_party/cmdLine/cmdLine.h"
+#include "third_party/stlplus3/filesystemSimplified/file_system.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+using namespace openMVG;
+using namespace openMVG::sfm;
+
+int main(int argc, char **argv)
+{
+  std::cout << std::endl
+    << "-----------------------------------------------------------\n"
+    << "Split the matching pairs into shards for a distributed matching:\n"
+    << " - the shards have a balanced matching cost (feature counts),\n"
+    << " - each shard is matched by an independent main_ComputeMatches\n"
+    << "   run (that can be restarted alone and resumed),\n"
+    << " - the shard results are merged by main_MergeMatchingShards.\n"
+    << "-----------------------------------------------------------\n"
+    << std::endl;
+
+  CmdLine cmd;
+
+  std::string sSfM_Data_Filename;
+  std::string sPlanDirectory;
+  std::string sFeaturesDirectory;
+  std::string sPredefinedPairList;
+  int iShardCount = 0;
+
+  cmd.add( make_option('i', sSfM_Data_Filename, "input_file") );
+  cmd.add( make_option('o', sPlanDirectory, "out_dir") );
+  cmd.add( make_option('n', iShardCount, "shard_count") );
+  cmd.add( make_option('F', sFeaturesDirectory, "features_dir") );
+  cmd.add( make_option('l', sPredefinedPairList, "pair_list") );
+
+  try {
+    if (argc == 1) throw std::string("Invalid command line parameter.");
+    cmd.process(argc, argv);
+  } catch (const std::string& s) {
+    std::cerr << "Usage: " << argv[0] << '\n'
+    << "[-i|--input_file] a SfM_Data file\n"
+    << "[-o|--out_dir] the matching plan directory (one shard_XXXX directory per shard)\n"
+    << "[-n|--shard_count] number of shards\n"
+    << "[-F|--features_dir] directory of the features (trailing @ means include parent directory)\n"
+    << "\n[Optional]\n"
+    << "[-l|--pair_list] file of the pairs to match (default: exhaustive matching)\n"
+    << std::endl;
+
+    std::cerr << s << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << " You called : " << "\n"
+            << argv[0] << "\n"
+            << "--input_file " << sSfM_Data_Filename << "\n"
+            << "--out_dir " << sPlanDirectory << "\n"
+            << "--shard_count " << iShardCount << "\n"
+            << "--features_dir " << sFeaturesDirectory << "\n"
+            << "--pair_list " << sPredefinedPairList << std::endl;
+
+  if (iShardCount <= 0)
+  {
+    std::cerr << "\nInvalid shard count" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (sPlanDirectory.empty()
+      || (!stlplus::is_folder(sPlanDirectory) && !stlplus::folder_create(sPlanDirectory)))
+  {
+    std::cerr << "\nIt is an invalid output directory" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  SfM_Data sfm_data;
+  if (!Load(sfm_data, sSfM_Data_Filename, ESfM_Data(VIEWS|INTRINSICS))) {
+    std::cerr << std::endl
+      << "The input SfM_Data file \""<< sSfM_Data_Filename << "\" cannot be read." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Pairs to match (the same as main_ComputeMatches would match)
+  Pair_Set pairs;
+  if (sPredefinedPairList.empty())
+    pairs = exhaustivePairs(sfm_data.GetViews().size());
+  else if (!loadPairs(sfm_data.GetViews().size(), sPredefinedPairList, pairs))
+    return EXIT_FAILURE;
+
+  // The matching cost of a view grows with its descriptor count:
+  // the size of its descriptor file is used as weight
+  View_Weights weights;
+  for (const auto & view_it : sfm_data.GetViews())
+  {
+    const std::string sDescFile = generate_feature_path(
+      sFeaturesDirectory, view_it.second->s_Img_path, ".desc");
+    if (!stlplus::is_file(sDescFile))
+    {
+      std::cerr << "\nMissing descriptor file: " << sDescFile << std::endl;
+      return EXIT_FAILURE;
+    }
+    weights[view_it.first] = static_cast<std::size_t>(stlplus::file_size(sDescFile));
+  }
+
+  const std::vector<Pair_Set> shards = shardPairs(pairs, weights, iShardCount);
+
+  //---------------------------------------
+  // Export the plan: the pair list of each shard and a summary
+  //---------------------------------------
+  const std::string sPlanFile = stlplus::create_filespec(sPlanDirectory, "matching_plan", "txt");
+  std::ofstream plan_stream(sPlanFile.c_str());
+  if (!plan_stream.is_open())
+  {
+    std::cerr << "\nCannot write the matching plan: " << sPlanFile << std::endl;
+    return EXIT_FAILURE;
+  }
+  plan_stream << "shard_count " << shards.size() << "\n"
+    << "# shard pair_count cost" << "\n";
+
+  std::cout << "\n#pairs: " << pairs.size() << " in " << shards.size() << " shards" << std::endl;
+  for (std::size_t shard = 0; shard < shards.size(); ++shard)
+  {
+    const std::string sShardDirectory = shardDirectory(sPlanDirectory, shard);
+    if (!stlplus::is_folder(sShardDirectory) && !stlplus::folder_create(sShardDirectory))
+    {
+      std::cerr << "\nCannot create the shard directory: " << sShardDirectory << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (!savePairs(stlplus::create_filespec(sShardDirectory, "pairs", "txt"), shards[shard]))
+      return EXIT_FAILURE;
+
+    double cost = 0.0;
+    for (const Pair & pair : shards[shard])
+      cost += pairMatchingCost(pair, weights);
+    plan_stream << shard << ' ' << shards[shard].size() << ' ' << cost << "\n";
+
+    std::cout
+      << "openMVG_main_ComputeMatches -i " << sSfM_Data_Filename
+      << " -F " << sFeaturesDirectory
+      << " -o " << sShardDirectory
+      << " -l " << stlplus::create_filespec(sShardDirectory, "pairs", "txt")
+      << " -R"
+      << "  # " << shards[shard].size() << " pairs" << std::endl;
+  }
+  plan_stream.close();
+  if (!plan_stream)
+  {
+    std::cerr << "\nCannot write the matching plan: " << sPlanFile << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -10,6 +10,7 @@
 #define TOOLS_PRECISION_EVALUATION_TO_GT_HPP
 
 #include "openMVG/numeric/numeric.h"
+#include "openMVG/geometry/ply_point_cloud.hpp"
 #include "openMVG/geometry/rigid_transformation3D_srt.hpp"
 
 #include "third_party/htmlDoc/htmlDoc.hpp"
@@ -66,33 +67,13 @@ static bool exportToPly(const std::vector<Vec3> & vec_camPosGT,
   const std::vector<Vec3> & vec_camPosComputed,
   const std::string & sFileName)
 {
-  std::ofstream outfile;
-  outfile.open(sFileName.c_str(), std::ios_base::out);
-
-  outfile << "ply"
-    << '\n' << "format ascii 1.0"
-    << '\n' << "element vertex " << vec_camPosGT.size()+vec_camPosComputed.size()
-    << '\n' << "property float x"
-    << '\n' << "property float y"
-    << '\n' << "property float z"
-    << '\n' << "property uchar red"
-    << '\n' << "property uchar green"
-    << '\n' << "property uchar blue"
-    << '\n' << "end_header" << std::endl;
-
-  for (size_t i=0; i < vec_camPosGT.size(); ++i)  {
-    outfile << vec_camPosGT[i].transpose()
-      << " 0 255 0" << "\n";
-  }
+  geometry::Ply_Point_Writer writer;
+  if (!writer.Open(sFileName, vec_camPosGT.size()+vec_camPosComputed.size()))
+    return false;
 
-  for (size_t i=0; i < vec_camPosComputed.size(); ++i)  {
-    outfile << vec_camPosComputed[i].transpose()
-      << " 255 255 0" << "\n";
-  }
-  outfile.flush();
-  const bool bOk = outfile.good();
-  outfile.close();
-  return bOk;
+  bool bOk = writer.Write(vec_camPosGT, geometry::Ply_Color(0, 255, 0));
+  bOk &= writer.Write(vec_camPosComputed, geometry::Ply_Color(255, 255, 0));
+  return writer.Close() && bOk;
 }
 
 /// Compare two camera path (translation and rotation residual after a 7DOF rigid registration)